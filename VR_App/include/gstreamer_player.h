@@ -3,13 +3,22 @@
  *
  * Manages two GStreamer pipelines (left and right eye) for receiving and
  * decoding RTP video streams. Supports three codec paths:
- *   - JPEG:  software decode via jpegdec -> appsink (CPU buffer)
+ *   - JPEG:  software decode -> CPU buffer; sliced across a thread pool by
+ *            JpegDecoder in the appsink callback (or jpegdec in-pipeline)
  *   - H264:  hardware decode via Qualcomm AMC -> glsinkbin (GL texture)
  *   - H265:  hardware decode via Qualcomm AMC -> glsinkbin (GL texture)
  *
  * Each pipeline inserts GStreamer identity elements at key points to
- * measure per-stage latency (UDP receive, RTP depay, decode, queue).
+ * measure per-stage latency (UDP receive, RTP depay, decode, queue); the
+ * pipeline strings and those probes live in ReceivePipeline, this class adds
+ * the Android GL sink and frame hand-off to the renderer.
  * Pipeline configuration and the GLib main loop run on a dedicated thread.
+ *
+ * Each pipeline is a long-lived RTP head (udpsrc -> jitterbuffer) plus a
+ * swappable decode tail bin ("dec_tail"). Codec changes flush the head and
+ * swap only the tail; resolution and fps changes only renegotiate the
+ * decoder caps. The main loop, udpsrc, jitterbuffer and stats all stay
+ * alive, as on the streaming driver.
  */
 #pragma once
 
@@ -21,26 +30,11 @@
 #include "types/camera_types.h"
 #include "BS_thread_pool.hpp"
 #include "ntp_timer.h"
+#include "jpeg_decoder.h"
+#include "receive_pipeline.h"
 #include <gst/gl/gstglcontext.h>
 #include <gst/gl/egl/gstgldisplay_egl.h>
 
-// ---------------------------------------------------------------------------
-// HW decoder selection
-// 1 = Quest dedicated low-latency AVC/HEVC components (emit frames as soon as
-//     decoded, no output-reorder queue; best for a single live stream).
-// 0 = stock decoders.
-// ---------------------------------------------------------------------------
-#define BUT_USE_LOW_LATENCY_DECODER 1
-
-#if BUT_USE_LOW_LATENCY_DECODER
-#define BUT_H264_DECODER "amcviddec-omxqcomvideodecoderavclowlatency"
-#define BUT_H265_DECODER "amcviddec-omxqcomvideodecoderhevclowlatency"
-#else
-#define BUT_H264_DECODER "amcviddec-omxqcomvideodecoderavc"
-#define BUT_H265_DECODER "amcviddec-omxqcomvideodecoderhevc"
-#endif
-
-
 class GstreamerPlayer {
 public:
 
@@ -50,31 +44,22 @@ public:
 
     /**
      * (Re)configure and start the stereo pipelines for the given streaming config.
-     * Stops any existing pipelines first. Runs the GLib main loop on the thread pool.
+     * Codec, resolution and fps changes in stereo/mono are applied to the
+     * running pipelines (decode-tail swap / caps renegotiation). Anything else stops
+     * the existing pipelines and builds new ones, with the GLib main loop run
+     * on the thread pool.
      */
     void configurePipelines(BS::thread_pool<BS::tp::none> &threadPool, const StreamingConfig &config);
 
 private:
 
-    /** Callback context: camera pair for frame output, NTP timer for timestamps,
-     *  and a pointer to the configured stream FPS used as the rolling-average
-     *  window size by CameraStats::updateHistory(). */
-    struct GStreamerCallbackObj {
-        CamPair *first;                    // kept .first/.second to minimise diff
-        NtpTimer *second;
-        std::atomic<int> *windowFrames;
-        GStreamerCallbackObj(CamPair *cp, NtpTimer *nt, std::atomic<int> *wf)
-            : first(cp), second(nt), windowFrames(wf) {}
-    };
+    using GStreamerCallbackObj = ReceiveCallbackObj;
 
     /** Called when appsink has a new decoded frame (GL texture or CPU buffer). */
     static GstFlowReturn newFrameCallback(GstElement *sink, GStreamerCallbackObj *callbackObj);
 
-    /** Extract per-frame latency data from RTP header extensions (identity at UDP source). */
-    static void onRtpHeaderMetadata(GstElement *identity, GstBuffer *buffer, gpointer data);
-
-    /** Record timestamps at pipeline probe points (rtpdepay, decoder, queue). */
-    static void onIdentityHandoff(GstElement *identity, GstBuffer *buffer, gpointer data);
+    /** newFrameCallback for image/jpeg samples: decode, then publish the planes by buffer swap. */
+    static GstFlowReturn publishJpegSample(GstElement *sink, GstSample *sample, GStreamerCallbackObj *callbackObj);
 
     static void stateChangedCallback(GstBus *bus, GstMessage *msg, GstElement *pipeline);
 
@@ -84,18 +69,43 @@ private:
 
     static void errorCallback(GstBus *bus, GstMessage *msg, GstElement *pipeline);
 
-    static GstPadProbeReturn udpPacketProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    /** Configure a single stereo pipeline (left or right eye). */
+    void configureSinglePipeline(GstElement* pipeline, const char* pipelineName, int port,
+                                 const StreamingConfig& config);
 
-    static GstCaps* buildDecoderSrcCaps(Codec codec, int width, int height, int fps);
+    /**
+     * Build the decode tail for config, add it to the pipeline behind
+     * postjb_ident and wire its sink and latency probes. The caller brings it
+     * to the pipeline's state. Returns the tail (owned by the pipeline), or
+     * nullptr if it could not be built or linked.
+     */
+    GstElement *addDecodeTail(GstElement *pipeline, const char *pipelineName, const StreamingConfig &config);
 
-    /** Helper functions for cleaner GStreamer element management. */
-    static GstElement* getElementRequired(GstElement* pipeline, const char* name, const char* context);
-    static GstElement* getElementOptional(GstElement* pipeline, const char* name);
-    static void connectAndUnref(GstElement* element, const char* signal, GCallback callback, gpointer data);
+    /** True if the running pipelines can move from `from` to `to` without a rebuild. */
+    static bool canReconfigureLive(const StreamingConfig &from, const StreamingConfig &to);
 
-    /** Configure a single stereo pipeline (left or right eye). */
-    void configureSinglePipeline(GstElement* pipeline, const char* pipelineName, int port,
-                                 const StreamingConfig& config, const std::string& xDimString, int payload);
+    /** Apply a canReconfigureLive() change to the running pipelines. Returns false if a rebuild is needed. */
+    bool reconfigureLive(const StreamingConfig &config, uint64_t reconfigureStartUs);
+
+    /**
+     * Codec change: flush the RTP head, replace the decode tail with one for
+     * config and restart the flow. Returns false if the new tail could not
+     * be built.
+     */
+    bool swapDecodeTail(GstElement *pipeline, const char *pipelineName, const StreamingConfig &config);
+
+    /** Replaces postjb_ident's stale sticky caps after a tail swap. userData = the new RTP caps. */
+    static GstPadProbeReturn replaceStaleCapsProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+
+    /**
+     * Resolution change within one codec: set the RTP caps and arm
+     * resolutionCapsProbe to renegotiate the decoder once the stream's caps
+     * carry the new size. Returns false if there is no probe point.
+     */
+    bool renegotiateResolution(GstElement *pipeline, const char *pipelineName, const StreamingConfig &config,
+                               uint64_t reconfigureStartUs, uint32_t generation);
+
+    static GstPadProbeReturn resolutionCapsProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
 
     GstElement *pipelineLeft_{}, *pipelineRight_{};
     GstContext *gContext_{};
@@ -104,61 +114,23 @@ private:
     GMainLoop *mainLoop_{};
     std::future<void> mainLoopFuture_;
 
+    /** Config the running pipelines were built for (or last reconfigured to). */
+    std::optional<StreamingConfig> activeConfig_;
+
+    /** Bumped by every in-place reconfigure; resolution probes armed by an earlier one remove themselves. */
+    std::atomic<uint32_t> reconfigureGeneration_{0};
+
+    /** Slice workers for the parallel JPEG decoders; each eye's callback thread decodes one slice too. */
+    static constexpr size_t JPEG_DECODE_THREADS = 3;
+    BS::thread_pool<BS::tp::none> jpegDecodePool_{JPEG_DECODE_THREADS};
+    std::unique_ptr<JpegDecoder> jpegDecoders_[2];
+
+    /** Jitterbuffer stats samplers attached to gMainContext_, one per pipeline. */
+    std::vector<GSource *> jbSamplers_;
+
     CamPair *camPair_;
     GStreamerCallbackObj *callbackObj_;
 
-    /** Rolling-average window size for CameraStats; tracks streamingConfig.fps. */
-    std::atomic<int> windowFrames_{60};
-
     NtpTimer *ntpTimer_;
 
-    /*
-     * GStreamer pipeline definition strings.
-     * Each pipeline: UDP source -> RTP jitter buffer -> depay -> decode -> output.
-     * Named elements (name=...) are configured at runtime in configureSinglePipeline().
-     * Identity elements (name=*_ident) are latency measurement probe points.
-     */
-
-    const std::string jpegPipeline_ =
-        "udpsrc name=udpsrc"
-        " ! capsfilter name=rtp_capsfilter"
-            " caps=\"application/x-rtp, media=video, encoding-name=JPEG, payload=26, clock-rate=90000\""
-        " ! identity name=udpsrc_ident"
-        " ! rtpjitterbuffer name=jitterbuffer latency=15 do-lost=true drop-on-latency=true do-retransmission=false"
-        " ! identity name=postjb_ident"
-        " ! rtpjpegdepay ! identity name=rtpdepay_ident"
-        " ! jpegparse ! jpegdec ! videoconvert"
-        " ! video/x-raw,format=RGB"
-        " ! identity name=dec_ident ! identity name=queue_ident"
-        " ! appsink emit-signals=true name=appsink sync=false";
-
-    const std::string h264Pipeline_ =
-        "udpsrc name=udpsrc"
-        " ! capsfilter name=rtp_capsfilter"
-            " caps=\"application/x-rtp, encoding-name=H264, media=video, clock-rate=90000, payload=96\""
-        " ! identity name=udpsrc_ident"
-        " ! rtpjitterbuffer name=jitterbuffer latency=25 do-lost=true drop-on-latency=true do-retransmission=true"
-        " ! identity name=postjb_ident"
-        " ! rtph264depay ! identity name=rtpdepay_ident"
-        " ! h264parse config-interval=-1 ! queue"
-        " ! capsfilter name=dec_capsfilter"
-        " ! " BUT_H264_DECODER " name=dec"
-        " ! identity name=dec_ident ! queue max-size-buffers=1 leaky=downstream"
-        " ! identity name=queue_ident"
-        " ! glsinkbin name=glsink";
-
-    const std::string h265Pipeline_ =
-        "udpsrc name=udpsrc"
-        " ! capsfilter name=rtp_capsfilter"
-            " caps=\"application/x-rtp, encoding-name=H265, media=video, clock-rate=90000, payload=96\""
-        " ! identity name=udpsrc_ident"
-        " ! rtpjitterbuffer name=jitterbuffer latency=25 do-lost=true drop-on-latency=true do-retransmission=true"
-        " ! identity name=postjb_ident"
-        " ! rtph265depay ! identity name=rtpdepay_ident"
-        " ! h265parse config-interval=-1 ! queue"
-        " ! capsfilter name=dec_capsfilter"
-        " ! " BUT_H265_DECODER " name=dec"
-        " ! identity name=dec_ident ! queue max-size-buffers=1 leaky=downstream"
-        " ! identity name=queue_ident"
-        " ! glsinkbin name=glsink";
 };
@@ -0,0 +1,65 @@
+/**
+ * head_pose_streamer.h - Fixed-rate head pose sampling for the robot pan-tilt
+ *
+ * Samples the HMD (view space in app space) on its own thread at a fixed,
+ * configurable rate and posts each sample to RobotControlSender as a 0x01
+ * Head Pose message. Each sample is located at (now + the runtime's display
+ * lead + prediction horizon), i.e. the horizon past predicted photon time as
+ * when it was sampled per frame, so the servo gets evenly spaced targets
+ * that keep coming while the render loop is slow or stalled (e.g. during a
+ * pipeline reconfigure).
+ *
+ * XrTime is CLOCK_MONOTONIC nanoseconds on Android/Quest (see xr_timing.h),
+ * so "now" is read from CLOCK_MONOTONIC directly.
+ */
+#pragma once
+
+#include "pch.h"
+#include "robot_control_sender.h"
+#include <atomic>
+#include <thread>
+
+class HeadPoseStreamer {
+public:
+    static constexpr uint32_t MIN_RATE_HZ = 50;
+    static constexpr uint32_t MAX_RATE_HZ = 500;
+
+    /** Starts the sampling thread, inactive. sender must outlive the streamer. */
+    HeadPoseStreamer(XrSpace viewSpace, XrSpace baseSpace, RobotControlSender *sender);
+
+    /** Stops and joins the sampling thread. */
+    ~HeadPoseStreamer();
+
+    HeadPoseStreamer(const HeadPoseStreamer &) = delete;
+    HeadPoseStreamer &operator=(const HeadPoseStreamer &) = delete;
+
+    /** Send or hold off (headset off, session not running). */
+    void setActive(bool active) { active_ = active; }
+
+    /** Sampling rate (clamped to [MIN_RATE_HZ, MAX_RATE_HZ]), prediction horizon and servo speed limit. */
+    void setParameters(uint32_t rateHz, uint32_t predictionMs, uint32_t maxSpeed);
+
+private:
+    void streamLoop();
+
+    static int64_t monotonicNowNs();
+
+    XrSpace viewSpace_;
+    XrSpace baseSpace_;
+    RobotControlSender *sender_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> active_{false};
+    std::atomic<uint32_t> rateHz_{250};
+    std::atomic<uint32_t> predictionMs_{50};
+    std::atomic<uint32_t> maxSpeed_{990000};
+    std::thread thread_;
+
+    // Sampling thread only: achieved rate and send-interval jitter, logged every REPORT_INTERVAL_NS.
+    static constexpr int64_t REPORT_INTERVAL_NS = 10'000'000'000;
+    int64_t reportStartNs_{0};
+    int64_t lastSendNs_{0};
+    size_t intervals_{0};
+    double intervalSumUs_{0.0};
+    double intervalSumSqUs_{0.0};
+};
@@ -0,0 +1,78 @@
+/**
+ * jpeg_decoder.h - Sliced parallel JPEG -> I420 decoder
+ *
+ * jpegdec decodes a whole frame on the pipeline's streaming thread, which at
+ * QHD/UHD stereo costs more than a frame interval on one Quest core. When a
+ * frame carries restart markers (DRI), its entropy-coded data can be cut at
+ * any restart boundary that starts an MCU row; every such horizontal slice is
+ * an independent JPEG once the headers are copied in front of it and the SOF
+ * height is patched. JpegDecoder cuts the frame into as many slices as it has
+ * threads and decodes them concurrently, straight into the I420 planes
+ * (libjpeg raw-data output: no colour conversion, no upsampling).
+ *
+ * Frames without usable restart markers, or with a chroma layout other than
+ * 4:2:0, are decoded whole on the calling thread.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BS_thread_pool.hpp"
+
+struct JpegLayout;
+
+class JpegDecoder {
+public:
+
+    /**
+     * pool may be shared between decoders (one per eye); the calling thread
+     * always decodes one slice itself. nullptr = decode on the caller only.
+     */
+    explicit JpegDecoder(BS::thread_pool<BS::tp::none> *pool);
+
+    ~JpegDecoder();
+
+    JpegDecoder(const JpegDecoder &) = delete;
+    JpegDecoder &operator=(const JpegDecoder &) = delete;
+
+    /**
+     * Decode one JPEG frame into the decoder's output buffer (tightly packed
+     * I420, I420FrameSize(width, height) bytes). Returns the buffer, or
+     * nullptr if the frame is corrupt or its size is not width x height.
+     */
+    uint8_t *decode(const uint8_t *jpeg, size_t size, int width, int height);
+
+    /**
+     * Hand the current output buffer to the caller and decode into planes
+     * from now on, so a decoded frame can be published by pointer swap.
+     * planes must be a new[]-allocated I420 buffer of the size last decoded.
+     */
+    uint8_t *exchangeOutput(uint8_t *planes);
+
+    /** Slices the last decode() was split into (1 = whole-frame decode). */
+    int lastSliceCount() const { return lastSliceCount_; }
+
+private:
+
+    struct Slice {
+        int firstInterval, endInterval;   // restart intervals [first, end)
+        int firstRow, endRow;             // luma rows [first, end)
+        std::vector<uint8_t> jpeg;        // standalone JPEG for this slice
+        std::vector<uint8_t> scratch;     // rows that do not land in the planes
+    };
+
+    /** Split the frame at MCU-row-aligned restart boundaries; returns the slice count (<= 1: whole frame). */
+    int planSlices(const JpegLayout &layout);
+
+    bool decodeSlices(const uint8_t *jpeg, const JpegLayout &layout, int count);
+
+    BS::thread_pool<BS::tp::none> *pool_;
+    std::unique_ptr<uint8_t[]> output_;
+    size_t outputSize_{0};
+    std::vector<Slice> slices_;
+    std::vector<size_t> restartOffsets_;
+    std::vector<uint8_t> scratch_;        // whole-frame path
+    int lastSliceCount_{0};
+};
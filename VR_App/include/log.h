@@ -2,11 +2,15 @@
  * log.h - Android logcat logging macros
  *
  * All log output goes to Android logcat under the tag "but_telepresence".
+ * Off-Android (tools/receive_bench) the same macros print to stderr.
  * LOG_INFO and LOG_ERROR are always active. LOG_DEBUG is compiled out
  * unless the ENABLE_DEBUG_LOG flag is set in CMakeLists.txt.
  */
 #pragma once
 
+#ifdef __ANDROID__
+#include <android/log.h>
+
 #define LOG_INFO(...) __android_log_print(ANDROID_LOG_INFO, "but_telepresence", __VA_ARGS__)
 #define LOG_WARN(...) __android_log_print(ANDROID_LOG_WARN, "but_telepresence", __VA_ARGS__)
 #define LOG_ERROR(...) __android_log_print(ANDROID_LOG_ERROR, "but_telepresence", __VA_ARGS__)
@@ -16,3 +20,20 @@
 #else
 #define LOG_DEBUG(...) do {} while(0)
 #endif
+
+#else
+#include <cstdio>
+
+#define BUT_LOG_STDERR(level, ...) \
+    do { std::fprintf(stderr, level " " __VA_ARGS__); std::fputc('\n', stderr); } while(0)
+
+#define LOG_INFO(...) BUT_LOG_STDERR("I", __VA_ARGS__)
+#define LOG_WARN(...) BUT_LOG_STDERR("W", __VA_ARGS__)
+#define LOG_ERROR(...) BUT_LOG_STDERR("E", __VA_ARGS__)
+
+#ifdef ENABLE_DEBUG_LOG
+#define LOG_DEBUG(...) BUT_LOG_STDERR("D", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while(0)
+#endif
+#endif
@@ -1,24 +1,47 @@
 /**
- * ntp_timer.h - NTP time synchronization with exponential smoothing
+ * ntp_timer.h - Headset-to-robot clock synchronization with a drift-compensated clock model
  *
- * Provides NTP-adjusted timestamps for cross-device latency measurement.
- * Syncs every 2 seconds with the primary NTP server (typically the Jetson),
- * falling back to pool.ntp.org after FALLBACK_THRESHOLD consecutive failures.
- * Uses exponential moving average (alpha=0.1) to smooth offset jitter.
+ * Provides robot-clock timestamps for cross-device latency measurement.
+ * With EnableEchoSync() the samples come from clock pings (0x05) answered by
+ * the robot relay on its control port, the host whose CLOCK_REALTIME stamps
+ * the frames. NTP is the fallback, for cycles in which no echo comes back:
+ * the primary NTP server (typically the Jetson), then the optional fallback
+ * server after FALLBACK_THRESHOLD consecutive failures.
+ *
+ * Clock ping/echo (little-endian, microseconds of CLOCK_REALTIME):
+ *   [0x05] [seq (uint32)] [t1 (uint64)]                                   headset -> relay
+ *   [0x06] [seq (uint32)] [t1 (uint64)] [t2 (uint64)] [t3 (uint64)]       relay -> headset
+ *   t1 is echoed; t2 and t3 are the relay's receive and transmit times.
+ *
+ * Rather than smoothing the offset, the sync thread fits offset and skew
+ * (the rate difference between the two clocks) over a window of low-RTT
+ * samples and publishes the fit as a ClockModel through a SeqLock. Timestamps
+ * are offset + skew·(t − t0), computed on the caller's thread without locks.
+ * Because the model tracks drift, the sync interval backs off from
+ * MIN_SYNC_INTERVAL_MS to MAX_SYNC_INTERVAL_MS while the predicted error stays
+ * under TARGET_ERROR_US.
  */
 #pragma once
 #include <string>
 #include <cstdint>
 #include <tuple>
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include "utils/seq_lock.h"
 
 /** A single NTP measurement sample. */
 struct Sample {
-    int64_t offset;   /* clock offset in microseconds (local - server) */
+    int64_t offset;   /* clock offset in microseconds (server - local) */
     uint64_t rtt;     /* round-trip time in microseconds */
     uint64_t diff;    /* difference between local and server transmit time */
+    uint64_t localUs; /* local time the offset refers to: midpoint of T1 and T4 */
 };
 
 /** Outcome of a single sample attempt — used by SyncWithServer for diagnostics. */
@@ -28,6 +51,38 @@ enum class SampleOutcome {
     Failed,        /* socket/recv/resolve/exception path */
 };
 
+/** Where the samples behind the clock model came from. */
+enum class ClockSource : uint8_t {
+    None,
+    Echo,   /* clock ping/echo with the robot relay */
+    Ntp,    /* NTP fallback */
+};
+
+/**
+ * Local-to-server clock mapping, valid once the first sample is in:
+ * server = local + offsetUs + skewPpm·1e-6·(local − refLocalUs).
+ * The error bound is offsetErrorUs at refLocalUs and widens by skewErrorPpm
+ * (µs per second) with distance from it.
+ */
+struct ClockModel {
+    uint64_t refLocalUs;    /* t0, local clock */
+    int64_t offsetUs;       /* server - local at t0 */
+    double skewPpm;         /* server clock rate relative to local, parts per million */
+    double offsetErrorUs;   /* error bound at t0: path asymmetry + fit residuals */
+    double skewErrorPpm;    /* skew uncertainty (2 sigma) */
+    bool valid;
+
+    [[nodiscard]] int64_t OffsetAt(uint64_t localUs) const {
+        const double dtUs = static_cast<double>(static_cast<int64_t>(localUs - refLocalUs));
+        return offsetUs + static_cast<int64_t>(skewPpm * 1e-6 * dtUs);
+    }
+
+    [[nodiscard]] double ErrorBoundAt(uint64_t localUs) const {
+        const double dtUs = static_cast<double>(static_cast<int64_t>(localUs - refLocalUs));
+        return offsetErrorUs + skewErrorPpm * 1e-6 * (dtUs < 0 ? -dtUs : dtUs);
+    }
+};
+
 class NtpTimer {
 public:
     explicit NtpTimer(const std::string& ntpServerAddress,
@@ -37,32 +92,60 @@ public:
      *  embedded std::thread is destroyed; otherwise std::terminate() fires. */
     ~NtpTimer();
 
+    /** Sync from clock echoes of the relay at address:port first, NTP only as fallback. Call before StartAutoSync(). */
+    void EnableEchoSync(const std::string& address, uint16_t port);
+
     /** Start the background sync loop (runs on its own io_context thread). */
     void StartAutoSync();
 
-    /** Return current time in microseconds, adjusted by the smoothed NTP offset. */
+    /** Return current time in microseconds, mapped through the clock model. Lock-free. */
     [[nodiscard]] uint64_t GetCurrentTimeUs() const;
 
-    /** Return the current smoothed NTP offset in microseconds. */
-    [[nodiscard]] int64_t GetSmoothedOffsetUs() const { return smoothedOffsetUs_; }
-    [[nodiscard]] bool HasInitialOffset() const { return hasInitialOffset_; }
+    /** Return the model's offset (server - local) at the current time, in microseconds. */
+    [[nodiscard]] int64_t GetOffsetUs() const {
+        return model_.load().OffsetAt(GetCurrentTimeUsNonAdjusted());
+    }
+    [[nodiscard]] bool HasInitialOffset() const { return model_.load().valid; }
     [[nodiscard]] uint64_t GetTimeSinceLastSyncUs() const {
-        return GetCurrentTimeUsNonAdjusted() - lastSyncedTimestampLocal_;
+        return GetCurrentTimeUsNonAdjusted() - lastSyncedTimestampLocal_.load(std::memory_order_relaxed);
+    }
+
+    /** Estimated bound on the error of GetCurrentTimeUs() right now, in microseconds. */
+    [[nodiscard]] double GetErrorBoundUs() const {
+        return model_.load().ErrorBoundAt(GetCurrentTimeUsNonAdjusted());
     }
+    [[nodiscard]] double GetSkewPpm() const { return model_.load().skewPpm; }
+    [[nodiscard]] uint32_t GetSyncIntervalMs() const { return syncIntervalMs_; }
+    [[nodiscard]] ClockSource GetSource() const { return source_; }
 
     /** True if recent syncs have been successful. */
     [[nodiscard]] bool IsSyncHealthy() const { return syncHealthy_; }
     [[nodiscard]] int GetConsecutiveFailures() const { return consecutiveSyncFailures_; }
 
-    /** True if no successful sample has been accepted within STALE_THRESHOLD_US. */
+    /** True if no sample has been accepted within STALE_THRESHOLD_US or two sync intervals, whichever is longer. */
     [[nodiscard]] bool IsSyncStale() const {
-        return hasInitialOffset_ && GetTimeSinceLastSyncUs() > STALE_THRESHOLD_US;
+        const uint64_t threshold = std::max<uint64_t>(STALE_THRESHOLD_US, 2'000ULL * syncIntervalMs_);
+        return HasInitialOffset() && GetTimeSinceLastSyncUs() > threshold;
     }
 
 private:
+    /** One accepted cycle in the regression window: the cycle's minimum-RTT sample. */
+    struct FitPoint {
+        uint64_t localUs;
+        int64_t offsetUs;
+        uint64_t rttUs;
+    };
+
     void SyncWithServer(boost::asio::io_context& io);
 
     std::optional<Sample> GetOneNtpSample(boost::asio::io_context& io, SampleOutcome& outcome);
+    std::optional<Sample> GetOneEchoSample(boost::asio::io_context& io, SampleOutcome& outcome);
+
+    /** Add a cycle's best sample to the window, refit and publish the model. Sync thread only. */
+    void UpdateClockModel(const Sample& best, ClockSource source);
+
+    /** Least-squares offset + skew over the low-RTT points of the window. */
+    ClockModel FitClockModel() const;
 
     static uint64_t GetCurrentTimeUsNonAdjusted();
 
@@ -70,21 +153,48 @@ private:
     std::string fallbackServerAddress_;
     bool usingFallback_{false};
 
-    int64_t smoothedOffsetUs_ = 0;
+    // Clock echo; the socket and counters belong to the sync thread.
+    std::string echoAddress_;
+    uint16_t echoPort_{0};
+    std::unique_ptr<boost::asio::ip::udp::socket> echoSocket_;
+    uint32_t echoSeq_{0};
+    int echoFailedCycles_{0};
+    std::atomic<ClockSource> source_{ClockSource::None};
 
-    bool hasInitialOffset_ = false;
-    uint64_t lastSyncedTimestampLocal_ = 0;
+    SeqLock<ClockModel> model_;
+    std::atomic<uint64_t> lastSyncedTimestampLocal_{0};
+    std::atomic<uint32_t> syncIntervalMs_{MIN_SYNC_INTERVAL_MS};
+
+    // Sync thread only: regression window, oldest overwritten first.
+    static constexpr size_t FIT_WINDOW = 16;
+    std::array<FitPoint, FIT_WINDOW> window_{};
+    size_t windowCount_{0};
+    size_t windowNext_{0};
 
     // Sync health tracking
     std::atomic<bool> syncHealthy_{false};
     std::atomic<int> consecutiveSyncFailures_{0};
 
     static constexpr uint32_t NTP_TIMESTAMP_DELTA = 2208988800U;  /* seconds between 1900 and 1970 */
-    static constexpr double alpha = 0.1;              /* EMA smoothing factor */
     static constexpr int FALLBACK_THRESHOLD = 5;      /* failures before switching to fallback server */
     static constexpr uint64_t STALE_THRESHOLD_US = 5'000'000;  /* 5 s without a successful sample → stale */
+    static constexpr uint64_t MAX_SAMPLE_RTT_US = 20'000;      /* samples slower than this are rejected outright */
+    static constexpr uint32_t ECHO_TIMEOUT_MS = 100;           /* the relay is one LAN hop away */
+    static constexpr uint8_t MSG_CLOCK_PING = 0x05;
+    static constexpr uint8_t MSG_CLOCK_ECHO = 0x06;
+    static constexpr size_t CLOCK_PING_SIZE = 13;
+    static constexpr size_t CLOCK_ECHO_SIZE = 29;
+    static constexpr uint32_t MIN_SYNC_INTERVAL_MS = 2'000;
+    static constexpr uint32_t MAX_SYNC_INTERVAL_MS = 16'000;
+    static constexpr double TARGET_ERROR_US = 1'000.0; /* back off only while the bound one interval ahead stays below */
+    static constexpr double MAX_SKEW_PPM = 500.0;      /* beyond any crystal; a fit this steep is noise or a clock step */
+    static constexpr uint64_t MIN_SKEW_SPAN_US = 10'000'000;  /* fit skew only over at least 10 s of samples */
+    static constexpr double UNFITTED_SKEW_ERROR_PPM = 100.0;  /* two crystals' tolerance, until the fit says otherwise */
+    static constexpr uint64_t RTT_SLACK_US = 500;             /* fit points within 2x the window's best RTT plus this */
+    static constexpr size_t MIN_BACKOFF_POINTS = 4;           /* window fill before the interval may grow */
+    static constexpr double STEP_THRESHOLD_US = 2'000.0;      /* miss beyond the bound that counts as a clock step */
 
     boost::asio::io_context io_;
     std::unique_ptr<boost::asio::steady_timer> timer_;
     std::thread ioThread_;
-};
\ No newline at end of file
+};
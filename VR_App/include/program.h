@@ -14,6 +14,7 @@
 #include "util_egl.h"
 #include "BS_thread_pool.hpp"
 #include "robot_control_sender.h"
+#include "head_pose_streamer.h"
 #include "gstreamer_player.h"
 #include "rest_client.h"
 #include "ntp_timer.h"
@@ -32,7 +33,9 @@
  * Threading model:
  *   - Main thread: OpenXR, rendering, and input polling
  *   - gstreamerThreadPool_ (1 thread): GStreamer pipeline management
- *   - threadPool_ (3 threads): async network operations (NTP, UDP sends)
+ *   - RobotControlSender: own thread for the control/telemetry datagrams
+ *   - HeadPoseStreamer: own thread sampling the head pose at a fixed rate
+ *   - RestClient: own thread for the camera server REST calls
  */
 class TelepresenceProgram {
 
@@ -57,9 +60,19 @@ private:
     /** Begin an OpenXR frame, render, and submit it. */
     void RenderFrame();
 
-    /** Render a single stereo layer (both eye views). */
+    /**
+     * Render a single stereo layer (both eye views). In quad-layer presentation the camera
+     * image goes into quadLayers instead, and false is returned if there is no GUI or
+     * controller ray to put in the projection layer.
+     */
     bool RenderLayer(XrTime displayTime, std::vector<XrCompositionLayerProjectionView> &layerViews,
-                     XrCompositionLayerProjection &layer);
+                     XrCompositionLayerProjection &layer, std::vector<XrCompositionLayerQuad> &quadLayers);
+
+    /** Fold the last GPU frame time into the periodic RENDER_TIMING report. */
+    void ReportGpuTime();
+
+    /** Copy a newly latched frame of stream (0 = first, 1 = second) into its quad layer swapchain. */
+    void UpdateCameraSurface(size_t stream, const CameraFrame &frame, bool latched);
 
     /** Send head pose and robot control data over UDP. */
     void SendControllerDatagram();
@@ -67,6 +80,9 @@ private:
     /** Start the camera stream via REST API and configure GStreamer pipelines. */
     void InitializeStreaming();
 
+    /** Take in REST results that have come back (stream start, Apply) and update the camera server status. */
+    void PollRestResults();
+
     /** Process VR controller input for GUI navigation and robot control. */
     void HandleControllers();
 
@@ -80,6 +96,12 @@ private:
 
     std::vector<viewsurface_t> viewsurfaces_;
 
+    /* Quad-layer presentation: a swapchain per camera stream at its frame size,
+     * written only when a new frame is latched; valid once it holds one. */
+    std::array<viewsurface_t, 2> cameraSurfaces_{};
+    std::array<bool, 2> cameraSurfaceValid_{};
+    PresentationMode loggedPresentationMode_{PresentationMode::Count};  /* logged with its resolution on change */
+
     std::vector<XrSpace> reference_spaces_;
     XrSpace app_reference_space_;
 
@@ -94,7 +116,6 @@ private:
 
     /* --- Thread pools --- */
     BS::thread_pool<BS::tp::none> gstreamerThreadPool_{1};  /* GStreamer pipeline ops */
-    BS::thread_pool<BS::tp::none> threadPool_{3};           /* async network ops */
 
     /* --- Subsystem modules --- */
     std::unique_ptr<GstreamerPlayer> gstreamerPlayer_;
@@ -102,11 +123,19 @@ private:
     std::unique_ptr<NtpTimer> ntpTimer_;
     std::unique_ptr<RosNetworkGatewayClient> rosNetworkGatewayClient_;
     std::unique_ptr<RobotControlSender> robotControlSender_;
+    std::unique_ptr<HeadPoseStreamer> headPoseStreamer_;  /* posts to robotControlSender_, so declared after it */
     std::unique_ptr<StateStorage> stateStorage_;
 
     /* --- Frame timing --- */
     std::chrono::time_point<std::chrono::high_resolution_clock> prevFrameStart_, frameStart_;
 
+    /* --- GPU frame time, averaged and logged every GPU_REPORT_INTERVAL --- */
+    static constexpr auto GPU_REPORT_INTERVAL = std::chrono::seconds(10);
+    std::chrono::steady_clock::time_point gpuReportStart_{};
+    PresentationMode gpuReportMode_{PresentationMode::Count};
+    long long gpuReportSumUs_{0};
+    uint32_t gpuReportFrames_{0};
+
     /* --- Shared application state --- */
     std::shared_ptr<AppState> appState_{};
 
@@ -115,6 +144,12 @@ private:
      *     (structural change) and a fast live encoder update (bitrate/quality). */
     std::optional<StreamingConfig> lastAppliedConfig_{};
 
+    /* --- REST calls in flight, polled every frame. An Apply pressed while one is
+     *     pending supersedes it: only the latest config's answer is waited for. */
+    std::future<RestResult> pendingStart_;
+    std::future<RestResult> pendingApply_;
+    StreamingConfig pendingApplyConfig_{};
+
     /* --- Data-driven GUI settings table --- */
     std::vector<GuiSetting> settings_;
 };
\ No newline at end of file
@@ -0,0 +1,230 @@
+/**
+ * receive_pipeline.h - Platform-neutral RTP receive pipeline and latency probes
+ *
+ * Everything on the headset's receive path that does not depend on Android,
+ * EGL or OpenXR: the pipeline description strings (per codec, per backend),
+ * source/decoder-caps configuration, and the identity-probe callbacks that
+ * fill CameraStats (RTP header metadata, jitterbuffer hold, depay, decode,
+ * queue, appsink). GstreamerPlayer builds on it for the Quest; the Linux
+ * receive_bench CLI (tools/receive_bench) runs the same code against a local
+ * streaming driver so receive-side latency can be measured off-headset.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <gst/gst.h>
+#include "types/enums.h"
+#include "types/camera_types.h"
+#include "ntp_timer.h"
+
+// ---------------------------------------------------------------------------
+// HW decoder selection (AndroidGl backend)
+// 1 = Quest dedicated low-latency AVC/HEVC components (emit frames as soon as
+//     decoded, no output-reorder queue; best for a single live stream).
+// 0 = stock decoders.
+// ---------------------------------------------------------------------------
+#define BUT_USE_LOW_LATENCY_DECODER 1
+
+#if BUT_USE_LOW_LATENCY_DECODER
+#define BUT_H264_DECODER "amcviddec-omxqcomvideodecoderavclowlatency"
+#define BUT_H265_DECODER "amcviddec-omxqcomvideodecoderhevclowlatency"
+#else
+#define BUT_H264_DECODER "amcviddec-omxqcomvideodecoderavc"
+#define BUT_H265_DECODER "amcviddec-omxqcomvideodecoderhevc"
+#endif
+
+// ---------------------------------------------------------------------------
+// JPEG decode placement
+// 1 = the pipeline ends after jpegparse; JpegDecoder decodes each frame in the
+//     appsink callback, split at restart markers across a thread pool.
+// 0 = jpegdec on the pipeline's streaming thread.
+// ---------------------------------------------------------------------------
+#define BUT_PARALLEL_JPEG_DECODE 1
+
+class JpegDecoder;
+
+/**
+ * Where decoded frames end up.
+ * - AndroidGl:   Qualcomm AMC decoders -> glsinkbin (GL texture); JPEG -> appsink (I420)
+ * - LinuxMemory: avdec_h264 / avdec_h265 / jpegdec -> appsink (I420, system memory)
+ * With parallel JPEG decode, both backends hand image/jpeg to the appsink.
+ */
+enum class ReceiveBackend {
+    AndroidGl,
+    LinuxMemory
+};
+
+/** Probe callback context: camera pair for frame/stats output, NTP timer for
+ *  timestamps, the bounds for the adaptive jitterbuffer latency, the
+ *  per-eye JPEG decoders for pipelines that end in image/jpeg, the RTP
+ *  payload type the payload gate lets through, and the stats window for
+ *  callers that present frames from the sample callback. */
+struct ReceiveCallbackObj {
+    CamPair *first;                    // kept .first/.second to minimise diff
+    NtpTimer *second;
+    int jbLatencyMinMs{5};
+    int jbLatencyMaxMs{60};
+    JpegDecoder *jpegDecoders[2]{nullptr, nullptr};  // left, right
+    std::atomic<uint64_t> reconfigureStartUs{0};       // set on reconfigure, cleared by the first frame
+    std::atomic<int> rtpPayloadType{-1};               // other payload types are dropped at udpsrc (-1 = any)
+    size_t windowFrames{60};                           // CameraStats rolling window: the stream FPS (~1 s)
+    ReceiveCallbackObj(CamPair *cp, NtpTimer *nt)
+        : first(cp), second(nt) {}
+};
+
+/** Latency probe points downstream of the UDP source, resolved once per identity. */
+enum class ProbeStage {
+    PostJitterBuffer,
+    RtpDepay,
+    Decoder,
+    Queue
+};
+
+/**
+ * Per-identity handoff context, built by connectProbes() and owned by the
+ * signal connection (freed when the identity is finalized). Lets the
+ * per-packet callbacks go straight to this eye's stats without looking up
+ * element names.
+ */
+struct ProbeContext {
+    ReceiveCallbackObj *obj;
+    CameraStats *stats;
+    ProbeStage stage;
+    const char *eye;  // static string, for logging only
+};
+
+class ReceivePipeline {
+public:
+
+    /** Jitterbuffer stats sampling / latency retune period (GLib main context timer). */
+    static constexpr guint JB_STATS_INTERVAL_MS = 500;
+
+    /**
+     * gst_parse_launch description for one stream: headDescription() !
+     * tailDescription(). Element names are the same for every codec/backend
+     * (udpsrc, rtp_capsfilter, jitterbuffer, parse, dec, dec_capsfilter, *_ident), so
+     * configureSource() and connectProbes() work on all of them. The AndroidGl
+     * H264/H265 tail is a glsinkbin named "glsink" whose sink the caller
+     * provides; every other tail ends in "appsink".
+     * parallelJpeg drops jpegdec (and the dec/queue identities) from the JPEG
+     * pipeline; decode with decodeJpegSample() instead.
+     * Throws std::runtime_error for codecs without a receive pipeline.
+     */
+    static std::string description(Codec codec, ReceiveBackend backend,
+                                   bool parallelJpeg = BUT_PARALLEL_JPEG_DECODE);
+
+    /** udpsrc .. jitterbuffer .. postjb_ident; only the caps depend on the codec. */
+    static std::string headDescription(Codec codec);
+
+    /** Depayloader .. sink, for gst_parse_bin_from_description() with ghost pads. */
+    static std::string tailDescription(Codec codec, ReceiveBackend backend,
+                                       bool parallelJpeg = BUT_PARALLEL_JPEG_DECODE);
+
+    /** Set the UDP port, then configureCodec(). */
+    static void configureSource(GstElement *pipeline, const char *pipelineName, int port,
+                                Codec codec, int width, int height, int fps);
+
+    /** configureRtpCaps() and configureDecoderCaps(). */
+    static void configureCodec(GstElement *pipeline, const char *pipelineName, Codec codec,
+                               int width, int height, int fps);
+
+    /** Set the RTP caps (buildRtpCaps()) and jitterbuffer retransmission. */
+    static void configureRtpCaps(GstElement *pipeline, const char *pipelineName, Codec codec,
+                                 int width, int height);
+
+    /** Set the H264/H265 decoder input caps (dec_capsfilter, in the decode tail); no-op for JPEG. */
+    static void configureDecoderCaps(GstElement *pipeline, Codec codec, int width, int height, int fps);
+
+    /** RTP payload type the sender uses for codec: 26 (JPEG), 96 (H264), 97 (H265). */
+    static int payloadType(Codec codec);
+
+    /** application/x-rtp caps for codec's stream, as set on rtp_capsfilter. */
+    static GstCaps *buildRtpCaps(Codec codec, int width, int height);
+
+    /**
+     * Drop packets whose RTP payload type is not callbackObj->rtpPayloadType
+     * at udpsrc, before they reach the jitterbuffer. After a codec swap this
+     * keeps the previous codec's packets, still in flight until the sender
+     * switches, away from the new depayloader.
+     */
+    static void connectPayloadGate(GstElement *pipeline, ReceiveCallbackObj *callbackObj);
+
+    /**
+     * Connect the latency identities found in bin (udpsrc, postjb, rtpdepay,
+     * dec, queue; a whole pipeline or just its decode tail) to this eye's
+     * stats. eye must be a string literal ("left"/"right").
+     */
+    static void connectProbes(GstElement *bin, ReceiveCallbackObj *callbackObj, CameraStats *stats,
+                              const char *eye);
+
+    /**
+     * Sample the pipeline's rtpjitterbuffer stats (num-lost, rtx-count) and run
+     * the adaptive latency controller every JB_STATS_INTERVAL_MS from a timer
+     * on the given main context, off the streaming threads. Returns the
+     * attached source; the caller destroys and unrefs it before releasing
+     * the pipeline. Returns nullptr if the pipeline has no jitterbuffer.
+     */
+    static GSource *attachJitterBufferSampler(GstElement *pipeline, ReceiveCallbackObj *callbackObj,
+                                              CameraStats *stats, GMainContext *context);
+
+    /**
+     * Common appsink bookkeeping for a new sample: resolve the eye from the
+     * sink's pipeline name, stamp frame-ready time and the appsink stage, and
+     * return the frame. *foveaRect receives the inset crop rect carried with
+     * this frame, *cameraPose the camera pose it was exposed at (0 if none).
+     */
+    static CameraFrame &onSample(GstElement *sink, GstBuffer *buffer, ReceiveCallbackObj *callbackObj,
+                                 uint64_t *foveaRect, uint64_t *cameraPose);
+
+    /**
+     * Decode an image/jpeg sample with the sink's eye decoder into that eye's
+     * frame size, and record the decoder and queue stages in place of the
+     * identities jpegdec pipelines have. Call before onSample(). Returns the
+     * I420 planes (the decoder's output buffer, see JpegDecoder::exchangeOutput)
+     * and the decoder used, or nullptr for a frame that failed to decode.
+     */
+    static uint8_t *decodeJpegSample(GstElement *sink, GstBuffer *buffer, ReceiveCallbackObj *callbackObj,
+                                     JpegDecoder **decoder);
+
+    /** Extract per-frame latency data from RTP header extensions (identity at UDP source). data = ProbeContext. */
+    static void onRtpHeaderMetadata(GstElement *identity, GstBuffer *buffer, gpointer data);
+
+    /** Record timestamps at pipeline probe points (postjb, rtpdepay, decoder, queue). data = ProbeContext. */
+    static void onIdentityHandoff(GstElement *identity, GstBuffer *buffer, gpointer data);
+
+    static GstCaps *buildDecoderSrcCaps(Codec codec, int width, int height, int fps);
+
+    /** Helper functions for cleaner GStreamer element management. */
+    static GstElement *getElementRequired(GstElement *pipeline, const char *name, const char *context);
+    static GstElement *getElementOptional(GstElement *pipeline, const char *name);
+    static void connectAndUnref(GstElement *element, const char *signal, GCallback callback, gpointer data);
+
+private:
+
+    /** True if the sink belongs to pipeline_left (resolved from the root pipeline name). */
+    static bool isLeftSink(GstElement *sink);
+
+    /**
+     * Per-frame stage bookkeeping after the jitterbuffer (depay, decoder,
+     * queue), keyed by buffer PTS: stamps the stage on the frame's record.
+     * The record is completed later, at presentation (CameraStats::presentFrame).
+     */
+    static void recordStage(const ProbeContext &ctx, uint64_t ptsKey, uint64_t now);
+
+    /**
+     * Adaptive jitterbuffer latency, run from the jitterbuffer sampler:
+     * follows a multiple of the RFC 3550 jitter, adds a boost while num-lost
+     * keeps growing (late packets dropped on latency), and clamps to the
+     * callback object's bounds.
+     */
+    static void retuneJitterBuffer(GstElement *jb, CameraStats *stats, const ReceiveCallbackObj *obj,
+                                   uint64_t now);
+
+    static gboolean sampleJitterBuffer(gpointer data);
+
+    static GstPadProbeReturn udpPacketProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+
+    static GstPadProbeReturn rtpPayloadGateProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+};
@@ -2,8 +2,12 @@
  * render_scene.h - Scene rendering coordination
  *
  * Orchestrates per-frame rendering: the camera image plane (stereo video)
- * and the ImGui settings overlay. Uses separate shaders for GL_TEXTURE_2D
- * (JPEG software decode) and GL_TEXTURE_EXTERNAL_OES (hardware decode).
+ * and the ImGui settings overlay. Uses separate shaders for planar YUV
+ * (JPEG software decode, I420 uploaded once per frame), GL_TEXTURE_2D
+ * (blitted hardware decode) and GL_TEXTURE_EXTERNAL_OES. Frames arrive
+ * through each CameraFrame's triple buffer, latched once per app frame.
+ * In quad-layer presentation the frame is instead copied into a layer
+ * swapchain and the eye views only carry the overlay.
  */
 #pragma once
 
@@ -25,21 +29,67 @@ void init_scene(int textureWidth, int textureHeight, bool reinit = false);
 /** Compile and link a shader program (used internally). */
 void generate_shader();
 
-/** Set up the quad geometry and texture for the camera image plane. */
+/** Set up the quad geometry for the camera image plane. */
 void init_image_plane(int textureWidth, int textureHeight);
 
 /**
  * Main render function. Binds the framebuffer, computes view/projection
  * matrices, draws the camera image plane, and overlays the ImGui GUI.
+ * `inset` (foveated mode) is composited over `image` at its crop rect.
  */
 void render_scene(const XrCompositionLayerProjectionView &layerView, render_target_t &rtarget,
                   const Quad &quad, const std::shared_ptr<AppState> &appState,
                   const CameraFrame *image, bool drawSettingsGui,
-                  const std::vector<GuiSetting> &settings);
+                  const std::vector<GuiSetting> &settings,
+                  const CameraFrame *inset = nullptr);
 
-/** Render a camera frame onto the image quad (GL texture or CPU upload). */
-int draw_image_plane(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame *image);
+/**
+ * Draw only the settings panel and the controller ray into an eye view, over
+ * a transparent clear: the projection layer above the camera quad layers.
+ * The colour is premultiplied by its alpha.
+ */
+void render_overlay(const XrCompositionLayerProjectionView &layerView, render_target_t &rtarget,
+                    const std::shared_ptr<AppState> &appState, bool drawSettingsGui,
+                    const std::vector<GuiSetting> &settings);
+
+/**
+ * Copy the latched frame texel for texel into a layer swapchain image of the
+ * frame's size (planar YUV converted on the way), for an XrCompositionLayerQuad.
+ * Returns false if there is no frame to copy.
+ */
+bool render_camera_surface(render_target_t &rtarget, const CameraFrame *frame);
+
+/**
+ * Take the newest frame the stream's producer has published, once per app
+ * frame and before any view is drawn: JPEG planes are uploaded here, HW
+ * textures get a GPU-side wait on their blit fence. The latched frame stays
+ * on screen until the next call. Returns true if a new frame was taken.
+ */
+bool latch_camera_frame(CameraFrame *frame);
+
+/**
+ * Bracket the app frame's GL work with a GPU timer query (GL_EXT_disjoint_timer_query).
+ * Results are read back a few frames later, never waited for: end_gpu_frame_timer()
+ * returns the newest one in microseconds, or -1 while none is known or the
+ * extension is missing.
+ */
+void begin_gpu_frame_timer();
+long long end_gpu_frame_timer();
+
+/**
+ * Render a camera frame onto the image quad (GL texture or CPU upload), then
+ * the optional foveated inset frame over the part of the quad it covers.
+ */
+int draw_image_plane(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame *image,
+                     const CameraFrame *inset = nullptr);
+
+/**
+ * Start an app frame for the settings panel, like latch_camera_frame() for the
+ * camera: the next draw_imgui() re-renders the panel's off-screen FBO if its
+ * inputs changed or its refresh interval passed, and the other views reuse it.
+ */
+void begin_settings_gui_frame();
 
-/** Render the ImGui settings panel into an off-screen FBO and draw it in VR. */
+/** Draw the ImGui settings panel in VR, refreshing its off-screen FBO first if this frame needs it. */
 int draw_imgui(const XrMatrix4x4f &vp, const std::shared_ptr<AppState> &appState,
                bool drawSettingsGui, const std::vector<GuiSetting> &settings);
\ No newline at end of file
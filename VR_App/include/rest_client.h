@@ -5,6 +5,12 @@
  * the camera pipeline and update streaming parameters (codec, resolution,
  * bitrate, etc.). Uses cpp-httplib for HTTP requests.
  *
+ * Requests never block the caller: the body is built from the config on the
+ * calling thread, queued, and sent in order by a worker thread over one
+ * keep-alive connection (re-opened if the Jetson IP changes or the server
+ * drops it). Each call returns a future for its RestResult, which the render
+ * loop polls instead of waiting on it.
+ *
  * REST endpoints:
  *   POST /api/v1/stream/start  - start streaming with given config
  *   POST /api/v1/stream/stop   - stop streaming
@@ -15,28 +21,72 @@
 #include "pch.h"
 #include "types/app_state.h"
 #include "httplib.h"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/** Outcome of one REST call. */
+struct RestResult {
+    bool ok{false};
+    int status{0};       /* HTTP status, 0 if no response came back */
+    std::string error;   /* what went wrong, empty on success */
+};
 
 class RestClient {
 public:
-    /** Create client connected to the Jetson IP from config on Config::REST_API_PORT. */
+    /** Start the worker; requests go to the Jetson IP in config on Config::REST_API_PORT. */
     explicit RestClient(StreamingConfig& config);
 
-    /** POST /api/v1/stream/start - returns 0 on success, -1 on failure. */
-    int StartStream();
+    /** Send whatever is still queued (e.g. a StopStream on exit), then stop the worker. */
+    ~RestClient();
 
-    /** POST /api/v1/stream/stop - returns 0 on success, -1 on failure. */
-    int StopStream();
+    RestClient(const RestClient &) = delete;
+    RestClient &operator=(const RestClient &) = delete;
+
+    /** POST /api/v1/stream/start with the current config. */
+    std::future<RestResult> StartStream();
+
+    /** POST /api/v1/stream/stop. */
+    std::future<RestResult> StopStream();
 
     /** Return the current local copy of the streaming configuration. */
     StreamingConfig GetStreamingConfig();
 
-    /** PUT /api/v1/stream/update - push new config to server. Returns 0 on success. */
-    int UpdateStreamingConfig(const StreamingConfig& config);
+    /** PUT /api/v1/stream/update - push config to the server. */
+    std::future<RestResult> UpdateStreamingConfig(const StreamingConfig& config);
 
 private:
+    struct Request {
+        std::string host;
+        bool put;
+        const char *path;
+        std::string body;
+        const char *action;  /* for the log: "start stream", ... */
+        std::promise<RestResult> result;
+    };
+
+    std::future<RestResult> enqueue(bool put, const char *path, std::string body, const char *action);
 
-    /** Create a fresh httplib::Client using the current config IP, with timeouts. */
-    std::unique_ptr<httplib::Client> makeClient();
+    void workerLoop();
+
+    /** Worker thread: send one request, reusing the connection when the host is unchanged. */
+    RestResult send(const Request &request);
+
+    /** JSON body of start/update: the stream parameters plus where to send the video. */
+    std::string configBody(const StreamingConfig &config) const;
 
     StreamingConfig& config_;
+
+    std::mutex mutex_;
+    std::condition_variable queueCv_;
+    std::deque<Request> queue_;
+    bool stopping_{false};
+
+    /* Worker thread only */
+    std::unique_ptr<httplib::Client> client_;
+    std::string clientHost_;
+
+    std::thread worker_;
 };
@@ -2,11 +2,13 @@
  * robot_control_sender.h - UDP client for robot head pose and movement control
  *
  * Sends three message types over UDP to the robot control server:
- *   0x01 Head Pose   - azimuth/elevation derived from HMD quaternion
+ *   0x01 Head Pose   - azimuth/elevation derived from HMD quaternion, last few samples
  *   0x02 Robot Control - mobile base linear/angular velocity
- *   0x03 Debug Info   - pipeline latency telemetry for analysis
+ *   0x04 Telemetry    - batched per-frame pipeline latency and stream health
  *
- * All sends are dispatched to a thread pool to avoid blocking the render loop.
+ * The render loop only posts each message into a latest-wins mailbox; a
+ * dedicated sender thread serializes whatever is newest into preallocated
+ * packet buffers and puts it on the wire with one sendmmsg() per wake-up.
  * Connection health is tracked via consecutive failure counts.
  */
 #pragma once
@@ -16,43 +18,72 @@
 #include "types/app_state.h"
 #include "types/camera_types.h"
 #include "utils/network_utils.h"
-#include "BS_thread_pool.hpp"
 #include "ntp_timer.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <array>
 #include <atomic>
 #include <cstring>
+#include <thread>
 
 /**
  * Sends head pose and robot control data over UDP.
  *
  * Protocol formats (little-endian):
  *
- * Message Type 0x01 - Head Pose (21 bytes):
- *   [0x01] [azimuth (float)] [elevation (float)] [speed (float)] [timestamp (uint64)]
+ * Message Type 0x01 - Head Pose (6 + 20 * sample_count bytes):
+ *   [0x01] [seq (uint32)] [sample_count (uint8)]
+ *   sample_count x [azimuth (float)] [elevation (float)] [speed (float)] [timestamp (uint64)]
+ *   seq numbers the samples; the first sample is seq, the next seq - 1 and
+ *   so on (newest first, up to HEAD_POSE_HISTORY). A lost datagram's sample
+ *   arrives again in the following ones, so the receiver fills gaps and drops
+ *   stale or reordered datagrams by seq without any retransmission.
  *
  * Message Type 0x02 - Robot Control (21 bytes):
  *   [0x02] [linear_x (float)] [linear_y (float)] [angular (float)] [timestamp (uint64)]
  *
- * Message Type 0x03 - Debug Info (166 bytes):
- *   [0x03] [timestamp (uint64)] [frame_id (uint64)] [fps (double)]
- *   [camera_us (uint64)] [vidConv_us (uint64)] [enc_us (uint64)] [rtpPay_us (uint64)]
- *   [udpStream_us (uint64)] [jbHold_us (uint64)] [rtpDepay_us (uint64)] [dec_us (uint64)]
- *   [appsink_us (uint64)] [presentation_us (uint64)]
+ * Message Type 0x04 - Telemetry Batch (variable, at most 1200 bytes):
+ *   [0x04] [version (uint8) = 1] [seq (uint32)] [timestamp (uint64)] [flags (uint8)]
+ *   [record_count (uint8)] [records_dropped (uint16)]
  *   [ntp_offset_us (int64)] [ntp_synced (uint8)] [time_since_ntp_sync_us (uint64)]
- *   --- streaming config (shared by both eyes) ---
+ *   --- flags bit 1: per-eye health, left then right (right = 0 in mono) ---
+ *   [fps (float)] [lost (uint32)] [rtx (uint32)] [jitter_us (uint32)] [bitrate_bps (uint32)]
+ *   [jb_latency_ms (uint16)] [total_p50_us (uint32)] [total_p95_us (uint32)]
+ *   [total_p99_us (uint32)] [total_max_us (uint32)]
+ *   --- flags bit 0: streaming config (shared by both eyes) ---
  *   [codec (uint8)] [video_mode (uint8)] [res_width (uint16)] [res_height (uint16)]
  *   [fps_config (uint16)] [bitrate_cfg (uint32)]
- *   --- per-eye network health (right = 0 in mono) ---
- *   [left_lost (uint32)] [left_rtx (uint32)] [left_jitter_us (uint32)] [left_bitrate_bps (uint32)]
- *   [right_lost (uint32)] [right_rtx (uint32)] [right_jitter_us (uint32)] [right_bitrate_bps (uint32)]
- *   The latency stages above are the left stream (per-eye-symmetric, representative).
+ *   --- record_count per-frame records ---
+ *   [eye (uint8)] [frame_id] [ready_us] [camera_us] [vidConv_us] [enc_us] [rtpPay_us]
+ *   [udpStream_us] [jbHold_us] [rtpDepay_us] [dec_us] [queue_us] [appsink_us] [presentation_us]
+ *   Every field after eye is a varint (LEB128) of the zigzag-encoded difference
+ *   from the same field of the previous record of that eye in the datagram
+ *   (from 0 for the first), so each datagram decodes on its own.
+ *
+ * One batch is sent per telemetry interval and holds every frame completed
+ * since the previous one. seq counts datagrams, so the receiver sees loss as
+ * a gap; a batch too large for one datagram continues in the next, and only
+ * its first datagram has the health block and records_dropped (records the
+ * headset could not queue). The config block is sent when the config changes
+ * and every TELEMETRY_CONFIG_REFRESH batches, so a restarted receiver catches up.
+ * timestamp and ready_us are on the NTP-adjusted clock.
  *
  * This simple protocol allows the receiving server to implement its own
  * robot-specific control logic without coupling the VR headset to specific hardware.
+ *
+ * Each message type is posted from one thread (head pose from
+ * HeadPoseStreamer, the others from the app's main loop) and the send*
+ * methods never block: a message not yet sent when the next one of its type is
+ * posted is replaced by it, since head pose and velocity are only meaningful
+ * at their latest value. Telemetry batches are posted once per interval, far
+ * apart compared to a sender wake-up, so in practice none is replaced; if one
+ * is, its records are counted in the next batch's records_dropped.
  */
 class RobotControlSender {
 public:
+    static constexpr uint32_t MIN_TELEMETRY_INTERVAL_MS = 50;
+    static constexpr uint32_t MAX_TELEMETRY_INTERVAL_MS = 500;
+
     explicit RobotControlSender(StreamingConfig &config, NtpTimer *ntpTimer);
     ~RobotControlSender();
 
@@ -61,16 +92,25 @@ public:
     [[nodiscard]] int getConsecutiveFailures() const { return consecutiveFailures_; }
     [[nodiscard]] bool hasEverSucceeded() const { return successfulSends_ > 0; }
 
+    /** Camera pose of the last head pose sent; false before the first one. */
+    bool lastCommandedPose(CameraPose *pose) const {
+        return UnpackCameraPose(lastCommandedPose_.load(std::memory_order_relaxed), pose);
+    }
+
     /** Send head pose (quaternion is converted to azimuth/elevation internally). */
-    void sendHeadPose(XrQuaternionf quatPose, float speed, BS::thread_pool<BS::tp::none> &threadPool);
+    void sendHeadPose(XrQuaternionf quatPose, float speed);
 
     /** Send robot mobile base velocity commands. */
-    void sendRobotControl(float linearX, float linearY, float angular, BS::thread_pool<BS::tp::none> &threadPool);
+    void sendRobotControl(float linearX, float linearY, float angular);
 
-    /** Send pipeline latency + streaming config + per-eye stream-health telemetry.
-     *  left/right are the two eyes' stats (right is default-zero in mono). */
-    void sendDebugInfo(const CameraStatsSnapshot &left, const CameraStatsSnapshot &right,
-                       const StreamingConfig &config, BS::thread_pool<BS::tp::none> &threadPool);
+    /**
+     * Collect the frames left/right completed since the last call (right is
+     * null in mono) and, once intervalMs has passed since the previous batch,
+     * send them as a telemetry batch with the stream health and config.
+     * Call every frame from the main loop so the CameraStats queues keep up.
+     */
+    void sendTelemetry(CameraStats *left, CameraStats *right, const StreamingConfig &config,
+                       uint32_t intervalMs);
 
 private:
     struct AzimuthElevation {
@@ -78,34 +118,179 @@ private:
         float elevation;  // radians, -π/2 to π/2
     };
 
-    static AzimuthElevation quaternionToAzimuthElevation(XrQuaternionf quat);
+    /** Head pose samples repeated in every 0x01 packet. */
+    static constexpr size_t HEAD_POSE_HISTORY = 4;
+
+    struct HeadPoseSample {
+        float azimuth, elevation, speed;
+        uint64_t timestamp;  // NTP-adjusted, when the sample was posted
+    };
+
+    /** The newest samples, newest first; samples[i] has seq - i. */
+    struct HeadPoseCommand {
+        uint32_t seq;
+        uint8_t sampleCount;
+        std::array<HeadPoseSample, HEAD_POSE_HISTORY> samples;
+        uint64_t enqueueUs;  // steady clock, for the enqueue-to-wire measurement
+    };
+
+    struct RobotControlCommand {
+        float linearX, linearY, angular;
+        uint64_t enqueueUs;
+    };
+
+    /** Stages a telemetry record carries: Camera .. Presentation (Total is their sum). */
+    static constexpr size_t TELEMETRY_STAGE_COUNT = static_cast<size_t>(LatencyStage::Total);
+    static constexpr size_t MAX_TELEMETRY_RECORDS = 128;
+
+    struct TelemetryRecord {
+        uint8_t eye;  // 0 = left, 1 = right
+        uint64_t frameId;
+        uint64_t readyUs;
+        uint64_t stages[TELEMETRY_STAGE_COUNT];
+    };
+
+    struct TelemetryEyeHealth {
+        float fps;
+        uint32_t lost, rtx, jitterUs, bitrateBps;
+        uint16_t jbLatencyMs;
+        LatencyPercentiles total;
+    };
+
+    /** The StreamingConfig fields the packet carries (the config itself holds vectors). */
+    struct TelemetryConfig {
+        uint8_t codec, videoMode;
+        uint16_t width, height, fps;
+        uint32_t bitrate;
+
+        bool sameAs(const TelemetryConfig &o) const {
+            return codec == o.codec && videoMode == o.videoMode && width == o.width &&
+                   height == o.height && fps == o.fps && bitrate == o.bitrate;
+        }
+    };
 
+    /** One telemetry interval; records accumulate in the mailbox back slot until it is published. */
+    struct TelemetryBatch {
+        std::array<TelemetryEyeHealth, 2> eyes;
+        TelemetryConfig config;
+        bool hasConfig;
+        uint32_t recordsDropped;
+        size_t recordCount;
+        std::array<TelemetryRecord, MAX_TELEMETRY_RECORDS> records;
+        uint64_t enqueueUs;
+    };
+
+    /** Latest-wins mailbox from the posting thread to the sender thread. */
     template<typename T>
-    static void serializeLittleEndian(std::vector<uint8_t> &buffer, const T &value) {
-        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&value);
-        for (size_t i = 0; i < sizeof(T); ++i) {
-            buffer.push_back(bytes[i]);
+    struct LatestMailbox {
+        TripleBufferIndex index;
+        std::array<T, TripleBufferIndex::SLOT_COUNT> slots{};
+
+        void post(const T &value) {
+            slots[index.backSlot()] = value;
+            index.publish();
+        }
+
+        bool take(T *value) {
+            if (!index.pending()) return false;
+            index.acquire();
+            *value = slots[index.frontSlot()];
+            return true;
         }
+    };
+
+    static AzimuthElevation quaternionToAzimuthElevation(XrQuaternionf quat);
+
+    template<typename T>
+    static void serializeLittleEndian(uint8_t *packet, size_t &offset, const T &value) {
+        std::memcpy(packet + offset, &value, sizeof(T));  // every target is little-endian
+        offset += sizeof(T);
     }
 
-    void sendHeadPosePacket(float azimuth, float elevation, float speed, uint64_t timestamp);
-    void sendRobotControlPacket(float linearX, float linearY, float angular, uint64_t timestamp);
-    void sendDebugInfoPacket(const CameraStatsSnapshot &left, const CameraStatsSnapshot &right,
-                             const StreamingConfig &config, uint64_t timestamp);
+    static uint64_t steadyNowUs();
+
+    /** Zigzag LEB128 varint of a signed difference; returns the bytes written (at most 10). */
+    static size_t putZigzagVarint(uint8_t *out, int64_t value);
+
+    /** Sender thread: sleep on the eventfd, then flush the mailboxes. */
+    void sendLoop();
+    void wakeSender();
+    void flushMailboxes();
+
+    size_t buildHeadPosePacket(const HeadPoseCommand &cmd);
+    size_t buildRobotControlPacket(const RobotControlCommand &cmd, uint64_t timestamp);
+    /** Encode batch into telemetryPackets_; returns the number of datagrams. */
+    size_t buildTelemetryPackets(const TelemetryBatch &batch, uint64_t timestamp);
+
+    void recordSendResult(uint8_t type, bool ok, int error);
+    void recordWireLatency(uint64_t enqueueUs, uint64_t wireUs);
 
     int socket_{-1};
+    int wakeFd_{-1};  // eventfd the sender thread blocks on
     struct sockaddr_in destAddr_{};
     std::atomic<bool> isInitialized_{false};
     NtpTimer *ntpTimer_;
     std::string destIpString_;  // For error messages
 
+    LatestMailbox<HeadPoseCommand> headPoseMailbox_;
+    HeadPoseCommand headPoseHistory_{};  // head pose posting thread only
+    LatestMailbox<RobotControlCommand> robotControlMailbox_;
+    LatestMailbox<TelemetryBatch> telemetryMailbox_;
+    std::atomic<bool> wakePending_{false};  // an eventfd write is outstanding
+    std::atomic<bool> running_{false};
+    std::thread senderThread_;
+
+    // Sender thread only: one preallocated buffer per message type, sent as one batch.
+    static constexpr size_t HEAD_POSE_SIZE = 6 + 20 * HEAD_POSE_HISTORY;
+    static constexpr size_t ROBOT_CONTROL_SIZE = 21;
+    static constexpr size_t TELEMETRY_MAX_SIZE = 1200;  // well under any path MTU
+    static constexpr size_t MAX_TELEMETRY_DATAGRAMS = 8;
+    static constexpr size_t MAX_BATCH = 2 + MAX_TELEMETRY_DATAGRAMS;
+    static constexpr int SENDER_NICE = -4;
+    std::array<uint8_t, HEAD_POSE_SIZE> headPosePacket_{};
+    std::array<uint8_t, ROBOT_CONTROL_SIZE> robotControlPacket_{};
+    std::array<std::array<uint8_t, TELEMETRY_MAX_SIZE>, MAX_TELEMETRY_DATAGRAMS> telemetryPackets_{};
+    std::array<size_t, MAX_TELEMETRY_DATAGRAMS> telemetryPacketSizes_{};
+    uint32_t telemetrySeq_{0};
+
+    // Main thread only: batch timing, config change tracking and the CameraStats drain buffer.
+    static constexpr size_t TELEMETRY_CONFIG_REFRESH = 50;
+    uint64_t telemetryBatchStartUs_{0};
+    TelemetryConfig telemetryConfig_{};
+    size_t batchesSinceConfig_{0};
+    std::array<FrameLatencyRecord, CameraStats::COMPLETED_CAPACITY> drained_{};
+
+    // Main thread -> sender thread report: telemetry batches the mailbox replaced
+    // before the sender took them, and the frame records they held.
+    std::atomic<size_t> telemetryBatchesReplaced_{0};
+    std::atomic<size_t> telemetryRecordsReplaced_{0};
+
+    // Sender thread only: enqueue-to-wire latency, logged every WIRE_REPORT_INTERVAL_US.
+    static constexpr uint64_t WIRE_REPORT_INTERVAL_US = 10'000'000;
+    LatencyHistogram wireLatency_;
+    size_t wireSamples_{0};
+    double wireSumUs_{0.0};
+    double wireSumSqUs_{0.0};
+    size_t wireBatches_{0};
+    uint64_t wireReportStartUs_{0};
+
+    // Sender thread only: head pose samples the mailbox replaced before they
+    // were sent, and those of them that fell out of the repeated history too.
+    uint32_t headPoseLastSeq_{0};
+    size_t headPoseCoalesced_{0};
+    size_t headPoseUnsent_{0};
+
     // Connection health tracking
     std::atomic<int> consecutiveFailures_{0};
     std::atomic<int> successfulSends_{0};
+    std::atomic<uint64_t> lastCommandedPose_{0};  // PackCameraPose
     static constexpr int FAILURE_THRESHOLD = 10;
 
     // Message types
     static constexpr uint8_t MSG_HEAD_POSE = 0x01;
     static constexpr uint8_t MSG_ROBOT_CONTROL = 0x02;
-    static constexpr uint8_t MSG_DEBUG_INFO = 0x03;
+    static constexpr uint8_t MSG_TELEMETRY = 0x04;
+    static constexpr uint8_t TELEMETRY_VERSION = 1;
+    static constexpr uint8_t TELEMETRY_HAS_CONFIG = 0x01;
+    static constexpr uint8_t TELEMETRY_HAS_HEALTH = 0x02;
 };
@@ -6,22 +6,49 @@
  * (timestamp + compressed flag + null-terminated topic + null-terminated type)
  * followed by a JSON payload (optionally Zstd-compressed).
  *
- * The SchemaRegistry learns message schemas from "proto" messages, then
- * ParsedMessage provides dot-notation field access (e.g. "clock.sec")
- * with automatic single-element array unwrapping.
+ * The SchemaRegistry learns message schemas from "proto" messages. Data
+ * messages are never parsed into a DOM: messages on a topic subscribed in the
+ * RosTopicStore have their fields found directly in the datagram text by
+ * compiled JsonFieldPaths, and the latest values published for the render
+ * thread to read without locking. Datagrams are received
+ * in batches into a buffer arena allocated once, and looked at through
+ * string_views into it, so the receive path does not allocate.
+ *
+ * Compressed payloads (gateway compression_level > 0) are decompressed on the
+ * listener thread with one ZSTD_DCtx kept for its lifetime, into a buffer that
+ * only grows. A frame compressed with a trained dictionary names it by ID; the
+ * dictionaries (*.zdict, typically one per topic) are loaded from a directory
+ * at construction. Without BUT_HAVE_ZSTD compressed datagrams are dropped.
  */
 #pragma once
 
 #include "pch.h"
 #include "log.h"
+#include "ros_topic_store.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
-#include <unordered_map>
+#include <array>
 #include <atomic>
 #include <cstring>
+#include <map>
+#include <string_view>
+#include <vector>
 #include "BS_thread_pool.hpp"
 #include <nlohmann/json.hpp>
 
+// ---------------------------------------------------------------------------
+// Build-time switch, set by CMake when libzstd is found:
+// 1 = decompress Zstd gateway payloads (and load trained dictionaries).
+// 0 = compressed datagrams are dropped with an error.
+// ---------------------------------------------------------------------------
+#ifndef BUT_HAVE_ZSTD
+#define BUT_HAVE_ZSTD 0
+#endif
+
+#if BUT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 using json = nlohmann::json;
 
 /** Schema definition for a ROS message type (parsed from gateway proto messages). */
@@ -30,179 +57,141 @@ struct MessageSchema {
     json definition;
 };
 
-/**
- * A parsed ROS message with typed field access.
- * Use get<T>("field.path") for dot-notation access into nested JSON data.
- * Single-element arrays are automatically unwrapped.
- */
-class ParsedMessage {
-public:
-    ParsedMessage(std::string type, std::string topic, json schema, json data)
-            : type_(std::move(type)), topic_(std::move(topic)), schema_(std::move(schema)),
-              data_(std::move(data)) {}
-
-    template<typename T>
-    T get(const std::string &field) const {
-        // Split path by dots: e.g. "clock.sec"
-        std::stringstream ss(field);
-        std::string part;
-        const json *cursor = &data_;
-
-        // Walk the path
-        while (std::getline(ss, part, '.')) {
-            if (!cursor->contains(part)) {
-                throw std::runtime_error(
-                        "ROS: Field '" + part + "' not found in message path '" + field + "'");
-            }
-
-            // Move to the next nested level
-            cursor = &cursor->at(part);
-
-            // Automatically unwrap single-element arrays
-            if (cursor->is_array() && !cursor->empty()) {
-                cursor = &cursor->at(0);
-            }
-        }
-
-        try {
-            if (cursor->is_array()) {
-                if (cursor->empty()) {
-                    throw std::runtime_error("ROS: Field '" + field + "' is an empty array");
-                }
-                return cursor->at(0).get<T>();  // unwrap scalar array
-            }
-            return cursor->get<T>();
-        }
-        catch (const std::exception &e) {
-            throw std::runtime_error("ROS: Type mismatch for field '" + field + "': " + e.what());
-        }
-    }
-
-    void print() const {
-        LOG_INFO("[ROS ParsedMessage] Type: %s", type_.c_str());
-        LOG_INFO("[ROS ParsedMessage] Data: %s", data_.dump(2).c_str());
-    }
-
-    const json &data() const { return data_; }
-
-    const json &schema() const { return schema_; }
-
-    const std::string &type() const { return type_; }
-
-    const std::string &topic() const { return topic_; }
-
-private:
-    std::string type_;
-    std::string topic_;
-    json schema_;
-    json data_;
+/** One gateway datagram, viewed in place: topic, type and payload point into the receive buffer. */
+struct GatewayMessage {
+    double timestamp;
+    bool compressed;
+    std::string_view topic;
+    std::string_view type;
+    std::string_view payload;
 };
 
 /**
  * Registry of known ROS message schemas.
  * When a "proto" message arrives (containing "fields", "namespace", "name"),
- * it is registered here. Subsequent data messages of that type can then
- * be parsed into ParsedMessage objects.
+ * it is registered here. Data messages are only looked at once their type
+ * has a schema.
  */
 class SchemaRegistry {
 public:
     /** If payload looks like a schema definition, register it and return true. */
-    bool registerIfSchema(const std::string &type, const std::string &payload) {
-        bool isSchema = false;
+    bool registerIfSchema(std::string_view type, std::string_view payload) {
+        // Only a payload with all three top-level keys is worth a full parse.
+        if (!fieldsKey_.present(payload) || !namespaceKey_.present(payload) || !nameKey_.present(payload)) {
+            return false;
+        }
         try {
             json j = json::parse(payload);
-
-            // If it looks like a schema definition (proto)
-            if (j.contains("fields") && j.contains("namespace") && j.contains("name")) {
-                registry_[type] = {type, j};
-                isSchema = true;
-                LOG_INFO("[ROS SchemaRegistry] Registered schema for type %s", type.c_str());
-            }
+            std::string key(type);
+            registry_[key] = {key, std::move(j)};
+            LOG_INFO("[ROS SchemaRegistry] Registered schema for type %s", key.c_str());
+            return true;
         } catch (const std::exception &e) {
             LOG_ERROR("[ROS SchemaRegistry] Failed to parse payload as JSON: %s", e.what());
+            return false;
         }
-
-        return isSchema;
     }
 
-    bool hasSchema(const std::string &type) const {
+    bool hasSchema(std::string_view type) const {
         return registry_.find(type) != registry_.end();
     }
 
-    const MessageSchema *getSchema(const std::string &type) const {
+    const MessageSchema *getSchema(std::string_view type) const {
         auto it = registry_.find(type);
         if (it != registry_.end())
             return &it->second;
         return nullptr;
     }
 
-    ParsedMessage buildParsedMessage(
-            const std::string &type,
-            const std::string &topic,
-            const std::string &payload) {
-        if (!hasSchema(type)) {
-            throw std::runtime_error("ROS: No schema found for type " + type + " during parsing");
-        }
-
-        auto schema = getSchema(type);
-        json j = json::parse(payload);
-
-        // Optional validation step
-        for (auto &field: schema->definition["fields"]) {
-            std::string name = field["name"];
-            if (!j.contains(name)) {
-                LOG_ERROR("[ROS Parse Warning] Missing field %s in payload of type %s",
-                          name.c_str(), type.c_str());
-            }
-        }
-
-        // Unwrap single element arrays
-        for (auto &[key, value]: j.items()) {
-            if (value.is_array() && value.size() == 1) {
-                value = value.at(0);
-            }
-        }
-
-        return ParsedMessage(type, topic, schema->definition, j);
-    }
-
 private:
-    std::unordered_map<std::string, MessageSchema> registry_;
+    // std::less<> so a string_view into the datagram looks a type up without a temporary string.
+    std::map<std::string, MessageSchema, std::less<>> registry_;
+    JsonFieldPath fieldsKey_{"fields"};
+    JsonFieldPath namespaceKey_{"namespace"};
+    JsonFieldPath nameKey_{"name"};
 };
 
 /**
  * UDP listener for ROS network gateway messages.
  * Runs a background thread that receives messages, registers schemas,
- * and parses data payloads.
+ * and publishes data messages on subscribed topics to topics().
  */
 class RosNetworkGatewayClient {
 
 public:
-    explicit RosNetworkGatewayClient();
+    /** dictionaryDir holds the trained Zstd dictionaries (*.zdict); empty or missing = none. */
+    explicit RosNetworkGatewayClient(const std::string &dictionaryDir = "");
     ~RosNetworkGatewayClient();
 
     [[nodiscard]] bool isInitialized() const { return isInitialized_; }
 
-private:
+    /** Subscribe here; the latest value of each subscribed topic is read from here too. */
+    RosTopicStore &topics() { return topics_; }
+    [[nodiscard]] const RosTopicStore &topics() const { return topics_; }
+
+    /** Data messages handled, and the listener thread's CPU time spent on them. */
+    [[nodiscard]] uint64_t messagesHandled() const { return messagesHandled_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t handleCpuNs() const { return handleCpuNs_.load(std::memory_order_relaxed); }
 
+    /**
+     * Split a datagram into its header fields and payload:
+     *   [timestamp(double)][compressed(uint8)][topic\0][type\0][payload]
+     * The views point into data. Returns false if it is too small or missing null terminators.
+     */
+    static bool parseMessage(const uint8_t *data, size_t size, GatewayMessage &message);
+
+private:
     void listenForMessages();
+    void handleMessage(const GatewayMessage &received, uint64_t nowUs);
+    void reportCounters(uint64_t nowUs);
+#if BUT_HAVE_ZSTD
+    void loadDictionaries(const std::string &dictionaryDir);
+    /** Decompress message.payload into decompressed_; payload views it. False if it is not a usable frame. */
+    bool decompress(const GatewayMessage &message, std::string_view *payload);
+#endif
 
     std::atomic<bool> isInitialized_{false};
     std::atomic<bool> running_{true};
 
-    static bool parseMessage(const std::vector<uint8_t> &buffer,
-                             double &timestamp,
-                             bool &compressed,
-                             std::string &topic,
-                             std::string &type,
-                             std::string &payload);
-
-    sockaddr_in myAddr_{}, serverAddr_{};
-    socklen_t serverAddrLen_;
+    sockaddr_in myAddr_{};
     int socket_ = -1;
 
     SchemaRegistry schemaRegistry_{};
+    RosTopicStore topics_;
+
+    // Listener thread only: RECV_BATCH datagram slots, each with room for a
+    // terminating NUL after the largest UDP payload, filled by one recvmmsg().
+    static constexpr size_t RECV_BATCH = 8;
+    static constexpr size_t MAX_DATAGRAM = 65535;
+    static constexpr size_t SLOT_SIZE = MAX_DATAGRAM + 1;
+    std::vector<uint8_t> arena_;
+    std::array<mmsghdr, RECV_BATCH> msgs_{};
+    std::array<iovec, RECV_BATCH> iovs_{};
+    std::array<sockaddr_in, RECV_BATCH> senders_{};
+
+#if BUT_HAVE_ZSTD
+    // Listener thread only (dictionaries_ is filled before it starts). The buffer starts at
+    // DECOMPRESS_BUFFER and grows to the largest payload seen, up to MAX_DECOMPRESSED.
+    static constexpr size_t DECOMPRESS_BUFFER = 256 * 1024;
+    static constexpr size_t MAX_DECOMPRESSED = 16 * 1024 * 1024;
+    ZSTD_DCtx *dctx_ = nullptr;
+    std::map<unsigned, ZSTD_DDict *> dictionaries_;  // by dictionary ID
+    std::vector<char> decompressed_;
+#endif
+
+    // Listener thread only: counts since the last report, logged every REPORT_INTERVAL_US.
+    static constexpr uint64_t REPORT_INTERVAL_US = 10'000'000;
+    uint64_t reportStartUs_{0};
+    size_t reportMessages_{0};
+    size_t reportMalformed_{0};
+    size_t reportCompressed_{0};
+    size_t reportCompressedBytes_{0};
+    size_t reportDecompressedBytes_{0};
+    size_t reportDecompressFailed_{0};
+    uint64_t reportCpuNs_{0};
+
+    std::atomic<uint64_t> messagesHandled_{0};
+    std::atomic<uint64_t> handleCpuNs_{0};
 
     std::thread listenerThread_;
 };
-
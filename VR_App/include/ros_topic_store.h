@@ -0,0 +1,128 @@
+/**
+ * ros_topic_store.h - Latest value of each subscribed ROS topic, shared lock-free
+ *
+ * A module subscribes to a topic with the fields it wants and their types;
+ * each field is compiled once into a JsonFieldPath. The ROS gateway listener
+ * publishes every message on a subscribed topic here: the fields are pulled
+ * out of the JSON text and, with the topic's message count, rate and arrival
+ * time, written to the topic's SeqLock block. The render thread (HUD) or any
+ * other reader copies the block without ever waiting on the listener.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils/seq_lock.h"
+
+/**
+ * A dot-notation field path ("clock.sec"), split once and looked up straight
+ * in the JSON text: values off the path are skipped over, nothing is built or
+ * copied. Arrays on the path are unwrapped to their first element, as the
+ * gateway wraps scalars and nested messages in single-element arrays.
+ */
+class JsonFieldPath {
+public:
+    explicit JsonFieldPath(const std::string &path);
+
+    /** The number at the path (a bool reads as 0/1); false if absent or of another type. */
+    bool extractNumber(std::string_view json, double *value) const;
+
+    /** The string at the path, escapes left as they are; false if absent or not a string. */
+    bool extractString(std::string_view json, std::string_view *value) const;
+
+    /** True if the path leads to a value. */
+    bool present(std::string_view json) const { return locate(json) != std::string_view::npos; }
+
+    [[nodiscard]] const std::string &path() const { return path_; }
+
+private:
+    /** Offset of the first character of the value at the path, or npos. */
+    size_t locate(std::string_view json) const;
+
+    std::string path_;
+    std::vector<std::string> keys_;
+};
+
+/** How a subscribed field is read: numbers and bools into RosFieldValue::number, strings into text. */
+enum class RosFieldType : uint8_t {
+    Number,
+    Bool,
+    String,
+};
+
+struct RosFieldValue {
+    bool valid;      // the last message on the topic had this field, of this type
+    double number;   // Number, or Bool as 0/1
+    char text[32];   // String, NUL-terminated, cut to fit
+};
+
+/** Everything known about one topic, as of its last message. */
+struct RosTopicSnapshot {
+    static constexpr size_t MAX_FIELDS = 4;
+
+    uint64_t messages;        // since subscribing
+    uint64_t lastReceiveUs;   // CLOCK_MONOTONIC (RosTopicStore::nowUs), 0 = nothing yet
+    double gatewayStamp;      // the gateway's timestamp of the last message (robot clock, seconds)
+    float rateHz;             // over the last completed RATE_WINDOW_US
+    RosFieldValue fields[MAX_FIELDS];
+
+    [[nodiscard]] uint64_t ageUs(uint64_t nowUs) const { return nowUs > lastReceiveUs ? nowUs - lastReceiveUs : 0; }
+};
+
+class RosTopicStore {
+public:
+    static constexpr size_t MAX_TOPICS = 16;
+    static constexpr uint64_t RATE_WINDOW_US = 1'000'000;
+
+    struct Field {
+        std::string path;
+        RosFieldType type;
+    };
+
+    /**
+     * Subscribe to topic with up to RosTopicSnapshot::MAX_FIELDS fields. Any thread, before or
+     * while the listener runs. Returns the topic's index, or -1 if the store is full, there are
+     * too many fields, or the topic is already subscribed.
+     */
+    int subscribe(const std::string &topic, const std::vector<Field> &fields);
+
+    /** Number of subscribed topics; indices below it are valid. */
+    [[nodiscard]] size_t size() const { return count_.load(std::memory_order_acquire); }
+
+    /** Index of topic, or -1. */
+    [[nodiscard]] int find(std::string_view topic) const;
+
+    [[nodiscard]] const std::string &topic(int index) const { return topics_[index].name; }
+    [[nodiscard]] const std::vector<Field> &fields(int index) const { return topics_[index].fields; }
+
+    /** Consistent copy of the topic's latest state; never blocks. */
+    [[nodiscard]] RosTopicSnapshot load(int index) const { return topics_[index].latest.load(); }
+
+    /** Listener thread: take in a message's payload if topic is subscribed. Returns false if it is not. */
+    bool publish(std::string_view topic, double gatewayStamp, std::string_view payload, uint64_t nowUs);
+
+    /** The clock of lastReceiveUs. */
+    static uint64_t nowUs();
+
+private:
+    struct Topic {
+        std::string name;
+        size_t hash{0};
+        std::vector<Field> fields;
+        std::vector<JsonFieldPath> paths;
+        SeqLock<RosTopicSnapshot> latest;
+
+        // Listener thread only: messages in the current rate window.
+        uint64_t windowStartUs{0};
+        uint32_t windowMessages{0};
+    };
+
+    std::array<Topic, MAX_TOPICS> topics_;
+    std::atomic<size_t> count_{0};  // slots below it are complete and read-only but for latest
+    std::mutex subscribeMutex_;     // subscribers only; the listener never takes it
+};
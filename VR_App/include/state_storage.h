@@ -23,7 +23,7 @@ public:
 
     /** Deserialize SharedPreferences into an existing AppState. Takes a reference
      *  rather than returning by value because AppState contains non-movable
-     *  members (CameraFrame::frameMutex). On parse failure, the AppState is
+     *  members (CameraFrame::mailbox). On parse failure, the AppState is
      *  left in its passed-in state. */
     void LoadAppState(AppState& appState);
 
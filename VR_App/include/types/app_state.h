@@ -16,6 +16,8 @@
 #include "types/enums.h"
 #include "types/camera_types.h"
 
+class RosTopicStore;
+
 // =============================================================================
 // Streaming Configuration
 // =============================================================================
@@ -40,6 +42,13 @@ struct StreamingConfig {
     VideoMode videoMode{VideoMode::Stereo};
     int fps{60};
 
+    /* Frames older than this when they reach the robot's encoder are dropped (0 = off) */
+    int maxFrameAgeMs{50};
+
+    /* Bounds for the adaptive rtpjitterbuffer latency (headset only, applied on pipeline build) */
+    int jbLatencyMinMs{5};
+    int jbLatencyMaxMs{60};
+
     StreamingConfig() {
         headset_ip = {Config::DEFAULT_HEADSET_IP[0], Config::DEFAULT_HEADSET_IP[1],
                       Config::DEFAULT_HEADSET_IP[2], Config::DEFAULT_HEADSET_IP[3]};
@@ -51,13 +60,17 @@ struct StreamingConfig {
 /**
  * Classification of a streaming-config change.
  * - None:       nothing relevant changed; no action needed.
- * - LiveOnly:   only bitrate / encoding quality changed. The robot updates the
- *               encoder in place and the headset keeps decoding the same stream,
+ * - LiveOnly:   only bitrate / encoding quality / max frame age changed. The
+ *               robot updates the encoder and its freshness gate in place and
+ *               the headset keeps decoding the same stream,
  *               so neither side tears anything down (fast, no glitch).
  * - Structural: resolution, codec, video mode, fps, ip, or ports changed. Both
- *               ends must rebuild: the robot re-launches its GStreamer pipeline
- *               (fresh SPS/keyframe at the new format) and the headset rebuilds
- *               its decode pipeline + GL render targets.
+ *               ends reconfigure: the robot swaps its encoder tail or re-launches
+ *               its pipeline (fresh SPS/keyframe at the new format), and the
+ *               headset swaps its decode tail (codec), renegotiates the
+ *               decoder caps (resolution, fps) or, for a video mode change,
+ *               rebuilds its decode pipelines; see
+ *               GstreamerPlayer::configurePipelines().
  *
  * This MUST stay in lockstep with the robot driver's CanUpdateDynamically()
  * (streaming_driver/main.cpp). If one end rebuilds while the other live-updates,
@@ -83,7 +96,8 @@ inline StreamConfigChange classifyStreamConfigChange(const StreamingConfig& a,
 
     const bool live =
         a.bitrate != b.bitrate ||
-        a.encodingQuality != b.encodingQuality;
+        a.encodingQuality != b.encodingQuality ||
+        a.maxFrameAgeMs != b.maxFrameAgeMs;
     return live ? StreamConfigChange::LiveOnly : StreamConfigChange::None;
 }
 
@@ -200,10 +214,15 @@ struct AppState {
      * shift of the camera image plane for stereo comfort. Headset-render only, NOT
      * sent to the robot. World metres at the image plane; 0 = no shift (default). */
     float stereoConvergence{0.0f};
+    /* Turn the image quad by the difference between the camera pose a frame was
+     * shot at and the last commanded head pose (hides pan-tilt lag). */
+    bool cameraPoseReprojection{true};
+    PresentationMode presentationMode{PresentationMode::Projection};
 
     /* Performance metrics */
     float appFrameRate{0.0f};       /* measured render FPS */
     long long appFrameTime{0};      /* last frame duration in microseconds */
+    long long appGpuTime{-1};       /* GPU time of the app's rendering in a recent frame, microseconds; -1 = unknown */
 
     /* System info */
     SystemInfo systemInfo{};
@@ -215,6 +234,8 @@ struct AppState {
     /* Head tracking settings - sent to the robot servo controller */
     uint32_t headMovementMaxSpeed{990000};        /* servo speed limit (device units) */
     uint32_t headMovementPredictionMs{50};         /* prediction horizon in milliseconds */
+    uint32_t headPoseRateHz{250};                  /* head pose send rate, independent of the render loop */
+    uint32_t telemetryIntervalMs{100};             /* per-frame telemetry is sent in batches this far apart */
     float headMovementSpeedMultiplier{1.5f};       /* angular velocity scaling factor */
 
     /* Connection monitoring */
@@ -223,6 +244,9 @@ struct AppState {
     std::string robotControlStatus{"Unknown"};
     std::string ntpSyncStatus{"Unknown"};
 
+    /* Latest ROS topic values from the gateway listener, read lock-free by the HUD (null until it exists) */
+    const RosTopicStore *rosTopics{nullptr};
+
     /* Runtime state */
     bool robotControlEnabled{true};
     bool headsetMounted{false};
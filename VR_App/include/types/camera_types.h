@@ -4,7 +4,9 @@
  * Defines the types used throughout the video pipeline:
  * - CameraResolution: predefined resolution presets (nHD through UHD)
  * - CameraStats / CameraStatsSnapshot: thread-safe per-frame pipeline latency tracking
- * - CameraFrame: a single decoded video frame (GL texture or CPU buffer)
+ *   (SeqLock blocks, one per writer thread, see utils/seq_lock.h)
+ * - TripleBufferIndex / FrameSlot: lock-free hand-off of decoded frames to the render thread
+ * - CameraFrame: one stream's decoded frames (GL textures or CPU buffers)
  * - CamPair: stereo pair alias (left + right camera frames)
  */
 #pragma once
@@ -12,12 +14,18 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <deque>
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <cstdint>
 #include <stdexcept>
 #include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#include "utils/seq_lock.h"
 
 // =============================================================================
 // Camera Resolution
@@ -155,10 +163,134 @@ private:
 // Camera Statistics
 // =============================================================================
 
+/** Per-frame latency stages CameraStats keeps a rolling distribution of. */
+enum class LatencyStage : uint8_t {
+    Camera, VidConv, Enc, RtpPay, UdpStream, JbHold, RtpDepay, Dec, Queue, Appsink, Presentation,
+    Total,  // camera .. presentation: the frame's glass-to-glass latency
+    Count
+};
+
+constexpr size_t LATENCY_STAGE_COUNT = static_cast<size_t>(LatencyStage::Count);
+
+/** Rolling-window distribution of one stage (microseconds, bucket upper bounds). */
+struct LatencyPercentiles {
+    uint32_t p50{0};
+    uint32_t p95{0};
+    uint32_t p99{0};
+    uint32_t max{0};
+};
+
+/**
+ * Log-bucketed latency histogram: values below 8 us are exact, above that
+ * each power of two is split into 8 buckets (<= 12.5 % relative error) up to
+ * 2^34 us. Counts are added and removed as samples enter and leave a
+ * window, so the distribution is maintained in O(1) per frame.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = 256;
+
+    static int bucketOf(uint64_t us) {
+        if (us < SUB_BUCKETS) return static_cast<int>(us);
+        const int msb = 63 - __builtin_clzll(us);
+        const int shift = msb - SUB_BUCKET_BITS;
+        const int bucket = ((shift + 1) << SUB_BUCKET_BITS) + static_cast<int>((us >> shift) & (SUB_BUCKETS - 1));
+        return std::min(bucket, BUCKET_COUNT - 1);
+    }
+
+    /** Largest value that lands in bucket. */
+    static uint64_t bucketUpperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        const int shift = (bucket >> SUB_BUCKET_BITS) - 1;
+        const uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1))) << shift;
+        return lower + (uint64_t{1} << shift) - 1;
+    }
+
+    void add(uint64_t us) { counts_[bucketOf(us)]++; }
+    void remove(uint64_t us) { counts_[bucketOf(us)]--; }
+    void clear() { counts_.fill(0); }
+
+    /** p50/p95/p99/max of the count samples currently held, in one pass. */
+    LatencyPercentiles percentiles(size_t count) const;
+
+private:
+    std::array<uint16_t, BUCKET_COUNT> counts_{};
+};
+
+/**
+ * One frame's latency, assembled stage by stage as the frame moves through
+ * the pipeline and keyed by the frame id the robot embeds (RTP extension
+ * id 1, element 0). Each stage runs from the end of the previous one, so the
+ * stages of a complete record add up to its Total.
+ */
+struct FrameLatencyRecord {
+    static constexpr uint16_t COMPLETE_MASK = (1u << static_cast<unsigned>(LatencyStage::Total)) - 1;
+
+    uint64_t frameId{0};
+    uint64_t stages[LATENCY_STAGE_COUNT]{};  // microseconds, by LatencyStage
+    uint64_t rtpPayTimestamp{0};             // rtppay emit (robot clock, NTP-synced)
+    uint64_t arrivalUs{0};                   // first packet at udpsrc
+    uint64_t readyUs{0};                     // appsink new-sample
+    uint64_t lastStageUs{0};                 // end of the latest stage recorded
+    uint64_t pts{0};                         // GstBuffer PTS after the jitterbuffer, 0 until bound
+    uint32_t rtpTs{0};
+    uint16_t stageMask{0};                   // bit per LatencyStage recorded; 0 = free slot
+
+    bool has(LatencyStage stage) const { return (stageMask & (1u << static_cast<unsigned>(stage))) != 0; }
+    bool complete() const { return (stageMask & COMPLETE_MASK) == COMPLETE_MASK; }
+    uint64_t stage(LatencyStage stage) const { return stages[static_cast<size_t>(stage)]; }
+
+    void setStage(LatencyStage stage, uint64_t us) {
+        stages[static_cast<size_t>(stage)] = us;
+        stageMask |= static_cast<uint16_t>(1u << static_cast<unsigned>(stage));
+    }
+};
+
+/**
+ * Latency records of the frames in flight, one slot per frame id modulo
+ * SLOT_COUNT. Up to the jitterbuffer, which rewrites PTS, a frame is found
+ * by its RTP timestamp; after it by PTS; on the render thread by frame id.
+ * A slot is simply reused when a later frame id maps onto it, so frames
+ * dropped on the way age out. Stages are recorded once per frame (postjb
+ * once per packet), so one mutex for the table is cheap.
+ */
+class FrameRecordTable {
+public:
+    static constexpr size_t SLOT_COUNT = 32;
+
+    /** udpsrc, first packet: record carries the frame id, RTP timestamp, the stages up to UdpStream and arrivalUs. */
+    void open(const FrameLatencyRecord &record);
+
+    /** postjb_ident, every packet: JbHold runs to the frame's last packet; binds the PTS the later stages use. */
+    void releaseFromJitterBuffer(uint32_t rtpTs, uint64_t pts, uint64_t now);
+
+    /** rtpdepay_ident, dec_ident, queue_ident: stage ends now. */
+    void recordStage(uint64_t pts, LatencyStage stage, uint64_t now);
+
+    /** appsink new-sample: Appsink stage. Returns false if the frame has no record. */
+    bool deliver(uint64_t pts, uint64_t now, uint64_t *frameId);
+
+    /**
+     * Render thread: Presentation stage. If that completes the record, it is
+     * copied to completed (with its Total), the slot is freed and true returned.
+     */
+    bool present(uint64_t frameId, uint64_t presentationUs, FrameLatencyRecord *completed);
+
+private:
+    FrameLatencyRecord *findByRtpTs(uint32_t rtpTs);
+    FrameLatencyRecord *findByPts(uint64_t pts);
+
+    std::mutex mtx_;
+    std::array<FrameLatencyRecord, SLOT_COUNT> slots_{};
+};
+
 /**
  * Copyable snapshot of camera stats for passing values between threads.
  * All latency values are in microseconds. The pipeline stages correspond
- * to GStreamer identity probe points inserted along the decoding pipeline.
+ * to GStreamer identity probe points inserted along the decoding pipeline;
+ * they are those of the latest frame whose record completed.
  */
 struct CameraStatsSnapshot {
     double prevTimestamp{0.0};
@@ -192,142 +324,313 @@ struct CameraStatsSnapshot {
     uint32_t rtxCount{0};          // rtpjitterbuffer cumulative retransmission requests
     uint32_t jitterUs{0};          // RFC 3550 interarrival jitter (microseconds)
     uint32_t actualBitrateBps{0};  // measured received bitrate at udpsrc (bits/sec)
+    uint32_t jbLatencyMs{0};       // rtpjitterbuffer latency currently chosen by the adaptive controller
+
+    uint32_t renderCpuUs{0};       // render thread: latch + draw of this stream per app frame (smoothed)
+
+    // Rolling-window distribution per LatencyStage; filled by averagedSnapshot() only.
+    std::array<LatencyPercentiles, LATENCY_STAGE_COUNT> percentiles{};
+
+    const LatencyPercentiles &stagePercentiles(LatencyStage stage) const {
+        return percentiles[static_cast<size_t>(stage)];
+    }
+};
+
+// CameraStats blocks, one per writer thread. Fields a block's writer keeps
+// for itself (scratch) live in the block too so they share its cache lines.
+// Per-frame stage latencies are not in the blocks: they go to the frame's
+// FrameLatencyRecord.
+
+/** udpsrc streaming thread, per RTP packet: arrival-side network health. */
+struct IngressStats {
+    uint16_t packetsPerFrame{0};
+    uint32_t jitterUs{0};              // RFC 3550 interarrival jitter
+    uint32_t actualBitrateBps{0};      // received bitrate over ~1 s windows
+
+    // Scratch: bitrate window, jitter estimator.
+    uint32_t jitterPrevRtpTs{0};
+    uint64_t jitterPrevArrivalUs{0};
+    double jitterAccum{0.0};
+    uint64_t bitrateWinBytes{0};
+    uint64_t bitrateWinStartUs{0};
+};
+
+/** appsink streaming thread: new-sample callback. */
+struct SinkStats {
+    double prevTimestamp{0.0};
+    double currTimestamp{0.0};
+    uint64_t frameReadyTimestamp{0};
+    uint64_t frameId{0};       // frame delivered at frameReadyTimestamp, if hasFrameId
+    bool hasFrameId{false};    // false: the frame has no latency record
+};
+
+/** Render thread. */
+struct RenderStats {
+    uint64_t lastMeasuredFrameReady{0};  // presentation is measured once per new frame
+    uint32_t renderCpuUs{0};             // latch + draw per app frame, exponentially smoothed
+};
+
+/** Thread that completes frame records (the render thread; appsink in receive_bench). */
+struct PresentedStats {
+    FrameLatencyRecord frame;  // latest complete record
+    double fps{0.0};           // windowed rate of complete records
+};
+
+/**
+ * GLib main context: rtpjitterbuffer "stats" sampler and the adaptive latency
+ * controller (ReceivePipeline::retuneJitterBuffer), whose state is the tune* scratch.
+ */
+struct JitterBufferStats {
+    uint32_t numLost{0};       // cumulative lost RTP packets
+    uint32_t rtxCount{0};      // cumulative retransmission requests
+    uint32_t latencyMs{0};     // latency currently chosen by the controller
+    uint32_t tuneLostPrev{0};
+    uint32_t lossBoostMs{0};
+    uint64_t tuneLastUs{0};
 };
 
 /**
  * Thread-safe camera statistics with running average support.
- * Uses std::atomic for lock-free reads from the render thread while
- * GStreamer callbacks write from pipeline threads. The running average
- * is computed over the last HISTORY_SIZE (50) frames.
+ * Each frame's stage latencies are collected in a FrameLatencyRecord; only
+ * complete records (udpsrc through presentation) feed the snapshot and the
+ * rolling window. Per-thread state is in SeqLock blocks, one per writer, so
+ * the writers do not false-share and snapshot() gets every block in one
+ * consistent piece. The rolling window (up to MAX_WINDOW_FRAMES frames)
+ * keeps running sums for the means and a LatencyHistogram per stage for
+ * the percentiles; nothing is allocated or re-summed per frame.
  */
 struct CameraStats {
-    /* Timing */
-    std::atomic<double> prevTimestamp{0.0};
-    std::atomic<double> currTimestamp{0.0};
-    std::atomic<double> fps{0.0};
-
-    // Pipeline stage latencies
-    std::atomic<uint64_t> camera{0};
-    std::atomic<uint64_t> vidConv{0};
-    std::atomic<uint64_t> enc{0};
-    std::atomic<uint64_t> rtpPay{0};
-    std::atomic<uint64_t> udpStream{0};
-    std::atomic<uint64_t> jbHold{0};
-    std::atomic<uint64_t> rtpDepay{0};
-    std::atomic<uint64_t> dec{0};
-    std::atomic<uint64_t> queue{0};
-    std::atomic<uint64_t> appsink{0};  // queue_ident -> appsink new-sample callback
-    std::atomic<uint64_t> presentation{0};  // appsink -> predicted photon emission
-    std::atomic<uint64_t> totalLatency{0};
-
-    // Timestamps
-    std::atomic<uint64_t> rtpPayTimestamp{0};
-    std::atomic<uint64_t> frameReadyTimestamp{0};
-
-    // Frame info
-    std::atomic<uint64_t> frameId{0};
-    std::atomic<uint16_t> packetsPerFrame{0};
-
-    // Only measure presentation on the first render after a new frame arrives
-    std::atomic<uint64_t> lastMeasuredFrameReady{0};
-
-    // Per-frame enter-time maps. Each stage stores its emit time so the
-    // downstream stage can compute the *correct* per-frame delta (instead
-    // of being fooled by a global "latest" timestamp when the stage is
-    // async/pipelined). See comment on PtsTimestampMap.
-    //
-    // Key choice follows the invariant that survives the interval:
-    //   - rtpTsArrivalMap is keyed by the RTP timestamp (uint32_t cast to
-    //     uint64_t) because rtpjitterbuffer rewrites GstBuffer PTS across
-    //     its interval; the RTP timestamp does not change.
-    //   - All other maps are keyed by GstBuffer PTS, which is preserved
-    //     across the post-jitterbuffer stages (depay, decoder, queue).
-    PtsTimestampMap rtpTsArrivalMap;  // first-packet arrival per RTP ts (udpsrc -> postjb)
-    PtsTimestampMap postjbPtsMap;     // post-jitterbuffer emit per pts  (postjb -> rtpdepay)
-    PtsTimestampMap depayPtsMap;      // rtpdepay emit per pts            (rtpdepay -> dec)
-    PtsTimestampMap decPtsMap;        // amcviddec emit per pts           (dec -> queue)
-    PtsTimestampMap queuePtsMap;      // post-decoder queue emit per pts  (queue -> appsink)
-
-    // Per-packet dedup: every RTP packet of one frame carries the same RTP
-    // timestamp; rtpTsArrivalMap should record only the first packet's arrival.
-    std::atomic<uint32_t> lastSeenRtpTs{0};
-
-    // Per-stream network health, published via snapshot(). loss/rtx are read from
-    // the named rtpjitterbuffer "stats"; jitter/bitrate are computed at the udpsrc
-    // probe. The *Win*/jitterPrev* accumulators are internal scratch for those
-    // computations (written only by this stream's probe thread).
-    std::atomic<uint32_t> jbNumLost{0};
-    std::atomic<uint32_t> rtxCount{0};
-    std::atomic<uint32_t> jitterUs{0};
-    std::atomic<uint32_t> actualBitrateBps{0};
-    std::atomic<uint64_t> bitrateWinBytes{0};
-    std::atomic<uint64_t> bitrateWinStartUs{0};
-    std::atomic<uint64_t> jitterPrevArrivalUs{0};
-    std::atomic<uint32_t> jitterPrevRtpTs{0};
-    std::atomic<double>   jitterAccum{0.0};
+    SeqLock<IngressStats> ingress;
+    SeqLock<SinkStats> sink;
+    SeqLock<RenderStats> render;
+    SeqLock<PresentedStats> presented;
+    SeqLock<JitterBufferStats> jitterBuffer;
+
+    FrameRecordTable frames;
+
+    // Foveated inset stream only: the packed crop rect the robot embedded in
+    // each frame (7th RTP extension element), carried to appsink the same way
+    // as the stage times -- by RTP ts across the jitterbuffer, then by pts.
+    // The stored value is the rect, not a timestamp.
+    PtsTimestampMap foveaRectRtpTsMap;
+    PtsTimestampMap foveaRectPtsMap;
+
+    // Camera pose each frame was exposed at (PackCameraPose, RTP extension
+    // id 2), carried to appsink the same way.
+    PtsTimestampMap cameraPoseRtpTsMap;
+    PtsTimestampMap cameraPosePtsMap;
 
     /**
-     * Create a copyable snapshot of current values
+     * Create a copyable snapshot of current values. Each block is read
+     * consistently; the blocks are read one after another.
      */
     CameraStatsSnapshot snapshot() const;
 
+    /** Longest rolling window; windowFrames beyond this are clamped. */
+    static constexpr size_t MAX_WINDOW_FRAMES = 128;
+
     /**
-     * Update history with current snapshot. windowFrames is the configured
-     * stream FPS — caller passes streamingConfig.fps so the rolling window
-     * always covers ≈1 s of data, regardless of the chosen rate.
+     * Record frameId's presentation stage. If that completes its record, the
+     * record becomes the latest in snapshot() and enters the rolling window.
+     * windowFrames is the configured stream FPS so the window covers ≈1 s.
      */
-    void updateHistory(size_t windowFrames);
+    void presentFrame(uint64_t frameId, uint64_t presentationUs, size_t windowFrames);
 
     /**
      * Get averaged snapshot. Per-stage latencies are arithmetic means over
-     * the deque; fps is the windowed rate (n−1)/(last_ts−first_ts), which
-     * is robust to decoder bursts that inflate per-frame 1/Δt readings.
+     * the window and percentiles holds each stage's p50/p95/p99/max; fps is
+     * the windowed rate (n−1)/(last_ts−first_ts), which is robust to decoder
+     * bursts that inflate per-frame 1/Δt readings.
      */
     CameraStatsSnapshot averagedSnapshot() const;
 
+    /** Complete records held for takeCompleted(); beyond this the oldest are overwritten. */
+    static constexpr size_t COMPLETED_CAPACITY = 64;
+
+    /**
+     * Move up to capacity complete records, oldest first, into out (the
+     * per-frame telemetry). *dropped gets the number overwritten unread since
+     * the previous call. Returns the number of records written.
+     */
+    size_t takeCompleted(FrameLatencyRecord *out, size_t capacity, uint32_t *dropped);
+
 private:
+    /** The per-frame values the window aggregates. */
+    struct WindowSample {
+        uint64_t readyUs;
+        uint64_t stages[LATENCY_STAGE_COUNT];
+    };
+
+    void evictOldest();
+
+    /** Add a complete record to the window, publish it with the windowed fps and queue it for takeCompleted(). */
+    void updateHistory(const FrameLatencyRecord &record, size_t windowFrames);
+
     mutable std::mutex historyMutex_;
-    mutable std::deque<CameraStatsSnapshot> history_;
+    std::array<WindowSample, MAX_WINDOW_FRAMES> window_{};
+    size_t windowStart_{0};  // oldest sample
+    size_t windowCount_{0};
+    std::array<uint64_t, LATENCY_STAGE_COUNT> stageSums_{};
+    std::array<LatencyHistogram, LATENCY_STAGE_COUNT> histograms_{};
+    std::array<FrameLatencyRecord, COMPLETED_CAPACITY> completed_{};
+    size_t completedStart_{0};
+    size_t completedCount_{0};
+    uint32_t completedDropped_{0};
 };
 
 // =============================================================================
 // Camera Frame
 // =============================================================================
 
+/** Bytes of a tightly packed I420 frame: full-size Y plane + quarter-size U and V planes. */
+inline unsigned long I420FrameSize(int width, int height) {
+    const unsigned long chroma = static_cast<unsigned long>((width + 1) / 2) * ((height + 1) / 2);
+    return static_cast<unsigned long>(width) * height + 2 * chroma;
+}
+
+/** Pan-tilt direction in radians; positive azimuth = left, positive elevation = up. */
+struct CameraPose {
+    float azimuth;
+    float elevation;
+};
+
 /**
- * Single camera frame data and metadata.
- * Depending on the codec, a frame is either a GL texture (hardware-decoded
- * H264/H265 via Qualcomm AMC) or a CPU buffer (software-decoded JPEG).
+ * Camera pose packed as the robot tags frames with it (RTP extension id 2):
+ * bits 0..15 azimuth, 16..31 elevation, signed 0.1 mrad units, bit 32 set so
+ * a valid pose is never 0.
+ */
+inline uint64_t PackCameraPose(CameraPose pose) {
+    auto q = [](float rad) -> uint64_t {
+        const float units = std::clamp(rad * 10000.0f, -32767.0f, 32767.0f);
+        return static_cast<uint16_t>(static_cast<int16_t>(std::lround(units)));
+    };
+    return q(pose.azimuth) | (q(pose.elevation) << 16) | (uint64_t{1} << 32);
+}
+
+/** false for 0 (frame not tagged). */
+inline bool UnpackCameraPose(uint64_t packed, CameraPose *pose) {
+    if ((packed & (uint64_t{1} << 32)) == 0) return false;
+    pose->azimuth = static_cast<float>(static_cast<int16_t>(packed & 0xFFFF)) / 10000.0f;
+    pose->elevation = static_cast<float>(static_cast<int16_t>((packed >> 16) & 0xFFFF)) / 10000.0f;
+    return true;
+}
+
+/**
+ * Lock-free triple buffer of slot indices between one producer (a GStreamer
+ * streaming or GstGL thread) and one consumer (the render thread). The
+ * producer owns one slot (back), the consumer another (front), and the third
+ * sits in the mailbox. publish() swaps back into the mailbox; acquire() swaps
+ * the newest published slot out. Neither side ever waits: a producer that
+ * outruns the consumer overwrites the slot nobody has picked up yet.
+ */
+class TripleBufferIndex {
+public:
+    static constexpr int SLOT_COUNT = 3;
+
+    /** Producer: slot to fill next. */
+    int backSlot() const { return back_; }
+
+    /**
+     * Producer: hand the filled back slot over and take the mailbox slot as the new back.
+     * Returns true if that slot was published and never acquired: the consumer missed it,
+     * and it comes back to the producer with its contents as they were.
+     */
+    bool publish() {
+        const uint8_t previous = state_.exchange(static_cast<uint8_t>(back_ | DIRTY), std::memory_order_acq_rel);
+        back_ = static_cast<uint8_t>(previous & INDEX_MASK);
+        return (previous & DIRTY) != 0;
+    }
+
+    /** Consumer: true if a slot was published since the last acquire(). */
+    bool pending() const { return (state_.load(std::memory_order_acquire) & DIRTY) != 0; }
+
+    /**
+     * Consumer: give the front slot back and take the newest published one.
+     * Anything the consumer stores in the old front slot beforehand is seen by
+     * the producer once it gets that slot back.
+     */
+    void acquire() {
+        front_ = static_cast<uint8_t>(state_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK);
+        hasFront_ = true;
+    }
+
+    /** Consumer: slot currently on screen; meaningful once hasFront(). */
+    int frontSlot() const { return front_; }
+    bool hasFront() const { return hasFront_; }
+
+    /** Back to the initial state. Only while neither side is running. */
+    void reset() {
+        state_.store(1);
+        back_ = 2;
+        front_ = 0;
+        hasFront_ = false;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    std::atomic<uint8_t> state_{1};  // mailbox slot | DIRTY
+    uint8_t back_{2};                // producer-owned
+    uint8_t front_{0};               // consumer-owned
+    bool hasFront_{false};           // consumer-owned
+};
+
+/**
+ * One buffer of a CameraFrame's triple buffer. HW frames use tex/fbo, an
+ * app-owned GL_TEXTURE_2D the OES->2D blit renders into; JPEG frames use
+ * planes. The fences are GLsync handles, kept as void* so this header stays
+ * GL-free; each is created by one side and waited on and deleted by the other.
+ */
+struct FrameSlot {
+    bool isTexture{false};
+    int width{0};
+    int height{0};
+
+    /* Foveated inset only: where this frame sits in the base frame, packed as
+     * 16-bit normalised x | y << 16 | w << 32 | h << 48 (row 0 = bottom of the
+     * displayed image). 0 = unknown, the inset is not drawn. */
+    uint64_t foveaRect{0};
+
+    /* Camera pose at exposure (PackCameraPose); 0 = not tagged. */
+    uint64_t cameraPose{0};
+
+    unsigned int tex{0};
+    unsigned int fbo{0};
+    void *readyFence{nullptr};    /* producer -> consumer: blit into tex issued */
+    void *releaseFence{nullptr};  /* consumer -> producer: last draw sampling tex issued */
+
+    uint8_t *planes{nullptr};     /* tightly packed I420 planes: Y, then U, then V (new[]) */
+};
+
+/**
+ * Single camera stream: its statistics and the decoded frames handed to the
+ * render thread. Depending on the codec, a frame is either a GL texture
+ * (hardware-decoded H264/H265 via Qualcomm AMC) or a CPU buffer (JPEG).
  */
 struct CameraFrame {
     CameraStats* stats{nullptr};
 
+    /* Configured stream size; CPU slots are allocated at this size. */
     int frameWidth{CameraResolution::fromLabel("FHD").getWidth()};
     int frameHeight{CameraResolution::fromLabel("FHD").getHeight()};
-
-    /* For HW frames, glTexture points to an *app-owned* GL_TEXTURE_2D backed
-     * by hwBackingTex below — populated by an OES->2D blit on the GstGL
-     * worker thread. Render thread therefore never touches a SurfaceTexture-
-     * backed external-OES handle whose underlying gralloc buffer can be
-     * swapped asynchronously by MediaCodec.updateTexImage(). */
-    bool hasGlTexture{false};
-    unsigned int glTexture{0};
-    unsigned int glTarget{0};     /* GL_TEXTURE_2D or GL_TEXTURE_EXTERNAL_OES */
-
-    /* CPU buffer info (for software-decoded frames via appsink) */
-    unsigned long memorySize{static_cast<unsigned long>(frameWidth * frameHeight * 3)};
-    void* dataHandle{nullptr};    /* pointer to raw RGB pixel data */
-
-    /* App-owned GL_TEXTURE_2D + FBO that the OES->2D blit writes into.
-     * Allocated lazily on the GstGL worker thread; reused across frames at
-     * the same resolution; reallocated on resolution change. */
-    unsigned int hwBackingTex{0};
-    unsigned int hwBackingFBO{0};
-    int          hwBackingWidth{0};
-    int          hwBackingHeight{0};
-
-    /* Serializes GStreamer field-publish against render-thread reads. */
-    mutable std::mutex frameMutex;
+    unsigned long memorySize{I420FrameSize(frameWidth, frameHeight)};
+
+    /* Frames travel producer -> render thread through these slots only; the
+     * producer fills slots[mailbox.backSlot()] and publishes, the render
+     * thread latches slots[mailbox.frontSlot()] once per app frame. No lock
+     * is shared between the two threads. The render thread therefore never
+     * touches a SurfaceTexture-backed external-OES handle whose gralloc
+     * buffer MediaCodec.updateTexImage() can swap asynchronously. */
+    FrameSlot slots[TripleBufferIndex::SLOT_COUNT];
+    TripleBufferIndex mailbox;
+
+    /* Render thread: the slot latched last, nullptr before the first one. */
+    const FrameSlot *frontSlot() const { return mailbox.hasFront() ? &slots[mailbox.frontSlot()] : nullptr; }
+
+    /* Producer side: latest inset rect received, stamped on every published
+     * slot (not every frame carries one). */
+    uint64_t foveaRect{0};
 };
 
 /**
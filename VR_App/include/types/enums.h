@@ -2,11 +2,12 @@
  * enums.h - Application-wide enumeration types with string conversion
  *
  * Defines enums for video codec selection, stereo/mono mode, aspect ratio,
- * robot platform type, and connection status. Each enum includes inline
- * string conversion functions for display and logging.
+ * camera presentation, robot platform type, and connection status. Each enum
+ * includes inline string conversion functions for display and logging.
  *
- * Enums that support cycling (Codec, VideoMode, AspectRatioMode, RobotType)
- * include a Count sentinel for modular arithmetic in the GUI settings.
+ * Enums that support cycling (Codec, VideoMode, AspectRatioMode,
+ * PresentationMode, RobotType) include a Count sentinel for modular
+ * arithmetic in the GUI settings.
  */
 #pragma once
 
@@ -43,11 +44,14 @@ inline std::string CodecToString(Codec codec) {
  * - Stereo: two independent eye streams (stereoscopic)
  * - Mono: single stream for both eyes
  * - Panoramic: 6 cameras at 60° intervals, head-yaw switching, mono rendering
+ * - Foveated: one camera as a full-FOV base stream plus a gaze-steered
+ *   high-detail inset stream (second port), composited, mono rendering
  */
 enum class VideoMode {
     Stereo,
     Mono,
     Panoramic,
+    Foveated,
     Count
 };
 
@@ -56,6 +60,7 @@ inline std::string VideoModeToString(VideoMode mode) {
         case VideoMode::Stereo:    return "STEREO";
         case VideoMode::Mono:      return "MONO";
         case VideoMode::Panoramic: return "PANORAMIC";
+        case VideoMode::Foveated:  return "FOVEATED";
         default:                   return "Unknown";
     }
 }
@@ -65,6 +70,7 @@ inline std::string VideoModeToApiString(VideoMode mode) {
         case VideoMode::Stereo:    return "stereo";
         case VideoMode::Mono:      return "mono";
         case VideoMode::Panoramic: return "panoramic";
+        case VideoMode::Foveated:  return "foveated";
         default:                   return "stereo";
     }
 }
@@ -84,6 +90,28 @@ inline std::string AspectRatioModeToString(AspectRatioMode mode) {
     }
 }
 
+/**
+ * How the camera image reaches the display.
+ * - Projection: drawn into each eye's projection swapchain with the GUI,
+ *   then resampled again by the compositor's reprojection
+ * - QuadLayer: copied once per new frame into a swapchain of its own and
+ *   submitted as an XrCompositionLayerQuad per eye; the projection layer
+ *   only carries the GUI and the controller ray
+ */
+enum class PresentationMode {
+    Projection,
+    QuadLayer,
+    Count
+};
+
+inline std::string PresentationModeToString(PresentationMode mode) {
+    switch (mode) {
+        case PresentationMode::Projection: return "PROJECTION";
+        case PresentationMode::QuadLayer:  return "QUAD LAYER";
+        default:                           return "Unknown";
+    }
+}
+
 // =============================================================================
 // Robot Enums
 // =============================================================================
@@ -30,9 +30,6 @@ namespace Side {
  * All arrays are indexed by Side::LEFT / Side::RIGHT.
  */
 struct UserState {
-    // Head-mounted display pose
-    XrPosef hmdPose{};
-
     // Controller poses (left/right)
     XrPosef controllerPose[Side::COUNT]{};
 
@@ -29,7 +29,7 @@ struct render_target_t {
     int height;
 };
 
-/** A swapchain surface for one eye view, with its associated render targets. */
+/** A swapchain surface for one eye view or composition layer, with its associated render targets. */
 struct viewsurface_t {
     uint32_t width, height;
     XrViewConfigurationView config_view;
@@ -100,7 +100,17 @@ void openxr_log_environment_blend_modes(XrInstance *instance, XrSystemId *system
 std::vector<viewsurface_t>
 openxr_create_swapchains(XrInstance *instance, XrSystemId *system_id, XrSession *session);
 
-void openxr_allocate_swapchain_rendertargets(viewsurface_t &viewsurface);
+/** Create an FBO for each swapchain image; withDepth adds a depth texture to each. */
+void openxr_allocate_swapchain_rendertargets(viewsurface_t &viewsurface, bool withDepth = true);
+
+/**
+ * Create a single-sample RGBA8 colour-only swapchain of width x height for a
+ * composition layer other than the projection layer (e.g. a quad layer).
+ */
+viewsurface_t openxr_create_layer_swapchain(XrSession *session, uint32_t width, uint32_t height);
+
+/** Destroy the swapchain and the FBOs (and depth textures) created for it. */
+void openxr_destroy_viewsurface(viewsurface_t &viewsurface);
 
 int openxr_acquire_viewsurface(viewsurface_t &viewSurface, render_target_t &renderTarget,
                                XrSwapchainSubImage &subImage);
@@ -0,0 +1,73 @@
+/**
+ * seq_lock.h - Sequence lock for small blocks shared between threads
+ *
+ * SeqLock publishes a trivially copyable block from its writer to any number
+ * of readers without locks: used for the CameraStats blocks and the NtpTimer
+ * clock model.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * Sequence lock around a trivially copyable block of fields, on cache lines
+ * of its own. A writer makes the sequence odd, rewrites the block and makes
+ * it even again; a reader copies the block and retries if the sequence was
+ * odd or moved meanwhile, so it never sees a half-written block and never
+ * holds up the writer. Meant for one writer thread per block; should a
+ * second one show up (a rebuilt pipeline, the JPEG slice decoder) the
+ * writers are serialised on the sequence rather than torn.
+ */
+template<typename T>
+class alignas(CACHE_LINE_SIZE) SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock blocks are copied word by word");
+
+public:
+    /** Consistent copy of the block. */
+    T load() const {
+        uint64_t words[WORD_COUNT];
+        uint32_t begin, end;
+        do {
+            begin = seq_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORD_COUNT; i++) words[i] = words_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            end = seq_.load(std::memory_order_relaxed);
+        } while ((begin & 1) != 0 || begin != end);
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    /** Read-modify-write: fn(T &) edits a copy of the block, which is then published. */
+    template<typename Fn>
+    void update(Fn &&fn) {
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        while ((seq & 1) != 0 ||
+               !seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            seq = seq_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t words[WORD_COUNT];
+        for (size_t i = 0; i < WORD_COUNT; i++) words[i] = words_[i].load(std::memory_order_relaxed);
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        fn(value);
+        std::memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORD_COUNT; i++) words_[i].store(words[i], std::memory_order_relaxed);
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> words_[WORD_COUNT]{};
+};
@@ -3,7 +3,8 @@
  *
  * Published by the render thread after each xrWaitFrame(), read by the
  * render thread's presentation-latency measurement to extend the
- * "presentation" stage to cover all the way to predicted photon emission.
+ * "presentation" stage to cover all the way to predicted photon emission,
+ * and by HeadPoseStreamer for its prediction horizon.
  *
  * Contribution 2 of the IEEE Telepresence 2026 paper: extend the
  * GStreamer-embedded pipeline probes with the runtime's predicted display
@@ -23,4 +24,11 @@ namespace XrTiming {
     // CLOCK_MONOTONIC ns at openxr_begin_frame() return — used by
     // openxr_end_frame() to log per-cycle render duration via adb logcat.
     inline std::atomic<int64_t> renderCycleStartMonotonicNs{0};
+
+    // How far ahead of xrWaitFrame() return the runtime predicts photons
+    // (predictedDisplayTime - now), smoothed over ~16 frames; 0 until the
+    // first frame. HeadPoseStreamer adds it to its prediction horizon, so a
+    // pose sampled off the frame loop leads by as much as one sampled for a
+    // frame's predicted display time.
+    inline std::atomic<int64_t> displayLeadNs{0};
 }
@@ -1,120 +1,242 @@
 /**
  * camera_stats.cpp - Camera statistics snapshot and averaging
  *
- * Implements thread-safe snapshot capture from atomic CameraStats fields,
- * history ring buffer management (HISTORY_SIZE entries), and running
- * average computation across the history for smooth latency display.
- * Timing fields (camera, enc, dec, etc.) are averaged; metadata fields
- * (frameId, timestamps) use the most recent value.
+ * Implements the per-frame latency records (FrameRecordTable), thread-safe
+ * snapshot capture from the CameraStats SeqLock blocks, and the rolling
+ * window behind averagedSnapshot(): a fixed ring of complete records' stage
+ * latencies with running sums (means) and a LatencyHistogram per stage
+ * (p50/p95/p99/max), both updated in O(1) per frame. Metadata fields
+ * (frameId, timestamps) use the most recent value. Complete records are also
+ * queued for takeCompleted(), which feeds the per-frame telemetry.
  */
 #include "types/camera_types.h"
 
+void FrameRecordTable::open(const FrameLatencyRecord &record) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    slots_[record.frameId % SLOT_COUNT] = record;
+}
+
+FrameLatencyRecord *FrameRecordTable::findByRtpTs(uint32_t rtpTs) {
+    for (FrameLatencyRecord &record : slots_) {
+        if (record.stageMask != 0 && record.rtpTs == rtpTs) return &record;
+    }
+    return nullptr;
+}
+
+FrameLatencyRecord *FrameRecordTable::findByPts(uint64_t pts) {
+    if (pts == 0) return nullptr;
+    for (FrameLatencyRecord &record : slots_) {
+        if (record.stageMask != 0 && record.pts == pts) return &record;
+    }
+    return nullptr;
+}
+
+void FrameRecordTable::releaseFromJitterBuffer(uint32_t rtpTs, uint64_t pts, uint64_t now) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    FrameLatencyRecord *record = findByRtpTs(rtpTs);
+    if (!record || record->has(LatencyStage::RtpDepay) || now < record->arrivalUs) return;
+    record->setStage(LatencyStage::JbHold, now - record->arrivalUs);
+    record->lastStageUs = now;
+    if (pts != 0) record->pts = pts;
+}
+
+void FrameRecordTable::recordStage(uint64_t pts, LatencyStage stage, uint64_t now) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    FrameLatencyRecord *record = findByPts(pts);
+    if (!record || record->has(stage) || now < record->lastStageUs) return;
+    record->setStage(stage, now - record->lastStageUs);
+    record->lastStageUs = now;
+}
+
+bool FrameRecordTable::deliver(uint64_t pts, uint64_t now, uint64_t *frameId) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    FrameLatencyRecord *record = findByPts(pts);
+    if (!record || record->has(LatencyStage::Appsink) || now < record->lastStageUs) return false;
+    record->setStage(LatencyStage::Appsink, now - record->lastStageUs);
+    record->lastStageUs = now;
+    record->readyUs = now;
+    *frameId = record->frameId;
+    return true;
+}
+
+bool FrameRecordTable::present(uint64_t frameId, uint64_t presentationUs, FrameLatencyRecord *completed) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    FrameLatencyRecord &record = slots_[frameId % SLOT_COUNT];
+    if (record.stageMask == 0 || record.frameId != frameId) return false;
+    record.setStage(LatencyStage::Presentation, presentationUs);
+    if (!record.complete()) return false;
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < static_cast<size_t>(LatencyStage::Total); i++) total += record.stages[i];
+    record.setStage(LatencyStage::Total, total);
+    *completed = record;
+    record = FrameLatencyRecord{};
+    return true;
+}
+
 CameraStatsSnapshot CameraStats::snapshot() const {
+    const IngressStats in = ingress.load();
+    const SinkStats sk = sink.load();
+    const RenderStats rd = render.load();
+    const PresentedStats pr = presented.load();
+    const JitterBufferStats jb = jitterBuffer.load();
+    const FrameLatencyRecord &f = pr.frame;
+
     return CameraStatsSnapshot{
-        prevTimestamp.load(),
-        currTimestamp.load(),
-        fps.load(),
-        camera.load(),
-        vidConv.load(),
-        enc.load(),
-        rtpPay.load(),
-        udpStream.load(),
-        jbHold.load(),
-        rtpDepay.load(),
-        dec.load(),
-        queue.load(),
-        appsink.load(),
-        presentation.load(),
-        totalLatency.load(),
-        rtpPayTimestamp.load(),
-        frameReadyTimestamp.load(),
-        frameId.load(),
-        packetsPerFrame.load(),
-        jbNumLost.load(),
-        rtxCount.load(),
-        jitterUs.load(),
-        actualBitrateBps.load()
+        sk.prevTimestamp,
+        sk.currTimestamp,
+        pr.fps,
+        f.stage(LatencyStage::Camera),
+        f.stage(LatencyStage::VidConv),
+        f.stage(LatencyStage::Enc),
+        f.stage(LatencyStage::RtpPay),
+        f.stage(LatencyStage::UdpStream),
+        f.stage(LatencyStage::JbHold),
+        f.stage(LatencyStage::RtpDepay),
+        f.stage(LatencyStage::Dec),
+        f.stage(LatencyStage::Queue),
+        f.stage(LatencyStage::Appsink),
+        f.stage(LatencyStage::Presentation),
+        f.stage(LatencyStage::Total),
+        f.rtpPayTimestamp,
+        sk.frameReadyTimestamp,
+        f.frameId,
+        in.packetsPerFrame,
+        jb.numLost,
+        jb.rtxCount,
+        in.jitterUs,
+        in.actualBitrateBps,
+        jb.latencyMs,
+        rd.renderCpuUs
     };
 }
 
-void CameraStats::updateHistory(size_t windowFrames) {
-    if (windowFrames < 2) windowFrames = 2;  // need at least 2 samples for fps
-    auto snap = snapshot();
-    std::lock_guard<std::mutex> lock(historyMutex_);
-    history_.push_back(snap);
-    while (history_.size() > windowFrames) {
-        history_.pop_front();
+LatencyPercentiles LatencyHistogram::percentiles(size_t count) const {
+    LatencyPercentiles result{};
+    if (count == 0) return result;
+
+    // Nearest-rank: the q-quantile is the ceil(q * count)-th smallest sample.
+    const size_t rank50 = (count * 50 + 99) / 100;
+    const size_t rank95 = (count * 95 + 99) / 100;
+    const size_t rank99 = (count * 99 + 99) / 100;
+    size_t seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        if (counts_[bucket] == 0) continue;
+        const size_t before = seen;
+        seen += counts_[bucket];
+        const auto upper = static_cast<uint32_t>(std::min<uint64_t>(bucketUpperBound(bucket), UINT32_MAX));
+        if (before < rank50 && seen >= rank50) result.p50 = upper;
+        if (before < rank95 && seen >= rank95) result.p95 = upper;
+        if (before < rank99 && seen >= rank99) result.p99 = upper;
+        result.max = upper;
     }
+    return result;
+}
 
-    // Recompute fps as the windowed rate over the deque so the value seen via
-    // snapshot() (which goes to InfluxDB) is stable across HW-decoder bursts,
-    // not the per-frame 1e6/Δt that swings into the kHz range on bursts.
-    if (history_.size() >= 2) {
-        double first = history_.front().currTimestamp;
-        double last = history_.back().currTimestamp;
-        double dt_us = last - first;
-        if (dt_us > 0.0) {
-            double windowed_fps = (history_.size() - 1) * 1e6 / dt_us;
-            fps.store(windowed_fps);
-        }
+void CameraStats::evictOldest() {
+    const WindowSample &oldest = window_[windowStart_];
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        stageSums_[i] -= oldest.stages[i];
+        histograms_[i].remove(oldest.stages[i]);
     }
+    windowStart_ = (windowStart_ + 1) % MAX_WINDOW_FRAMES;
+    windowCount_--;
 }
 
-CameraStatsSnapshot CameraStats::averagedSnapshot() const {
+void CameraStats::presentFrame(uint64_t frameId, uint64_t presentationUs, size_t windowFrames) {
+    FrameLatencyRecord record;
+    if (frames.present(frameId, presentationUs, &record)) {
+        updateHistory(record, windowFrames);
+    }
+}
+
+void CameraStats::updateHistory(const FrameLatencyRecord &record, size_t windowFrames) {
+    windowFrames = std::clamp<size_t>(windowFrames, 2, MAX_WINDOW_FRAMES);  // need at least 2 samples for fps
+    WindowSample sample{record.readyUs, {}};
+    std::copy(std::begin(record.stages), std::end(record.stages), sample.stages);
+
     std::lock_guard<std::mutex> lock(historyMutex_);
+    // Shrinks the window when the configured fps drops; one eviction per frame otherwise.
+    while (windowCount_ >= windowFrames) {
+        evictOldest();
+    }
+    window_[(windowStart_ + windowCount_) % MAX_WINDOW_FRAMES] = sample;
+    windowCount_++;
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        stageSums_[i] += sample.stages[i];
+        histograms_[i].add(sample.stages[i]);
+    }
+
+    // Publish fps as the windowed rate so the value seen via snapshot()
+    // (which goes to InfluxDB) is stable across HW-decoder bursts, not the
+    // per-frame 1e6/Δt that swings into the kHz range on bursts.
+    double windowedFps = 0.0;
+    if (windowCount_ >= 2 && sample.readyUs > window_[windowStart_].readyUs) {
+        windowedFps = (windowCount_ - 1) * 1e6 / static_cast<double>(sample.readyUs - window_[windowStart_].readyUs);
+    }
+    presented.update([&](PresentedStats &pr) {
+        pr.frame = record;
+        if (windowedFps > 0.0) pr.fps = windowedFps;
+    });
 
-    if (history_.empty()) {
-        return snapshot();
+    if (completedCount_ == COMPLETED_CAPACITY) {
+        completedStart_ = (completedStart_ + 1) % COMPLETED_CAPACITY;
+        completedCount_--;
+        completedDropped_++;
     }
+    completed_[(completedStart_ + completedCount_) % COMPLETED_CAPACITY] = record;
+    completedCount_++;
+}
+
+size_t CameraStats::takeCompleted(FrameLatencyRecord *out, size_t capacity, uint32_t *dropped) {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    const size_t count = std::min(capacity, completedCount_);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = completed_[(completedStart_ + i) % COMPLETED_CAPACITY];
+    }
+    completedStart_ = (completedStart_ + count) % COMPLETED_CAPACITY;
+    completedCount_ -= count;
+    *dropped = completedDropped_;
+    completedDropped_ = 0;
+    return count;
+}
 
-    CameraStatsSnapshot avg{};
-    for (const auto& snap : history_) {
-        avg.prevTimestamp += snap.prevTimestamp;
-        avg.currTimestamp += snap.currTimestamp;
-        avg.camera += snap.camera;
-        avg.vidConv += snap.vidConv;
-        avg.enc += snap.enc;
-        avg.rtpPay += snap.rtpPay;
-        avg.udpStream += snap.udpStream;
-        avg.jbHold += snap.jbHold;
-        avg.rtpDepay += snap.rtpDepay;
-        avg.dec += snap.dec;
-        avg.queue += snap.queue;
-        avg.appsink += snap.appsink;
-        avg.presentation += snap.presentation;
-        avg.totalLatency += snap.totalLatency;
+CameraStatsSnapshot CameraStats::averagedSnapshot() const {
+    // Non-averaged fields keep the most recent values.
+    CameraStatsSnapshot avg = snapshot();
+
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    if (windowCount_ == 0) {
+        return avg;
     }
 
-    size_t count = history_.size();
-    avg.prevTimestamp /= static_cast<double>(count);
-    avg.currTimestamp /= static_cast<double>(count);
-    avg.camera /= count;
-    avg.vidConv /= count;
-    avg.enc /= count;
-    avg.rtpPay /= count;
-    avg.udpStream /= count;
-    avg.jbHold /= count;
-    avg.rtpDepay /= count;
-    avg.dec /= count;
-    avg.queue /= count;
-    avg.appsink /= count;
-    avg.presentation /= count;
-    avg.totalLatency /= count;
+    const size_t count = windowCount_;
+    uint64_t means[LATENCY_STAGE_COUNT];
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        means[i] = stageSums_[i] / count;
+        avg.percentiles[i] = histograms_[i].percentiles(count);
+    }
+    avg.camera = means[static_cast<size_t>(LatencyStage::Camera)];
+    avg.vidConv = means[static_cast<size_t>(LatencyStage::VidConv)];
+    avg.enc = means[static_cast<size_t>(LatencyStage::Enc)];
+    avg.rtpPay = means[static_cast<size_t>(LatencyStage::RtpPay)];
+    avg.udpStream = means[static_cast<size_t>(LatencyStage::UdpStream)];
+    avg.jbHold = means[static_cast<size_t>(LatencyStage::JbHold)];
+    avg.rtpDepay = means[static_cast<size_t>(LatencyStage::RtpDepay)];
+    avg.dec = means[static_cast<size_t>(LatencyStage::Dec)];
+    avg.queue = means[static_cast<size_t>(LatencyStage::Queue)];
+    avg.appsink = means[static_cast<size_t>(LatencyStage::Appsink)];
+    avg.presentation = means[static_cast<size_t>(LatencyStage::Presentation)];
+    avg.totalLatency = means[static_cast<size_t>(LatencyStage::Total)];
 
     // fps as the true windowed rate, not arithmetic mean of per-frame ratios.
     if (count >= 2) {
-        double dt_us = history_.back().currTimestamp - history_.front().currTimestamp;
-        avg.fps = (dt_us > 0.0) ? (count - 1) * 1e6 / dt_us : 0.0;
+        const uint64_t first = window_[windowStart_].readyUs;
+        const uint64_t last = window_[(windowStart_ + count - 1) % MAX_WINDOW_FRAMES].readyUs;
+        avg.fps = (last > first) ? (count - 1) * 1e6 / static_cast<double>(last - first) : 0.0;
     } else {
         avg.fps = 0.0;
     }
 
-    // Use most recent values for non-averaged fields
-    const auto& latest = history_.back();
-    avg.frameId = latest.frameId;
-    avg.packetsPerFrame = latest.packetsPerFrame;
-    avg.rtpPayTimestamp = latest.rtpPayTimestamp;
-    avg.frameReadyTimestamp = latest.frameReadyTimestamp;
-
     return avg;
 }
@@ -3,14 +3,15 @@
  *
  * Implements stereo video pipeline management:
  * - Constructor wraps the EGL context for GStreamer GL interop
- * - configurePipelines() tears down existing pipelines and builds new ones
+ * - configurePipelines() swaps decode tails in place on a codec change,
+ *   renegotiates caps on a resolution/fps change, or tears down existing
+ *   pipelines and builds new ones
  * - configureSinglePipeline() wires up a single eye's pipeline elements
  * - Callbacks extract frame data and measure per-stage latency
  */
 #include "gstreamer_player.h"
 #include "util_egl.h"
 #include <ctime>
-#include <gst/rtp/rtp.h>
 #include <fmt/format.h>
 #include <gst/video/video.h>
 #include <GLES3/gl3.h>
@@ -180,37 +181,112 @@ void OesBlitter::blit(GLuint oesTex) {
     glUseProgram(0);
 }
 
+/**
+ * Free the CPU planes of every slot and empty the triple buffer. The slots' GL
+ * objects are left to the GStreamer GL context: no context is current here.
+ */
+static void releaseFrameSlots(CameraFrame &frame) {
+    for (FrameSlot &slot : frame.slots) {
+        delete[] slot.planes;
+        slot = FrameSlot{};
+    }
+    frame.mailbox.reset();
+    frame.foveaRect = 0;
+}
+
+/**
+ * Fill slots with a black I420 frame (Y = 0, U = V = 128) and publish one so
+ * the render thread has something to show before the first sample. JPEG
+ * decodes into all three slots; HW frames only use the planes of that first one.
+ */
+static void allocateFrameSlots(CameraFrame &frame, bool cpuFrames) {
+    const size_t lumaSize = static_cast<size_t>(frame.frameWidth) * frame.frameHeight;
+    for (int i = 0; i < TripleBufferIndex::SLOT_COUNT; i++) {
+        if (!cpuFrames && i != frame.mailbox.backSlot()) continue;
+        FrameSlot &slot = frame.slots[i];
+        slot.planes = new uint8_t[frame.memorySize];
+        memset(slot.planes, 0, lumaSize);
+        memset(slot.planes + lumaSize, 128, frame.memorySize - lumaSize);
+        slot.width = frame.frameWidth;
+        slot.height = frame.frameHeight;
+    }
+    frame.mailbox.publish();
+}
+
+/**
+ * Size the back slot's CPU planes for a width x height frame. The back slot
+ * belongs to the producer, so a decode-tail swap to a new codec or
+ * resolution resizes it here rather than under the render thread. A slot
+ * last used as a texture carries the texture's size, not the planes'.
+ */
+static void fitSlotPlanes(FrameSlot &slot, int width, int height) {
+    if (slot.planes && !slot.isTexture && slot.width == width && slot.height == height) return;
+    delete[] slot.planes;
+    slot.planes = new uint8_t[I420FrameSize(width, height)];
+    slot.width = width;
+    slot.height = height;
+}
+
 struct OesBlitJob {
     CameraFrame *frame;
     GLuint       oesTex;
     int          width;
     int          height;
+    uint64_t     cameraPose;
     bool         success;
 };
 
+static void deleteSlotTexture(FrameSlot &slot) {
+    if (slot.fbo != 0) {
+        GLuint fbo = slot.fbo;
+        glDeleteFramebuffers(1, &fbo);
+        slot.fbo = 0;
+    }
+    if (slot.tex != 0) {
+        GLuint tex = slot.tex;
+        glDeleteTextures(1, &tex);
+        slot.tex = 0;
+    }
+}
+
+// Blit into the frame's back slot and publish it. Nothing here waits for the
+// GPU: the render thread's last draw from the slot is ordered before the blit
+// with glWaitSync on the slot's release fence, and the render thread orders
+// its draw after the blit the same way on the ready fence. The OES buffer
+// itself needs no wait -- SurfaceTexture attaches a release fence to it when
+// the next updateTexImage() hands it back to MediaCodec.
 static void oesBlitOnGstGlThread(GstGLContext * /*ctx*/, gpointer data) {
     auto *job = static_cast<OesBlitJob *>(data);
     job->success = false;
 
-    if (job->frame->hwBackingTex == 0 ||
-        job->frame->hwBackingWidth  != job->width ||
-        job->frame->hwBackingHeight != job->height) {
-        // Drain GPU before freeing FBO/texture that may still be referenced
-        // by an in-flight render command (Adreno does not honour GL deferred
-        // deletion for FBO-attached textures cleanly).
-        if (job->frame->hwBackingFBO != 0 || job->frame->hwBackingTex != 0) {
-            glFinish();
-        }
-        if (job->frame->hwBackingFBO != 0) {
-            GLuint fbo = job->frame->hwBackingFBO;
-            glDeleteFramebuffers(1, &fbo);
-            job->frame->hwBackingFBO = 0;
-        }
-        if (job->frame->hwBackingTex != 0) {
-            GLuint tex = job->frame->hwBackingTex;
-            glDeleteTextures(1, &tex);
-            job->frame->hwBackingTex = 0;
+    CameraFrame &frame = *job->frame;
+    FrameSlot &slot = frame.slots[frame.mailbox.backSlot()];
+    // A slot last filled with CPU planes (before a codec swap) carries their size.
+    const bool reallocate = slot.tex == 0 || !slot.isTexture ||
+                            slot.width != job->width || slot.height != job->height;
+
+    if (slot.releaseFence) {
+        auto fence = static_cast<GLsync>(slot.releaseFence);
+        if (reallocate) {
+            // Reallocating: the old texture may still be sampled by an
+            // in-flight render command (Adreno does not honour GL deferred
+            // deletion for FBO-attached textures cleanly), so this one
+            // resolution-change frame waits on the CPU.
+            glClientWaitSync(fence, 0, 100'000'000);
+        } else {
+            glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
         }
+        glDeleteSync(fence);
+        slot.releaseFence = nullptr;
+    }
+    if (slot.readyFence) {
+        // Published earlier but replaced before the render thread picked it up.
+        glDeleteSync(static_cast<GLsync>(slot.readyFence));
+        slot.readyFence = nullptr;
+    }
+
+    if (reallocate) {
+        deleteSlotTexture(slot);
 
         GLuint tex = 0;
         glGenTextures(1, &tex);
@@ -234,22 +310,32 @@ static void oesBlitOnGstGlThread(GstGLContext * /*ctx*/, gpointer data) {
             LOG_ERROR("OesBlit: FBO incomplete (status=0x%x)", status);
             glDeleteFramebuffers(1, &fbo);
             glDeleteTextures(1, &tex);
+            slot.width = slot.height = 0;
             return;
         }
 
-        job->frame->hwBackingTex    = tex;
-        job->frame->hwBackingFBO    = fbo;
-        job->frame->hwBackingWidth  = job->width;
-        job->frame->hwBackingHeight = job->height;
+        slot.tex    = tex;
+        slot.fbo    = fbo;
+        slot.width  = job->width;
+        slot.height = job->height;
     }
 
     if (!g_oesBlitter.init()) return;
 
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, job->frame->hwBackingFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, slot.fbo);
     glViewport(0, 0, job->width, job->height);
     g_oesBlitter.blit(job->oesTex);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glFinish();
+
+    // Flush so the render context can wait on the fence without this
+    // context ever having to drain.
+    slot.readyFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    slot.isTexture = true;
+    slot.foveaRect = frame.foveaRect;
+    slot.cameraPose = job->cameraPose;
+    frame.mailbox.publish();
 
     job->success = true;
 }
@@ -325,113 +411,33 @@ GstreamerPlayer::~GstreamerPlayer() {
         }
 
         // Clean up frame buffers
-        if (camPair_->first.dataHandle) {
-            delete[] static_cast<unsigned char *>(camPair_->first.dataHandle);
-            camPair_->first.dataHandle = nullptr;
-        }
-        if (camPair_->second.dataHandle) {
-            delete[] static_cast<unsigned char *>(camPair_->second.dataHandle);
-            camPair_->second.dataHandle = nullptr;
-        }
-    }
-}
-
-/** Get a named pipeline element; throws if not found. */
-GstElement *
-GstreamerPlayer::getElementRequired(GstElement *pipeline, const char *name, const char *context) {
-    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name);
-    if (!element) {
-        LOG_ERROR("Failed to get %s element from %s pipeline", name, context);
-        throw std::runtime_error(
-                fmt::format("Failed to get {} element from {} pipeline", name, context));
-    }
-    return element;
-}
-
-/** Get a named pipeline element; returns nullptr if not found. */
-GstElement *GstreamerPlayer::getElementOptional(GstElement *pipeline, const char *name) {
-    return gst_bin_get_by_name(GST_BIN(pipeline), name);
-}
-
-/** Connect a signal callback to an element, then unref it (if non-null). */
-void GstreamerPlayer::connectAndUnref(GstElement *element, const char *signal, GCallback callback,
-                                      gpointer data) {
-    if (element) {
-        g_signal_connect(G_OBJECT(element), signal, callback, data);
-        gst_object_unref(element);
+        releaseFrameSlots(camPair_->first);
+        releaseFrameSlots(camPair_->second);
     }
 }
 
 /**
- * Configure a single eye's pipeline: set UDP port, RTP caps, decoder caps,
- * GL context, bus callbacks, and latency measurement probes.
+ * Configure a single eye's pipeline: connect the RTP head's latency probes,
+ * add the decode tail, set UDP port, RTP caps and decoder caps, and attach
+ * the bus callbacks and jitterbuffer sampler.
  */
 void
 GstreamerPlayer::configureSinglePipeline(GstElement *pipeline, const char *pipelineName, int port,
-                                         const StreamingConfig &config,
-                                         const std::string &xDimString, int payload) {
-    // Get optional identity elements
-    GstElement *udpsrc_ident = getElementOptional(pipeline, "udpsrc_ident");
-    GstElement *postjb_ident = getElementOptional(pipeline, "postjb_ident");
-    GstElement *rtpdepay_ident = getElementOptional(pipeline, "rtpdepay_ident");
-    GstElement *dec_ident = getElementOptional(pipeline, "dec_ident");
-    GstElement *queue_ident = getElementOptional(pipeline, "queue_ident");
-
-    // Configure UDP source
-    GstElement *udpsrc = getElementRequired(pipeline, "udpsrc", pipelineName);
-    GstPad *pad = gst_element_get_static_pad(udpsrc, "src");
-    if (pad) {
-        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, udpPacketProbeCallback, nullptr, nullptr);
-        gst_object_unref(pad);
+                                         const StreamingConfig &config) {
+    const bool isLeft = std::strcmp(pipelineName, "left") == 0;
+    CameraStats *stats = isLeft ? camPair_->first.stats : camPair_->second.stats;
+
+    // Head identities only: the tail's are connected by addDecodeTail().
+    ReceivePipeline::connectProbes(pipeline, callbackObj_, stats, isLeft ? "left" : "right");
+    ReceivePipeline::connectPayloadGate(pipeline, callbackObj_);
+    if (!addDecodeTail(pipeline, pipelineName, config)) {
+        throw std::runtime_error("Failed to build decode tail");
     }
-    g_object_set(udpsrc, "port", port, NULL);
-
-    // Configure RTP capsfilter
-    GstElement *rtp_capsfilter = getElementRequired(pipeline, "rtp_capsfilter", pipelineName);
-    GstCaps *new_caps = gst_caps_new_simple("application/x-rtp",
-                                            "encoding-name", G_TYPE_STRING,
-                                            CodecToString(config.codec).c_str(),
-                                            "payload", G_TYPE_INT, payload,
-                                            "x-dimensions", G_TYPE_STRING, xDimString.c_str(),
-                                            NULL);
-    g_object_set(rtp_capsfilter, "caps", new_caps, NULL);
-    gst_caps_unref(new_caps);
-    gst_object_unref(rtp_capsfilter);
-
-    // Configure decoder and sink based on codec
-    GstElement *dec = nullptr;
-    GstElement *glsink = nullptr;
-    GstElement *appsink = nullptr;
-
-    if (config.codec != Codec::JPEG) {
-        dec = getElementRequired(pipeline, "dec", pipelineName);
-
-        GstElement *dec_capsfilter = getElementOptional(pipeline, "dec_capsfilter");
-        if (dec_capsfilter) {
-            GstCaps *decCaps = buildDecoderSrcCaps(config.codec,
-                                                   config.resolution.getWidth(),
-                                                   config.resolution.getHeight(),
-                                                   config.fps);
-            g_object_set(dec_capsfilter, "caps", decCaps, NULL);
-            gst_caps_unref(decCaps);
-            gst_object_unref(dec_capsfilter);
-        }
 
-        glsink = getElementRequired(pipeline, "glsink", pipelineName);
-        gst_element_set_context(glsink, gContext_);
-
-        g_autoptr(GstCaps) caps_sink = gst_caps_from_string(SINK_CAPS);
-        appsink = gst_element_factory_make("appsink", nullptr);
-        gst_element_set_context(appsink, gContext_);
-        g_object_set(appsink, "caps", caps_sink, "max-buffers", 1, "drop", true, "emit-signals",
-                     true, "sync", false, NULL);
-
-        g_autoptr(GstElement) glsinkbin = getElementRequired(pipeline, "glsink", pipelineName);
-        g_object_set(glsinkbin, "sink", appsink, NULL);
-    } else {
-        appsink = getElementRequired(pipeline, "appsink", pipelineName);
-        gst_element_set_context(GST_ELEMENT(appsink), gContext_);
-    }
+    // UDP port, RTP caps and decoder input caps (dec_capsfilter is in the tail)
+    ReceivePipeline::configureSource(pipeline, pipelineName, port, config.codec,
+                                     config.resolution.getWidth(), config.resolution.getHeight(),
+                                     config.fps);
 
     // Set up bus and callbacks
     GstBus *bus = gst_element_get_bus(pipeline);
@@ -445,26 +451,13 @@ GstreamerPlayer::configureSinglePipeline(GstElement *pipeline, const char *pipel
     g_signal_connect(G_OBJECT(bus), "message::error", (GCallback) errorCallback, pipeline);
     g_signal_connect(G_OBJECT(bus), "message::state-changed", (GCallback) stateChangedCallback,
                      pipeline);
-    g_signal_connect(G_OBJECT(appsink), "new-sample", (GCallback) newFrameCallback, callbackObj_);
-
-    // Connect and unref optional identity elements
-    connectAndUnref(udpsrc_ident, "handoff", (GCallback) onRtpHeaderMetadata, callbackObj_);
-    connectAndUnref(postjb_ident, "handoff", (GCallback) onIdentityHandoff, callbackObj_);
-    connectAndUnref(rtpdepay_ident, "handoff", (GCallback) onIdentityHandoff, callbackObj_);
-    connectAndUnref(dec_ident, "handoff", (GCallback) onIdentityHandoff, callbackObj_);
-    connectAndUnref(queue_ident, "handoff", (GCallback) onIdentityHandoff, callbackObj_);
+    gst_object_unref(bus);
 
-    // Clean up refs obtained via gst_bin_get_by_name / gst_element_get_bus
-    if (config.codec != Codec::JPEG) {
-        gst_object_unref(dec);
-        gst_object_unref(glsink);
-        // Do NOT unref appsink here — glsinkbin took ownership via the "sink" property.
-        // It will be freed when glsinkbin is finalized during pipeline disposal.
-    } else {
-        // JPEG path: appsink came from gst_bin_get_by_name (extra ref), so unref it.
-        gst_object_unref(appsink);
+    // Jitterbuffer stats sampling
+    if (GSource *sampler = ReceivePipeline::attachJitterBufferSampler(pipeline, callbackObj_, stats,
+                                                                       gMainContext_)) {
+        jbSamplers_.push_back(sampler);
     }
-    gst_object_unref(bus);
 
     // Set pipeline name and state
     std::string fullPipelineName = fmt::format("pipeline_{}", pipelineName);
@@ -472,8 +465,283 @@ GstreamerPlayer::configureSinglePipeline(GstElement *pipeline, const char *pipel
     gst_element_set_state(pipeline, GST_STATE_READY);
 }
 
+GstElement *
+GstreamerPlayer::addDecodeTail(GstElement *pipeline, const char *pipelineName, const StreamingConfig &config) {
+    GError *error = nullptr;
+    const std::string description = ReceivePipeline::tailDescription(config.codec, ReceiveBackend::AndroidGl);
+    GstElement *tail = gst_parse_bin_from_description(description.c_str(), TRUE, &error);
+    if (!tail) {
+        LOG_ERROR("Unable to build %s decode tail: %s", pipelineName, error ? error->message : "unknown error");
+        if (error) g_error_free(error);
+        return nullptr;
+    }
+    gst_element_set_name(tail, "dec_tail");
+
+    // Sink: H264/H265 decode into GL memory through glsinkbin, whose appsink
+    // we provide; JPEG ends in the tail's own appsink.
+    GstElement *appsink = nullptr;
+    if (config.codec != Codec::JPEG) {
+        GstElement *glsink = ReceivePipeline::getElementOptional(tail, "glsink");
+        if (glsink) {
+            gst_element_set_context(glsink, gContext_);
+
+            g_autoptr(GstCaps) caps_sink = gst_caps_from_string(SINK_CAPS);
+            appsink = gst_element_factory_make("appsink", nullptr);
+            gst_element_set_context(appsink, gContext_);
+            g_object_set(appsink, "caps", caps_sink, "max-buffers", 1, "drop", true, "emit-signals",
+                         true, "sync", false, NULL);
+            // glsinkbin takes ownership of appsink via the "sink" property.
+            g_object_set(glsink, "sink", appsink, NULL);
+            gst_object_unref(glsink);
+        }
+    } else {
+        appsink = ReceivePipeline::getElementOptional(tail, "appsink");
+        if (appsink) {
+            gst_element_set_context(appsink, gContext_);
+            gst_object_unref(appsink);  // still owned by the tail bin
+        }
+    }
+    if (!appsink) {
+        LOG_ERROR("No sink in %s decode tail", pipelineName);
+        gst_object_unref(tail);
+        return nullptr;
+    }
+    g_signal_connect(G_OBJECT(appsink), "new-sample", (GCallback) newFrameCallback, callbackObj_);
+
+    const bool isLeft = std::strcmp(pipelineName, "left") == 0;
+    ReceivePipeline::connectProbes(tail, callbackObj_, isLeft ? camPair_->first.stats : camPair_->second.stats,
+                                   isLeft ? "left" : "right");
+
+    gst_bin_add(GST_BIN(pipeline), tail);
+    GstElement *postjb = ReceivePipeline::getElementOptional(pipeline, "postjb_ident");
+    const bool linked = postjb && gst_element_link(postjb, tail);
+    if (postjb) gst_object_unref(postjb);
+    if (!linked) {
+        LOG_ERROR("Failed to link %s postjb_ident -> dec_tail", pipelineName);
+        gst_bin_remove(GST_BIN(pipeline), tail);
+        return nullptr;
+    }
+    return tail;
+}
+
+bool GstreamerPlayer::canReconfigureLive(const StreamingConfig &from, const StreamingConfig &to) {
+    // Mirrors the driver's CanUpdateDynamically() for what reaches the headset:
+    // the video mode sets the pipeline count, and panoramic/foveated streams are
+    // rebuilt on the robot for any codec/fps/resolution change. Receive ports
+    // are fixed (Config::*_CAMERA_PORT), so the endpoint never matters here.
+    return from.videoMode == to.videoMode &&
+           (to.videoMode == VideoMode::Stereo || to.videoMode == VideoMode::Mono);
+}
+
+/** Resolution caps probe context; freed when the probe is removed. */
+struct ResolutionProbeContext {
+    GstreamerPlayer *player;
+    GstElement *pipeline;
+    const char *pipelineName;  // "left" / "right" literal
+    StreamingConfig config;
+    uint64_t reconfigureStartUs;
+    uint32_t generation;       // reconfigureGeneration_ when armed
+};
+
+static void freeResolutionProbeContext(gpointer data) {
+    delete static_cast<ResolutionProbeContext *>(data);
+}
+
+/** Resize an eye's frame; the caller makes sure no sample callback of that eye is running. */
+static void resizeFrame(CameraFrame &frame, int width, int height) {
+    frame.frameWidth = width;
+    frame.frameHeight = height;
+    frame.memorySize = I420FrameSize(width, height);
+}
+
+bool GstreamerPlayer::reconfigureLive(const StreamingConfig &config, uint64_t reconfigureStartUs) {
+    const StreamingConfig &from = *activeConfig_;
+    const bool codecChanged = from.codec != config.codec;
+    const bool resized = from.resolution.getWidth() != config.resolution.getWidth() ||
+                         from.resolution.getHeight() != config.resolution.getHeight();
+    const uint32_t generation = ++reconfigureGeneration_;  // retires resolution probes still waiting
+
+    // The sender switches a little after us: from here on its old-codec packets are dropped at udpsrc.
+    if (codecChanged) callbackObj_->rtpPayloadType.store(ReceivePipeline::payloadType(config.codec));
+
+    const std::pair<GstElement *, const char *> pipelines[] = {{pipelineLeft_, "left"}, {pipelineRight_, "right"}};
+    for (const auto &[pipeline, name] : pipelines) {
+        if (!pipeline) continue;
+        if (codecChanged) {
+            if (!swapDecodeTail(pipeline, name, config)) return false;
+        } else if (resized) {
+            if (!renegotiateResolution(pipeline, name, config, reconfigureStartUs, generation)) return false;
+        } else if (from.fps != config.fps) {
+            // FPS only: the decoder input caps carry the framerate; they
+            // renegotiate on the next buffer.
+            ReceivePipeline::configureDecoderCaps(pipeline, config.codec, config.resolution.getWidth(),
+                                                  config.resolution.getHeight(), config.fps);
+        }
+    }
+    return true;
+}
+
 /**
- * (Re)configure both stereo pipelines. Stops existing pipelines, reinitializes
+ * Codec change, on the caller's thread: flush the RTP head from udpsrc, swap
+ * the decode tail while nothing flows, then restart. The flush empties the
+ * jitterbuffer of the old codec's packets, the payload gate keeps the ones
+ * still in flight out, and the RTP caps are set and postjb_ident's sticky
+ * caps replaced before the new tail is linked, so the new depayloader only
+ * sees its own codec. udpsrc, the jitterbuffer and the main loop never stop.
+ * H264/H265 decoders resume on the keyframe the driver sends after its own
+ * encoder swap.
+ */
+bool GstreamerPlayer::swapDecodeTail(GstElement *pipeline, const char *pipelineName, const StreamingConfig &config) {
+    GstElement *udpsrc = ReceivePipeline::getElementOptional(pipeline, "udpsrc");
+    GstElement *postjb = ReceivePipeline::getElementOptional(pipeline, "postjb_ident");
+    GstElement *oldTail = ReceivePipeline::getElementOptional(pipeline, "dec_tail");
+    if (!udpsrc || !postjb || !oldTail) {
+        LOG_ERROR("swapDecodeTail: missing udpsrc/postjb_ident/dec_tail in %s pipeline", pipelineName);
+        if (udpsrc) gst_object_unref(udpsrc);
+        if (postjb) gst_object_unref(postjb);
+        if (oldTail) gst_object_unref(oldTail);
+        return false;
+    }
+    const int width = config.resolution.getWidth();
+    const int height = config.resolution.getHeight();
+
+    // basesrc pushes the flush downstream: the jitterbuffer drops its queue
+    // and pauses, the old tail unblocks. flush-stop restarts udpsrc's task.
+    gst_element_send_event(udpsrc, gst_event_new_flush_start());
+
+    // NULL joins the old tail's streaming threads; with the jitterbuffer
+    // paused as well, no sample callback runs while the frame is resized.
+    gst_element_set_state(oldTail, GST_STATE_NULL);
+    gst_element_unlink(postjb, oldTail);
+    gst_bin_remove(GST_BIN(pipeline), oldTail);  // drops the pipeline's ref
+    gst_object_unref(oldTail);
+
+    ReceivePipeline::configureRtpCaps(pipeline, pipelineName, config.codec, width, height);
+    if (GstPad *postjbSrc = gst_element_get_static_pad(postjb, "src")) {
+        gst_pad_add_probe(postjbSrc, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, replaceStaleCapsProbe,
+                          ReceivePipeline::buildRtpCaps(config.codec, width, height),
+                          (GDestroyNotify) gst_caps_unref);
+        gst_object_unref(postjbSrc);
+    }
+
+    const bool isLeft = std::strcmp(pipelineName, "left") == 0;
+    resizeFrame(isLeft ? camPair_->first : camPair_->second, width, height);
+    if (config.codec == Codec::JPEG && BUT_PARALLEL_JPEG_DECODE) {
+        const int eye = isLeft ? 0 : 1;
+        if (!jpegDecoders_[eye]) jpegDecoders_[eye] = std::make_unique<JpegDecoder>(&jpegDecodePool_);
+        callbackObj_->jpegDecoders[eye] = jpegDecoders_[eye].get();
+    }
+
+    GstElement *newTail = addDecodeTail(pipeline, pipelineName, config);
+    if (newTail) {
+        ReceivePipeline::configureDecoderCaps(pipeline, config.codec, width, height, config.fps);
+        gst_element_sync_state_with_parent(newTail);
+    }
+
+    gst_element_send_event(udpsrc, gst_event_new_flush_stop(FALSE));
+    gst_object_unref(udpsrc);
+    gst_object_unref(postjb);
+
+    if (!newTail) {
+        LOG_ERROR("Decode-tail swap on %s failed", pipelineName);
+        return false;
+    }
+    LOG_INFO("Decode tail swapped on %s (codec %s, %dx%d), jitterbuffer flushed and kept alive", pipelineName,
+             CodecToString(config.codec).c_str(), width, height);
+    return true;
+}
+
+/**
+ * One-shot probe on postjb_ident:src after a codec swap. Relinking marks the
+ * pad's sticky events for resending, so the first caps the new tail would get
+ * are still the old codec's; they are replaced with the new codec's. The
+ * jitterbuffer sends the same caps again ahead of the first new packet.
+ */
+GstPadProbeReturn GstreamerPlayer::replaceStaleCapsProbe(GstPad * /*pad*/, GstPadProbeInfo *info,
+                                                         gpointer userData) {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS) return GST_PAD_PROBE_OK;
+
+    auto *newCaps = static_cast<GstCaps *>(userData);
+    GstCaps *caps = nullptr;
+    gst_event_parse_caps(event, &caps);
+    if (!gst_caps_is_equal(caps, newCaps)) {
+        gst_event_unref(event);
+        GST_PAD_PROBE_INFO_DATA(info) = gst_event_new_caps(newCaps);
+    }
+    return GST_PAD_PROBE_REMOVE;
+}
+
+/**
+ * Resolution change within one codec: the decode tail stays. The RTP caps
+ * change now; the decoder input caps and the frame size follow when the
+ * stream itself changes size (resolutionCapsProbe), since the sender keeps
+ * sending the old size until its own reconfigure.
+ */
+bool GstreamerPlayer::renegotiateResolution(GstElement *pipeline, const char *pipelineName,
+                                            const StreamingConfig &config, uint64_t reconfigureStartUs,
+                                            uint32_t generation) {
+    // H264/H265: dec_capsfilter's sink, behind the tail's queue, so every
+    // old-size buffer has passed the filter before it changes. JPEG: the
+    // parser's src, on the thread that runs the sample callback.
+    const bool jpeg = config.codec == Codec::JPEG;
+    GstElement *element = ReceivePipeline::getElementOptional(pipeline, jpeg ? "parse" : "dec_capsfilter");
+    GstPad *pad = element ? gst_element_get_static_pad(element, jpeg ? "src" : "sink") : nullptr;
+    if (element) gst_object_unref(element);
+    if (!pad) {
+        LOG_ERROR("renegotiateResolution: no caps probe point in %s pipeline", pipelineName);
+        return false;
+    }
+
+    ReceivePipeline::configureRtpCaps(pipeline, pipelineName, config.codec, config.resolution.getWidth(),
+                                      config.resolution.getHeight());
+    auto *ctx = new ResolutionProbeContext{this, pipeline, pipelineName, config, reconfigureStartUs, generation};
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, resolutionCapsProbe, ctx,
+                      freeResolutionProbeContext);
+    gst_object_unref(pad);
+    LOG_INFO("Resolution change armed on %s (%dx%d), waiting for the stream's new caps", pipelineName,
+             config.resolution.getWidth(), config.resolution.getHeight());
+    return true;
+}
+
+/**
+ * Runs on a decode-tail streaming thread for each downstream event. On the
+ * caps for the new size, re-set the decoder input caps ahead of this event,
+ * so the decoder renegotiates with it (amcviddec drains and reconfigures its
+ * MediaCodec in place), and resize the eye's frame. The frame size only
+ * matters to the JPEG sample path, which runs on this same thread; H264/H265
+ * frames take their size from the sample caps.
+ */
+GstPadProbeReturn GstreamerPlayer::resolutionCapsProbe(GstPad * /*pad*/, GstPadProbeInfo *info,
+                                                       gpointer userData) {
+    auto *ctx = static_cast<ResolutionProbeContext *>(userData);
+    GstreamerPlayer *self = ctx->player;
+    if (ctx->generation != self->reconfigureGeneration_.load()) return GST_PAD_PROBE_REMOVE;  // superseded
+
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS) return GST_PAD_PROBE_OK;
+
+    const StreamingConfig &cfg = ctx->config;
+    GstCaps *caps = nullptr;
+    gst_event_parse_caps(event, &caps);
+    const GstStructure *structure = gst_caps_get_structure(caps, 0);
+    int width = 0, height = 0;
+    if (!gst_structure_get_int(structure, "width", &width) || !gst_structure_get_int(structure, "height", &height) ||
+        width != cfg.resolution.getWidth() || height != cfg.resolution.getHeight()) {
+        return GST_PAD_PROBE_OK;  // still the old stream
+    }
+
+    ReceivePipeline::configureDecoderCaps(ctx->pipeline, cfg.codec, width, height, cfg.fps);
+    const bool isLeft = std::strcmp(ctx->pipelineName, "left") == 0;
+    resizeFrame(isLeft ? self->camPair_->first : self->camPair_->second, width, height);
+    self->callbackObj_->reconfigureStartUs.store(ctx->reconfigureStartUs);
+    LOG_INFO("Caps renegotiated on %s (%dx%d), decode tail kept", ctx->pipelineName, width, height);
+    return GST_PAD_PROBE_REMOVE;
+}
+
+/**
+ * (Re)configure both stereo pipelines. Changes canReconfigureLive() accepts
+ * are applied in place; otherwise stops existing pipelines, reinitializes
  * CameraFrame buffers and stats, parses new pipeline strings, configures
  * elements, and starts playback. The GLib main loop runs on the thread pool.
  */
@@ -481,13 +749,10 @@ void
 GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
                                     const StreamingConfig &config) {
     GError *error = nullptr;
+    const uint64_t reconfigureStartUs = ntpTimer_->GetCurrentTimeUs();
 
     LOG_INFO("(Re)configuring GStreamer pipelines");
 
-    // Track configured stream rate as the rolling-average window so the GUI
-    // overlay shows ~1 s of history regardless of the chosen FPS.
-    windowFrames_.store(config.fps > 0 ? config.fps : 60);
-
     // Validate prerequisites
     if (!gContext_) {
         LOG_ERROR("GStreamer GL context not initialized - cannot configure pipelines");
@@ -503,6 +768,22 @@ GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
         return;
     }
 
+    if (activeConfig_ && callbackObj_ && pipelineLeft_ && canReconfigureLive(*activeConfig_, config)) {
+        // A resolution-only change waits for the stream's new caps (resolutionCapsProbe),
+        // which starts the first-frame timer itself.
+        const bool waitsForCaps = activeConfig_->codec == config.codec &&
+                                  (activeConfig_->resolution.getWidth() != config.resolution.getWidth() ||
+                                   activeConfig_->resolution.getHeight() != config.resolution.getHeight());
+        if (!waitsForCaps) callbackObj_->reconfigureStartUs.store(reconfigureStartUs);
+        if (reconfigureLive(config, reconfigureStartUs)) {
+            activeConfig_ = config;
+            LOG_INFO("Pipelines reconfigured in place (main loop and jitterbuffers kept)");
+            return;
+        }
+        LOG_WARN("In-place reconfigure failed, rebuilding pipelines");
+    }
+    activeConfig_.reset();
+
     if (pipelineLeft_) {
         LOG_INFO("Setting left pipeline to NULL");
         gst_element_set_state(pipelineLeft_, GST_STATE_NULL);
@@ -529,6 +810,13 @@ GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
         mainLoopFuture_.wait();
     }
 
+    // The samplers reference the stats deleted below; detach them before draining.
+    for (GSource *sampler : jbSamplers_) {
+        g_source_destroy(sampler);
+        g_source_unref(sampler);
+    }
+    jbSamplers_.clear();
+
     // 3. Drain any remaining pending callbacks on the main context
     while (g_main_context_pending(gMainContext_))
         g_main_context_iteration(gMainContext_, FALSE);
@@ -559,17 +847,21 @@ GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
         delete camPair_->second.stats;
         camPair_->second.stats = nullptr;
     }
-    if (camPair_->first.dataHandle) {
-        delete[] static_cast<unsigned char *>(camPair_->first.dataHandle);
-        camPair_->first.dataHandle = nullptr;
-    }
-    if (camPair_->second.dataHandle) {
-        delete[] static_cast<unsigned char *>(camPair_->second.dataHandle);
-        camPair_->second.dataHandle = nullptr;
-    }
+    releaseFrameSlots(camPair_->first);
+    releaseFrameSlots(camPair_->second);
 
     // Allocate new objects
-    callbackObj_ = new GStreamerCallbackObj(camPair_, ntpTimer_, &windowFrames_);
+    callbackObj_ = new GStreamerCallbackObj(camPair_, ntpTimer_);
+    callbackObj_->jbLatencyMinMs = config.jbLatencyMinMs;
+    callbackObj_->jbLatencyMaxMs = config.jbLatencyMaxMs;
+    callbackObj_->reconfigureStartUs.store(reconfigureStartUs);
+    callbackObj_->rtpPayloadType.store(ReceivePipeline::payloadType(config.codec));
+    if (config.codec == Codec::JPEG && BUT_PARALLEL_JPEG_DECODE) {
+        for (int eye = 0; eye < 2; eye++) {
+            if (!jpegDecoders_[eye]) jpegDecoders_[eye] = std::make_unique<JpegDecoder>(&jpegDecodePool_);
+            callbackObj_->jpegDecoders[eye] = jpegDecoders_[eye].get();
+        }
+    }
     camPair_->first.stats = new CameraStats();
     camPair_->second.stats = new CameraStats();
 
@@ -577,56 +869,19 @@ GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
     camPair_->first.frameHeight = config.resolution.getHeight();
     camPair_->second.frameWidth = config.resolution.getWidth();
     camPair_->second.frameHeight = config.resolution.getHeight();
-    camPair_->first.memorySize = camPair_->first.frameWidth * camPair_->first.frameHeight * 3;
-    camPair_->second.memorySize = camPair_->second.frameWidth * camPair_->second.frameHeight * 3;
-
-    auto *emptyFrameLeft = new unsigned char[camPair_->first.memorySize];
-    memset(emptyFrameLeft, 0, camPair_->first.memorySize);
-    camPair_->first.dataHandle = (void *) emptyFrameLeft;
-
-    auto *emptyFrameRight = new unsigned char[camPair_->second.memorySize];
-    memset(emptyFrameRight, 0, camPair_->second.memorySize);
-    camPair_->second.dataHandle = (void *) emptyFrameRight;
-
-    camPair_->first.hwBackingTex = 0;
-    camPair_->first.hwBackingFBO = 0;
-    camPair_->first.hwBackingWidth = 0;
-    camPair_->first.hwBackingHeight = 0;
-    camPair_->first.glTexture = 0;
-    camPair_->first.hasGlTexture = false;
-    camPair_->second.hwBackingTex = 0;
-    camPair_->second.hwBackingFBO = 0;
-    camPair_->second.hwBackingWidth = 0;
-    camPair_->second.hwBackingHeight = 0;
-    camPair_->second.glTexture = 0;
-    camPair_->second.hasGlTexture = false;
+    camPair_->first.memorySize = I420FrameSize(camPair_->first.frameWidth, camPair_->first.frameHeight);
+    camPair_->second.memorySize = I420FrameSize(camPair_->second.frameWidth, camPair_->second.frameHeight);
+
+    allocateFrameSlots(camPair_->first, config.codec == Codec::JPEG);
+    allocateFrameSlots(camPair_->second, config.codec == Codec::JPEG);
 
     // Determine if we need one or two decode pipelines
     bool singlePipeline = (config.videoMode == VideoMode::Mono || config.videoMode == VideoMode::Panoramic);
 
-    // Create new pipelines based on the provided configuration
-    switch (config.codec) {
-        case Codec::JPEG:
-            pipelineLeft_ = gst_parse_launch(jpegPipeline_.c_str(), &error);
-            if (!singlePipeline) pipelineRight_ = gst_parse_launch(jpegPipeline_.c_str(), &error);
-            break;
-        case Codec::VP8:
-            //TODO:
-            break;
-        case Codec::VP9:
-            //TODO:
-            break;
-        case Codec::H264:
-            pipelineLeft_ = gst_parse_launch(h264Pipeline_.c_str(), &error);
-            if (!singlePipeline) pipelineRight_ = gst_parse_launch(h264Pipeline_.c_str(), &error);
-            break;
-        case Codec::H265:
-            pipelineLeft_ = gst_parse_launch(h265Pipeline_.c_str(), &error);
-            if (!singlePipeline) pipelineRight_ = gst_parse_launch(h265Pipeline_.c_str(), &error);
-            break;
-        default:
-            break;
-    }
+    // Create the RTP heads; configureSinglePipeline() adds the decode tails (VP8/VP9: TODO, throws)
+    const std::string description = ReceivePipeline::headDescription(config.codec);
+    pipelineLeft_ = gst_parse_launch(description.c_str(), &error);
+    if (!singlePipeline) pipelineRight_ = gst_parse_launch(description.c_str(), &error);
 
     if (error) {
         LOG_ERROR("Unable to build pipeline!: %s", error->message);
@@ -639,19 +894,16 @@ GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
         throw std::runtime_error("Failed to create pipelines");
     }
 
-    // Pipeline configuration
-    std::string xDimString = fmt::format("{},{}", config.resolution.getWidth(), config.resolution.getHeight());
-    int payload = (config.codec == Codec::JPEG) ? 26 : 96;
-
     // Configure left pipeline (always present)
-    configureSinglePipeline(pipelineLeft_, "left", Config::LEFT_CAMERA_PORT, config, xDimString, payload);
+    configureSinglePipeline(pipelineLeft_, "left", Config::LEFT_CAMERA_PORT, config);
     gst_element_set_state(pipelineLeft_, GST_STATE_PLAYING);
 
     // Configure right pipeline (stereo only)
     if (!singlePipeline) {
-        configureSinglePipeline(pipelineRight_, "right", Config::RIGHT_CAMERA_PORT, config, xDimString, payload);
+        configureSinglePipeline(pipelineRight_, "right", Config::RIGHT_CAMERA_PORT, config);
         gst_element_set_state(pipelineRight_, GST_STATE_PLAYING);
     }
+    activeConfig_ = config;
 
     auto loopPromise = std::make_shared<std::promise<void>>();
     mainLoopFuture_ = loopPromise->get_future();
@@ -673,8 +925,9 @@ GstreamerPlayer::configurePipelines(BS::thread_pool<BS::tp::none> &threadPool,
 /**
  * Appsink "new-sample" callback. Retrieves the decoded frame and stores it
  * in the appropriate CameraFrame (left or right, determined by pipeline name).
- * Two paths: GLMemory (hardware decode) extracts the GL texture ID;
- * non-GLMemory (JPEG) copies raw RGB data to the CPU buffer.
+ * Three paths: GLMemory (hardware decode) extracts the GL texture ID;
+ * non-GLMemory (jpegdec) copies the I420 planes to the CPU buffer;
+ * image/jpeg (parallel JPEG decode) goes to publishJpegSample().
  */
 GstFlowReturn
 GstreamerPlayer::newFrameCallback(GstElement *sink, GStreamerCallbackObj *callbackObj) {
@@ -688,55 +941,23 @@ GstreamerPlayer::newFrameCallback(GstElement *sink, GStreamerCallbackObj *callba
 
     LOG_DEBUG("GStreamer: sample arrived");
 
-    CamPair *pair = callbackObj->first;
-
-    GstObject *parent = GST_OBJECT(sink);
-    while (GST_OBJECT_PARENT(parent) != nullptr) {
-        parent = GST_OBJECT_PARENT(parent);
-    }
-    std::string pipelineName = GST_OBJECT_NAME(parent);
-
-    const bool isLeftCamera = (pipelineName == "pipeline_left");
-    const bool isRightCamera = (pipelineName == "pipeline_right");
-
-    CameraFrame &frame = isLeftCamera ? pair->first : pair->second;
-
-    // Update frame timestamps.
-    double currentTime = callbackObj->second->GetCurrentTimeUs();
-    double prevTime = frame.stats->currTimestamp.load();
-    frame.stats->prevTimestamp.store(prevTime);
-    frame.stats->currTimestamp.store(currentTime);
-    frame.stats->frameReadyTimestamp.store(static_cast<uint64_t>(currentTime));
-
     GstBuffer *buffer = gst_sample_get_buffer(sample);
     GstCaps *caps = gst_sample_get_caps(sample);
-
-    // appsink stage = time between the last GStreamer probe (queue_ident) and
-    // this new-sample callback firing. Per-frame correct via PTS lookup —
-    // pulls THIS frame's queue emit time rather than the latest global one,
-    // so async stages (glsinkbin GL upload on H.264/H.265 path) are honest.
-    GstClockTime appsinkPts = GST_BUFFER_PTS(buffer);
-    if (appsinkPts != GST_CLOCK_TIME_NONE) {
-        uint64_t queueEnter = frame.stats->queuePtsMap.consume(static_cast<uint64_t>(appsinkPts));
-        if (queueEnter != 0 && static_cast<uint64_t>(currentTime) >= queueEnter) {
-            frame.stats->appsink.store(static_cast<uint64_t>(currentTime) - queueEnter);
-        }
+    if (caps && gst_structure_has_name(gst_caps_get_structure(caps, 0), "image/jpeg")) {
+        return publishJpegSample(sink, sample, callbackObj);
     }
 
+    // Timestamps, appsink stage, and the inset rect and camera pose published with the pixels below.
+    uint64_t foveaRect = 0;
+    uint64_t cameraPose = 0;
+    CameraFrame &frame = ReceivePipeline::onSample(sink, buffer, callbackObj, &foveaRect, &cameraPose);
+
     if (!caps) {
         LOG_ERROR("GSTREAMER: Sample has no caps");
         gst_sample_unref(sample);
         return GST_FLOW_ERROR;
     }
 
-    GstStructure *st = gst_caps_get_structure(caps, 0);
-    const gchar *tex_target_str = gst_structure_get_string(st, "texture-target");
-    if (g_strcmp0(tex_target_str, "external-oes") == 0) {
-        frame.glTarget = GL_TEXTURE_EXTERNAL_OES;
-    } else {
-        frame.glTarget = GL_TEXTURE_2D;  // fallback / SW GL path
-    }
-
     // Check whether this is GLMemory (HW decode) or plain system memory (JPEG)
     GstCapsFeatures *features = gst_caps_get_features(caps, 0);
     const bool isGLMemory = (features != nullptr) &&
@@ -744,22 +965,44 @@ GstreamerPlayer::newFrameCallback(GstElement *sink, GStreamerCallbackObj *callba
 
     if (!isGLMemory) {
         // -----------------------------------------------------------------
-        // SOFTWARE PATH (e.g. JPEG) – CPU buffer, memcpy to dataHandle
+        // SOFTWARE PATH (JPEG) – I420 planes, packed tightly into the back
+        // slot. YUV->RGB happens in the fragment shader; the render thread
+        // uploads each published slot once.
         // -----------------------------------------------------------------
-        GstMapInfo mapInfo{};
-        if (!gst_buffer_map(buffer, &mapInfo, GST_MAP_READ)) {
-            LOG_ERROR("GSTREAMER: Failed to map CPU buffer");
+        GstVideoInfo vinfo;
+        GstVideoFrame vframe;
+        if (!gst_video_info_from_caps(&vinfo, caps) ||
+            GST_VIDEO_INFO_FORMAT(&vinfo) != GST_VIDEO_FORMAT_I420 ||
+            !gst_video_frame_map(&vframe, &vinfo, buffer, GST_MAP_READ)) {
+            LOG_ERROR("GSTREAMER: Failed to map I420 frame");
             gst_sample_unref(sample);
             return GST_FLOW_ERROR;
         }
 
-        {
-            std::lock_guard<std::mutex> lk(frame.frameMutex);
-            memcpy(frame.dataHandle, mapInfo.data, frame.memorySize);
-            frame.hasGlTexture = false;
+        FrameSlot &slot = frame.slots[frame.mailbox.backSlot()];
+        fitSlotPlanes(slot, GST_VIDEO_FRAME_WIDTH(&vframe), GST_VIDEO_FRAME_HEIGHT(&vframe));
+        uint8_t *dst = slot.planes;
+        for (guint plane = 0; plane < 3; plane++) {
+            const auto *src = static_cast<const uint8_t *>(GST_VIDEO_FRAME_PLANE_DATA(&vframe, plane));
+            const int srcStride = GST_VIDEO_FRAME_PLANE_STRIDE(&vframe, plane);
+            const int rowBytes = GST_VIDEO_FRAME_COMP_WIDTH(&vframe, plane);
+            const int rows = GST_VIDEO_FRAME_COMP_HEIGHT(&vframe, plane);
+            if (srcStride == rowBytes) {
+                memcpy(dst, src, static_cast<size_t>(rowBytes) * rows);
+                dst += static_cast<size_t>(rowBytes) * rows;
+            } else {
+                for (int row = 0; row < rows; row++, dst += rowBytes) {
+                    memcpy(dst, src + static_cast<size_t>(row) * srcStride, rowBytes);
+                }
+            }
         }
+        if (foveaRect != 0) frame.foveaRect = foveaRect;
+        slot.isTexture = false;
+        slot.foveaRect = frame.foveaRect;
+        slot.cameraPose = cameraPose;
+        frame.mailbox.publish();
 
-        gst_buffer_unmap(buffer, &mapInfo);
+        gst_video_frame_unmap(&vframe);
         gst_sample_unref(sample);
 
         return GST_FLOW_OK;
@@ -772,7 +1015,8 @@ GstreamerPlayer::newFrameCallback(GstElement *sink, GStreamerCallbackObj *callba
         // Strategy: copy the OES sample into an app-owned GL_TEXTURE_2D on
         // GstGL's worker thread (where the OES handle is fresh and the GL
         // context is current), publish *our* 2D texture to the render
-        // thread, then unref the sample. The render thread never sees an
+        // thread through the frame's triple buffer, then unref the sample.
+        // The render thread never sees an
         // external-OES handle, so MediaCodec.updateTexImage() can no
         // longer race with glDrawElements.
         // -----------------------------------------------------------------
@@ -807,18 +1051,10 @@ GstreamerPlayer::newFrameCallback(GstElement *sink, GStreamerCallbackObj *callba
             return GST_FLOW_ERROR;
         }
 
-        OesBlitJob job{&frame, tex_id, newW, newH, false};
-        {
-            std::lock_guard<std::mutex> lk(frame.frameMutex);
-            gst_gl_context_thread_add(gl_ctx, oesBlitOnGstGlThread, &job);
-            if (job.success) {
-                frame.glTexture    = frame.hwBackingTex;
-                frame.glTarget     = GL_TEXTURE_2D;
-                frame.hasGlTexture = true;
-                frame.frameWidth   = newW;
-                frame.frameHeight  = newH;
-            }
-        }
+        // The blit publishes the slot itself, on the GstGL thread.
+        if (foveaRect != 0) frame.foveaRect = foveaRect;
+        OesBlitJob job{&frame, tex_id, newW, newH, cameraPose, false};
+        gst_gl_context_thread_add(gl_ctx, oesBlitOnGstGlThread, &job);
 
         gst_video_frame_unmap(&vframe);
         gst_sample_unref(sample);
@@ -832,208 +1068,36 @@ GstreamerPlayer::newFrameCallback(GstElement *sink, GStreamerCallbackObj *callba
     }
 }
 
-/**
- * Identity handoff at the UDP source. Extracts server-side latency data
- * from RTP header extensions (frame ID, camera/vidconv/enc/rtpPay timestamps)
- * and records the UDP arrival timestamp for network latency calculation.
- */
-void GstreamerPlayer::onRtpHeaderMetadata(GstElement *identity, GstBuffer *buffer, gpointer data) {
-    auto *obj = reinterpret_cast<GStreamerCallbackObj *>(data);
-    auto *pair = obj->first;
-    auto *ntpTimer = obj->second;
-
-    bool isLeftCamera = std::string(identity->object.parent->name) == "pipeline_left";
-    auto stats = isLeftCamera ? pair->first.stats : pair->second.stats;
-    stats->totalLatency = 0;
-
-    GstRTPBuffer rtp_buf = GST_RTP_BUFFER_INIT;
-    gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp_buf);
-    gpointer myInfoBuf = nullptr;
-    guint size_64 = 8;
-
-    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 0, &myInfoBuf, &size_64) != 0) {
-        stats->frameId = *(static_cast<uint64_t *>(myInfoBuf));
-        LOG_DEBUG("GStreamer: New frameid from %s, packets in prev frame: %u",
-                  identity->object.parent->name, stats->packetsPerFrame.load());
-        stats->packetsPerFrame = 0;
-    }
-    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 1, &myInfoBuf, &size_64) != 0) {
-        stats->camera = *(static_cast<uint64_t *>(myInfoBuf));
-    }
-    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 2, &myInfoBuf, &size_64) != 0) {
-        stats->vidConv = *(static_cast<uint64_t *>(myInfoBuf));
-    }
-    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 3, &myInfoBuf, &size_64) != 0) {
-        stats->enc = *(static_cast<uint64_t *>(myInfoBuf));
-    }
-    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 4, &myInfoBuf, &size_64) != 0) {
-        stats->rtpPay = *(static_cast<uint64_t *>(myInfoBuf));
-    }
-    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 5, &myInfoBuf, &size_64) != 0) {
-        stats->rtpPayTimestamp = *(static_cast<uint64_t *>(myInfoBuf));
-    }
-    uint32_t rtpTs = gst_rtp_buffer_get_timestamp(&rtp_buf);
-    gst_rtp_buffer_unmap(&rtp_buf);
-
-    LOG_DEBUG("GStreamer: RTP header from %s, frame %lu",
-              identity->object.parent->name, (unsigned long)stats->frameId.load());
-
-    uint64_t now = ntpTimer->GetCurrentTimeUs();
-    stats->udpStream = now - stats->rtpPayTimestamp;
-
-    // Anchor the jitter-buffer-hold timer at first-packet-of-frame arrival.
-    // Key by the RTP timestamp — the canonical per-frame identifier in RTP,
-    // identical across every packet of one frame, and invariant across the
-    // jitterbuffer (which rewrites GstBuffer PTS). Every packet of a frame
-    // fires this callback; lastSeenRtpTs dedupes to store only the first.
-    if (rtpTs != stats->lastSeenRtpTs.load()) {
-        stats->rtpTsArrivalMap.store(static_cast<uint64_t>(rtpTs), now);
-        stats->lastSeenRtpTs = rtpTs;
-    }
-    stats->packetsPerFrame += 1;
-
-    // Per-stream network health from RTP packet arrivals (this eye's stats).
-    // Actual received bitrate: bytes over a ~1 s window -> bits/sec.
-    gsize pktBytes = gst_buffer_get_size(buffer);
-    uint64_t winStart = stats->bitrateWinStartUs.load();
-    if (winStart == 0) {
-        stats->bitrateWinStartUs.store(now);
-        stats->bitrateWinBytes.store(pktBytes);
-    } else {
-        uint64_t bytes = stats->bitrateWinBytes.fetch_add(pktBytes) + pktBytes;
-        uint64_t elapsed = now - winStart;
-        if (elapsed >= 1000000ULL) {
-            uint64_t bps = bytes * 8ULL * 1000000ULL / elapsed;
-            if (bps > 0xFFFFFFFFULL) bps = 0xFFFFFFFFULL;
-            stats->actualBitrateBps.store(static_cast<uint32_t>(bps));
-            stats->bitrateWinStartUs.store(now);
-            stats->bitrateWinBytes.store(0);
-        }
-    }
-    // RFC 3550 interarrival jitter (RTP clock-rate 90000): D = arrival-delta minus
-    // rtp-timestamp-delta; J += (|D| - J)/16. Published in microseconds.
-    uint64_t prevArr = stats->jitterPrevArrivalUs.load();
-    if (prevArr != 0) {
-        int64_t dArrUs = static_cast<int64_t>(now - prevArr);
-        int32_t dTicks = static_cast<int32_t>(rtpTs - stats->jitterPrevRtpTs.load());
-        int64_t dRtpUs = static_cast<int64_t>(dTicks) * 1000000LL / 90000LL;
-        double D = static_cast<double>(dArrUs - dRtpUs);
-        if (D < 0) D = -D;
-        double J = stats->jitterAccum.load();
-        J += (D - J) / 16.0;
-        stats->jitterAccum.store(J);
-        stats->jitterUs.store(static_cast<uint32_t>(J < 0.0 ? 0.0 : J));
-    }
-    stats->jitterPrevArrivalUs.store(now);
-    stats->jitterPrevRtpTs.store(rtpTs);
-}
+GstFlowReturn
+GstreamerPlayer::publishJpegSample(GstElement *sink, GstSample *sample, GStreamerCallbackObj *callbackObj) {
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
 
-/**
- * Identity handoff at downstream probe points (rtpdepay, decoder, queue).
- * Records timestamps and computes per-stage latency deltas. At the final
- * probe (queue_ident), sums up total pipeline latency and updates the
- * running average history.
- */
-void GstreamerPlayer::onIdentityHandoff(GstElement *identity, GstBuffer *buffer, gpointer data) {
-    auto *obj = reinterpret_cast<GStreamerCallbackObj *>(data);
-    auto *pair = obj->first;
-    auto *ntpTimer = obj->second;
-
-    bool isLeftCamera = std::string(identity->object.parent->name) == "pipeline_left";
-    auto *stats = isLeftCamera ? pair->first.stats : pair->second.stats;
-
-    uint64_t now = ntpTimer->GetCurrentTimeUs();
-    GstClockTime pts = GST_BUFFER_PTS(buffer);
-    uint64_t ptsKey = (pts != GST_CLOCK_TIME_NONE) ? static_cast<uint64_t>(pts) : 0;
-
-    if (std::string(identity->object.name) == "postjb_ident") {
-        // Per-frame: jbHold = (post-jitterbuffer release time) - (first-packet arrival time)
-        // The buffer here is still an RTP packet (post-jitterbuffer, pre-depay), so we read
-        // its RTP timestamp directly. This is the canonical key across the jitterbuffer,
-        // where GstBuffer PTS is rewritten by the buffer itself and therefore unusable.
-        GstRTPBuffer rtp_buf = GST_RTP_BUFFER_INIT;
-        if (gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp_buf)) {
-            uint32_t rtpTs = gst_rtp_buffer_get_timestamp(&rtp_buf);
-            gst_rtp_buffer_unmap(&rtp_buf);
-            uint64_t arrived = stats->rtpTsArrivalMap.consume(static_cast<uint64_t>(rtpTs));
-            if (arrived != 0 && now > arrived) {
-                stats->jbHold = now - arrived;
-            }
-        }
-        // Read this stream's rtpjitterbuffer loss/rtx counters (cumulative). The
-        // identity's parent is the pipeline; the jitterbuffer is named per pipeline.
-        if (GstObject *parent = identity->object.parent) {
-            GstElement *jb = gst_bin_get_by_name(GST_BIN(parent), "jitterbuffer");
-            if (jb) {
-                GstStructure *jbStats = nullptr;
-                g_object_get(jb, "stats", &jbStats, NULL);
-                if (jbStats) {
-                    guint64 lost = 0, rtx = 0;
-                    gst_structure_get_uint64(jbStats, "num-lost", &lost);
-                    gst_structure_get_uint64(jbStats, "rtx-count", &rtx);
-                    stats->jbNumLost.store(static_cast<uint32_t>(lost));
-                    stats->rtxCount.store(static_cast<uint32_t>(rtx));
-                    gst_structure_free(jbStats);
-                }
-                gst_object_unref(jb);
-            }
-        }
-        // Hand off to the GstBuffer-PTS-keyed chain for the rest of the pipeline,
-        // where PTS is stable and can serve as the per-frame key.
-        if (ptsKey != 0) {
-            stats->postjbPtsMap.store(ptsKey, now);
-        }
-    } else if (std::string(identity->object.name) == "rtpdepay_ident") {
-        // Per-frame: rtpDepay = (depay emit time) - (post-jitterbuffer release time)
-        // Both probes are downstream of the jitterbuffer, so GstBuffer PTS is stable
-        // and matches across them.
-        if (ptsKey != 0) {
-            uint64_t postjbEnter = stats->postjbPtsMap.consume(ptsKey);
-            if (postjbEnter != 0 && now > postjbEnter) {
-                stats->rtpDepay = now - postjbEnter;
-            }
-            stats->depayPtsMap.store(ptsKey, now);
-        }
-    } else if (std::string(identity->object.name) == "dec_ident") {
-        // Per-frame: dec = (this frame's amcviddec emit time) - (this frame's depay emit time).
-        // Critical for HW decoder pipeline visibility — the previous global-timestamp
-        // approach subtracted frame N+depth's depay time, masking ~100 ms of AVC
-        // pipeline depth as ~3 ms steady-state inter-frame interval.
-        if (ptsKey != 0) {
-            uint64_t depayEnter = stats->depayPtsMap.consume(ptsKey);
-            if (depayEnter != 0 && now > depayEnter) {
-                stats->dec = now - depayEnter;
-            }
-            stats->decPtsMap.store(ptsKey, now);
-        }
-    } else if (std::string(identity->object.name) == "queue_ident") {
-        // Per-frame: queue = (queue emit time) - (this frame's dec emit time).
-        if (ptsKey != 0) {
-            uint64_t decEnter = stats->decPtsMap.consume(ptsKey);
-            if (decEnter != 0 && now > decEnter) {
-                stats->queue = now - decEnter;
-            }
-            stats->queuePtsMap.store(ptsKey, now);
-        }
-        stats->totalLatency =
-                stats->camera + stats->vidConv + stats->enc + stats->rtpPay + stats->udpStream +
-                stats->jbHold + stats->rtpDepay + stats->dec + stats->queue;
-
-        // Update running average history after all stats are computed.
-        // Window size = configured stream FPS, so the rolling average always
-        // covers ~1 s regardless of the chosen rate.
-        stats->updateHistory(static_cast<size_t>(obj->windowFrames->load()));
-
-        LOG_DEBUG("GStreamer: %s latencies (us): camera=%lu vidconv=%lu enc=%lu rtpPay=%lu "
-                  "udpStream=%lu rtpDepay=%lu dec=%lu queue=%lu total=%lu",
-                  identity->object.parent->name,
-                  (unsigned long) stats->camera.load(),
-                  (unsigned long) stats->vidConv.load(), (unsigned long) stats->enc.load(),
-                  (unsigned long) stats->rtpPay.load(), (unsigned long) stats->udpStream.load(),
-                  (unsigned long) stats->rtpDepay.load(), (unsigned long) stats->dec.load(),
-                  (unsigned long) stats->queue.load(),
-                  (unsigned long) stats->totalLatency.load());
+    // Decode first so the decoder stage is stamped before the appsink one.
+    JpegDecoder *decoder = nullptr;
+    uint8_t *planes = ReceivePipeline::decodeJpegSample(sink, buffer, callbackObj, &decoder);
+
+    uint64_t foveaRect = 0;
+    uint64_t cameraPose = 0;
+    CameraFrame &frame = ReceivePipeline::onSample(sink, buffer, callbackObj, &foveaRect, &cameraPose);
+
+    if (planes) {
+        // The decoder wrote a full frame at frameWidth x frameHeight; publish
+        // it by swapping buffers with the back slot and decode the next frame
+        // into the slot's old planes.
+        FrameSlot &slot = frame.slots[frame.mailbox.backSlot()];
+        fitSlotPlanes(slot, frame.frameWidth, frame.frameHeight);
+        slot.planes = decoder->exchangeOutput(slot.planes);
+        if (foveaRect != 0) frame.foveaRect = foveaRect;
+        slot.isTexture = false;
+        slot.foveaRect = frame.foveaRect;
+        slot.cameraPose = cameraPose;
+        frame.mailbox.publish();
     }
+
+    gst_sample_unref(sample);
+
+    // A corrupt frame (lost packets) is skipped; the next one may be fine.
+    return GST_FLOW_OK;
 }
 
 void GstreamerPlayer::stateChangedCallback(GstBus *bus, GstMessage *msg, GstElement *pipeline) {
@@ -1073,38 +1137,3 @@ void GstreamerPlayer::errorCallback(GstBus *bus, GstMessage *msg, GstElement *pi
     LOG_ERROR("GSTREAMER error received from element: %s, %s", GST_OBJECT_NAME(msg->src),
               err->message);
 }
-
-/** Pad probe on UDP source to log packet arrival intervals (debug only). */
-GstPadProbeReturn
-GstreamerPlayer::udpPacketProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
-    static auto last_time = std::chrono::steady_clock::now();
-
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time).count();
-    last_time = now;
-
-    LOG_DEBUG("GStreamer: UDP packet arrived, interval: %lld ms", elapsed);
-
-    return GST_PAD_PROBE_OK;
-}
-
-/** Build GstCaps for the hardware decoder input (H264 or H265 byte-stream). */
-GstCaps *GstreamerPlayer::buildDecoderSrcCaps(Codec codec, int width, int height, int fps) {
-    const char *media_type = codec == Codec::H265 ? "video/x-h265" : "video/x-h264";
-
-    GstCaps *caps = gst_caps_new_simple(
-            media_type,
-            "width", G_TYPE_INT, width,
-            "height", G_TYPE_INT, height,
-            "stream-format", G_TYPE_STRING, "byte-stream",
-            "alignment", G_TYPE_STRING, "au",
-            "parsed", G_TYPE_BOOLEAN, TRUE,
-            nullptr
-    );
-
-    if (codec == Codec::H265) {
-        gst_caps_set_simple(caps, "framerate", GST_TYPE_FRACTION, fps, 1, nullptr);
-    }
-
-    return caps;
-}
\ No newline at end of file
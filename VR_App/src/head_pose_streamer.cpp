@@ -0,0 +1,96 @@
+/**
+ * head_pose_streamer.cpp - Fixed-rate head pose sampling thread
+ *
+ * See head_pose_streamer.h. The loop sleeps to absolute deadlines so the
+ * send interval does not drift with the time spent locating and posting;
+ * a deadline that has already passed is dropped rather than caught up.
+ */
+#include "head_pose_streamer.h"
+#include "xr_timing.h"
+#include <sys/resource.h>
+#include <unistd.h>
+
+HeadPoseStreamer::HeadPoseStreamer(XrSpace viewSpace, XrSpace baseSpace, RobotControlSender *sender)
+        : viewSpace_(viewSpace), baseSpace_(baseSpace), sender_(sender) {
+    running_ = true;
+    thread_ = std::thread(&HeadPoseStreamer::streamLoop, this);
+}
+
+HeadPoseStreamer::~HeadPoseStreamer() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void HeadPoseStreamer::setParameters(uint32_t rateHz, uint32_t predictionMs, uint32_t maxSpeed) {
+    rateHz_ = std::clamp(rateHz, MIN_RATE_HZ, MAX_RATE_HZ);
+    predictionMs_ = predictionMs;
+    maxSpeed_ = maxSpeed;
+}
+
+int64_t HeadPoseStreamer::monotonicNowNs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000LL + ts.tv_nsec;
+}
+
+void HeadPoseStreamer::streamLoop() {
+    // Same class as the sender thread: the sample should be taken on time, not after the decoders.
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), -4) != 0) {
+        LOG_WARN("HeadPoseStreamer: setpriority failed (errno=%d: %s)", errno, strerror(errno));
+    }
+    LOG_INFO("HeadPoseStreamer: Sampling thread started");
+
+    auto deadline = std::chrono::steady_clock::now();
+    while (running_) {
+        const auto period = std::chrono::nanoseconds(1'000'000'000LL / rateHz_.load());
+        deadline += period;
+
+        if (active_) {
+            const int64_t nowNs = monotonicNowNs();
+            XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+            // Lead by the frame loop's display latency too: the horizon stays measured from
+            // photon time, as when the pose was sampled for the frame's predicted display time.
+            const int64_t leadNs = XrTiming::displayLeadNs.load(std::memory_order_relaxed);
+            const XrTime targetTime = nowNs + leadNs + static_cast<XrTime>(predictionMs_.load()) * 1'000'000;
+            XrResult res = xrLocateSpace(viewSpace_, baseSpace_, targetTime, &location);
+            if (XR_UNQUALIFIED_SUCCESS(res) &&
+                (location.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
+                (location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0) {
+                sender_->sendHeadPose(location.pose.orientation, static_cast<float>(maxSpeed_.load()));
+
+                if (lastSendNs_ != 0) {
+                    const double intervalUs = static_cast<double>(nowNs - lastSendNs_) / 1000.0;
+                    intervals_++;
+                    intervalSumUs_ += intervalUs;
+                    intervalSumSqUs_ += intervalUs * intervalUs;
+                }
+                lastSendNs_ = nowNs;
+                if (reportStartNs_ == 0) reportStartNs_ = nowNs;
+                if (nowNs - reportStartNs_ >= REPORT_INTERVAL_NS && intervals_ > 0) {
+                    const double mean = intervalSumUs_ / static_cast<double>(intervals_);
+                    const double variance = std::max(0.0, intervalSumSqUs_ / static_cast<double>(intervals_) - mean * mean);
+                    LOG_INFO("HeadPoseStreamer: %.1f Hz (target %u), send interval jitter %.1f us, "
+                             "horizon %.1f ms display lead + %u ms",
+                             1e6 / mean, rateHz_.load(), std::sqrt(variance), static_cast<double>(leadNs) / 1e6,
+                             predictionMs_.load());
+                    reportStartNs_ = nowNs;
+                    intervals_ = 0;
+                    intervalSumUs_ = 0.0;
+                    intervalSumSqUs_ = 0.0;
+                }
+            } else if (!XR_UNQUALIFIED_SUCCESS(res)) {
+                LOG_DEBUG("HeadPoseStreamer: xrLocateSpace failed: %d", res);
+            }
+        } else {
+            lastSendNs_ = 0;  // a pause is not an interval
+        }
+
+        // Fell behind (descheduled, or the rate was raised): restart the grid instead of bursting.
+        const auto now = std::chrono::steady_clock::now();
+        if (deadline < now) deadline = now;
+        std::this_thread::sleep_until(deadline);
+    }
+    LOG_INFO("HeadPoseStreamer: Sampling thread stopped");
+}
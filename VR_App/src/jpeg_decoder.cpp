@@ -0,0 +1,423 @@
+/**
+ * jpeg_decoder.cpp - Sliced parallel JPEG -> I420 decoder
+ *
+ * Marker parsing and restart-interval slicing on top of libjpeg. Each slice
+ * is rebuilt as a standalone JPEG (all header segments, SOF height patched,
+ * the slice's entropy-coded intervals with their RSTn renumbered from RST0,
+ * EOI) and decoded with raw-data output into its rows of the I420 planes.
+ */
+#include "jpeg_decoder.h"
+#include "log.h"
+#include "types/camera_types.h"
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <numeric>
+#include <jpeglib.h>
+
+// ============================================================================
+// Marker parsing
+// ============================================================================
+
+struct JpegLayout {
+    int width{0}, height{0};
+    bool yuv420{false};            // 3 components, Y 2x2 + Cb/Cr 1x1 (16x16 MCUs)
+    bool sliceable{false};         // + sequential, single interleaved scan, DRI set
+    unsigned restartInterval{0};   // MCUs per restart interval, 0 = none
+    size_t sofHeightOffset{0};     // offset of the SOF height field
+    size_t scanStart{0};           // first entropy-coded byte after SOS
+    size_t scanEnd{0};             // offset of EOI (or end of data)
+};
+
+static constexpr int MCU_SIZE = 16;  // 4:2:0 MCU: 16x16 luma, 8x8 per chroma plane
+
+static inline unsigned readBe16(const uint8_t *p) {
+    return (static_cast<unsigned>(p[0]) << 8) | p[1];
+}
+
+/**
+ * Walk the header segments up to SOS and, for sliceable frames, index the
+ * restart markers in the entropy-coded data. Returns false if the header is
+ * malformed; a frame libjpeg can decode but that cannot be sliced returns
+ * true with sliceable unset.
+ */
+static bool parseLayout(const uint8_t *data, size_t size, JpegLayout &layout, std::vector<size_t> &restarts) {
+    restarts.clear();
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+
+    bool sequential = false;
+    size_t pos = 2;
+    for (;;) {
+        while (pos + 1 < size && data[pos] == 0xFF && data[pos + 1] == 0xFF) pos++;  // fill bytes
+        if (pos + 4 > size || data[pos] != 0xFF) return false;
+        const uint8_t marker = data[pos + 1];
+        const size_t length = readBe16(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size) return false;
+        const uint8_t *segment = data + pos + 4;
+
+        if (marker == 0xC0 || marker == 0xC1) {
+            // SOF0/SOF1: P, Y, X, Nf, then (id, HiVi, Tq) per component.
+            if (length < 8) return false;
+            const unsigned components = segment[5];
+            if (length < 8 + 3 * components) return false;
+            layout.height = static_cast<int>(readBe16(segment + 1));
+            layout.width = static_cast<int>(readBe16(segment + 3));
+            layout.sofHeightOffset = pos + 5;
+            layout.yuv420 = components == 3 &&
+                            segment[7] == 0x22 && segment[10] == 0x11 && segment[13] == 0x11;
+            sequential = true;
+        } else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            // Progressive / lossless / arithmetic: decodable whole, not sliceable.
+            if (length >= 8) {
+                layout.height = static_cast<int>(readBe16(segment + 1));
+                layout.width = static_cast<int>(readBe16(segment + 3));
+            }
+            sequential = false;
+        } else if (marker == 0xDD) {
+            if (length < 4) return false;
+            layout.restartInterval = readBe16(segment);
+        } else if (marker == 0xDA) {
+            layout.scanStart = pos + 2 + length;
+            layout.sliceable = sequential && layout.yuv420 && segment[0] == 3 && layout.restartInterval > 0;
+            break;
+        }
+        pos += 2 + length;
+    }
+
+    layout.scanEnd = size;
+    if (!layout.sliceable) return true;
+
+    // RSTn positions; 0xFF00 is a stuffed data byte, anything else ends the scan.
+    const uint8_t *p = data + layout.scanStart;
+    const uint8_t *end = data + size;
+    while (p + 1 < end) {
+        p = static_cast<const uint8_t *>(std::memchr(p, 0xFF, static_cast<size_t>(end - p - 1)));
+        if (!p) break;
+        const uint8_t next = p[1];
+        if (next == 0x00) {
+            p += 2;
+        } else if (next == 0xFF) {
+            p += 1;
+        } else if (next >= 0xD0 && next <= 0xD7) {
+            restarts.push_back(static_cast<size_t>(p - data));
+            p += 2;
+        } else {
+            layout.scanEnd = static_cast<size_t>(p - data);
+            layout.sliceable = next == 0xD9;  // a second scan or DNL cannot be sliced
+            break;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// libjpeg decode into I420 planes
+// ============================================================================
+
+struct JpegErrorManager {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+/** libjpeg's default error_exit calls exit(); unwind to the decode call instead. */
+static void onJpegError(j_common_ptr cinfo) {
+    char message[JMSG_LENGTH_MAX];
+    cinfo->err->format_message(cinfo, message);
+    LOG_DEBUG("JpegDecoder: %s", message);
+    longjmp(reinterpret_cast<JpegErrorManager *>(cinfo->err)->jump, 1);
+}
+
+/** Corrupt-data warnings go to the debug log rather than stderr. */
+static void onJpegMessage(j_common_ptr cinfo) {
+    char message[JMSG_LENGTH_MAX];
+    cinfo->err->format_message(cinfo, message);
+    LOG_DEBUG("JpegDecoder: %s", message);
+}
+
+/** Destination rows [0, lumaRows) of one (sub)image inside a tightly packed I420 frame. */
+struct PlaneTarget {
+    uint8_t *y, *u, *v;
+    int width;
+    int lumaRows;
+};
+
+static PlaneTarget planesAt(uint8_t *frame, int width, int height, int firstRow, int rows) {
+    const size_t chromaWidth = static_cast<size_t>((width + 1) / 2);
+    const size_t chromaHeight = static_cast<size_t>((height + 1) / 2);
+    uint8_t *u = frame + static_cast<size_t>(width) * height;
+    uint8_t *v = u + chromaWidth * chromaHeight;
+    const size_t chromaRow = static_cast<size_t>(firstRow / 2);
+    return {frame + static_cast<size_t>(firstRow) * width, u + chromaRow * chromaWidth,
+            v + chromaRow * chromaWidth, width, rows};
+}
+
+/** Scratch bytes either decode path needs for an image this wide. */
+static size_t scratchBytes(int width) {
+    const size_t padded = static_cast<size_t>((width + MCU_SIZE - 1) / MCU_SIZE) * MCU_SIZE;
+    return std::max(MCU_SIZE * padded + MCU_SIZE * (padded / 2),   // raw: 16 Y + 8 Cb + 8 Cr rows
+                    2 * static_cast<size_t>(width) * 3);              // scanlines: 2 YCbCr rows
+}
+
+static void initDecompress(jpeg_decompress_struct &cinfo, JpegErrorManager &err) {
+    cinfo.err = jpeg_std_error(&err.pub);
+    err.pub.error_exit = onJpegError;
+    err.pub.output_message = onJpegMessage;
+}
+
+/**
+ * 4:2:0 decode with raw-data output: libjpeg writes the Y/Cb/Cr planes
+ * directly, one 16-row iMCU row per call. Rows past the image bottom (and
+ * every row, if the padded block width differs from the plane width) go to
+ * scratch.
+ */
+static bool decodeRaw420(const uint8_t *jpeg, size_t size, const PlaneTarget &dst, uint8_t *scratch) {
+    jpeg_decompress_struct cinfo{};
+    JpegErrorManager err{};
+    initDecompress(cinfo, err);
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<uint8_t *>(jpeg), static_cast<unsigned long>(size));
+    jpeg_read_header(&cinfo, TRUE);
+
+    const bool is420 = cinfo.num_components == 3 &&
+                       cinfo.comp_info[0].h_samp_factor == 2 && cinfo.comp_info[0].v_samp_factor == 2 &&
+                       cinfo.comp_info[1].h_samp_factor == 1 && cinfo.comp_info[1].v_samp_factor == 1 &&
+                       cinfo.comp_info[2].h_samp_factor == 1 && cinfo.comp_info[2].v_samp_factor == 1;
+    if (!is420 || cinfo.image_width != static_cast<JDIMENSION>(dst.width) ||
+        cinfo.image_height != static_cast<JDIMENSION>(dst.lumaRows)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    cinfo.raw_data_out = TRUE;
+    cinfo.dct_method = JDCT_IFAST;
+    jpeg_start_decompress(&cinfo);
+
+    const size_t chromaWidth = static_cast<size_t>((dst.width + 1) / 2);
+    const int chromaRows = (dst.lumaRows + 1) / 2;
+    const size_t yPad = cinfo.comp_info[0].width_in_blocks * DCTSIZE;
+    const size_t cPad = cinfo.comp_info[1].width_in_blocks * DCTSIZE;
+    const bool direct = yPad == static_cast<size_t>(dst.width) && cPad == chromaWidth;
+    uint8_t *yScratch = scratch;
+    uint8_t *uScratch = yScratch + MCU_SIZE * yPad;
+    uint8_t *vScratch = uScratch + (MCU_SIZE / 2) * cPad;
+
+    JSAMPROW yRows[MCU_SIZE], uRows[MCU_SIZE / 2], vRows[MCU_SIZE / 2];
+    JSAMPARRAY planes[3] = {yRows, uRows, vRows};
+    while (cinfo.output_scanline < cinfo.output_height) {
+        const int y0 = static_cast<int>(cinfo.output_scanline);
+        const int c0 = y0 / 2;
+        for (int i = 0; i < MCU_SIZE; i++) {
+            yRows[i] = (direct && y0 + i < dst.lumaRows)
+                       ? dst.y + static_cast<size_t>(y0 + i) * dst.width : yScratch + i * yPad;
+        }
+        for (int i = 0; i < MCU_SIZE / 2; i++) {
+            const bool inPlane = direct && c0 + i < chromaRows;
+            uRows[i] = inPlane ? dst.u + (c0 + i) * chromaWidth : uScratch + i * cPad;
+            vRows[i] = inPlane ? dst.v + (c0 + i) * chromaWidth : vScratch + i * cPad;
+        }
+        jpeg_read_raw_data(&cinfo, planes, MCU_SIZE);
+
+        if (!direct) {
+            for (int i = 0; i < MCU_SIZE && y0 + i < dst.lumaRows; i++) {
+                memcpy(dst.y + static_cast<size_t>(y0 + i) * dst.width, yRows[i], dst.width);
+            }
+            for (int i = 0; i < MCU_SIZE / 2 && c0 + i < chromaRows; i++) {
+                memcpy(dst.u + (c0 + i) * chromaWidth, uRows[i], chromaWidth);
+                memcpy(dst.v + (c0 + i) * chromaWidth, vRows[i], chromaWidth);
+            }
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+/**
+ * Any other sampling (4:4:4, 4:2:2, greyscale, progressive): decode YCbCr
+ * scanlines in pairs and box-filter the chroma down to 4:2:0.
+ */
+static bool decodeScanlines(const uint8_t *jpeg, size_t size, const PlaneTarget &dst, uint8_t *scratch) {
+    jpeg_decompress_struct cinfo{};
+    JpegErrorManager err{};
+    initDecompress(cinfo, err);
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<uint8_t *>(jpeg), static_cast<unsigned long>(size));
+    jpeg_read_header(&cinfo, TRUE);
+
+    if ((cinfo.num_components != 1 && cinfo.num_components != 3) ||
+        cinfo.image_width != static_cast<JDIMENSION>(dst.width) ||
+        cinfo.image_height != static_cast<JDIMENSION>(dst.lumaRows)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    cinfo.out_color_space = cinfo.num_components == 1 ? JCS_GRAYSCALE : JCS_YCbCr;
+    cinfo.dct_method = JDCT_IFAST;
+    jpeg_start_decompress(&cinfo);
+
+    const int comps = cinfo.output_components;
+    const size_t width = static_cast<size_t>(dst.width);
+    const size_t chromaWidth = (width + 1) / 2;
+    JSAMPROW rows[2] = {scratch, scratch + width * 3};
+    while (cinfo.output_scanline < cinfo.output_height) {
+        const int y0 = static_cast<int>(cinfo.output_scanline);
+        jpeg_read_scanlines(&cinfo, &rows[0], 1);
+        if (cinfo.output_scanline < cinfo.output_height) {
+            jpeg_read_scanlines(&cinfo, &rows[1], 1);
+        } else {
+            memcpy(rows[1], rows[0], width * comps);
+        }
+        const int pair = (y0 + 1 < dst.lumaRows) ? 2 : 1;
+        for (int r = 0; r < pair; r++) {
+            uint8_t *yDst = dst.y + static_cast<size_t>(y0 + r) * width;
+            for (size_t x = 0; x < width; x++) yDst[x] = rows[r][x * comps];
+        }
+        uint8_t *uDst = dst.u + static_cast<size_t>(y0 / 2) * chromaWidth;
+        uint8_t *vDst = dst.v + static_cast<size_t>(y0 / 2) * chromaWidth;
+        if (comps == 1) {
+            memset(uDst, 128, chromaWidth);
+            memset(vDst, 128, chromaWidth);
+            continue;
+        }
+        for (size_t cx = 0; cx < chromaWidth; cx++) {
+            const size_t x0 = 2 * cx * 3;
+            const size_t x1 = std::min(2 * cx + 1, width - 1) * 3;
+            uDst[cx] = static_cast<uint8_t>((rows[0][x0 + 1] + rows[0][x1 + 1] +
+                                             rows[1][x0 + 1] + rows[1][x1 + 1] + 2) / 4);
+            vDst[cx] = static_cast<uint8_t>((rows[0][x0 + 2] + rows[0][x1 + 2] +
+                                             rows[1][x0 + 2] + rows[1][x1 + 2] + 2) / 4);
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
+
+// ============================================================================
+// JpegDecoder
+// ============================================================================
+
+JpegDecoder::JpegDecoder(BS::thread_pool<BS::tp::none> *pool) : pool_(pool) {}
+
+JpegDecoder::~JpegDecoder() = default;
+
+uint8_t *JpegDecoder::exchangeOutput(uint8_t *planes) {
+    uint8_t *previous = output_.release();
+    output_.reset(planes);
+    return previous;
+}
+
+uint8_t *JpegDecoder::decode(const uint8_t *jpeg, size_t size, int width, int height) {
+    JpegLayout layout;
+    if (!parseLayout(jpeg, size, layout, restartOffsets_)) {
+        LOG_DEBUG("JpegDecoder: malformed JPEG header (%zu bytes)", size);
+        return nullptr;
+    }
+    if (layout.width != width || layout.height != height) {
+        LOG_DEBUG("JpegDecoder: frame is %dx%d, expected %dx%d", layout.width, layout.height, width, height);
+        return nullptr;
+    }
+
+    const size_t frameSize = I420FrameSize(width, height);
+    if (!output_ || outputSize_ != frameSize) {
+        output_.reset(new uint8_t[frameSize]);
+        outputSize_ = frameSize;
+    }
+
+    const int slices = planSlices(layout);
+    lastSliceCount_ = std::max(slices, 1);
+    if (slices > 1) {
+        return decodeSlices(jpeg, layout, slices) ? output_.get() : nullptr;
+    }
+
+    scratch_.resize(scratchBytes(width));
+    const PlaneTarget whole = planesAt(output_.get(), width, height, 0, height);
+    const bool ok = layout.yuv420 ? decodeRaw420(jpeg, size, whole, scratch_.data())
+                                  : decodeScanlines(jpeg, size, whole, scratch_.data());
+    return ok ? output_.get() : nullptr;
+}
+
+int JpegDecoder::planSlices(const JpegLayout &layout) {
+    const int threads = pool_ ? static_cast<int>(pool_->get_thread_count()) + 1 : 1;
+    if (!layout.sliceable || threads < 2) return 0;
+
+    const uint64_t mcusPerRow = (layout.width + MCU_SIZE - 1) / MCU_SIZE;
+    const uint64_t mcuRows = (layout.height + MCU_SIZE - 1) / MCU_SIZE;
+    const uint64_t interval = layout.restartInterval;
+    const uint64_t intervals = restartOffsets_.size() + 1;
+    if (intervals != (mcusPerRow * mcuRows + interval - 1) / interval) {
+        return 0;  // markers lost or extra: the boundaries cannot be trusted
+    }
+
+    // A restart interval starts an MCU row every rowStep rows; only those
+    // boundaries can start a slice.
+    const uint64_t rowStep = interval / std::gcd(interval, mcusPerRow);
+    const uint64_t starts = (mcuRows + rowStep - 1) / rowStep;
+    const int count = static_cast<int>(std::min<uint64_t>(threads, starts));
+    if (count < 2) return 0;
+
+    if (slices_.size() < static_cast<size_t>(count)) slices_.resize(count);
+    for (int s = 0; s < count; s++) {
+        const uint64_t firstMcuRow = (starts * s / count) * rowStep;
+        const uint64_t endMcuRow = std::min(mcuRows, (starts * (s + 1) / count) * rowStep);
+        Slice &slice = slices_[s];
+        slice.firstInterval = static_cast<int>(firstMcuRow * mcusPerRow / interval);
+        slice.endInterval = (s == count - 1) ? static_cast<int>(intervals)
+                                             : static_cast<int>(endMcuRow * mcusPerRow / interval);
+        slice.firstRow = static_cast<int>(firstMcuRow * MCU_SIZE);
+        slice.endRow = std::min(layout.height, static_cast<int>(endMcuRow * MCU_SIZE));
+    }
+    return count;
+}
+
+bool JpegDecoder::decodeSlices(const uint8_t *jpeg, const JpegLayout &layout, int count) {
+    auto intervalBegin = [&](int k) {
+        return k == 0 ? layout.scanStart : restartOffsets_[k - 1] + 2;
+    };
+    auto intervalEnd = [&](int k) {
+        return static_cast<size_t>(k) < restartOffsets_.size() ? restartOffsets_[k] : layout.scanEnd;
+    };
+
+    auto runSlice = [&](Slice &slice) {
+        // Headers + this slice's intervals, restart markers renumbered from
+        // RST0 (libjpeg checks the sequence), + EOI.
+        std::vector<uint8_t> &out = slice.jpeg;
+        out.assign(jpeg, jpeg + layout.scanStart);
+        const unsigned rows = static_cast<unsigned>(slice.endRow - slice.firstRow);
+        out[layout.sofHeightOffset] = static_cast<uint8_t>(rows >> 8);
+        out[layout.sofHeightOffset + 1] = static_cast<uint8_t>(rows & 0xFF);
+        for (int k = slice.firstInterval; k < slice.endInterval; k++) {
+            out.insert(out.end(), jpeg + intervalBegin(k), jpeg + intervalEnd(k));
+            if (k + 1 < slice.endInterval) {
+                out.push_back(0xFF);
+                out.push_back(static_cast<uint8_t>(0xD0 + ((k - slice.firstInterval) & 7)));
+            }
+        }
+        out.push_back(0xFF);
+        out.push_back(0xD9);
+
+        slice.scratch.resize(scratchBytes(layout.width));
+        const PlaneTarget dst = planesAt(output_.get(), layout.width, layout.height,
+                                         slice.firstRow, static_cast<int>(rows));
+        return decodeRaw420(out.data(), out.size(), dst, slice.scratch.data());
+    };
+
+    std::vector<std::future<bool>> pending;
+    pending.reserve(count - 1);
+    for (int s = 1; s < count; s++) {
+        pending.push_back(pool_->submit_task([&runSlice, this, s] { return runSlice(slices_[s]); }));
+    }
+    bool ok = runSlice(slices_[0]);
+    for (auto &result : pending) {
+        ok = result.get() && ok;
+    }
+    return ok;
+}
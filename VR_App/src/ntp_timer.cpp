@@ -1,17 +1,33 @@
 /**
  * ntp_timer.cpp - NTP synchronization implementation
  *
- * Each sync cycle takes 3 NTP samples, selects the one with the lowest RTT,
- * and applies exponential moving average smoothing (alpha=0.1) to the offset.
- * Samples with RTT > 20ms are rejected. Falls back to pool.ntp.org after
+ * Each sync cycle takes 3 NTP samples and keeps the one with the lowest RTT
+ * (samples with RTT > 20ms are rejected outright). The kept samples form a
+ * window of FIT_WINDOW points; offset and skew are fitted by least squares
+ * over those whose RTT is close to the window's best, since a slow exchange
+ * mostly measures path asymmetry. Falls back to pool.ntp.org after
  * FALLBACK_THRESHOLD consecutive failures on the primary server.
+ *
+ * With EnableEchoSync() the samples come from clock pings to the robot
+ * relay instead, and the NTP servers are asked only in cycles where no
+ * echo comes back.
  */
 #include <boost/asio.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
 #include <sys/socket.h>
-#include "pch.h"
 #include "log.h"
 #include "ntp_timer.h"
 
@@ -45,7 +61,7 @@ void NtpTimer::StartAutoSync() {
 
         // Always re-arm — a broken sync attempt must not stop the loop.
         try {
-            timer_->expires_after(std::chrono::seconds(2));
+            timer_->expires_after(std::chrono::milliseconds(syncIntervalMs_.load()));
             timer_->async_wait([syncLoop](const boost::system::error_code &ec) {
                 if (!ec) (*syncLoop)();
             });
@@ -75,59 +91,101 @@ void NtpTimer::StartAutoSync() {
     });
 }
 
+void NtpTimer::EnableEchoSync(const std::string &address, uint16_t port) {
+    echoAddress_ = address;
+    echoPort_ = port;
+    LOG_INFO("NtpTimer: Clock echo from %s:%u", echoAddress_.c_str(), echoPort_);
+}
+
 /**
- * Take 3 NTP samples, pick the best (lowest RTT), and update the smoothed offset.
- * Switches to the fallback server after FALLBACK_THRESHOLD consecutive failures.
+ * Take 3 samples, pick the best (lowest RTT), and feed it to the clock model.
+ * Samples come from the clock echo when enabled, from NTP when it yields
+ * none. Switches to the fallback NTP server after FALLBACK_THRESHOLD
+ * consecutive failures.
  */
 void NtpTimer::SyncWithServer(boost::asio::io_context &io) {
     // Heartbeat: one line per cycle so the loop's liveness is visible without
     // needing DEBUG-level logs to be enabled.
-    LOG_INFO("NtpTimer: cycle start (server='%s', stale_for=%lu ms)",
-             ntpServerAddress_.c_str(),
+    LOG_INFO("NtpTimer: cycle start (echo='%s', server='%s', stale_for=%lu ms)",
+             echoAddress_.c_str(), ntpServerAddress_.c_str(),
              (unsigned long)(GetTimeSinceLastSyncUs() / 1000));
 
     std::vector<Sample> goodSamples;
     int rttRejected = 0;
     int failed = 0;
+    ClockSource source = ClockSource::Echo;
+
+    auto collect = [&](ClockSource from) {
+        for (int i = 0; i < 3; ++i) {
+            SampleOutcome outcome;
+            auto result = from == ClockSource::Echo ? GetOneEchoSample(io, outcome) : GetOneNtpSample(io, outcome);
+            if (result.has_value()) {
+                goodSamples.push_back(result.value());
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            } else if (outcome == SampleOutcome::RttRejected) {
+                ++rttRejected;
+            } else {
+                ++failed;
+            }
+        }
+    };
 
-    for (int i = 0; i < 3; ++i) {
-        SampleOutcome outcome;
-        auto result = GetOneNtpSample(io, outcome);
-        if (result.has_value()) {
-            goodSamples.push_back(result.value());
-            std::this_thread::sleep_for(std::chrono::milliseconds(20));
-        } else if (outcome == SampleOutcome::RttRejected) {
-            ++rttRejected;
+    if (!echoAddress_.empty()) {
+        collect(ClockSource::Echo);
+        if (goodSamples.empty()) {
+            if (echoFailedCycles_++ == 0) {
+                LOG_WARN("NtpTimer: no clock echo from %s:%u (rttRejected=%d, failed=%d)%s",
+                         echoAddress_.c_str(), echoPort_, rttRejected, failed,
+                         ntpServerAddress_.empty() ? "" : ", falling back to NTP");
+            }
         } else {
-            ++failed;
+            if (echoFailedCycles_ > 0) {
+                LOG_INFO("NtpTimer: Clock echo recovered after %d cycles", echoFailedCycles_);
+            }
+            echoFailedCycles_ = 0;
+            consecutiveSyncFailures_ = 0;
+            syncHealthy_ = true;
         }
     }
 
-    // Per-cycle diagnostic: surface the rejection breakdown so silent-freeze
-    // failure modes (all samples RTT-rejected, no failures incremented, no
-    // fallback engaged) are visible in logcat.
-    if (goodSamples.empty()) {
-        LOG_WARN("NtpTimer: sync cycle yielded no good samples "
-                 "(rttRejected=%d, failed=%d, server='%s', stale_for=%lu ms)",
-                 rttRejected, failed, ntpServerAddress_.c_str(),
-                 (unsigned long)(GetTimeSinceLastSyncUs() / 1000));
+    if (goodSamples.empty() && !ntpServerAddress_.empty()) {
+        source = ClockSource::Ntp;
+        rttRejected = 0;
+        failed = 0;
+        collect(ClockSource::Ntp);
+
+        // Per-cycle diagnostic: surface the rejection breakdown so silent-freeze
+        // failure modes (all samples RTT-rejected, no failures incremented, no
+        // fallback engaged) are visible in logcat.
+        if (goodSamples.empty()) {
+            LOG_WARN("NtpTimer: sync cycle yielded no good samples "
+                     "(rttRejected=%d, failed=%d, server='%s', stale_for=%lu ms)",
+                     rttRejected, failed, ntpServerAddress_.c_str(),
+                     (unsigned long)(GetTimeSinceLastSyncUs() / 1000));
+        }
+
+        // Fall back to public NTP server if primary is unreachable
+        if (goodSamples.empty() && !usingFallback_ &&
+            consecutiveSyncFailures_ >= FALLBACK_THRESHOLD && !fallbackServerAddress_.empty()) {
+            LOG_INFO("NtpTimer: Primary NTP server '%s' unreachable after %d attempts, "
+                     "falling back to '%s'",
+                     ntpServerAddress_.c_str(), consecutiveSyncFailures_.load(),
+                     fallbackServerAddress_.c_str());
+            ntpServerAddress_ = fallbackServerAddress_;
+            usingFallback_ = true;
+            consecutiveSyncFailures_ = 0;
+        }
+    } else if (goodSamples.empty()) {
+        // Echo only: the NTP path does this accounting for itself.
+        ++consecutiveSyncFailures_;
+        syncHealthy_ = false;
     }
 
-    // Fall back to public NTP server if primary is unreachable
-    if (goodSamples.empty() && !usingFallback_ &&
-        consecutiveSyncFailures_ >= FALLBACK_THRESHOLD && !fallbackServerAddress_.empty()) {
-        LOG_INFO("NtpTimer: Primary NTP server '%s' unreachable after %d attempts, "
-                 "falling back to '%s'",
-                 ntpServerAddress_.c_str(), consecutiveSyncFailures_.load(),
-                 fallbackServerAddress_.c_str());
-        ntpServerAddress_ = fallbackServerAddress_;
-        usingFallback_ = true;
-        consecutiveSyncFailures_ = 0;
+    if (goodSamples.empty()) {
+        syncIntervalMs_ = MIN_SYNC_INTERVAL_MS;
         return;
     }
 
-    if (goodSamples.empty()) return;
-
     uint64_t bestRtt = std::numeric_limits<uint64_t>::max();
     uint64_t bestIndex = 0;
     for (int i = 0; i < goodSamples.size(); i++) {
@@ -138,20 +196,207 @@ void NtpTimer::SyncWithServer(boost::asio::io_context &io) {
     }
 
     const auto& best = goodSamples[bestIndex];
+    LOG_DEBUG("NtpTimer: Selected sample Offset=%ld ms | RTT=%lu us | Diff=%ld us",
+              best.offset / 1000, (unsigned long)best.rtt, best.diff);
+
+    UpdateClockModel(best, source);
+}
+
+void NtpTimer::UpdateClockModel(const Sample &best, ClockSource source) {
+    // Echo and NTP may not reach the same clock (the fallback NTP server
+    // certainly does not): points of one source say nothing about the other.
+    if (source != source_.load(std::memory_order_relaxed) && windowCount_ > 0) {
+        LOG_INFO("NtpTimer: clock source changed to %s, restarting the fit",
+                 source == ClockSource::Echo ? "echo" : "NTP");
+        windowCount_ = 0;
+        windowNext_ = 0;
+        syncIntervalMs_ = MIN_SYNC_INTERVAL_MS;
+    }
+    source_.store(source, std::memory_order_relaxed);
+
+    // A sample far outside the model's own bound means one of the clocks
+    // stepped (server restart, the OS setting the wall clock): the window
+    // describes the old mapping, so start over from this sample.
+    const ClockModel previous = model_.load();
+    if (previous.valid && windowCount_ > 0) {
+        const double miss = std::fabs(static_cast<double>(best.offset - previous.OffsetAt(best.localUs)));
+        const double allowed = previous.ErrorBoundAt(best.localUs) + best.rtt / 2.0 + STEP_THRESHOLD_US;
+        if (miss > allowed) {
+            LOG_WARN("NtpTimer: sample misses the clock model by %.0f us (allowed %.0f us), restarting the fit",
+                     miss, allowed);
+            windowCount_ = 0;
+            windowNext_ = 0;
+            syncIntervalMs_ = MIN_SYNC_INTERVAL_MS;
+        }
+    }
 
-    if (!hasInitialOffset_) {
-        smoothedOffsetUs_ = best.offset;
-        hasInitialOffset_ = true;
-    } else {
-        smoothedOffsetUs_ = alpha * best.offset +
-                            (1.0 - alpha) * smoothedOffsetUs_;
+    window_[windowNext_] = FitPoint{best.localUs, best.offset, best.rtt};
+    windowNext_ = (windowNext_ + 1) % FIT_WINDOW;
+    windowCount_ = std::min(windowCount_ + 1, FIT_WINDOW);
+
+    const ClockModel fitted = FitClockModel();
+    model_.update([&fitted](ClockModel &model) { model = fitted; });
+    lastSyncedTimestampLocal_.store(GetCurrentTimeUsNonAdjusted(), std::memory_order_relaxed);
+
+    // Sync less often while the model would still be within target one
+    // interval past the next sync (so a single lost cycle stays in bounds),
+    // more often as soon as it would not.
+    uint32_t interval = syncIntervalMs_;
+    const double boundAhead = fitted.ErrorBoundAt(best.localUs + 2'000ULL * interval);
+    if (boundAhead >= TARGET_ERROR_US) {
+        interval = std::max(interval / 2, MIN_SYNC_INTERVAL_MS);
+    } else if (windowCount_ >= MIN_BACKOFF_POINTS) {
+        interval = std::min(interval * 2, MAX_SYNC_INTERVAL_MS);
     }
+    syncIntervalMs_ = interval;
 
-    lastSyncedTimestampLocal_ = GetCurrentTimeUsNonAdjusted();
+    LOG_INFO("NtpTimer: offset=%ld us, skew=%.2f ppm, error=+-%.0f us (%zu points); next sync in %u ms",
+             (long)fitted.offsetUs, fitted.skewPpm, fitted.offsetErrorUs, windowCount_, interval);
+}
 
-    LOG_DEBUG("NtpTimer: Selected sample Offset=%ld ms | RTT=%lu us | Diff=%ld us",
-              best.offset / 1000, (unsigned long)best.rtt, best.diff);
-    LOG_DEBUG("NtpTimer: Current smoothed offset=%ld ms", smoothedOffsetUs_ / 1000);
+/**
+ * Fit offset + skew·(t − t0) by least squares, t0 being the newest point.
+ * Only points whose RTT is within 2x the window's best (plus RTT_SLACK_US)
+ * take part. Skew is left at zero, with UNFITTED_SKEW_ERROR_PPM as its
+ * uncertainty, until there are 3 such points spanning MIN_SKEW_SPAN_US, or
+ * when the slope comes out steeper than any real oscillator (MAX_SKEW_PPM).
+ */
+ClockModel NtpTimer::FitClockModel() const {
+    uint64_t minRtt = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < windowCount_; i++) minRtt = std::min(minRtt, window_[i].rttUs);
+    const uint64_t rttLimit = 2 * minRtt + RTT_SLACK_US;
+
+    // Work relative to the newest point: x in seconds, y in microseconds, so
+    // the slope is directly in ppm and doubles keep their precision.
+    const FitPoint &newest = window_[(windowNext_ + FIT_WINDOW - 1) % FIT_WINDOW];
+    std::array<double, FIT_WINDOW> xs{}, ys{};
+    size_t n = 0;
+    double minX = 0.0;
+    for (size_t i = 0; i < windowCount_; i++) {
+        const FitPoint &point = window_[i];
+        if (point.rttUs > rttLimit) continue;
+        xs[n] = static_cast<double>(static_cast<int64_t>(point.localUs - newest.localUs)) / 1e6;
+        ys[n] = static_cast<double>(point.offsetUs - newest.offsetUs);
+        minX = std::min(minX, xs[n]);
+        n++;
+    }
+
+    double xMean = 0.0, yMean = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        xMean += xs[i];
+        yMean += ys[i];
+    }
+    xMean /= static_cast<double>(n);
+    yMean /= static_cast<double>(n);
+
+    ClockModel model{};
+    model.refLocalUs = newest.localUs;
+    model.valid = true;
+    const double asymmetryUs = static_cast<double>(minRtt) / 2.0;
+
+    if (n >= 3 && -minX * 1e6 >= static_cast<double>(MIN_SKEW_SPAN_US)) {
+        double sxx = 0.0, sxy = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            sxx += (xs[i] - xMean) * (xs[i] - xMean);
+            sxy += (xs[i] - xMean) * (ys[i] - yMean);
+        }
+        const double skew = sxy / sxx;
+        const double intercept = yMean - skew * xMean;
+        if (std::fabs(skew) <= MAX_SKEW_PPM) {
+            double residuals = 0.0;
+            for (size_t i = 0; i < n; i++) {
+                const double r = ys[i] - intercept - skew * xs[i];
+                residuals += r * r;
+            }
+            const double variance = residuals / static_cast<double>(n - 2);
+            model.offsetUs = newest.offsetUs + std::llround(intercept);
+            model.skewPpm = skew;
+            model.offsetErrorUs = asymmetryUs +
+                                  2.0 * std::sqrt(variance * (1.0 / static_cast<double>(n) + xMean * xMean / sxx));
+            model.skewErrorPpm = 2.0 * std::sqrt(variance / sxx);
+            return model;
+        }
+    }
+
+    // Too little history to tell drift from jitter: plain mean offset.
+    double variance = 0.0;
+    for (size_t i = 0; i < n; i++) variance += (ys[i] - yMean) * (ys[i] - yMean);
+    variance = n > 1 ? variance / static_cast<double>(n - 1) : 0.0;
+    model.offsetUs = newest.offsetUs + std::llround(yMean);
+    model.skewPpm = 0.0;
+    model.offsetErrorUs = asymmetryUs + 2.0 * std::sqrt(variance / static_cast<double>(n));
+    model.skewErrorPpm = UNFITTED_SKEW_ERROR_PPM;
+    return model;
+}
+
+/**
+ * Perform a single clock ping/echo exchange with the robot relay.
+ * Same arithmetic as NTP, on plain microseconds: T1 is sent and echoed
+ * back with the relay's receive (T2) and transmit (T3) times. The socket
+ * stays open between cycles and waits at most ECHO_TIMEOUT_MS, so an absent
+ * relay costs a few hundred milliseconds of this thread per cycle.
+ */
+std::optional<Sample> NtpTimer::GetOneEchoSample(boost::asio::io_context &io, SampleOutcome &outcome) {
+    outcome = SampleOutcome::Failed;
+    try {
+        if (!echoSocket_) {
+            auto socket = std::make_unique<udp::socket>(io);
+            socket->open(udp::v4());
+            // Connected: echoes from anything but the relay are filtered out by the kernel.
+            socket->connect(udp::endpoint(boost::asio::ip::make_address_v4(echoAddress_), echoPort_));
+            struct timeval tv{};
+            tv.tv_sec = 0;
+            tv.tv_usec = ECHO_TIMEOUT_MS * 1000;
+            setsockopt(socket->native_handle(), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            echoSocket_ = std::move(socket);
+        }
+
+        const uint32_t seq = ++echoSeq_;
+        std::array<uint8_t, CLOCK_PING_SIZE> request{};
+        request[0] = MSG_CLOCK_PING;
+        std::memcpy(&request[1], &seq, sizeof(seq));  // little-endian on every target
+        const uint64_t T1 = GetCurrentTimeUsNonAdjusted();
+        std::memcpy(&request[5], &T1, sizeof(T1));
+        echoSocket_->send(boost::asio::buffer(request));
+
+        std::array<uint8_t, CLOCK_ECHO_SIZE + 1> response{};
+        while (true) {
+            boost::system::error_code ec;
+            const size_t len = echoSocket_->receive(boost::asio::buffer(response), 0, ec);
+            const uint64_t T4 = GetCurrentTimeUsNonAdjusted();
+            // Timeout, or ICMP port unreachable when the relay is not running.
+            if (ec) return std::nullopt;
+
+            uint32_t echoedSeq = 0;
+            if (len == CLOCK_ECHO_SIZE && response[0] == MSG_CLOCK_ECHO) {
+                std::memcpy(&echoedSeq, &response[1], sizeof(echoedSeq));
+            }
+            if (echoedSeq != seq) {
+                // The late echo of an earlier ping: skip it, within this ping's own timeout.
+                if (T4 - T1 > ECHO_TIMEOUT_MS * 1000ULL) return std::nullopt;
+                continue;
+            }
+
+            uint64_t T2 = 0, T3 = 0;
+            std::memcpy(&T2, &response[13], sizeof(T2));
+            std::memcpy(&T3, &response[21], sizeof(T3));
+            const int64_t offset = ((int64_t)(T2 - T1) + (int64_t)(T3 - T4)) / 2;
+            const uint64_t delay = (T4 - T1) - (T3 - T2);
+
+            LOG_DEBUG("NtpTimer: Echo sample offset=%ld us | RTT=%lu us", offset, (unsigned long)delay);
+
+            if (delay > MAX_SAMPLE_RTT_US) {
+                outcome = SampleOutcome::RttRejected;
+                return std::nullopt;
+            }
+            outcome = SampleOutcome::Accepted;
+            return Sample{offset, delay, GetCurrentTimeUs() - T3, T1 + (T4 - T1) / 2};
+        }
+    } catch (const std::exception &e) {
+        LOG_DEBUG("NtpTimer: Echo exception: %s", e.what());
+        echoSocket_.reset();
+        return std::nullopt;
+    }
 }
 
 /**
@@ -239,7 +484,7 @@ std::optional<Sample> NtpTimer::GetOneNtpSample(boost::asio::io_context &io, Sam
 
         LOG_DEBUG("NtpTimer: Sample offset=%ld us | RTT=%lu us", offset, (unsigned long)delay);
 
-        if (delay > 20000) {
+        if (delay > MAX_SAMPLE_RTT_US) {
             outcome = SampleOutcome::RttRejected;
             LOG_INFO("NtpTimer: sample rejected for high RTT=%lu us (offset=%ld us)",
                      (unsigned long)delay, offset);
@@ -254,7 +499,7 @@ std::optional<Sample> NtpTimer::GetOneNtpSample(boost::asio::io_context &io, Sam
         syncHealthy_ = true;
         outcome = SampleOutcome::Accepted;
 
-        return Sample{offset, delay, GetCurrentTimeUs() - T3};
+        return Sample{offset, delay, GetCurrentTimeUs() - T3, T1 + (T4 - T1) / 2};
     } catch (const std::exception &e) {
         int failures = ++consecutiveSyncFailures_;
         if (failures == 1) {
@@ -266,7 +511,8 @@ std::optional<Sample> NtpTimer::GetOneNtpSample(boost::asio::io_context &io, Sam
 }
 
 uint64_t NtpTimer::GetCurrentTimeUs() const {
-    return GetCurrentTimeUsNonAdjusted() + smoothedOffsetUs_;
+    const uint64_t local = GetCurrentTimeUsNonAdjusted();
+    return local + model_.load().OffsetAt(local);
 }
 
 uint64_t NtpTimer::GetCurrentTimeUsNonAdjusted() {
@@ -64,10 +64,18 @@ TelepresenceProgram::TelepresenceProgram(struct android_app *app) {
 
     viewsurfaces_ = openxr_create_swapchains(&openxr_instance_, &openxr_system_id_, &openxr_session_);
 
-    ntpTimer_ = std::make_unique<NtpTimer>(IpToString(appState_->streamingConfig.jetson_ip), "195.113.144.201");
+    // Clock echo from the robot relay; the Jetson's NTP server only when it does not answer. No public
+    // NTP fallback: the robot network is usually isolated, and its clock need not match the Jetson's anyway.
+    ntpTimer_ = std::make_unique<NtpTimer>(IpToString(appState_->streamingConfig.jetson_ip), "");
+    ntpTimer_->EnableEchoSync(IpToString(appState_->streamingConfig.jetson_ip), Config::SERVO_PORT);
     ntpTimer_->StartAutoSync();
     gstreamerPlayer_ = std::make_unique<GstreamerPlayer>(&appState_->cameraStreamingStates, ntpTimer_.get());
-    rosNetworkGatewayClient_ = std::make_unique<RosNetworkGatewayClient>();
+    // Trained Zstd dictionaries for the gateway topics are pushed next to the app's external files.
+    rosNetworkGatewayClient_ = std::make_unique<RosNetworkGatewayClient>(
+            app->activity->externalDataPath ? std::string(app->activity->externalDataPath) + "/ros_dictionaries" : "");
+    rosNetworkGatewayClient_->topics().subscribe("/loki_1/chassis/battery_voltage", {{"data", RosFieldType::Number}});
+    rosNetworkGatewayClient_->topics().subscribe("/loki_1/chassis/clock", {{"clock.sec", RosFieldType::Number}});
+    appState_->rosTopics = &rosNetworkGatewayClient_->topics();
 
     appState_->systemInfo.openXrRuntime = openxr_get_runtime_name(&openxr_instance_);
     appState_->systemInfo.openXrSystem = openxr_get_system_name(&openxr_instance_, &openxr_system_id_);
@@ -81,7 +89,8 @@ TelepresenceProgram::TelepresenceProgram(struct android_app *app) {
 }
 
 TelepresenceProgram::~TelepresenceProgram() {
-    if (restClient_ && appState_->connectionState.cameraServer == ConnectionStatus::Connected) {
+    // Queued behind a start still in flight; ~RestClient sends it before the worker exits.
+    if (restClient_ && appState_->connectionState.cameraServer != ConnectionStatus::Failed) {
         LOG_INFO("TelepresenceProgram: Stopping camera stream...");
         restClient_->StopStream();
     }
@@ -96,6 +105,7 @@ void TelepresenceProgram::UpdateFrame() {
     openxr_poll_events(&openxr_instance_, &openxr_session_, &exit, &request_restart, &appState_->headsetMounted);
 
     if (!openxr_is_session_running()) {
+        if (headPoseStreamer_) headPoseStreamer_->setActive(false);
         return;
     }
 
@@ -107,13 +117,18 @@ void TelepresenceProgram::UpdateFrame() {
                 std::to_string(ntpTimer_->GetTimeSinceLastSyncUs() / 1'000'000) + " s)";
         } else if (ntpTimer_->IsSyncHealthy()) {
             appState_->connectionState.ntpSync = ConnectionStatus::Connected;
-            appState_->ntpSyncStatus = "Synced";
+            char status[48];
+            snprintf(status, sizeof(status), "Synced (%s, +-%.1f ms)",
+                     ntpTimer_->GetSource() == ClockSource::Echo ? "echo" : "NTP",
+                     ntpTimer_->GetErrorBoundUs() / 1000.0);
+            appState_->ntpSyncStatus = status;
         } else if (ntpTimer_->GetConsecutiveFailures() > 0) {
             appState_->connectionState.ntpSync = ConnectionStatus::Failed;
             appState_->ntpSyncStatus = "Not Synced";
         }
     }
 
+    PollRestResults();
     PollActions();
     SendControllerDatagram();
 
@@ -135,7 +150,17 @@ void TelepresenceProgram::RenderFrame() {
     std::vector<XrCompositionLayerBaseHeader *> layers;
     XrCompositionLayerProjection layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
     std::vector<XrCompositionLayerProjectionView> projectionLayerViews;
-    if (RenderLayer(display_time, projectionLayerViews, layer)) {
+    std::vector<XrCompositionLayerQuad> quadLayers;
+    begin_gpu_frame_timer();
+    const bool projection = RenderLayer(display_time, projectionLayerViews, layer, quadLayers);
+    appState_->appGpuTime = end_gpu_frame_timer();
+    ReportGpuTime();
+
+    // Back to front: the camera quads, then the GUI and ray over them.
+    for (XrCompositionLayerQuad &quadLayer : quadLayers) {
+        layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader *>(&quadLayer));
+    }
+    if (projection) {
         layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader *>(&layer));
     }
 
@@ -148,19 +173,135 @@ void TelepresenceProgram::RenderFrame() {
     appState_->appFrameRate = (frameDuration > 0) ? (1e6f / frameDuration) : 0.0f;
 }
 
+/**
+ * Average the GPU frame time over GPU_REPORT_INTERVAL and log it with the
+ * presentation mode, so the two modes can be compared from logcat. A mode
+ * change starts a new interval.
+ */
+void TelepresenceProgram::ReportGpuTime() {
+    const auto now = std::chrono::steady_clock::now();
+    if (appState_->presentationMode != gpuReportMode_) {
+        gpuReportMode_ = appState_->presentationMode;
+        gpuReportStart_ = now;
+        gpuReportSumUs_ = 0;
+        gpuReportFrames_ = 0;
+    }
+    if (appState_->appGpuTime >= 0) {
+        gpuReportSumUs_ += appState_->appGpuTime;
+        gpuReportFrames_++;
+    }
+    if (now - gpuReportStart_ < GPU_REPORT_INTERVAL) return;
+
+    if (gpuReportFrames_ > 0) {
+        LOG_INFO("RENDER_TIMING gpu_us_avg=%lld over %u frames, presentation=%s",
+                 gpuReportSumUs_ / gpuReportFrames_, gpuReportFrames_,
+                 PresentationModeToString(gpuReportMode_).c_str());
+    }
+    gpuReportStart_ = now;
+    gpuReportSumUs_ = 0;
+    gpuReportFrames_ = 0;
+}
+
+/**
+ * Rotate the image quad about the eye (app-space (0, 0, 2): the quad is
+ * head-locked 2 m in front of it) by yaw `azimuth` about +Y, then pitch
+ * `elevation` about +X - the pan-tilt convention of the head pose command.
+ */
+static void RotateQuadAboutEye(Quad &quad, float azimuth, float elevation) {
+    const float cy = std::cos(azimuth), sy = std::sin(azimuth);
+    const float cp = std::cos(elevation), sp = std::sin(elevation);
+
+    // Quad orientation is identity, so the result is R = Ry(azimuth) * Rx(elevation).
+    const float hcy = std::cos(azimuth * 0.5f), hsy = std::sin(azimuth * 0.5f);
+    const float hcp = std::cos(elevation * 0.5f), hsp = std::sin(elevation * 0.5f);
+    quad.Pose.orientation = {hcy * hsp, hsy * hcp, -hsy * hsp, hcy * hcp};
+
+    const XrVector3f d{quad.Pose.position.x, quad.Pose.position.y, quad.Pose.position.z - 2.0f};
+    const float py = d.y * cp - d.z * sp;
+    const float pz = d.y * sp + d.z * cp;
+    quad.Pose.position = {d.x * cy + pz * sy, py, -d.x * sy + pz * cy + 2.0f};
+}
+
+/**
+ * Pose and size of the foveated inset's quad layer: rect (FrameSlot::foveaRect)
+ * is normalised to the base frame, whose quad spans -0.5..0.5 in its own space.
+ */
+static void InsetQuadPose(const Quad &quad, uint64_t rect, XrPosef *pose, XrExtent2Df *size) {
+    auto unpack = [rect](int i) { return static_cast<float>((rect >> (16 * i)) & 0xFFFF) / 65535.0f; };
+    const float x = unpack(0), y = unpack(1), w = unpack(2), h = unpack(3);
+    const float lx = x + w / 2.0f - 0.5f, ly = y + h / 2.0f - 0.5f;
+
+    XrMatrix4x4f model;
+    XrMatrix4x4f_CreateTranslationRotationScale(&model, &quad.Pose.position, &quad.Pose.orientation, &quad.Scale);
+    pose->orientation = quad.Pose.orientation;
+    pose->position = {model.m[0] * lx + model.m[4] * ly + model.m[12],
+                      model.m[1] * lx + model.m[5] * ly + model.m[13],
+                      model.m[2] * lx + model.m[6] * ly + model.m[14]};
+    *size = {w * quad.Scale.x, h * quad.Scale.y};
+}
+
+/** A quad layer showing the whole of a camera surface to one eye. */
+static XrCompositionLayerQuad CameraQuadLayer(XrSpace space, const viewsurface_t &surface, XrEyeVisibility eye,
+                                              const XrPosef &pose, XrExtent2Df size) {
+    XrCompositionLayerQuad layer{XR_TYPE_COMPOSITION_LAYER_QUAD};
+    layer.layerFlags = 0;
+    layer.space = space;
+    layer.eyeVisibility = eye;
+    layer.subImage.swapchain = surface.swapchain;
+    layer.subImage.imageRect.offset = {0, 0};
+    layer.subImage.imageRect.extent = {static_cast<int32_t>(surface.width), static_cast<int32_t>(surface.height)};
+    layer.subImage.imageArrayIndex = 0;
+    layer.pose = pose;
+    layer.size = size;
+    return layer;
+}
+
+/**
+ * Keep a camera stream's quad layer swapchain current: (re)created at the
+ * latched frame's size, and written only when a new frame was latched (or it
+ * holds none yet). Between frames the compositor keeps showing the last image
+ * released, so nothing is acquired or drawn.
+ */
+void TelepresenceProgram::UpdateCameraSurface(size_t stream, const CameraFrame &frame, bool latched) {
+    const FrameSlot *slot = frame.frontSlot();
+    if (!slot || slot->width <= 0 || slot->height <= 0) return;
+
+    viewsurface_t &surface = cameraSurfaces_[stream];
+    if (surface.width != static_cast<uint32_t>(slot->width) || surface.height != static_cast<uint32_t>(slot->height)) {
+        openxr_destroy_viewsurface(surface);
+        surface = openxr_create_layer_swapchain(&openxr_session_, static_cast<uint32_t>(slot->width),
+                                                static_cast<uint32_t>(slot->height));
+        cameraSurfaceValid_[stream] = false;
+    }
+    if (!latched && cameraSurfaceValid_[stream]) return;
+
+    XrSwapchainSubImage subImg;
+    render_target_t rtarget;
+    openxr_acquire_viewsurface(surface, rtarget, subImg);
+    cameraSurfaceValid_[stream] = render_camera_surface(rtarget, &frame);
+    openxr_release_viewsurface(surface);
+}
+
 /**
  * Render both eye views into their swapchain images.
  *
  * For each eye: acquires a swapchain image, renders the camera image plane
  * and ImGui overlay, then releases the image. View matrices are rendered at
  * the OpenXR runtime's predicted display time so time warp reprojects cleanly.
- * A separately over-predicted HMD pose (displayTime + headMovementPredictionMs)
- * is queried only for the robot pan-tilt command, to compensate for uplink
- * and servo delay.
+ * The robot pan-tilt command is sampled separately by HeadPoseStreamer.
+ * Whatever the servo has not caught up with is corrected by turning the
+ * image quad by (pose the frame was shot at) - (pose commanded).
+ *
+ * Quad-layer presentation: the image quad becomes an XrCompositionLayerQuad
+ * per eye (plus one for the foveated inset), sampled once by the compositor
+ * straight from the frame-sized camera surface. The eye views then only carry
+ * the GUI and the ray over a transparent clear, and are not rendered at all
+ * while neither is shown.
  */
 bool TelepresenceProgram::RenderLayer(XrTime displayTime,
                                       std::vector<XrCompositionLayerProjectionView> &layerViews,
-                                      XrCompositionLayerProjection &layer) {
+                                      XrCompositionLayerProjection &layer,
+                                      std::vector<XrCompositionLayerQuad> &quadLayers) {
     auto viewCount = viewsurfaces_.size();
     std::vector<XrView> views(viewCount, {XR_TYPE_VIEW});
     openxr_locate_views(&openxr_session_, &displayTime, app_reference_space_, viewCount,
@@ -168,26 +309,6 @@ bool TelepresenceProgram::RenderLayer(XrTime displayTime,
 
     layerViews.resize(viewCount);
 
-    XrSpaceLocation spaceLocation{XR_TYPE_SPACE_LOCATION};
-
-    // Query the HMD pose at the over-predicted time for the robot-side pan-tilt command.
-    // This is intentionally ahead of the OpenXR predicted display time to compensate for
-    // the uplink and servo delay on the robot. The rendered view matrices above use the
-    // unmodified predictedDisplayTime so OpenXR time warp behaves canonically.
-    XrTime robotTargetTime = displayTime + (XrTime) (appState_->headMovementPredictionMs * 1e6);
-    auto res = xrLocateSpace(reference_spaces_[1], app_reference_space_, robotTargetTime,
-                             &spaceLocation);
-    CHECK_XRRESULT(res, "xrLocateSpace")
-    if (XR_UNQUALIFIED_SUCCESS(res)) {
-        if ((spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
-            (spaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0) {
-
-            userState_.hmdPose = spaceLocation.pose;
-        }
-    } else {
-        LOG_INFO("Unable to locate a visualized reference space in app space: %d", res);
-    }
-
     Quad quad{};
     quad.Pose.position = {0.0f, 0.0f, 0.0f};
     quad.Pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -197,11 +318,43 @@ bool TelepresenceProgram::RenderLayer(XrTime displayTime,
         quad.Scale = {3.56f * appState_->streamingConfig.resolution.getAspectRatio(), 3.56f, 0.0f};
     }
 
+    // Both eyes (and the foveated inset) draw the frame latched here, so a
+    // sample published mid-frame cannot show in one eye only.
+    const bool firstLatched = latch_camera_frame(&appState_->cameraStreamingStates.first);
+    const bool secondLatched = latch_camera_frame(&appState_->cameraStreamingStates.second);
+    // Likewise the settings panel: rendered at most once (by the first view), sampled by both.
+    begin_settings_gui_frame();
+
+    const bool quadLayerMode = appState_->presentationMode == PresentationMode::QuadLayer;
+    const bool projection = !quadLayerMode || renderGui_ || appState_->guiPanel.rayActive;
+    if (quadLayerMode) {
+        UpdateCameraSurface(0, appState_->cameraStreamingStates.first, firstLatched);
+        UpdateCameraSurface(1, appState_->cameraStreamingStates.second, secondLatched);
+    } else {
+        // Frames latched meanwhile are not copied: refill on the way back.
+        cameraSurfaceValid_ = {false, false};
+    }
+
+    if (appState_->presentationMode != loggedPresentationMode_ && viewCount > 0) {
+        // Angular density of the video on its quad (eye 2 m behind it) against the eye buffer's.
+        loggedPresentationMode_ = appState_->presentationMode;
+        const float quadDeg = 2.0f * std::atan(quad.Scale.x / 4.0f) * 180.0f / static_cast<float>(M_PI);
+        const float fovDeg = (views[0].fov.angleRight - views[0].fov.angleLeft) * 180.0f / static_cast<float>(M_PI);
+        LOG_INFO("Presentation: %s, video %.1f px/deg, eye buffer %.1f px/deg (%s)",
+                 PresentationModeToString(loggedPresentationMode_).c_str(),
+                 appState_->streamingConfig.resolution.getWidth() / quadDeg,
+                 viewsurfaces_[0].width / fovDeg,
+                 quadLayerMode ? "sampled once by the compositor"
+                               : "resampled into the eye buffer, then by the compositor");
+    }
+
     for (uint32_t i = 0; i < viewCount; i++) {
-        XrSwapchainSubImage subImg;
-        render_target_t rtarget;
+        XrSwapchainSubImage subImg{};
+        render_target_t rtarget{};
 
-        openxr_acquire_viewsurface(viewsurfaces_[i], rtarget, subImg);
+        if (projection) {
+            openxr_acquire_viewsurface(viewsurfaces_[i], rtarget, subImg);
+        }
 
         layerViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
         layerViews[i].pose = views[i].pose;
@@ -214,21 +367,40 @@ bool TelepresenceProgram::RenderLayer(XrTime displayTime,
         HandleControllers();
 
         const auto vm = appState_->streamingConfig.videoMode;
-        if (vm == VideoMode::Mono || vm == VideoMode::Panoramic) {
+        if (vm == VideoMode::Mono || vm == VideoMode::Panoramic || vm == VideoMode::Foveated) {
             imageHandle = &appState_->cameraStreamingStates.first;
         }
+        // Foveated: the right-port stream is the inset, composited over the base.
+        CameraFrame *insetHandle = (vm == VideoMode::Foveated) ? &appState_->cameraStreamingStates.second
+                                                               : nullptr;
 
         // Stereo convergence (horizontal image translation): shift the two eyes'
         // image planes horizontally in opposite directions to set convergence/comfort.
-        // Headset-only; only meaningful in stereo (mono/panoramic show one image to
-        // both eyes). 0 = no shift = unchanged behaviour.
+        // Headset-only; only meaningful in stereo (mono/panoramic/foveated show one
+        // image to both eyes). 0 = no shift = unchanged behaviour.
         quad.Pose.position.x = (vm == VideoMode::Stereo)
             ? (i == 0 ? +0.5f : -0.5f) * appState_->stereoConvergence
             : 0.0f;
+        quad.Pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+        quad.Pose.position.y = 0.0f;
+        quad.Pose.position.z = 0.0f;
+
+        // Camera-pose reprojection: the frame shows where the camera pointed at
+        // exposure, not where the head is now. The inset is drawn on the same
+        // quad, so it follows. Panoramic has no pan-tilt to compensate.
+        CameraPose shotPose{}, commandedPose{};
+        const FrameSlot *shown = imageHandle->frontSlot();
+        if (appState_->cameraPoseReprojection && vm != VideoMode::Panoramic &&
+            shown && UnpackCameraPose(shown->cameraPose, &shotPose) &&
+            robotControlSender_ && robotControlSender_->lastCommandedPose(&commandedPose)) {
+            RotateQuadAboutEye(quad, shotPose.azimuth - commandedPose.azimuth,
+                               shotPose.elevation - commandedPose.elevation);
+        }
 
         // Measure presentation latency only on the first render after a NEW camera frame.
         // Without this guard, repeated renders of the same frame produce increasing
-        // values (the frame ages), and updateHistory() always captures the worst case.
+        // values (the frame ages). This completes the frame's latency record, which
+        // only then enters the averages, percentiles and the debug packet.
         //
         // "presentation" is defined as appsink -> predicted photon emission, i.e.
         // (wait-for-render-cycle)  +  (OpenXR's remaining-to-display prediction).
@@ -236,8 +408,9 @@ bool TelepresenceProgram::RenderLayer(XrTime displayTime,
         // derived from CLOCK_MONOTONIC because XrTime == CLOCK_MONOTONIC ns on
         // Android/Quest. Both are durations, so adding them is clock-safe.
         {
-            uint64_t frameReadyTime = imageHandle->stats->frameReadyTimestamp.load();
-            uint64_t lastMeasured = imageHandle->stats->lastMeasuredFrameReady.load();
+            const SinkStats sink = imageHandle->stats->sink.load();
+            uint64_t frameReadyTime = sink.frameReadyTimestamp;
+            uint64_t lastMeasured = imageHandle->stats->render.load().lastMeasuredFrameReady;
             if (frameReadyTime > 0 && frameReadyTime != lastMeasured) {
                 uint64_t renderTime = ntpTimer_->GetCurrentTimeUs();
                 uint64_t waitForRenderUs = renderTime - frameReadyTime;
@@ -252,24 +425,54 @@ bool TelepresenceProgram::RenderLayer(XrTime displayTime,
                     (predictedDisplayNs - monotonicNowNs) / 1000;
                 if (predictedRemainingUs < 0) predictedRemainingUs = 0;
 
-                imageHandle->stats->presentation.store(
-                    waitForRenderUs + static_cast<uint64_t>(predictedRemainingUs));
-                imageHandle->stats->lastMeasuredFrameReady.store(frameReadyTime);
+                imageHandle->stats->render.update([&](RenderStats &rd) {
+                    rd.lastMeasuredFrameReady = frameReadyTime;
+                });
+                // Window = configured stream FPS, so the rolling average covers ~1 s.
+                if (sink.hasFrameId) {
+                    const int fps = appState_->streamingConfig.fps;
+                    imageHandle->stats->presentFrame(sink.frameId,
+                                                     waitForRenderUs + static_cast<uint64_t>(predictedRemainingUs),
+                                                     static_cast<size_t>(fps > 0 ? fps : 60));
+                }
             }
         }
 
-        render_scene(layerViews[i], rtarget, quad, appState_, imageHandle, renderGui_, settings_);
+        if (!quadLayerMode) {
+            render_scene(layerViews[i], rtarget, quad, appState_, imageHandle, renderGui_, settings_, insetHandle);
+        } else {
+            const size_t stream = imageHandle == &appState_->cameraStreamingStates.first ? 0 : 1;
+            const XrEyeVisibility eye = i == 0 ? XR_EYE_VISIBILITY_LEFT : XR_EYE_VISIBILITY_RIGHT;
+            if (cameraSurfaceValid_[stream]) {
+                quadLayers.push_back(CameraQuadLayer(app_reference_space_, cameraSurfaces_[stream], eye,
+                                                     quad.Pose, {quad.Scale.x, quad.Scale.y}));
+            }
+            const FrameSlot *insetSlot = insetHandle ? insetHandle->frontSlot() : nullptr;
+            if (insetSlot && insetSlot->foveaRect != 0 && cameraSurfaceValid_[1]) {
+                XrPosef insetPose;
+                XrExtent2Df insetSize;
+                InsetQuadPose(quad, insetSlot->foveaRect, &insetPose, &insetSize);
+                quadLayers.push_back(CameraQuadLayer(app_reference_space_, cameraSurfaces_[1], eye,
+                                                     insetPose, insetSize));
+            }
+            if (projection) {
+                render_overlay(layerViews[i], rtarget, appState_, renderGui_, settings_);
+            }
+        }
 
-        openxr_release_viewsurface(viewsurfaces_[i]);
+        if (projection) {
+            openxr_release_viewsurface(viewsurfaces_[i]);
+        }
     }
 
     layer = {XR_TYPE_COMPOSITION_LAYER_PROJECTION};
     layer.space = app_reference_space_;
-    layer.layerFlags = 0;
+    // Over the camera quad layers, the overlay is blended by its (premultiplied) alpha.
+    layer.layerFlags = quadLayerMode ? XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT : 0;
     layer.viewCount = layerViews.size();
     layer.views = layerViews.data();
 
-    return true;
+    return projection;
 }
 
 /**
@@ -617,11 +820,15 @@ void TelepresenceProgram::PollActions() {
 /**
  * Send head pose, robot control, and debug telemetry over UDP.
  *
- * Lazily initializes the RobotControlSender on first call. Tracks
+ * Lazily initializes the RobotControlSender on first call, together with
+ * the HeadPoseStreamer that sends head pose at its own rate. Tracks
  * connection health via consecutive send failures and updates the
  * AppState connection status accordingly.
  */
 void TelepresenceProgram::SendControllerDatagram() {
+    if (headPoseStreamer_) {
+        headPoseStreamer_->setActive(appState_->headsetMounted);
+    }
     if (!appState_->headsetMounted) {
         return;
     }
@@ -633,6 +840,9 @@ void TelepresenceProgram::SendControllerDatagram() {
             // UDP is connectionless - we can't know if destination is reachable until we try sending
             appState_->connectionState.robotControl = ConnectionStatus::Connecting;
             appState_->robotControlStatus = "Connecting";
+            headPoseStreamer_ = std::make_unique<HeadPoseStreamer>(reference_spaces_[1], app_reference_space_,
+                                                                   robotControlSender_.get());
+            headPoseStreamer_->setActive(true);
         } else {
             appState_->connectionState.robotControl = ConnectionStatus::Failed;
             appState_->robotControlStatus = "Socket Failed";
@@ -640,27 +850,23 @@ void TelepresenceProgram::SendControllerDatagram() {
     }
 
     if (robotControlSender_->isInitialized()) {
-        // Always send head pose
-        robotControlSender_->sendHeadPose(userState_.hmdPose.orientation, appState_->headMovementMaxSpeed, threadPool_);
+        // Head pose goes out from the streamer thread; hand it the current settings.
+        headPoseStreamer_->setParameters(appState_->headPoseRateHz, appState_->headMovementPredictionMs,
+                                         appState_->headMovementMaxSpeed);
 
         // Send robot control when enabled
         if (appState_->robotControlEnabled && !renderGui_) {
             robotControlSender_->sendRobotControl(userState_.thumbstickPose[Side::RIGHT].y,
                                               userState_.thumbstickPose[Side::RIGHT].x,
-                                              userState_.thumbstickPose[Side::LEFT].x,
-                                              threadPool_);
+                                              userState_.thumbstickPose[Side::LEFT].x);
         }
 
-        // Send debug/validation information. Left = the (only) stream in mono;
-        // right is captured too so stereo reports per-eye health (right stays
-        // zero-valued in mono since that pipeline/stats never updates).
+        // Per-frame telemetry: collected every frame, sent once per interval.
+        // Left = the (only) stream in mono; right's stats stay idle there.
         if (appState_->cameraStreamingStates.first.stats) {
-            auto leftSnap = appState_->cameraStreamingStates.first.stats->snapshot();
-            CameraStatsSnapshot rightSnap{};
-            if (appState_->cameraStreamingStates.second.stats) {
-                rightSnap = appState_->cameraStreamingStates.second.stats->snapshot();
-            }
-            robotControlSender_->sendDebugInfo(leftSnap, rightSnap, appState_->streamingConfig, threadPool_);
+            robotControlSender_->sendTelemetry(appState_->cameraStreamingStates.first.stats,
+                                               appState_->cameraStreamingStates.second.stats,
+                                               appState_->streamingConfig, appState_->telemetryIntervalMs);
         }
 
         // Update connection status based on health
@@ -680,33 +886,18 @@ void TelepresenceProgram::SendControllerDatagram() {
 
 /**
  * Start the camera stream via REST API, then configure GStreamer pipelines.
- * If the REST call fails, the pipelines are still configured (they will
- * wait for data) so the app can recover if the server comes online later.
+ * The pipelines are configured without waiting for the REST answer (they
+ * wait for data), so the app can recover if the server comes online later.
  */
 void TelepresenceProgram::InitializeStreaming() {
     restClient_ = std::make_unique<RestClient>(appState_->streamingConfig);
     appState_->connectionState.cameraServer = ConnectionStatus::Connecting;
     appState_->cameraServerStatus = "Connecting...";
 
-    // Stop any existing stream (OK to fail if not running)
+    // Stop any existing stream (OK to fail if not running), then start ours. Both go out on the
+    // REST worker; PollRestResults() reports the start once it is answered.
     restClient_->StopStream();
-
-    int startResult = restClient_->StartStream();
-    if (startResult != 0) {
-        appState_->connectionState.cameraServer = ConnectionStatus::Failed;
-        appState_->connectionState.lastError = "Camera server unreachable at " +
-            IpToString(appState_->streamingConfig.jetson_ip) + ":" +
-            std::to_string(Config::REST_API_PORT);
-        appState_->cameraServerStatus = "Failed";
-        LOG_ERROR("InitializeStreaming: Failed to start stream - camera server at %s:%d is unreachable. "
-                  "Verify the server is running and the IP address is correct in the GUI settings.",
-                  IpToString(appState_->streamingConfig.jetson_ip).c_str(), Config::REST_API_PORT);
-    } else {
-        appState_->connectionState.cameraServer = ConnectionStatus::Connected;
-        appState_->cameraServerStatus = "Connected";
-        LOG_INFO("InitializeStreaming: Successfully connected to camera server at %s:%d",
-                 IpToString(appState_->streamingConfig.jetson_ip).c_str(), Config::REST_API_PORT);
-    }
+    pendingStart_ = restClient_->StartStream();
 
     // Configure pipelines regardless - they will wait for data
     gstreamerPlayer_->configurePipelines(gstreamerThreadPool_, appState_->streamingConfig);
@@ -716,6 +907,49 @@ void TelepresenceProgram::InitializeStreaming() {
     lastAppliedConfig_ = appState_->streamingConfig;
 }
 
+/**
+ * Check the REST calls in flight without waiting on them, and move the camera
+ * server status to Connected or Failed as their answers come back.
+ */
+void TelepresenceProgram::PollRestResults() {
+    auto ready = [](const std::future<RestResult> &result) {
+        return result.valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+
+    if (ready(pendingStart_)) {
+        const RestResult result = pendingStart_.get();
+        if (!result.ok) {
+            appState_->connectionState.cameraServer = ConnectionStatus::Failed;
+            appState_->connectionState.lastError = "Camera server unreachable at " +
+                IpToString(appState_->streamingConfig.jetson_ip) + ":" +
+                std::to_string(Config::REST_API_PORT) + " (" + result.error + ")";
+            appState_->cameraServerStatus = "Failed (" + result.error + ")";
+            LOG_ERROR("InitializeStreaming: Failed to start stream - camera server at %s:%d is unreachable. "
+                      "Verify the server is running and the IP address is correct in the GUI settings.",
+                      IpToString(appState_->streamingConfig.jetson_ip).c_str(), Config::REST_API_PORT);
+        } else {
+            appState_->connectionState.cameraServer = ConnectionStatus::Connected;
+            appState_->cameraServerStatus = "Connected";
+            LOG_INFO("InitializeStreaming: Successfully connected to camera server at %s:%d",
+                     IpToString(appState_->streamingConfig.jetson_ip).c_str(), Config::REST_API_PORT);
+        }
+    }
+
+    if (ready(pendingApply_)) {
+        const RestResult result = pendingApply_.get();
+        if (!result.ok) {
+            appState_->connectionState.cameraServer = ConnectionStatus::Failed;
+            appState_->connectionState.lastError = "Update failed: " + result.error;
+            appState_->cameraServerStatus = "Update Failed (" + result.error + ")";
+            LOG_ERROR("Apply: failed to update streaming config - camera server not responding");
+        } else {
+            appState_->connectionState.cameraServer = ConnectionStatus::Connected;
+            appState_->cameraServerStatus = "Connected";
+            lastAppliedConfig_ = pendingApplyConfig_;  // remember only what the robot acknowledged
+        }
+    }
+}
+
 /**
  * Build the data-driven GUI settings table.
  *
@@ -804,6 +1038,15 @@ void TelepresenceProgram::BuildSettings() {
             [this]() { if (appState_->streamingConfig.fps < 80) appState_->streamingConfig.fps += 1; },
             [this]() { if (appState_->streamingConfig.fps > 1) appState_->streamingConfig.fps -= 1; }
         },
+        {
+            "Max frame age", GuiSettingType::Text, "",
+            [this]() {
+                const int ms = appState_->streamingConfig.maxFrameAgeMs;
+                return ms > 0 ? fmt::format("Max frame age: {} ms", ms) : std::string("Max frame age: off");
+            },
+            [this]() { appState_->streamingConfig.maxFrameAgeMs = std::min(appState_->streamingConfig.maxFrameAgeMs + 5, 500); },
+            [this]() { appState_->streamingConfig.maxFrameAgeMs = std::max(appState_->streamingConfig.maxFrameAgeMs - 5, 0); }
+        },
         {
             "Resolution", GuiSettingType::Text, "",
             [this]() {
@@ -842,12 +1085,12 @@ void TelepresenceProgram::BuildSettings() {
 
                 switch (change) {
                     case StreamConfigChange::Structural:
-                        LOG_INFO("Apply: structural change -> rebuilding decode pipeline + GL render targets");
+                        LOG_INFO("Apply: structural change -> reconfiguring decode pipelines + GL render targets");
                         init_scene(cfg.resolution.getWidth(), cfg.resolution.getHeight(), true);
                         gstreamerPlayer_->configurePipelines(gstreamerThreadPool_, cfg);
                         break;
                     case StreamConfigChange::LiveOnly:
-                        LOG_INFO("Apply: live-only change (bitrate/quality) -> no rebuild, keeping pipeline");
+                        LOG_INFO("Apply: live-only change (bitrate/quality/max frame age) -> no rebuild, keeping pipeline");
                         break;
                     case StreamConfigChange::None:
                         LOG_INFO("Apply: no streaming-config change -> nothing to rebuild");
@@ -858,16 +1101,11 @@ void TelepresenceProgram::BuildSettings() {
                 // it updates the encoder in place; for a structural change it
                 // rebuilds its pipeline and emits a fresh keyframe so the
                 // freshly-rebuilt headset decoder re-syncs cleanly.
-                int updateResult = restClient_->UpdateStreamingConfig(cfg);
-                if (updateResult != 0) {
-                    appState_->connectionState.cameraServer = ConnectionStatus::Failed;
-                    appState_->cameraServerStatus = "Update Failed";
-                    LOG_ERROR("Apply: failed to update streaming config - camera server not responding");
-                } else {
-                    appState_->connectionState.cameraServer = ConnectionStatus::Connected;
-                    appState_->cameraServerStatus = "Connected";
-                    lastAppliedConfig_ = cfg;  // remember only what the robot acknowledged
-                }
+                // The answer comes back through PollRestResults(); the frame goes on meanwhile.
+                pendingApply_ = restClient_->UpdateStreamingConfig(cfg);
+                pendingApplyConfig_ = cfg;
+                appState_->connectionState.cameraServer = ConnectionStatus::Connecting;
+                appState_->cameraServerStatus = "Applying...";
             }
         },
 
@@ -886,16 +1124,46 @@ void TelepresenceProgram::BuildSettings() {
         },
         {
             "Headset movement prediction", GuiSettingType::Text, "",
-            [this]() { return fmt::format("Headset movement prediction: {} ms", appState_->headMovementPredictionMs); },
+            [this]() { return fmt::format("Headset movement prediction: {} ms past display", appState_->headMovementPredictionMs); },
             [this]() { if (appState_->headMovementPredictionMs < 100) appState_->headMovementPredictionMs += 1; },
             [this]() { if (appState_->headMovementPredictionMs > 0) appState_->headMovementPredictionMs -= 1; }
         },
+        {
+            "Head pose rate", GuiSettingType::Text, "",
+            [this]() { return fmt::format("Head pose rate: {} Hz", appState_->headPoseRateHz); },
+            [this]() { if (appState_->headPoseRateHz < HeadPoseStreamer::MAX_RATE_HZ) appState_->headPoseRateHz += 50; },
+            [this]() { if (appState_->headPoseRateHz > HeadPoseStreamer::MIN_RATE_HZ) appState_->headPoseRateHz -= 50; }
+        },
+        {
+            "Telemetry interval", GuiSettingType::Text, "",
+            [this]() { return fmt::format("Telemetry interval: {} ms", appState_->telemetryIntervalMs); },
+            [this]() { if (appState_->telemetryIntervalMs < RobotControlSender::MAX_TELEMETRY_INTERVAL_MS) appState_->telemetryIntervalMs += 50; },
+            [this]() { if (appState_->telemetryIntervalMs > RobotControlSender::MIN_TELEMETRY_INTERVAL_MS) appState_->telemetryIntervalMs -= 50; }
+        },
         {
             "Stereo convergence", GuiSettingType::Text, "Rendering",
             [this]() { return fmt::format("Stereo convergence (HIT): {:.3f}", appState_->stereoConvergence); },
             [this]() { if (appState_->stereoConvergence <  0.5f) appState_->stereoConvergence += 0.01f; },
             [this]() { if (appState_->stereoConvergence > -0.5f) appState_->stereoConvergence -= 0.01f; }
         },
+        {
+            "Camera pose reprojection", GuiSettingType::Text, "",
+            [this]() { return fmt::format("Camera pose reprojection: {}", appState_->cameraPoseReprojection ? "On" : "Off"); },
+            [this]() { appState_->cameraPoseReprojection = !appState_->cameraPoseReprojection; },
+            [this]() { appState_->cameraPoseReprojection = !appState_->cameraPoseReprojection; }
+        },
+        {
+            "Camera presentation", GuiSettingType::Text, "",
+            [this]() { return fmt::format("Camera presentation: {}", PresentationModeToString(appState_->presentationMode)); },
+            [this]() {
+                appState_->presentationMode = static_cast<PresentationMode>(
+                    (static_cast<int>(appState_->presentationMode) + 1) % static_cast<int>(PresentationMode::Count));
+            },
+            [this]() {
+                appState_->presentationMode = static_cast<PresentationMode>(
+                    (static_cast<int>(appState_->presentationMode) - 1 + static_cast<int>(PresentationMode::Count)) % static_cast<int>(PresentationMode::Count));
+            }
+        },
     };
 }
 
@@ -927,7 +1195,7 @@ void TelepresenceProgram::HandleControllers() {
         if (!appState_->robotControlEnabled) {
             // Send stop command (all zeros) when disabling robot control
             if (robotControlSender_ && robotControlSender_->isInitialized()) {
-                robotControlSender_->sendRobotControl(0.0f, 0.0f, 0.0f, threadPool_);
+                robotControlSender_->sendRobotControl(0.0f, 0.0f, 0.0f);
             }
         }
         controlLockMovement_ = true;
@@ -0,0 +1,630 @@
+/**
+ * receive_pipeline.cpp - Platform-neutral RTP receive pipeline and latency probes
+ *
+ * Pipeline descriptions for both backends, source/decoder-caps setup, and the
+ * identity-probe callbacks that compute per-stage receive latency into
+ * CameraStats. No Android, EGL or GL dependencies: shared by GstreamerPlayer
+ * (Quest) and tools/receive_bench (Linux).
+ */
+#include "receive_pipeline.h"
+#include "jpeg_decoder.h"
+#include "log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <gst/rtp/rtp.h>
+
+// ============================================================================
+// Pipeline descriptions
+// ----------------------------------------------------------------------------
+// Each pipeline: UDP source -> RTP jitter buffer -> depay -> decode -> output.
+// Named elements (name=...) are configured at runtime in configureSource().
+// Identity elements (name=*_ident) are latency measurement probe points.
+// The RTP head (udpsrc .. postjb_ident) is codec-neutral apart from its caps;
+// everything from the depayloader on is the decode tail, which GstreamerPlayer
+// hot-swaps as a bin on codec changes. The RTP payload type differs per codec
+// (see payloadType()) so packets of the previous codec can be told apart.
+// ============================================================================
+
+/** RTP front of every pipeline, up to the post-jitterbuffer probe; lives across decode-tail swaps. */
+static std::string rtpHead(Codec codec) {
+    const bool jpeg = codec == Codec::JPEG;
+    const std::string caps = "application/x-rtp, media=video, encoding-name=" + CodecToString(codec) +
+        ", clock-rate=90000, payload=" + std::to_string(ReceivePipeline::payloadType(codec));
+    return "udpsrc name=udpsrc"
+        " ! capsfilter name=rtp_capsfilter caps=\"" + caps + "\""
+        " ! identity name=udpsrc_ident"
+        " ! rtpjitterbuffer name=jitterbuffer latency=" + (jpeg ? "15" : "25") +
+            " do-lost=true drop-on-latency=true do-retransmission=" + (jpeg ? "false" : "true") +
+        " ! identity name=postjb_ident";
+}
+
+static const char *JPEG_TAIL =
+    "rtpjpegdepay ! identity name=rtpdepay_ident"
+    " ! jpegparse name=parse ! jpegdec ! videoconvert"   // passthrough for 4:2:0 JPEG
+    " ! video/x-raw,format=I420"
+    " ! identity name=dec_ident ! identity name=queue_ident"
+    " ! appsink emit-signals=true name=appsink sync=false";
+
+/** JPEG frames leave the pipeline undecoded; ReceivePipeline::decodeJpegSample() decodes them. */
+static const char *JPEG_PARALLEL_TAIL =
+    "rtpjpegdepay ! identity name=rtpdepay_ident"
+    " ! jpegparse name=parse ! image/jpeg"
+    " ! appsink emit-signals=true name=appsink sync=false";
+
+/** H264/H265 depay up to (and including) the decoder input capsfilter. */
+static std::string h26xDepay(Codec codec) {
+    const bool h265 = codec == Codec::H265;
+    return std::string(h265 ? "rtph265depay" : "rtph264depay") + " ! identity name=rtpdepay_ident"
+        " ! " + (h265 ? "h265parse" : "h264parse") + " name=parse config-interval=-1 ! queue"
+        " ! capsfilter name=dec_capsfilter";
+}
+
+static void requireReceiveCodec(Codec codec) {
+    if (codec != Codec::JPEG && codec != Codec::H264 && codec != Codec::H265) {
+        throw std::runtime_error("No receive pipeline for codec " + CodecToString(codec));
+    }
+}
+
+std::string ReceivePipeline::headDescription(Codec codec) {
+    requireReceiveCodec(codec);
+    return rtpHead(codec);
+}
+
+std::string ReceivePipeline::tailDescription(Codec codec, ReceiveBackend backend, bool parallelJpeg) {
+    requireReceiveCodec(codec);
+    if (codec == Codec::JPEG) {
+        return parallelJpeg ? JPEG_PARALLEL_TAIL : JPEG_TAIL;
+    }
+
+    std::string desc = h26xDepay(codec);
+    if (backend == ReceiveBackend::AndroidGl) {
+        desc += std::string(" ! ") + (codec == Codec::H265 ? BUT_H265_DECODER : BUT_H264_DECODER) + " name=dec"
+                " ! identity name=dec_ident ! queue max-size-buffers=1 leaky=downstream"
+                " ! identity name=queue_ident"
+                " ! glsinkbin name=glsink";
+    } else {
+        desc += std::string(" ! ") + (codec == Codec::H265 ? "avdec_h265" : "avdec_h264") + " name=dec"
+                " ! identity name=dec_ident ! queue max-size-buffers=1 leaky=downstream"
+                " ! identity name=queue_ident"
+                " ! videoconvert ! video/x-raw,format=I420"
+                " ! appsink emit-signals=true name=appsink sync=false max-buffers=1 drop=true";
+    }
+    return desc;
+}
+
+std::string ReceivePipeline::description(Codec codec, ReceiveBackend backend, bool parallelJpeg) {
+    return headDescription(codec) + " ! " + tailDescription(codec, backend, parallelJpeg);
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+/** Get a named pipeline element; throws if not found. */
+GstElement *
+ReceivePipeline::getElementRequired(GstElement *pipeline, const char *name, const char *context) {
+    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!element) {
+        LOG_ERROR("Failed to get %s element from %s pipeline", name, context);
+        throw std::runtime_error(std::string("Failed to get ") + name + " element from " + context +
+                                 " pipeline");
+    }
+    return element;
+}
+
+/** Get a named pipeline element; returns nullptr if not found. */
+GstElement *ReceivePipeline::getElementOptional(GstElement *pipeline, const char *name) {
+    return gst_bin_get_by_name(GST_BIN(pipeline), name);
+}
+
+/** Connect a signal callback to an element, then unref it (if non-null). */
+void ReceivePipeline::connectAndUnref(GstElement *element, const char *signal, GCallback callback,
+                                      gpointer data) {
+    if (element) {
+        g_signal_connect(G_OBJECT(element), signal, callback, data);
+        gst_object_unref(element);
+    }
+}
+
+/**
+ * Configure a stream's source side: UDP port (+ debug arrival probe), RTP caps
+ * with the expected x-dimensions, and for H264/H265 the decoder input caps.
+ */
+void ReceivePipeline::configureSource(GstElement *pipeline, const char *pipelineName, int port,
+                                      Codec codec, int width, int height, int fps) {
+    GstElement *udpsrc = getElementRequired(pipeline, "udpsrc", pipelineName);
+    GstPad *pad = gst_element_get_static_pad(udpsrc, "src");
+    if (pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, udpPacketProbeCallback, nullptr, nullptr);
+        gst_object_unref(pad);
+    }
+    g_object_set(udpsrc, "port", port, NULL);
+    gst_object_unref(udpsrc);
+
+    configureCodec(pipeline, pipelineName, codec, width, height, fps);
+}
+
+int ReceivePipeline::payloadType(Codec codec) {
+    switch (codec) {
+        case Codec::JPEG: return 26;  // static RFC 3551 type
+        case Codec::H265: return 97;
+        default:          return 96;
+    }
+}
+
+GstCaps *ReceivePipeline::buildRtpCaps(Codec codec, int width, int height) {
+    const std::string xDimString = std::to_string(width) + "," + std::to_string(height);
+    return gst_caps_new_simple("application/x-rtp",
+                               "media", G_TYPE_STRING, "video",
+                               "encoding-name", G_TYPE_STRING, CodecToString(codec).c_str(),
+                               "clock-rate", G_TYPE_INT, 90000,
+                               "payload", G_TYPE_INT, payloadType(codec),
+                               "x-dimensions", G_TYPE_STRING, xDimString.c_str(),
+                               NULL);
+}
+
+/**
+ * Codec-dependent settings of the RTP head (caps, retransmission) and, for
+ * H264/H265, the decoder input caps. Safe to re-run on a live pipeline: the
+ * capsfilters renegotiate on the next buffer.
+ */
+void ReceivePipeline::configureCodec(GstElement *pipeline, const char *pipelineName, Codec codec,
+                                     int width, int height, int fps) {
+    configureRtpCaps(pipeline, pipelineName, codec, width, height);
+    configureDecoderCaps(pipeline, codec, width, height, fps);
+}
+
+void ReceivePipeline::configureRtpCaps(GstElement *pipeline, const char *pipelineName, Codec codec,
+                                       int width, int height) {
+    GstElement *rtp_capsfilter = getElementRequired(pipeline, "rtp_capsfilter", pipelineName);
+    GstCaps *new_caps = buildRtpCaps(codec, width, height);
+    g_object_set(rtp_capsfilter, "caps", new_caps, NULL);
+    gst_caps_unref(new_caps);
+    gst_object_unref(rtp_capsfilter);
+
+    if (GstElement *jb = getElementOptional(pipeline, "jitterbuffer")) {
+        g_object_set(jb, "do-retransmission", codec != Codec::JPEG, NULL);
+        gst_object_unref(jb);
+    }
+}
+
+void ReceivePipeline::configureDecoderCaps(GstElement *pipeline, Codec codec, int width, int height, int fps) {
+    if (codec == Codec::JPEG) return;
+    GstElement *dec_capsfilter = getElementOptional(pipeline, "dec_capsfilter");
+    if (dec_capsfilter) {
+        GstCaps *decCaps = buildDecoderSrcCaps(codec, width, height, fps);
+        g_object_set(dec_capsfilter, "caps", decCaps, NULL);
+        gst_caps_unref(decCaps);
+        gst_object_unref(dec_capsfilter);
+    }
+}
+
+void ReceivePipeline::connectPayloadGate(GstElement *pipeline, ReceiveCallbackObj *callbackObj) {
+    GstElement *udpsrc = getElementOptional(pipeline, "udpsrc");
+    if (!udpsrc) return;
+    if (GstPad *pad = gst_element_get_static_pad(udpsrc, "src")) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, rtpPayloadGateProbe, callbackObj, nullptr);
+        gst_object_unref(pad);
+    }
+    gst_object_unref(udpsrc);
+}
+
+static void freeProbeContext(gpointer data, GClosure * /*closure*/) {
+    delete static_cast<ProbeContext *>(data);
+}
+
+/** Connect a handoff with its own ProbeContext (freed with the connection), then unref the identity. */
+static void connectProbe(GstElement *identity, GCallback callback, ReceiveCallbackObj *callbackObj,
+                         CameraStats *stats, ProbeStage stage, const char *eye) {
+    if (!identity) return;
+    auto *ctx = new ProbeContext{callbackObj, stats, stage, eye};
+    g_signal_connect_data(G_OBJECT(identity), "handoff", callback, ctx, freeProbeContext, (GConnectFlags) 0);
+    gst_object_unref(identity);
+}
+
+void ReceivePipeline::connectProbes(GstElement *bin, ReceiveCallbackObj *callbackObj, CameraStats *stats,
+                                    const char *eye) {
+    // The udpsrc context's stage is unused (onRtpHeaderMetadata has a single role).
+    connectProbe(getElementOptional(bin, "udpsrc_ident"), (GCallback) onRtpHeaderMetadata,
+                 callbackObj, stats, ProbeStage::PostJitterBuffer, eye);
+
+    static const std::pair<const char *, ProbeStage> stages[] = {
+        {"postjb_ident",   ProbeStage::PostJitterBuffer},
+        {"rtpdepay_ident", ProbeStage::RtpDepay},
+        {"dec_ident",      ProbeStage::Decoder},
+        {"queue_ident",    ProbeStage::Queue},
+    };
+    for (const auto &[name, stage] : stages) {
+        connectProbe(getElementOptional(bin, name), (GCallback) onIdentityHandoff,
+                     callbackObj, stats, stage, eye);
+    }
+}
+
+/** Timer context for sampleJitterBuffer(); holds a ref on the jitterbuffer. */
+struct JitterBufferSampler {
+    GstElement *jb;
+    ReceiveCallbackObj *obj;
+    CameraStats *stats;
+};
+
+static void freeJitterBufferSampler(gpointer data) {
+    auto *sampler = static_cast<JitterBufferSampler *>(data);
+    gst_object_unref(sampler->jb);
+    delete sampler;
+}
+
+GSource *ReceivePipeline::attachJitterBufferSampler(GstElement *pipeline, ReceiveCallbackObj *callbackObj,
+                                                    CameraStats *stats, GMainContext *context) {
+    GstElement *jb = getElementOptional(pipeline, "jitterbuffer");
+    if (!jb) return nullptr;
+
+    auto *sampler = new JitterBufferSampler{jb, callbackObj, stats};
+    GSource *source = g_timeout_source_new(JB_STATS_INTERVAL_MS);
+    g_source_set_callback(source, sampleJitterBuffer, sampler, freeJitterBufferSampler);
+    g_source_attach(source, context);
+    return source;
+}
+
+// ============================================================================
+// Probes
+// ============================================================================
+
+bool ReceivePipeline::isLeftSink(GstElement *sink) {
+    GstObject *parent = GST_OBJECT(sink);
+    while (GST_OBJECT_PARENT(parent) != nullptr) {
+        parent = GST_OBJECT_PARENT(parent);
+    }
+    return std::strcmp(GST_OBJECT_NAME(parent), "pipeline_left") == 0;
+}
+
+CameraFrame &ReceivePipeline::onSample(GstElement *sink, GstBuffer *buffer, ReceiveCallbackObj *callbackObj,
+                                       uint64_t *foveaRect, uint64_t *cameraPose) {
+    CamPair *pair = callbackObj->first;
+    CameraFrame &frame = isLeftSink(sink) ? pair->first : pair->second;
+
+    // Update frame timestamps.
+    double currentTime = callbackObj->second->GetCurrentTimeUs();
+
+    // appsink stage = time between the last GStreamer probe (queue_ident) and
+    // this new-sample callback firing, on THIS frame's record (found by PTS),
+    // so async stages (glsinkbin GL upload on H.264/H.265 path) are honest.
+    // The render thread finds the record by the frame id left in the sink block.
+    GstClockTime appsinkPts = buffer ? GST_BUFFER_PTS(buffer) : GST_CLOCK_TIME_NONE;
+    uint64_t frameId = 0;
+    const bool hasFrameId = appsinkPts != GST_CLOCK_TIME_NONE &&
+        frame.stats->frames.deliver(static_cast<uint64_t>(appsinkPts), static_cast<uint64_t>(currentTime), &frameId);
+    frame.stats->sink.update([&](SinkStats &sk) {
+        sk.prevTimestamp = sk.currTimestamp;
+        sk.currTimestamp = currentTime;
+        sk.frameReadyTimestamp = static_cast<uint64_t>(currentTime);
+        sk.frameId = frameId;
+        sk.hasFrameId = hasFrameId;
+    });
+    // Apply -> first frame from the reconfigured pipeline (tail swap or rebuild).
+    const uint64_t reconfigureStart = callbackObj->reconfigureStartUs.exchange(0);
+    if (reconfigureStart != 0 && static_cast<uint64_t>(currentTime) >= reconfigureStart) {
+        LOG_INFO("GStreamer: first frame %.1f ms after reconfigure",
+                 static_cast<double>(static_cast<uint64_t>(currentTime) - reconfigureStart) / 1000.0);
+    }
+
+    // Foveated inset: published together with the pixels by the caller (0 = not an inset).
+    *foveaRect = (appsinkPts != GST_CLOCK_TIME_NONE)
+        ? frame.stats->foveaRectPtsMap.consume(static_cast<uint64_t>(appsinkPts)) : 0;
+    *cameraPose = (appsinkPts != GST_CLOCK_TIME_NONE)
+        ? frame.stats->cameraPosePtsMap.consume(static_cast<uint64_t>(appsinkPts)) : 0;
+
+    return frame;
+}
+
+uint8_t *ReceivePipeline::decodeJpegSample(GstElement *sink, GstBuffer *buffer, ReceiveCallbackObj *callbackObj,
+                                           JpegDecoder **decoder) {
+    const bool isLeft = isLeftSink(sink);
+    CameraFrame &frame = isLeft ? callbackObj->first->first : callbackObj->first->second;
+    *decoder = callbackObj->jpegDecoders[isLeft ? 0 : 1];
+    if (!*decoder || !buffer) return nullptr;
+
+    GstMapInfo map{};
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return nullptr;
+    uint8_t *planes = (*decoder)->decode(map.data, map.size, frame.frameWidth, frame.frameHeight);
+    gst_buffer_unmap(buffer, &map);
+
+    // Same stage split as dec_ident + queue_ident on a jpegdec pipeline: the
+    // decoder stage runs from depay emit to here, there is no queue.
+    const char *eye = isLeft ? "left" : "right";
+    if (!planes) {
+        LOG_DEBUG("GStreamer: %s JPEG frame failed to decode", eye);
+        return nullptr;
+    }
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+    const uint64_t ptsKey = (pts != GST_CLOCK_TIME_NONE) ? static_cast<uint64_t>(pts) : 0;
+    const uint64_t now = callbackObj->second->GetCurrentTimeUs();
+    recordStage(ProbeContext{callbackObj, frame.stats, ProbeStage::Decoder, eye}, ptsKey, now);
+    recordStage(ProbeContext{callbackObj, frame.stats, ProbeStage::Queue, eye}, ptsKey, now);
+    return planes;
+}
+
+/**
+ * Identity handoff at the UDP source. Extracts server-side latency data
+ * from RTP header extensions (frame ID, camera/vidconv/enc/rtpPay timestamps)
+ * and records the UDP arrival timestamp for network latency calculation.
+ */
+void ReceivePipeline::onRtpHeaderMetadata(GstElement *identity, GstBuffer *buffer, gpointer data) {
+    auto *ctx = static_cast<ProbeContext *>(data);
+    auto *ntpTimer = ctx->obj->second;
+    auto *stats = ctx->stats;
+
+    // Extension id 1, elements 0..5: frame id, camera, vidconv, enc, rtpPay, rtpPay timestamp.
+    uint64_t ext[6]{};
+    bool hasExt[6]{};
+    GstRTPBuffer rtp_buf = GST_RTP_BUFFER_INIT;
+    gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp_buf);
+    gpointer myInfoBuf = nullptr;
+    guint size_64 = 8;
+
+    for (guint i = 0; i < 6; i++) {
+        if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, i, &myInfoBuf, &size_64) != 0) {
+            ext[i] = *(static_cast<uint64_t *>(myInfoBuf));
+            hasExt[i] = true;
+        }
+    }
+    uint32_t rtpTs = gst_rtp_buffer_get_timestamp(&rtp_buf);
+    // Foveated inset stream: crop rect of this frame in the base frame.
+    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 1, 6, &myInfoBuf, &size_64) != 0) {
+        stats->foveaRectRtpTsMap.store(static_cast<uint64_t>(rtpTs), *(static_cast<uint64_t *>(myInfoBuf)));
+    }
+    // Camera pose at exposure (extension id 2), see PackCameraPose().
+    if (gst_rtp_buffer_get_extension_onebyte_header(&rtp_buf, 2, 0, &myInfoBuf, &size_64) != 0) {
+        stats->cameraPoseRtpTsMap.store(static_cast<uint64_t>(rtpTs), *(static_cast<uint64_t *>(myInfoBuf)));
+    }
+    gst_rtp_buffer_unmap(&rtp_buf);
+
+    uint64_t now = ntpTimer->GetCurrentTimeUs();
+    gsize pktBytes = gst_buffer_get_size(buffer);
+
+    // Logging and the record table stay outside the write section, which readers spin on.
+    uint16_t prevFramePackets = 0;
+    stats->ingress.update([&](IngressStats &in) {
+        if (hasExt[0]) {
+            prevFramePackets = in.packetsPerFrame;
+            in.packetsPerFrame = 0;
+        }
+        in.packetsPerFrame += 1;
+
+        // Per-stream network health from RTP packet arrivals (this eye's stats).
+        // Actual received bitrate: bytes over a ~1 s window -> bits/sec.
+        if (in.bitrateWinStartUs == 0) {
+            in.bitrateWinStartUs = now;
+            in.bitrateWinBytes = pktBytes;
+        } else {
+            in.bitrateWinBytes += pktBytes;
+            uint64_t elapsed = now - in.bitrateWinStartUs;
+            if (elapsed >= 1000000ULL) {
+                uint64_t bps = in.bitrateWinBytes * 8ULL * 1000000ULL / elapsed;
+                if (bps > 0xFFFFFFFFULL) bps = 0xFFFFFFFFULL;
+                in.actualBitrateBps = static_cast<uint32_t>(bps);
+                in.bitrateWinStartUs = now;
+                in.bitrateWinBytes = 0;
+            }
+        }
+        // RFC 3550 interarrival jitter (RTP clock-rate 90000): D = arrival-delta minus
+        // rtp-timestamp-delta; J += (|D| - J)/16. Published in microseconds.
+        if (in.jitterPrevArrivalUs != 0) {
+            int64_t dArrUs = static_cast<int64_t>(now - in.jitterPrevArrivalUs);
+            int32_t dTicks = static_cast<int32_t>(rtpTs - in.jitterPrevRtpTs);
+            int64_t dRtpUs = static_cast<int64_t>(dTicks) * 1000000LL / 90000LL;
+            double D = static_cast<double>(dArrUs - dRtpUs);
+            if (D < 0) D = -D;
+            in.jitterAccum += (D - in.jitterAccum) / 16.0;
+            in.jitterUs = static_cast<uint32_t>(in.jitterAccum < 0.0 ? 0.0 : in.jitterAccum);
+        }
+        in.jitterPrevArrivalUs = now;
+        in.jitterPrevRtpTs = rtpTs;
+    });
+
+    // The robot tags the first packet of each frame with its frame id and
+    // server-side stages: open the frame's latency record there. It is found
+    // by the RTP timestamp until the jitterbuffer — the canonical per-frame
+    // identifier in RTP, identical across every packet of one frame, and
+    // invariant across the jitterbuffer (which rewrites GstBuffer PTS).
+    if (hasExt[0]) {
+        LOG_DEBUG("GStreamer: New frameid %lu from %s, packets in prev frame: %u",
+                  (unsigned long) ext[0], ctx->eye, prevFramePackets);
+        FrameLatencyRecord record;
+        record.frameId = ext[0];
+        record.rtpTs = rtpTs;
+        record.setStage(LatencyStage::Camera, ext[1]);
+        record.setStage(LatencyStage::VidConv, ext[2]);
+        record.setStage(LatencyStage::Enc, ext[3]);
+        record.setStage(LatencyStage::RtpPay, ext[4]);
+        record.rtpPayTimestamp = ext[5];
+        record.setStage(LatencyStage::UdpStream, now > ext[5] ? now - ext[5] : 0);
+        record.arrivalUs = now;
+        record.lastStageUs = now;
+        stats->frames.open(record);
+    }
+}
+
+/**
+ * Identity handoff at downstream probe points (postjb, rtpdepay, decoder,
+ * queue). Records timestamps and computes per-stage latency deltas; the
+ * stages after the jitterbuffer go through recordStage().
+ */
+void ReceivePipeline::onIdentityHandoff(GstElement *identity, GstBuffer *buffer, gpointer data) {
+    auto *ctx = static_cast<ProbeContext *>(data);
+    auto *stats = ctx->stats;
+
+    uint64_t now = ctx->obj->second->GetCurrentTimeUs();
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    uint64_t ptsKey = (pts != GST_CLOCK_TIME_NONE) ? static_cast<uint64_t>(pts) : 0;
+
+    if (ctx->stage != ProbeStage::PostJitterBuffer) {
+        recordStage(*ctx, ptsKey, now);
+        return;
+    }
+
+    // Per-frame: jbHold = (post-jitterbuffer release time) - (first-packet arrival time),
+    // taken at the frame's last packet. The release also binds the record to the
+    // GstBuffer PTS that keys the rest of the pipeline. The buffer here is still an RTP packet (post-jitterbuffer, pre-depay), so we read
+    // its RTP timestamp directly. This is the canonical key across the jitterbuffer,
+    // where GstBuffer PTS is rewritten by the buffer itself and therefore unusable.
+    GstRTPBuffer rtp_buf = GST_RTP_BUFFER_INIT;
+    if (gst_rtp_buffer_map(buffer, GST_MAP_READ, &rtp_buf)) {
+        uint32_t rtpTs = gst_rtp_buffer_get_timestamp(&rtp_buf);
+        gst_rtp_buffer_unmap(&rtp_buf);
+        stats->frames.releaseFromJitterBuffer(rtpTs, ptsKey, now);
+        uint64_t foveaRect = stats->foveaRectRtpTsMap.consume(static_cast<uint64_t>(rtpTs));
+        if (foveaRect != 0 && ptsKey != 0) {
+            stats->foveaRectPtsMap.store(ptsKey, foveaRect);
+        }
+        uint64_t cameraPose = stats->cameraPoseRtpTsMap.consume(static_cast<uint64_t>(rtpTs));
+        if (cameraPose != 0 && ptsKey != 0) {
+            stats->cameraPosePtsMap.store(ptsKey, cameraPose);
+        }
+    }
+    // Loss/rtx counters are sampled off the streaming thread, see sampleJitterBuffer().
+}
+
+void ReceivePipeline::recordStage(const ProbeContext &ctx, uint64_t ptsKey, uint64_t now) {
+    // Every probe downstream of the jitterbuffer sees a stable GstBuffer PTS, so
+    // each stage lands on THIS frame's record as (emit time) - (previous stage's
+    // emit time). Critical for HW decoder pipeline visibility — a global
+    // timestamp would subtract frame N+depth's depay time, masking ~100 ms of
+    // AVC pipeline depth as ~3 ms steady-state inter-frame interval.
+    if (ptsKey == 0) return;
+
+    LatencyStage stage;
+    switch (ctx.stage) {
+        case ProbeStage::RtpDepay: stage = LatencyStage::RtpDepay; break;
+        case ProbeStage::Decoder:  stage = LatencyStage::Dec; break;
+        case ProbeStage::Queue:    stage = LatencyStage::Queue; break;
+        default: return;
+    }
+    ctx.stats->frames.recordStage(ptsKey, stage, now);
+}
+
+// Adaptive jitterbuffer latency tuning
+static constexpr uint32_t JB_JITTER_MULTIPLIER = 4;      // latency >= 4x interarrival jitter
+static constexpr uint32_t JB_BASE_MS = 3;                // scheduling headroom on a clean link
+static constexpr uint32_t JB_LOSS_STEP_MS = 5;           // boost per tick that saw new losses
+static constexpr uint32_t JB_LOSS_DECAY_MS = 1;          // boost decay per clean tick
+static constexpr uint32_t JB_HYSTERESIS_MS = 2;          // ignore smaller downward moves
+
+void ReceivePipeline::retuneJitterBuffer(GstElement *jb, CameraStats *stats, const ReceiveCallbackObj *obj,
+                                         uint64_t now) {
+    // Only this timer writes the block, so it can be read and published separately.
+    const JitterBufferStats state = stats->jitterBuffer.load();
+
+    guint current = 0;
+    g_object_get(jb, "latency", &current, NULL);
+
+    // Packets still missing at their deadline are dropped (drop-on-latency) and
+    // counted as lost: while that count grows the buffer is too shallow, so
+    // step up quickly and give the margin back slowly once the link is clean.
+    uint32_t lost = state.numLost;
+    uint32_t boost = state.lossBoostMs;
+    if (state.tuneLastUs != 0 && lost > state.tuneLostPrev) {
+        boost += JB_LOSS_STEP_MS;
+    } else if (boost >= JB_LOSS_DECAY_MS) {
+        boost -= JB_LOSS_DECAY_MS;
+    }
+
+    const uint32_t minMs = static_cast<uint32_t>(obj->jbLatencyMinMs);
+    const uint32_t maxMs = static_cast<uint32_t>(std::max(obj->jbLatencyMinMs, obj->jbLatencyMaxMs));
+    boost = std::min(boost, maxMs - minMs);
+
+    const uint32_t jitterUs = stats->ingress.load().jitterUs;
+    uint32_t jitterMs = (jitterUs * JB_JITTER_MULTIPLIER + 999) / 1000;
+    uint32_t target = std::clamp(JB_BASE_MS + jitterMs + boost, minMs, maxMs);
+
+    // Raise immediately; lower only past the hysteresis band so the buffer
+    // does not hunt around a noisy jitter estimate.
+    if (target > current || current - target >= JB_HYSTERESIS_MS || current > maxMs) {
+        if (target != current) {
+            g_object_set(jb, "latency", target, NULL);
+            LOG_INFO("GStreamer: %s jitterbuffer latency %u -> %u ms (jitter %u us, lost %u, boost %u ms)",
+                     GST_OBJECT_NAME(GST_OBJECT_PARENT(jb)), current, target,
+                     jitterUs, lost, boost);
+        }
+        current = target;
+    }
+    stats->jitterBuffer.update([&](JitterBufferStats &jbs) {
+        jbs.tuneLastUs = now;
+        jbs.tuneLostPrev = lost;
+        jbs.lossBoostMs = boost;
+        jbs.latencyMs = current;
+    });
+}
+
+/**
+ * Jitterbuffer sampler tick (GLib main context). The "stats" property builds a
+ * fresh GstStructure on every read, so it is polled here at a low rate rather
+ * than from the per-packet postjb handoff.
+ */
+gboolean ReceivePipeline::sampleJitterBuffer(gpointer data) {
+    auto *sampler = static_cast<JitterBufferSampler *>(data);
+    CameraStats *stats = sampler->stats;
+
+    GstStructure *jbStats = nullptr;
+    g_object_get(sampler->jb, "stats", &jbStats, NULL);
+    if (jbStats) {
+        guint64 lost = 0, rtx = 0;
+        gst_structure_get_uint64(jbStats, "num-lost", &lost);
+        gst_structure_get_uint64(jbStats, "rtx-count", &rtx);
+        stats->jitterBuffer.update([&](JitterBufferStats &jbs) {
+            jbs.numLost = static_cast<uint32_t>(lost);
+            jbs.rtxCount = static_cast<uint32_t>(rtx);
+        });
+        gst_structure_free(jbStats);
+    }
+    retuneJitterBuffer(sampler->jb, stats, sampler->obj, sampler->obj->second->GetCurrentTimeUs());
+    return G_SOURCE_CONTINUE;
+}
+
+/** Pad probe on UDP source to log packet arrival intervals (debug only). */
+GstPadProbeReturn
+ReceivePipeline::udpPacketProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    static auto last_time = std::chrono::steady_clock::now();
+
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time).count();
+    last_time = now;
+
+    LOG_DEBUG("GStreamer: UDP packet arrived, interval: %lld ms", elapsed);
+
+    return GST_PAD_PROBE_OK;
+}
+
+/** Drop packets whose RTP payload type is not the configured codec's (the sender has not switched yet). */
+GstPadProbeReturn
+ReceivePipeline::rtpPayloadGateProbe(GstPad * /*pad*/, GstPadProbeInfo *info, gpointer user_data) {
+    const int expected = static_cast<ReceiveCallbackObj *>(user_data)->rtpPayloadType.load(std::memory_order_relaxed);
+    if (expected < 0) return GST_PAD_PROBE_OK;
+
+    uint8_t header[2];
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (gst_buffer_extract(buffer, 0, header, sizeof(header)) != sizeof(header)) return GST_PAD_PROBE_DROP;
+    return (header[1] & 0x7F) == expected ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+}
+
+/** Build GstCaps for the hardware decoder input (H264 or H265 byte-stream). */
+GstCaps *ReceivePipeline::buildDecoderSrcCaps(Codec codec, int width, int height, int fps) {
+    const char *media_type = codec == Codec::H265 ? "video/x-h265" : "video/x-h264";
+
+    GstCaps *caps = gst_caps_new_simple(
+            media_type,
+            "width", G_TYPE_INT, width,
+            "height", G_TYPE_INT, height,
+            "stream-format", G_TYPE_STRING, "byte-stream",
+            "alignment", G_TYPE_STRING, "au",
+            "parsed", G_TYPE_BOOLEAN, TRUE,
+            nullptr
+    );
+
+    if (codec == Codec::H265) {
+        gst_caps_set_simple(caps, "framerate", GST_TYPE_FRACTION, fps, 1, nullptr);
+    }
+
+    return caps;
+}
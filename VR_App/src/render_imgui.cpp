@@ -8,7 +8,8 @@
  * Renders the in-VR settings GUI using Dear ImGui. The focus-based
  * navigation system (no mouse) processes queued input events from
  * HandleControllers() to move focus and highlights the active element.
- * Also displays connection status indicators and pipeline latency stats.
+ * Also displays connection status indicators, the latest robot state from
+ * the ROS gateway and pipeline latency stats.
  */
 #include <cfloat>
 #include "imgui.h"
@@ -16,6 +17,7 @@
 #include "render_imgui.h"
 #include "openxr/openxr.h"
 #include "utils/string_utils.h"
+#include "ros_topic_store.h"
 
 #define DISPLAY_SCALE_X 1.0f
 #define DISPLAY_SCALE_Y 1.0f
@@ -65,6 +67,54 @@ imgui_mousemove(int x, int y) {
     s_mouse_pos.y = y;
 }
 
+/**
+ * One line per subscribed ROS topic: its fields' latest values, message rate
+ * and age. Copies each topic's block from the RosTopicStore, so the gateway
+ * listener never holds up the frame. A topic that has gone quiet for longer
+ * than a few of its periods is shown as stale.
+ */
+static void render_robot_state(const RosTopicStore &topics) {
+    const size_t count = topics.size();
+    if (count == 0) return;
+    ImGui::SeparatorText("Robot State");
+    const uint64_t nowUs = RosTopicStore::nowUs();
+    for (size_t i = 0; i < count; i++) {
+        const int index = static_cast<int>(i);
+        const RosTopicSnapshot latest = topics.load(index);
+        const std::string &topic = topics.topic(index);
+        const char *name = topic.c_str() + topic.rfind('/') + 1;
+        if (latest.messages == 0) {
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "%s: no data", name);
+            continue;
+        }
+
+        char values[160];
+        size_t length = 0;
+        values[0] = '\0';
+        const auto &fields = topics.fields(index);
+        for (size_t f = 0; f < fields.size() && length < sizeof(values); f++) {
+            const RosFieldValue &value = latest.fields[f];
+            const char *separator = f > 0 ? ", " : "";
+            if (!value.valid) {
+                length += snprintf(values + length, sizeof(values) - length, "%s-", separator);
+            } else if (fields[f].type == RosFieldType::String) {
+                length += snprintf(values + length, sizeof(values) - length, "%s%s", separator, value.text);
+            } else if (fields[f].type == RosFieldType::Bool) {
+                length += snprintf(values + length, sizeof(values) - length, "%s%s", separator,
+                                   value.number != 0.0 ? "true" : "false");
+            } else {
+                length += snprintf(values + length, sizeof(values) - length, "%s%.6g", separator, value.number);
+            }
+        }
+
+        const double ageMs = static_cast<double>(latest.ageUs(nowUs)) / 1000.0;
+        const double periodMs = latest.rateHz > 0.0f ? 1000.0 / latest.rateHz : 1000.0;
+        const bool stale = ageMs > std::max(1000.0, 3.0 * periodMs);
+        ImGui::TextColored(stale ? ImVec4(1.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f),
+                           "%s: %s (%.1f Hz, %.0f ms ago)", name, values, latest.rateHz, ageMs);
+    }
+}
+
 /**
  * Render the full settings panel: process focus navigation events,
  * iterate over all GuiSettings, draw connection status, and show
@@ -152,9 +202,9 @@ static void render_settings_gui(const std::shared_ptr<AppState> &appState,
 
         ImGui::SeparatorText("Connection Status");
         {
-            ImVec4 color = (appState->cameraServerStatus == "Connected")
+            ImVec4 color = (appState->connectionState.cameraServer == ConnectionStatus::Connected)
                 ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f)
-                : (appState->cameraServerStatus == "Connecting...")
+                : (appState->connectionState.cameraServer == ConnectionStatus::Connecting)
                     ? ImVec4(1.0f, 1.0f, 0.0f, 1.0f)
                     : ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
             ImGui::TextColored(color, "Camera Server: %s", appState->cameraServerStatus.c_str());
@@ -166,14 +216,18 @@ static void render_settings_gui(const std::shared_ptr<AppState> &appState,
             ImGui::TextColored(color, "Robot Control: %s", appState->robotControlStatus.c_str());
         }
         {
-            ImVec4 color = (appState->ntpSyncStatus == "Synced")
+            ImVec4 color = (appState->connectionState.ntpSync == ConnectionStatus::Connected)
                 ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f)
                 : ImVec4(1.0f, 1.0f, 0.0f, 1.0f);
             ImGui::TextColored(color, "NTP Time Sync: %s", appState->ntpSyncStatus.c_str());
         }
 
+        if (appState->rosTopics) {
+            render_robot_state(*appState->rosTopics);
+        }
+
         ImGui::Text("");
-        ImGui::Text("Latencies (avg last 50 frames):");
+        ImGui::Text("Latencies (ms, avg over the last second):");
         auto s = appState->cameraStreamingStates.first.stats;
         if (s) {
             auto snapshot = s->averagedSnapshot();
@@ -193,10 +247,20 @@ static void render_settings_gui(const std::shared_ptr<AppState> &appState,
                     "camera: %u vidConv: %u enc: %u\nrtpPay: %u udpStream: %u jbHold: %u\nrtpDepay: %u dec: %u queue: %u display: %u",
                     cameraMs, vidConvMs, encMs, rtpPayMs, udpStreamMs, jbHoldMs, rtpDepayMs,
                     decMs, queueMs, displayMs);
-            ImGui::Text("In Total: %u: \n", cameraMs + vidConvMs + encMs + rtpPayMs + udpStreamMs +
-                                             jbHoldMs + rtpDepayMs + decMs + queueMs + displayMs);
-            ImGui::Text("Camera FPS: %.1f | App: %.1f Hz",
-                        snapshot.fps, appState->appFrameRate);
+            ImGui::Text("In Total: %u: \n", static_cast<uint32_t>(snapshot.totalLatency / 1000));
+            LatencyPercentiles total = snapshot.stagePercentiles(LatencyStage::Total);
+            LatencyPercentiles dec = snapshot.stagePercentiles(LatencyStage::Dec);
+            ImGui::Text("Total p50: %u p95: %u p99: %u max: %u",
+                        total.p50 / 1000, total.p95 / 1000, total.p99 / 1000, total.max / 1000);
+            ImGui::Text("Dec p50: %u p95: %u p99: %u max: %u",
+                        dec.p50 / 1000, dec.p95 / 1000, dec.p99 / 1000, dec.max / 1000);
+            ImGui::Text("Camera FPS: %.1f | App: %.1f Hz, %.2f ms | draw: %u us",
+                        snapshot.fps, appState->appFrameRate, static_cast<double>(appState->appFrameTime) / 1000.0,
+                        snapshot.renderCpuUs);
+        }
+        if (appState->appGpuTime >= 0) {
+            ImGui::Text("GPU: %.2f ms (%s)", static_cast<double>(appState->appGpuTime) / 1000.0,
+                        PresentationModeToString(appState->presentationMode).c_str());
         }
 
         s_win_pos[s_win_num] = ImGui::GetWindowPos();
@@ -1,16 +1,18 @@
 /**
  * render_scene.cpp - Scene rendering implementation
  *
- * Sets up OpenGL ES shaders (2D texture, OES texture, solid color GUI),
+ * Sets up OpenGL ES shaders (2D texture, OES texture, planar YUV, solid color GUI),
  * geometry buffers, and the settings GUI render target. The main render
  * function computes the view-projection matrix and draws the camera image
- * plane followed by the ImGui overlay.
+ * plane followed by the ImGui overlay, whose texture is refreshed at most
+ * once per app frame.
  */
 #include "pch.h"
 #include <GLES3/gl3.h>
 #include "util_shader.h"
 #include "geometry.h"
 #include "linear.h"
+#include <chrono>
 #include <random>
 #include <GLES2/gl2ext.h>
 #include "render_imgui.h"
@@ -27,14 +29,87 @@ static const int SETTINGS_GUI_HEIGHT = GuiPanelState::PIXEL_HEIGHT;
 
 
 static GLuint cubeVertexBuffer{0}, cubeIndexBuffer{0}, vertexArrayObject{0},
-        vertexAttribCoords{0}, vertexAttribTexCoords{0}, texture2D{0};
+        vertexAttribCoords{0}, vertexAttribTexCoords{0};
 
 static shader_obj_t image_shader_object_2d;
 static shader_obj_t image_shader_object_oes;
+static shader_obj_t image_shader_object_yuv;
+static GLint yuvSamplerLocs[3]{-1, -1, -1};  // u_TextureY, u_TextureU, u_TextureV
+
+// ----------------------------------------------------------------------------
+// CPU (JPEG) frames: I420 planes in three GL_R8 textures per CameraFrame,
+// filled from a ring of pixel-unpack buffers so glTexSubImage2D is an async
+// DMA from driver-owned memory rather than a synchronous copy of client
+// memory. Each frame is uploaded once, when latch_camera_frame() takes it
+// from the CameraFrame's triple buffer, not once per eye draw. The sets are
+// keyed by the CameraFrame they mirror.
+// ----------------------------------------------------------------------------
+static constexpr int YUV_PBO_RING_SIZE = 3;
+
+struct YuvPlaneSet {
+    GLuint   tex[3]{};                  // Y, U, V
+    GLuint   pbo[YUV_PBO_RING_SIZE]{};
+    int      pboIndex{0};
+    int      width{0};
+    int      height{0};
+};
+
+static std::unordered_map<const CameraFrame *, YuvPlaneSet> yuvPlaneSets;
+
+// Render-thread CPU time spent on each CameraFrame since its last latch
+// (latch + every draw), folded into RenderStats::renderCpuUs on the next one.
+static std::unordered_map<const CameraFrame *, uint64_t> frameCpuNs;
 static shader_obj_t gui_shader_object;
 
 static render_target_t settings_gui_render_target;
 
+// ----------------------------------------------------------------------------
+// The settings panel is rasterised into settings_gui_render_target at most
+// once per app frame, by the first draw_imgui() after begin_settings_gui_frame();
+// every view then samples that texture. It is redrawn only when its inputs
+// (focus, controller ray, the settings and status texts) changed, for one
+// frame after that so ImGui's hover state catches up, and otherwise every
+// SETTINGS_GUI_REFRESH_US for the live stats.
+// ----------------------------------------------------------------------------
+static constexpr auto SETTINGS_GUI_REFRESH_US = std::chrono::microseconds(100'000);
+
+struct SettingsGuiInputs {
+    size_t textHash{0};
+    int focusedElement{-1};
+    int focusedSegment{-1};
+    int mouseX{-1};
+    int mouseY{-1};
+    bool rayHitting{false};
+    bool grabbing{false};
+    bool triggerDown{false};
+
+    bool operator==(const SettingsGuiInputs &o) const {
+        return textHash == o.textHash && focusedElement == o.focusedElement && focusedSegment == o.focusedSegment &&
+               mouseX == o.mouseX && mouseY == o.mouseY && rayHitting == o.rayHitting && grabbing == o.grabbing &&
+               triggerDown == o.triggerDown;
+    }
+};
+
+static bool settingsGuiPending = false;     // begin_settings_gui_frame() called, panel not yet considered
+static bool settingsGuiValid = false;       // the texture holds a rendered panel
+static int settingsGuiSettleFrames = 0;
+static SettingsGuiInputs settingsGuiInputs{};
+static std::chrono::steady_clock::time_point settingsGuiRenderedAt{};
+
+// ----------------------------------------------------------------------------
+// GPU time of the app frame: one GL_TIME_ELAPSED_EXT query around it, from a
+// small ring whose results are polled, oldest first, a few frames later. A
+// frame is not timed while every query is still in flight; a result spanning
+// a disjoint event (frequency change, preemption) is thrown away.
+// ----------------------------------------------------------------------------
+static constexpr int GPU_TIMER_RING_SIZE = 4;
+static GLuint gpuTimerQueries[GPU_TIMER_RING_SIZE]{};
+static int gpuTimerSupported = -1;  // -1 = not yet checked
+static int gpuTimerNext = 0;        // ring index of the next query to begin
+static int gpuTimerInFlight = 0;    // begun and not yet read back
+static bool gpuTimerActive = false;
+static long long gpuTimerLastUs = -1;
+
 static const char *ImageVertexShaderGlsl = R"_(#version 320 es
 
     in vec3 position;
@@ -86,6 +161,22 @@ static const char *ImageFragmentShaderGlsl = R"_(#version 320 es
     }
     )_";
 
+static const char *ImageFragmentShaderYUV = R"_(#version 320 es
+    in lowp vec2 v_TexCoord;
+    out lowp vec4 color;
+
+    uniform sampler2D u_TextureY;
+    uniform sampler2D u_TextureU;
+    uniform sampler2D u_TextureV;
+
+    const lowp float LATENCY_THRESHOLD = 0.7;
+
+    void main() {
+        lowp float Y = texture(u_TextureY, vec2(0.5, 0.5)).r;
+        color = (Y > LATENCY_THRESHOLD) ? vec4(1.0) : vec4(0.0, 0.0, 0.0, 1.0);
+    }
+    )_";
+
 static const char *ImageFragmentShaderOES = R"_(#version 320 es
     #extension GL_OES_EGL_image_external_essl3 : require
 
@@ -139,6 +230,32 @@ static const char *ImageFragmentShaderOES = R"_(#version 320 es
         color = vec4(rgb, c.a);
     }
     )_";
+
+static const char *ImageFragmentShaderYUV = R"_(#version 320 es
+    in lowp vec2 v_TexCoord;
+    out lowp vec4 color;
+
+    uniform sampler2D u_TextureY;
+    uniform sampler2D u_TextureU;
+    uniform sampler2D u_TextureV;
+
+    void main() {
+        // JFIF JPEG is full-range BT.601.
+        highp float y = texture(u_TextureY, v_TexCoord).r;
+        highp float u = texture(u_TextureU, v_TexCoord).r - 0.5;
+        highp float v = texture(u_TextureV, v_TexCoord).r - 0.5;
+        highp vec3 s = clamp(vec3(y + 1.402 * v,
+                                  y - 0.344136 * u - 0.714136 * v,
+                                  y + 1.772 * u), 0.0, 1.0);
+
+        // sRGB EOTF: the RGB path uploaded into GL_SRGB textures, which
+        // sampled as linear; keep the same output.
+        highp vec3 lin = mix(s / 12.92,
+                             pow((s + vec3(0.055)) / 1.055, vec3(2.4)),
+                             step(vec3(0.04045), s));
+        color = vec4(lin, 1.0);
+    }
+    )_";
 #endif
 
 static const char *GuiVertexShaderGlsl = R"_(#version 320 es
@@ -173,12 +290,18 @@ void init_scene(const int textureWidth, const int textureHeight, bool reinit) {
     generate_shader(&image_shader_object_2d, ImageVertexShaderGlsl, ImageFragmentShaderGlsl);
     // OES shader (HW decoder giving GL_TEXTURE_EXTERNAL_OES)
     generate_shader(&image_shader_object_oes, ImageVertexShaderGlsl, ImageFragmentShaderOES);
+    // Planar YUV shader (JPEG software decode, I420 planes)
+    generate_shader(&image_shader_object_yuv, ImageVertexShaderGlsl, ImageFragmentShaderYUV);
+    yuvSamplerLocs[0] = glGetUniformLocation(image_shader_object_yuv.program, "u_TextureY");
+    yuvSamplerLocs[1] = glGetUniformLocation(image_shader_object_yuv.program, "u_TextureU");
+    yuvSamplerLocs[2] = glGetUniformLocation(image_shader_object_yuv.program, "u_TextureV");
     generate_shader(&gui_shader_object, GuiVertexShaderGlsl, GuiFragmentShaderGlsl);
     init_image_plane(textureWidth, textureHeight);
     init_imgui();
     init_texplate();
 
     create_render_target(&settings_gui_render_target, SETTINGS_GUI_WIDTH, SETTINGS_GUI_HEIGHT);
+    settingsGuiValid = false;
 }
 
 void init_image_plane(const int textureWidth, const int textureHeight) {
@@ -205,26 +328,88 @@ void init_image_plane(const int textureWidth, const int textureHeight) {
     glVertexAttribPointer(vertexAttribCoords, 3, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex),nullptr);
     glVertexAttribPointer(vertexAttribTexCoords, 2, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), reinterpret_cast<const void *>(sizeof(XrVector3f)));
 
-    glGenTextures(1, &texture2D);
-    glBindTexture(GL_TEXTURE_2D, texture2D);
+    // CPU-upload targets (YuvPlaneSet) are sized lazily from the frames they
+    // mirror, so a resolution change needs nothing here.
+}
+
+/** (Re)allocate a plane set's textures and PBO ring for a width x height I420 frame. */
+static void allocate_yuv_planes(YuvPlaneSet &set, int width, int height) {
+    if (set.tex[0] != 0) {
+        glDeleteTextures(3, set.tex);
+        glDeleteBuffers(YUV_PBO_RING_SIZE, set.pbo);
+    }
+    const int cw = (width + 1) / 2, ch = (height + 1) / 2;
+    const int planeW[3] = {width, cw, cw};
+    const int planeH[3] = {height, ch, ch};
+
+    glGenTextures(3, set.tex);
+    for (int i = 0; i < 3; i++) {
+        glBindTexture(GL_TEXTURE_2D, set.tex[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, planeW[i], planeH[i]);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenBuffers(YUV_PBO_RING_SIZE, set.pbo);
+    for (GLuint pbo : set.pbo) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(I420FrameSize(width, height)),
+                     nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, textureWidth, textureHeight, 0, GL_SRGB,GL_UNSIGNED_BYTE, nullptr);
+    set.pboIndex = 0;
+    set.width = width;
+    set.height = height;
+}
+
+/**
+ * Copy a packed I420 frame into the next PBO of the ring and update the three
+ * plane textures from it. data must be a slot the render thread has latched.
+ */
+static bool upload_yuv_planes(YuvPlaneSet &set, const void *data, int width, int height) {
+    if (set.width != width || set.height != height || set.tex[0] == 0) {
+        allocate_yuv_planes(set, width, height);
+    }
+    const auto size = static_cast<GLsizeiptr>(I420FrameSize(width, height));
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, set.pbo[set.pboIndex]);
+    set.pboIndex = (set.pboIndex + 1) % YUV_PBO_RING_SIZE;
+    void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!dst) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        LOG_ERROR("render_scene: failed to map YUV upload buffer");
+        return false;
+    }
+    memcpy(dst, data, static_cast<size_t>(size));
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    const int cw = (width + 1) / 2, ch = (height + 1) / 2;
+    const int planeW[3] = {width, cw, cw};
+    const int planeH[3] = {height, ch, ch};
+    size_t offset = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < 3; i++) {
+        glBindTexture(GL_TEXTURE_2D, set.tex[i]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planeW[i], planeH[i], GL_RED, GL_UNSIGNED_BYTE,
+                        reinterpret_cast<const void *>(offset));
+        offset += static_cast<size_t>(planeW[i]) * planeH[i];
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
 }
 
 static void draw_controller_ray(const XrMatrix4x4f &vp, const std::shared_ptr<AppState> &appState);
 
-void render_scene(const XrCompositionLayerProjectionView &layerView,
-                  render_target_t &rtarget, const Quad &quad,
-                  const std::shared_ptr<AppState> &appState,
-                  const CameraFrame *cameraFrame, bool drawSettingsGui,
-                  const std::vector<GuiSetting> &settings) {
-
+/** Bind the eye view's swapchain image, clear it to clearColor, and compute its view-projection matrix. */
+static XrMatrix4x4f begin_view(const XrCompositionLayerProjectionView &layerView, render_target_t &rtarget,
+                               const std::array<float, 4> &clearColor) {
     glBindFramebuffer(GL_FRAMEBUFFER, rtarget.fbo_id);
     glViewport(
             static_cast<GLint>(layerView.subImage.imageRect.offset.x),
@@ -241,7 +426,7 @@ void render_scene(const XrCompositionLayerProjectionView &layerView,
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rtarget.texc_id, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, rtarget.texz_id, 0);
 
-    glClearColor(CLEAR_COLOR[0], CLEAR_COLOR[1], CLEAR_COLOR[2], CLEAR_COLOR[3]);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
     glClearDepthf(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
@@ -255,8 +440,19 @@ void render_scene(const XrCompositionLayerProjectionView &layerView,
     XrMatrix4x4f_InvertRigidBody(&view, &toView);
     XrMatrix4x4f vp;
     XrMatrix4x4f_Multiply(&vp, &proj, &view);
+    return vp;
+}
 
-    draw_image_plane(vp, quad, cameraFrame);
+void render_scene(const XrCompositionLayerProjectionView &layerView,
+                  render_target_t &rtarget, const Quad &quad,
+                  const std::shared_ptr<AppState> &appState,
+                  const CameraFrame *cameraFrame, bool drawSettingsGui,
+                  const std::vector<GuiSetting> &settings,
+                  const CameraFrame *insetFrame) {
+
+    const XrMatrix4x4f vp = begin_view(layerView, rtarget, CLEAR_COLOR);
+
+    draw_image_plane(vp, quad, cameraFrame, insetFrame);
     draw_imgui(vp, appState, drawSettingsGui, settings);
     draw_controller_ray(vp, appState);
 
@@ -264,42 +460,143 @@ void render_scene(const XrCompositionLayerProjectionView &layerView,
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-int draw_image_plane(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame *cameraFrame) {
+void render_overlay(const XrCompositionLayerProjectionView &layerView, render_target_t &rtarget,
+                    const std::shared_ptr<AppState> &appState, bool drawSettingsGui,
+                    const std::vector<GuiSetting> &settings) {
 
-    if(!cameraFrame) { return 0; }
+    // Transparent where neither is drawn: the camera quad layers below show through.
+    const XrMatrix4x4f vp = begin_view(layerView, rtarget, {0.0f, 0.0f, 0.0f, 0.0f});
 
-    // Hold frame.frameMutex for the entire draw. The GStreamer thread takes
-    // the same lock when publishing a new sample, so the texture bound below
-    // cannot be torn down between glBindTexture and glDrawElements. The
-    // Phase 2 glFinish() at the bottom additionally guarantees the GPU has
-    // fully consumed the binding before we release the lock — defense in
-    // depth against any residual OES update/unref racing the draw.
-    std::lock_guard<std::mutex> lk(cameraFrame->frameMutex);
+    draw_imgui(vp, appState, drawSettingsGui, settings);
+    draw_controller_ray(vp, appState);
 
-    const bool   hasGl       = cameraFrame->hasGlTexture;
-    const GLenum gTargetSnap = cameraFrame->glTarget;
-    const GLuint gTexSnap    = cameraFrame->glTexture;
-    void* const  dataSnap    = cameraFrame->dataHandle;
-    const int    fwSnap      = cameraFrame->frameWidth;
-    const int    fhSnap      = cameraFrame->frameHeight;
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-    const shader_obj_t *shader = nullptr;
-    GLenum              target = GL_TEXTURE_2D;
-
-    if (hasGl) {
-        target = gTargetSnap;
-        if (target == GL_TEXTURE_EXTERNAL_OES) {
-            shader = &image_shader_object_oes;
-        } else { // treat everything else as 2D
-            shader = &image_shader_object_2d;
+static int draw_frame_quad(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame *cameraFrame,
+                           bool asInset);
+
+int draw_image_plane(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame *cameraFrame,
+                     const CameraFrame *insetFrame) {
+    draw_frame_quad(vp, quad, cameraFrame, false);
+
+    // Foveated inset: coplanar with the image plane and drawn after it, so the
+    // depth test (GL_LESS against the plane's own depth) is off for this draw.
+    if (insetFrame) {
+        glDisable(GL_DEPTH_TEST);
+        draw_frame_quad(vp, quad, insetFrame, true);
+        glEnable(GL_DEPTH_TEST);
+    }
+    return 0;
+}
+
+bool render_camera_surface(render_target_t &rtarget, const CameraFrame *cameraFrame) {
+    if (!cameraFrame || !cameraFrame->mailbox.hasFront()) return false;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, rtarget.fbo_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rtarget.texc_id, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glViewport(0, 0, rtarget.width, rtarget.height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+
+    // The unit quad scaled by 2 covers clip space exactly, so with the viewport
+    // at the frame's size every fragment samples one texel at its centre.
+    XrMatrix4x4f toClip;
+    XrMatrix4x4f_CreateScale(&toClip, 2.0f, 2.0f, 1.0f);
+    Quad fullscreen{};
+    fullscreen.Pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    fullscreen.Scale = {1.0f, 1.0f, 1.0f};
+    draw_frame_quad(toClip, fullscreen, cameraFrame, false);
+
+    glEnable(GL_DEPTH_TEST);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+}
+
+bool latch_camera_frame(CameraFrame *cameraFrame) {
+    if (!cameraFrame) return false;
+    const auto start = std::chrono::steady_clock::now();
+
+    uint64_t &spentNs = frameCpuNs[cameraFrame];
+    if (cameraFrame->stats && spentNs > 0) {
+        // Smoothed over ~16 app frames, like the RFC 3550 jitter estimate.
+        const auto cur = static_cast<int64_t>(spentNs / 1000);
+        cameraFrame->stats->render.update([&](RenderStats &rd) {
+            const auto prev = static_cast<int64_t>(rd.renderCpuUs);
+            rd.renderCpuUs = static_cast<uint32_t>(prev + (cur - prev) / 16);
+        });
+    }
+    spentNs = 0;
+
+    TripleBufferIndex &mailbox = cameraFrame->mailbox;
+    const bool latched = mailbox.pending();
+    if (latched) {
+        // The texture going back to the producer may still be sampled by the
+        // draws already submitted; the blit into it waits on this fence on
+        // the GPU. Flushed so the other context can wait on it.
+        if (mailbox.hasFront()) {
+            FrameSlot &released = cameraFrame->slots[mailbox.frontSlot()];
+            if (released.isTexture) {
+                released.releaseFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush();
+            }
+        }
+        mailbox.acquire();
+
+        FrameSlot &slot = cameraFrame->slots[mailbox.frontSlot()];
+        if (slot.isTexture) {
+            // Orders this frame's draws after the blit without blocking the CPU.
+            if (slot.readyFence) {
+                auto fence = static_cast<GLsync>(slot.readyFence);
+                glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+                glDeleteSync(fence);
+                slot.readyFence = nullptr;
+            }
+        } else if (slot.planes && slot.width > 0 && slot.height > 0) {
+            upload_yuv_planes(yuvPlaneSets[cameraFrame], slot.planes, slot.width, slot.height);
         }
-        if (gTexSnap == 0) return 0;
-    } else if (dataSnap) {
+    }
+
+    spentNs += elapsed_ns(start);
+    return latched;
+}
+
+// Draw one camera frame on the image quad. asInset: place it on the sub-rect of
+// the quad given by the frame's foveaRect (skipped while that is still unknown).
+static int draw_frame_quad(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame *cameraFrame,
+                           bool asInset) {
+
+    if(!cameraFrame || !cameraFrame->mailbox.hasFront()) { return 0; }
+    const auto start = std::chrono::steady_clock::now();
+
+    // The latched front slot belongs to the render thread until the next
+    // latch_camera_frame(), so nothing here needs a lock, and the fences set
+    // up at latch time order the GPU work -- no glFinish.
+    const FrameSlot &slot = cameraFrame->slots[cameraFrame->mailbox.frontSlot()];
+    const uint64_t rect = slot.foveaRect;
+
+    if (asInset && rect == 0) return 0;
+
+    const shader_obj_t *shader = nullptr;
+    const YuvPlaneSet *planes = nullptr;
+
+    if (slot.isTexture) {
+        if (slot.tex == 0) return 0;
         shader = &image_shader_object_2d;
-        target = GL_TEXTURE_2D;
-        if (fwSnap <= 0 || fhSnap <= 0) return 0;
     } else {
-        return 0;
+        auto it = yuvPlaneSets.find(cameraFrame);
+        if (it == yuvPlaneSets.end() || it->second.tex[0] == 0) return 0;
+        planes = &it->second;
+        shader = &image_shader_object_yuv;
     }
 
     if (!shader || shader->program == 0 || vertexArrayObject == 0) return 0;
@@ -310,31 +607,41 @@ int draw_image_plane(const XrMatrix4x4f &vp, const Quad &quad, const CameraFrame
     auto pos = XrVector3f{quad.Pose.position.x, quad.Pose.position.y, quad.Pose.position.z};
     XrMatrix4x4f model;
     XrMatrix4x4f_CreateTranslationRotationScale(&model, &pos, &quad.Pose.orientation, &quad.Scale);
+    if (asInset) {
+        // Rect is normalised to the base frame; the quad spans -0.5..0.5 with
+        // row 0 at the bottom, so it maps 1:1 onto the quad's local space.
+        auto unpack = [rect](int i) { return static_cast<float>((rect >> (16 * i)) & 0xFFFF) / 65535.0f; };
+        const float x = unpack(0), y = unpack(1), w = unpack(2), h = unpack(3);
+        XrVector3f localPos{x + w / 2.0f - 0.5f, y + h / 2.0f - 0.5f, 0.0f};
+        XrQuaternionf identity{0.0f, 0.0f, 0.0f, 1.0f};
+        XrVector3f localScale{w, h, 1.0f};
+        XrMatrix4x4f local, baseModel = model;
+        XrMatrix4x4f_CreateTranslationRotationScale(&local, &localPos, &identity, &localScale);
+        XrMatrix4x4f_Multiply(&model, &baseModel, &local);
+    }
     XrMatrix4x4f mvp;
     XrMatrix4x4f_Multiply(&mvp, &vp, &model);
     glUniformMatrix4fv(static_cast<GLint>(shader->loc_mvp), 1, GL_FALSE,reinterpret_cast<const GLfloat *>(&mvp));
 
     glActiveTexture(GL_TEXTURE0);
 
-    if(hasGl) {
-        glBindTexture(target, gTexSnap);
+    if (slot.isTexture) {
+        glBindTexture(GL_TEXTURE_2D, slot.tex);
         glUniform1i((GLint)shader->loc_texture, 0);
-        LOG_DEBUG("GStreamer: rendering GL texture %u (target=0x%x)", gTexSnap, target);
+        LOG_DEBUG("GStreamer: rendering GL texture %u", slot.tex);
     } else {
-        glBindTexture(GL_TEXTURE_2D, texture2D);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, fwSnap, fhSnap, 0,
-                     GL_SRGB, GL_UNSIGNED_BYTE, dataSnap);
-        glUniform1i((GLint)shader->loc_texture, 0);
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, planes->tex[i]);
+            glUniform1i(yuvSamplerLocs[i], i);
+        }
+        glActiveTexture(GL_TEXTURE0);
     }
 
     glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(ArraySize(Geometry::c_quadIndices)),GL_UNSIGNED_SHORT, nullptr);
     glBindVertexArray(0);
 
-    // Phase 2: drain GPU before releasing the lock so the bound texture is
-    // fully consumed before GstGL can overwrite anything. ~1 ms cost per
-    // eye render, but eliminates the residual race window inside the driver.
-    glFinish();
-
+    frameCpuNs[cameraFrame] += elapsed_ns(start);
     return 0;
 }
 
@@ -372,7 +679,8 @@ draw_controller_ray(const XrMatrix4x4f &vp, const std::shared_ptr<AppState> &app
     }
 
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Alpha blended like the tex plate, so the overlay layer's alpha is the coverage.
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     glLineWidth(2.0f);
     glDrawArrays(GL_LINES, 0, 2);
     glDisable(GL_BLEND);
@@ -380,43 +688,141 @@ draw_controller_ray(const XrMatrix4x4f &vp, const std::shared_ptr<AppState> &app
     glDisableVertexAttribArray(gui_shader_object.loc_position);
 }
 
-int
-draw_imgui(const XrMatrix4x4f &vp, const std::shared_ptr<AppState> &appState,
-           bool drawSettingsGui, const std::vector<GuiSetting> &settings) {
+void begin_settings_gui_frame() {
+    settingsGuiPending = true;
+}
+
+static void hash_combine(size_t &hash, const std::string &text) {
+    hash ^= std::hash<std::string>{}(text) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+}
+
+/** What the panel shows, apart from the stats that SETTINGS_GUI_REFRESH_US takes care of. */
+static SettingsGuiInputs settings_gui_inputs(const AppState &appState, const std::vector<GuiSetting> &settings) {
+    SettingsGuiInputs inputs;
+    for (const GuiSetting &setting : settings) {
+        if (setting.getDisplayText) hash_combine(inputs.textHash, setting.getDisplayText());
+    }
+    hash_combine(inputs.textHash, appState.cameraServerStatus);
+    hash_combine(inputs.textHash, appState.robotControlStatus);
+    hash_combine(inputs.textHash, appState.ntpSyncStatus);
+    hash_combine(inputs.textHash, appState.robotControlEnabled ? "on" : "off");
+    inputs.focusedElement = appState.guiControl.focusedElement;
+    inputs.focusedSegment = appState.guiControl.focusedSegment;
+    inputs.rayHitting = appState.guiPanel.rayHitting;
+    inputs.grabbing = appState.guiPanel.grabbing;
+    inputs.triggerDown = appState.guiPanel.triggerDown;
+    if (inputs.rayHitting) {
+        inputs.mouseX = static_cast<int>(appState.guiPanel.imguiMouseX);
+        inputs.mouseY = static_cast<int>(appState.guiPanel.imguiMouseY);
+    }
+    return inputs;
+}
+
+/** Rasterise the panel into its FBO if it is dirty; the caller's render target is restored. */
+static void update_settings_gui_texture(const std::shared_ptr<AppState> &appState,
+                                        const std::vector<GuiSetting> &settings) {
+    const auto now = std::chrono::steady_clock::now();
+    const SettingsGuiInputs inputs = settings_gui_inputs(*appState, settings);
+    const bool changed = !(inputs == settingsGuiInputs) || appState->guiControl.changesEnqueued ||
+                         appState->guiPanel.scrollDelta != 0.0f;
+    if (changed) settingsGuiSettleFrames = 1;
+    if (settingsGuiValid && !changed && settingsGuiSettleFrames == 0 &&
+        now - settingsGuiRenderedAt < SETTINGS_GUI_REFRESH_US) {
+        return;
+    }
+    if (!changed && settingsGuiSettleFrames > 0) settingsGuiSettleFrames--;
 
     /* save current FBO */
     render_target_t rtarget0{};
     get_render_target(&rtarget0);
 
-    /* render to settings UIPlane-FBO */
-    if (drawSettingsGui) {
-        set_render_target(&settings_gui_render_target);
-        glClearColor(1.0f, 0.0f, 1.0f, 0.8f);
-        glClear(GL_COLOR_BUFFER_BIT);
+    set_render_target(&settings_gui_render_target);
+    glClearColor(1.0f, 0.0f, 1.0f, 0.8f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    invoke_imgui_settings(SETTINGS_GUI_WIDTH, SETTINGS_GUI_HEIGHT, appState, settings);
 
-        {
-            invoke_imgui_settings(SETTINGS_GUI_WIDTH, SETTINGS_GUI_HEIGHT, appState, settings);
-        }
+    /* restore FBO */
+    set_render_target(&rtarget0);
 
-        /* restore FBO */
-        set_render_target(&rtarget0);
+    // Taken after the ImGui frame, which may have moved the focus.
+    settingsGuiInputs = settings_gui_inputs(*appState, settings);
+    settingsGuiRenderedAt = now;
+    settingsGuiValid = true;
+}
 
-        glEnable(GL_DEPTH_TEST);
+int
+draw_imgui(const XrMatrix4x4f &vp, const std::shared_ptr<AppState> &appState,
+           bool drawSettingsGui, const std::vector<GuiSetting> &settings) {
 
-        {
-            XrMatrix4x4f matT;
-            float win_h = appState->guiPanel.height;
-            float win_w = appState->guiPanel.getWorldWidth();
-            XrVector3f translation = appState->guiPanel.position;
-            XrQuaternionf rotation{0.0f, 0.0f, 0.0f, 1.0f};
-            XrVector3f scale{win_w, win_h, 1.0f};
-            XrMatrix4x4f_CreateTranslationRotationScale(&matT, &translation, &rotation, &scale);
-
-            XrMatrix4x4f matPVM;
-            XrMatrix4x4f_Multiply(&matPVM, &vp, &matT);
-            draw_tex_plate(settings_gui_render_target.texc_id, matPVM);
-        }
+    if (!drawSettingsGui) {
+        settingsGuiValid = false;  // stale by the time the panel is shown again
+        return 0;
+    }
+
+    if (settingsGuiPending) {
+        settingsGuiPending = false;
+        update_settings_gui_texture(appState, settings);
+    }
+
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        XrMatrix4x4f matT;
+        float win_h = appState->guiPanel.height;
+        float win_w = appState->guiPanel.getWorldWidth();
+        XrVector3f translation = appState->guiPanel.position;
+        XrQuaternionf rotation{0.0f, 0.0f, 0.0f, 1.0f};
+        XrVector3f scale{win_w, win_h, 1.0f};
+        XrMatrix4x4f_CreateTranslationRotationScale(&matT, &translation, &rotation, &scale);
+
+        XrMatrix4x4f matPVM;
+        XrMatrix4x4f_Multiply(&matPVM, &vp, &matT);
+        draw_tex_plate(settings_gui_render_target.texc_id, matPVM);
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+void begin_gpu_frame_timer() {
+    if (gpuTimerSupported < 0) {
+        const auto *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+        gpuTimerSupported = extensions && strstr(extensions, "GL_EXT_disjoint_timer_query") ? 1 : 0;
+        if (gpuTimerSupported) {
+            glGenQueries(GPU_TIMER_RING_SIZE, gpuTimerQueries);
+        } else {
+            LOG_INFO("render_scene: GL_EXT_disjoint_timer_query not supported, no GPU frame time");
+        }
+    }
+    gpuTimerActive = gpuTimerSupported == 1 && gpuTimerInFlight < GPU_TIMER_RING_SIZE;
+    if (!gpuTimerActive) return;
+
+    // Clears a disjoint flag raised before this frame.
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    glBeginQuery(GL_TIME_ELAPSED_EXT, gpuTimerQueries[gpuTimerNext]);
+}
+
+long long end_gpu_frame_timer() {
+    if (gpuTimerActive) {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        gpuTimerNext = (gpuTimerNext + 1) % GPU_TIMER_RING_SIZE;
+        gpuTimerInFlight++;
+        gpuTimerActive = false;
+    }
+
+    while (gpuTimerInFlight > 0) {
+        const GLuint query = gpuTimerQueries[(gpuTimerNext - gpuTimerInFlight + GPU_TIMER_RING_SIZE) %
+                                             GPU_TIMER_RING_SIZE];
+        GLuint available = 0;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint elapsedNs = 0;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT, &elapsedNs);
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (!disjoint) gpuTimerLastUs = elapsedNs / 1000;
+        gpuTimerInFlight--;
+    }
+    return gpuTimerLastUs;
+}
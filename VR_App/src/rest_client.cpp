@@ -3,6 +3,7 @@
  *
  * Sends JSON requests to the Jetson camera streaming server.
  * Uses nlohmann/json for serialization and cpp-httplib for HTTP.
+ * All network I/O happens on the worker thread, one request at a time.
  */
 #include <nlohmann/json.hpp>
 #include "rest_client.h"
@@ -12,83 +13,107 @@
 
 using json = nlohmann::json;
 
-RestClient::RestClient(StreamingConfig &config) : config_(config) {}
-
-std::unique_ptr<httplib::Client> RestClient::makeClient() {
-    auto client = std::make_unique<httplib::Client>(
-            IpToString(config_.jetson_ip).c_str(), Config::REST_API_PORT);
-    client->set_connection_timeout(2, 0);
-    client->set_read_timeout(5, 0);
-    client->set_write_timeout(2, 0);
-    return client;
+RestClient::RestClient(StreamingConfig &config) : config_(config) {
+    worker_ = std::thread(&RestClient::workerLoop, this);
 }
 
-int RestClient::StartStream() {
-    json j = {{"bitrate",          config_.bitrate},
-               {"codec",            CodecToString(config_.codec)},
-               {"encoding_quality", config_.encodingQuality},
-               {"fps",              config_.fps},
-               {"ip_address",       IpToString(config_.headset_ip)},
-               {"port_left",        config_.portLeft},
-               {"port_right",       config_.portRight},
-               {"resolution",       {{"height", config_.resolution.getHeight()}, {"width", config_.resolution.getWidth()}}},
-               {"video_mode",       VideoModeToApiString(config_.videoMode)}};
-    std::string req = j.dump();
-
-    auto client = makeClient();
-    auto res = client->Post("/api/v1/stream/start", req, "application/json");
-    if (!res) {
-        LOG_ERROR("RestClient: Failed to send start stream request - connection error");
-        return -1;
+RestClient::~RestClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
     }
-    if (res->status != 200) {
-        LOG_ERROR("RestClient: Start stream request failed with status %d: %s", res->status, res->body.c_str());
-        return -1;
+    queueCv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
     }
-    LOG_INFO("RestClient: Stream started successfully");
-    return 0;
 }
 
-int RestClient::StopStream() {
-    auto client = makeClient();
-    auto res = client->Post("/api/v1/stream/stop");
-    if (!res) {
-        LOG_ERROR("RestClient: Failed to send stop stream request - connection error");
-        return -1;
-    }
-    if (res->status != 200) {
-        LOG_ERROR("RestClient: Stop stream request failed with status %d: %s", res->status, res->body.c_str());
-        return -1;
+std::string RestClient::configBody(const StreamingConfig &config) const {
+    return json{{"bitrate",          config.bitrate},
+                {"codec",            CodecToString(config.codec)},
+                {"encoding_quality", config.encodingQuality},
+                {"fps",              config.fps},
+                {"ip_address",       IpToString(config_.headset_ip)},
+                {"max_frame_age_ms", config.maxFrameAgeMs},
+                {"port_left",        config.portLeft},
+                {"port_right",       config.portRight},
+                {"resolution",       {{"height", config.resolution.getHeight()}, {"width", config.resolution.getWidth()}}},
+                {"video_mode",       VideoModeToApiString(config.videoMode)}}.dump();
+}
+
+std::future<RestResult> RestClient::enqueue(bool put, const char *path, std::string body, const char *action) {
+    // The host is read here, on the caller's thread, like the body: the worker never touches config_.
+    Request request{IpToString(config_.jetson_ip), put, path, std::move(body), action, {}};
+    std::future<RestResult> result = request.result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(request));
     }
-    LOG_INFO("RestClient: Stream stopped successfully");
-    return 0;
+    queueCv_.notify_one();
+    return result;
+}
+
+std::future<RestResult> RestClient::StartStream() {
+    return enqueue(false, "/api/v1/stream/start", configBody(config_), "start stream");
+}
+
+std::future<RestResult> RestClient::StopStream() {
+    return enqueue(false, "/api/v1/stream/stop", "", "stop stream");
 }
 
 StreamingConfig RestClient::GetStreamingConfig() {
     return config_;
 }
 
-int RestClient::UpdateStreamingConfig(const StreamingConfig &config) {
-    std::string req = json{{"bitrate",          config.bitrate},
-                           {"codec",            CodecToString(config.codec)},
-                           {"encoding_quality", config.encodingQuality},
-                           {"fps",              config.fps},
-                           {"ip_address",       IpToString(config_.headset_ip)},
-                           {"port_left",        config.portLeft},
-                           {"port_right",       config.portRight},
-                           {"resolution",       {{"height", config.resolution.getHeight()}, {"width", config.resolution.getWidth()}}},
-                           {"video_mode",       VideoModeToApiString(config.videoMode)}}.dump();
-    auto client = makeClient();
-    auto res = client->Put("/api/v1/stream/update", req, "application/json");
+std::future<RestResult> RestClient::UpdateStreamingConfig(const StreamingConfig &config) {
+    return enqueue(true, "/api/v1/stream/update", configBody(config), "update config");
+}
+
+void RestClient::workerLoop() {
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        queueCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return;  // stopping, and everything queued has been sent
+        Request request = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        request.result.set_value(send(request));
+    }
+}
+
+RestResult RestClient::send(const Request &request) {
+    if (!client_ || clientHost_ != request.host) {
+        client_ = std::make_unique<httplib::Client>(request.host, Config::REST_API_PORT);
+        client_->set_keep_alive(true);
+        client_->set_connection_timeout(2, 0);
+        client_->set_read_timeout(5, 0);
+        client_->set_write_timeout(2, 0);
+        clientHost_ = request.host;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    httplib::Result res = request.put ? client_->Put(request.path, request.body, "application/json")
+                        : request.body.empty() ? client_->Post(request.path)
+                        : client_->Post(request.path, request.body, "application/json");
+    const long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    RestResult result;
     if (!res) {
-        LOG_ERROR("RestClient: Failed to send update config request - connection error");
-        return -1;
+        result.error = "connection error (" + httplib::to_string(res.error()) + ")";
+        LOG_ERROR("RestClient: Failed to send %s request to %s:%d - %s", request.action, request.host.c_str(),
+                  Config::REST_API_PORT, result.error.c_str());
+        client_.reset();  // start over with a fresh connection next time
+        return result;
     }
+    result.status = res->status;
     if (res->status != 200) {
-        LOG_ERROR("RestClient: Update config request failed with status %d: %s", res->status, res->body.c_str());
-        return -1;
+        result.error = "HTTP " + std::to_string(res->status);
+        LOG_ERROR("RestClient: %s request failed with status %d: %s", request.action, res->status, res->body.c_str());
+        return result;
     }
-    LOG_INFO("RestClient: Config updated successfully");
-    config_ = config;
-    return 0;
+    result.ok = true;
+    LOG_INFO("RestClient: %s succeeded in %lld ms", request.action, elapsedMs);
+    return result;
 }
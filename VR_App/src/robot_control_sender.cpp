@@ -2,10 +2,15 @@
  * robot_control_sender.cpp - UDP packet construction and sending
  *
  * Implements the binary protocol described in robot_control_sender.h.
- * All send methods serialize data in little-endian format and dispatch
- * the actual sendto() call to a thread pool.
+ * The send methods post into latest-wins mailboxes; the sender thread
+ * serializes the newest message of each type in little-endian format into
+ * fixed packet buffers and sends them together with sendmmsg(). Telemetry
+ * records are gathered on the main thread straight into the back slot of
+ * their mailbox and published as one batch per interval.
  */
 #include "robot_control_sender.h"
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 RobotControlSender::RobotControlSender(StreamingConfig &config, NtpTimer *ntpTimer)
@@ -20,6 +25,17 @@ RobotControlSender::RobotControlSender(StreamingConfig &config, NtpTimer *ntpTim
         return;
     }
 
+    wakeFd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        LOG_ERROR("RobotControlSender: eventfd creation failed (errno=%d: %s). "
+                  "Head tracking and robot control will not work.",
+                  errno, strerror(errno));
+        close(socket_);
+        socket_ = -1;
+        isInitialized_ = false;
+        return;
+    }
+
     // Configure destination address
     memset(&destAddr_, 0, sizeof(destAddr_));
     destAddr_.sin_family = AF_INET;
@@ -27,207 +43,461 @@ RobotControlSender::RobotControlSender(StreamingConfig &config, NtpTimer *ntpTim
     destAddr_.sin_port = htons(Config::SERVO_PORT);
 
     isInitialized_ = true;
+    running_ = true;
+    senderThread_ = std::thread(&RobotControlSender::sendLoop, this);
     LOG_INFO("RobotControlSender: Initialized, sending to %s:%d",
              destIpString_.c_str(), Config::SERVO_PORT);
 }
 
 RobotControlSender::~RobotControlSender() {
+    running_ = false;
+    if (senderThread_.joinable()) {
+        uint64_t one = 1;
+        (void) write(wakeFd_, &one, sizeof(one));  // Unblock read
+        senderThread_.join();
+    }
+    if (wakeFd_ >= 0) {
+        close(wakeFd_);
+        wakeFd_ = -1;
+    }
     if (socket_ >= 0) {
         close(socket_);
         socket_ = -1;
     }
 }
 
-void RobotControlSender::sendHeadPose(XrQuaternionf quatPose, float speed,
-                                      BS::thread_pool<BS::tp::none> &threadPool) {
+uint64_t RobotControlSender::steadyNowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void RobotControlSender::sendHeadPose(XrQuaternionf quatPose, float speed) {
     if (!isInitialized_) {
         return;
     }
-
-    threadPool.detach_task([this, quatPose, speed]() {
-        // Convert quaternion to azimuth/elevation
-        auto azElev = quaternionToAzimuthElevation(quatPose);
-
-        // Get current timestamp
-        uint64_t timestamp = ntpTimer_->GetCurrentTimeUs();
-
-        // Send the packet
-        sendHeadPosePacket(azElev.azimuth, azElev.elevation, speed, timestamp);
-    });
+    // The history rides along in the message, so samples the mailbox replaces still go out.
+    HeadPoseCommand &cmd = headPoseHistory_;
+    const auto azElev = quaternionToAzimuthElevation(quatPose);
+    std::copy_backward(cmd.samples.begin(), cmd.samples.end() - 1, cmd.samples.end());
+    cmd.samples[0] = HeadPoseSample{azElev.azimuth, azElev.elevation, speed, ntpTimer_->GetCurrentTimeUs()};
+    cmd.seq++;
+    cmd.sampleCount = static_cast<uint8_t>(std::min<size_t>(cmd.sampleCount + 1, HEAD_POSE_HISTORY));
+    cmd.enqueueUs = steadyNowUs();
+    headPoseMailbox_.post(cmd);
+    wakeSender();
 }
 
-void RobotControlSender::sendRobotControl(float linearX, float linearY, float angular,
-                                          BS::thread_pool<BS::tp::none> &threadPool) {
+void RobotControlSender::sendRobotControl(float linearX, float linearY, float angular) {
     if (!isInitialized_) {
         return;
     }
-
-    threadPool.detach_task([this, linearX, linearY, angular]() {
-        // Get current timestamp
-        uint64_t timestamp = ntpTimer_->GetCurrentTimeUs();
-
-        // Send the packet
-        sendRobotControlPacket(linearX, linearY, angular, timestamp);
-        LOG_INFO(
-                "RobotControlSender: Sending robot control message: linearX=%f, linearY=%f, angular=%f",
-                linearX, linearY, angular);
-    });
+    robotControlMailbox_.post(RobotControlCommand{linearX, linearY, angular, steadyNowUs()});
+    wakeSender();
 }
 
-void RobotControlSender::sendDebugInfo(const CameraStatsSnapshot &left,
-                                       const CameraStatsSnapshot &right,
-                                       const StreamingConfig &config,
-                                       BS::thread_pool<BS::tp::none> &threadPool) {
+void RobotControlSender::sendTelemetry(CameraStats *left, CameraStats *right,
+                                       const StreamingConfig &config, uint32_t intervalMs) {
     if (!isInitialized_) {
         return;
     }
+    // The back slot is ours until publish(): records accumulate there frame by frame.
+    TelemetryBatch &batch = telemetryMailbox_.slots[telemetryMailbox_.index.backSlot()];
+    CameraStats *eyes[2] = {left, right};
+    for (uint8_t eye = 0; eye < 2; eye++) {
+        if (!eyes[eye]) continue;
+        uint32_t dropped = 0;
+        const size_t count = eyes[eye]->takeCompleted(drained_.data(), drained_.size(), &dropped);
+        batch.recordsDropped += dropped;
+        for (size_t i = 0; i < count; i++) {
+            if (batch.recordCount == MAX_TELEMETRY_RECORDS) {
+                batch.recordsDropped += static_cast<uint32_t>(count - i);
+                break;
+            }
+            const FrameLatencyRecord &frame = drained_[i];
+            TelemetryRecord &record = batch.records[batch.recordCount++];
+            record.eye = eye;
+            record.frameId = frame.frameId;
+            record.readyUs = frame.readyUs;
+            std::copy(frame.stages, frame.stages + TELEMETRY_STAGE_COUNT, record.stages);
+        }
+    }
 
-    threadPool.detach_task([this, left, right, config]() {
-        // Get current timestamp
-        uint64_t timestamp = ntpTimer_->GetCurrentTimeUs();
+    const uint64_t nowUs = steadyNowUs();
+    intervalMs = std::clamp(intervalMs, MIN_TELEMETRY_INTERVAL_MS, MAX_TELEMETRY_INTERVAL_MS);
+    if (nowUs - telemetryBatchStartUs_ < static_cast<uint64_t>(intervalMs) * 1000) {
+        return;
+    }
+    telemetryBatchStartUs_ = nowUs;
+
+    // Health once per batch, over the rolling window.
+    for (size_t eye = 0; eye < 2; eye++) {
+        TelemetryEyeHealth &health = batch.eyes[eye];
+        if (!eyes[eye]) {
+            health = TelemetryEyeHealth{};
+            continue;
+        }
+        const CameraStatsSnapshot snap = eyes[eye]->averagedSnapshot();
+        health.fps = static_cast<float>(snap.fps);
+        health.lost = snap.jbNumLost;
+        health.rtx = snap.rtxCount;
+        health.jitterUs = snap.jitterUs;
+        health.bitrateBps = snap.actualBitrateBps;
+        health.jbLatencyMs = static_cast<uint16_t>(snap.jbLatencyMs);
+        health.total = snap.stagePercentiles(LatencyStage::Total);
+    }
 
-        // Send the packet
-        sendDebugInfoPacket(left, right, config, timestamp);
-    });
+    batch.config = TelemetryConfig{
+            static_cast<uint8_t>(config.codec), static_cast<uint8_t>(config.videoMode),
+            static_cast<uint16_t>(config.resolution.getWidth()),
+            static_cast<uint16_t>(config.resolution.getHeight()),
+            static_cast<uint16_t>(config.fps), static_cast<uint32_t>(config.bitrate)};
+    batch.hasConfig = !batch.config.sameAs(telemetryConfig_) || ++batchesSinceConfig_ >= TELEMETRY_CONFIG_REFRESH;
+    if (batch.hasConfig) {
+        telemetryConfig_ = batch.config;
+        batchesSinceConfig_ = 0;
+    }
+    batch.enqueueUs = nowUs;
+    const bool replaced = telemetryMailbox_.index.publish();
+
+    // The new back slot starts the next batch empty. If it is a batch the sender never
+    // took, its records are lost: they go into the next batch's records_dropped.
+    TelemetryBatch &next = telemetryMailbox_.slots[telemetryMailbox_.index.backSlot()];
+    uint32_t carriedDropped = 0;
+    if (replaced) {
+        const uint32_t lost = static_cast<uint32_t>(next.recordCount);
+        carriedDropped = next.recordsDropped + lost;
+        telemetryBatchesReplaced_.fetch_add(1, std::memory_order_relaxed);
+        telemetryRecordsReplaced_.fetch_add(lost, std::memory_order_relaxed);
+    }
+    next.recordCount = 0;
+    next.recordsDropped = carriedDropped;
+    wakeSender();
 }
 
-void RobotControlSender::sendHeadPosePacket(float azimuth, float elevation, float speed,
-                                            uint64_t timestamp) {
-    std::vector<uint8_t> packet;
-    packet.reserve(21);
+/**
+ * At most one eventfd write per wake-up: a post that finds a wake already
+ * pending is picked up by that wake's flush, which starts only after the
+ * sender thread has cleared the flag.
+ */
+void RobotControlSender::wakeSender() {
+    if (!wakePending_.exchange(true, std::memory_order_acq_rel)) {
+        uint64_t one = 1;
+        (void) write(wakeFd_, &one, sizeof(one));
+    }
+}
 
-    // Message type
-    packet.push_back(MSG_HEAD_POSE);
+void RobotControlSender::sendLoop() {
+    // Same class as Android's THREAD_PRIORITY_DISPLAY: a wake-up should not wait
+    // for a time slice behind decode and network pool work.
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), SENDER_NICE) != 0) {
+        LOG_WARN("RobotControlSender: setpriority(%d) failed (errno=%d: %s)", SENDER_NICE, errno, strerror(errno));
+    }
+    LOG_INFO("RobotControlSender: Sender thread started");
+    while (running_) {
+        uint64_t count = 0;
+        if (read(wakeFd_, &count, sizeof(count)) < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("RobotControlSender: eventfd read failed (errno=%d: %s). Sender thread exiting.",
+                      errno, strerror(errno));
+            break;
+        }
+        wakePending_.exchange(false, std::memory_order_acq_rel);
+        if (!running_) break;
+        flushMailboxes();
+    }
+    LOG_INFO("RobotControlSender: Sender thread stopped");
+}
 
-    // Azimuth (float, 4 bytes, little-endian)
-    serializeLittleEndian(packet, azimuth);
+/** Serialize the newest message of each type and send them as one batch. */
+void RobotControlSender::flushMailboxes() {
+    std::array<mmsghdr, MAX_BATCH> msgs{};
+    std::array<iovec, MAX_BATCH> iovs{};
+    std::array<uint8_t, MAX_BATCH> types{};
+    std::array<uint64_t, MAX_BATCH> enqueuedUs{};
+    size_t count = 0;
+
+    auto add = [&](uint8_t type, uint8_t *packet, size_t size, uint64_t enqueueUs) {
+        iovs[count] = iovec{packet, size};
+        msgs[count].msg_hdr.msg_name = &destAddr_;
+        msgs[count].msg_hdr.msg_namelen = sizeof(destAddr_);
+        msgs[count].msg_hdr.msg_iov = &iovs[count];
+        msgs[count].msg_hdr.msg_iovlen = 1;
+        types[count] = type;
+        enqueuedUs[count] = enqueueUs;
+        count++;
+    };
+
+    const uint64_t timestamp = ntpTimer_->GetCurrentTimeUs();
+    HeadPoseCommand headPose{};
+    if (headPoseMailbox_.take(&headPose)) {
+        if (headPoseLastSeq_ != 0) {
+            const uint32_t skipped = headPose.seq - headPoseLastSeq_ - 1;
+            headPoseCoalesced_ += skipped;
+            if (skipped >= headPose.sampleCount) headPoseUnsent_ += skipped - (headPose.sampleCount - 1);
+        }
+        headPoseLastSeq_ = headPose.seq;
+        add(MSG_HEAD_POSE, headPosePacket_.data(), buildHeadPosePacket(headPose), headPose.enqueueUs);
+    }
+    RobotControlCommand robotControl{};
+    if (robotControlMailbox_.take(&robotControl)) {
+        add(MSG_ROBOT_CONTROL, robotControlPacket_.data(), buildRobotControlPacket(robotControl, timestamp),
+            robotControl.enqueueUs);
+        LOG_INFO(
+                "RobotControlSender: Sending robot control message: linearX=%f, linearY=%f, angular=%f",
+                robotControl.linearX, robotControl.linearY, robotControl.angular);
+    }
+    if (telemetryMailbox_.index.pending()) {
+        // Taken in place: a batch holds up to MAX_TELEMETRY_RECORDS records.
+        telemetryMailbox_.index.acquire();
+        const TelemetryBatch &telemetry = telemetryMailbox_.slots[telemetryMailbox_.index.frontSlot()];
+        const size_t datagrams = buildTelemetryPackets(telemetry, timestamp);
+        for (size_t i = 0; i < datagrams; i++) {
+            add(MSG_TELEMETRY, telemetryPackets_[i].data(), telemetryPacketSizes_[i], telemetry.enqueueUs);
+        }
+    }
+    if (count == 0) return;
+
+    // sendmmsg() stops at the first datagram that fails: account for it and go on with the rest.
+    size_t next = 0;
+    while (next < count) {
+        int sent = sendmmsg(socket_, &msgs[next], static_cast<unsigned int>(count - next), 0);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            recordSendResult(types[next], false, errno);
+            next++;
+            continue;
+        }
+        const uint64_t wireUs = steadyNowUs();
+        for (int i = 0; i < sent; i++, next++) {
+            recordSendResult(types[next], true, 0);
+            recordWireLatency(enqueuedUs[next], wireUs);
+        }
+    }
+    wireBatches_++;
+}
 
-    // Elevation (float, 4 bytes, little-endian)
-    serializeLittleEndian(packet, elevation);
+size_t RobotControlSender::buildHeadPosePacket(const HeadPoseCommand &cmd) {
+    lastCommandedPose_.store(PackCameraPose(CameraPose{cmd.samples[0].azimuth, cmd.samples[0].elevation}),
+                             std::memory_order_relaxed);
 
-    // Speed (float, 4 bytes, little-endian)
-    serializeLittleEndian(packet, speed);
+    uint8_t *packet = headPosePacket_.data();
+    size_t offset = 0;
 
-    // Timestamp (uint64, 8 bytes, little-endian)
-    serializeLittleEndian(packet, timestamp);
+    // Message type
+    packet[offset++] = MSG_HEAD_POSE;
 
-    // Send UDP packet
-    ssize_t sent = sendto(socket_, packet.data(), packet.size(), 0,
-                          (sockaddr *) &destAddr_, sizeof(destAddr_));
+    // Sequence number of the newest sample (uint32, 4 bytes, little-endian)
+    serializeLittleEndian(packet, offset, cmd.seq);
 
-    if (sent < 0) {
-        int failures = ++consecutiveFailures_;
-        if (failures == 1) {
-            LOG_ERROR("RobotControlSender: Head pose send failed (errno=%d: %s). "
-                      "Robot may not be receiving head tracking data.",
-                      errno, strerror(errno));
-        } else if (failures == FAILURE_THRESHOLD) {
-            LOG_ERROR("RobotControlSender: %d consecutive send failures to %s:%d. "
-                      "Check network connection and robot controller status.",
-                      failures, destIpString_.c_str(), Config::SERVO_PORT);
-        }
-    } else {
-        if (consecutiveFailures_ > 0) {
-            LOG_INFO("RobotControlSender: Connection recovered after %d failures",
-                     consecutiveFailures_.load());
-        }
-        consecutiveFailures_ = 0;
-        ++successfulSends_;
+    // Sample count (uint8)
+    packet[offset++] = cmd.sampleCount;
+
+    // Samples, newest first: azimuth, elevation, speed (float), timestamp (uint64)
+    for (size_t i = 0; i < cmd.sampleCount; i++) {
+        const HeadPoseSample &sample = cmd.samples[i];
+        serializeLittleEndian(packet, offset, sample.azimuth);
+        serializeLittleEndian(packet, offset, sample.elevation);
+        serializeLittleEndian(packet, offset, sample.speed);
+        serializeLittleEndian(packet, offset, sample.timestamp);
     }
+    return offset;
 }
 
-void RobotControlSender::sendRobotControlPacket(float linearX, float linearY, float angular,
-                                                uint64_t timestamp) {
-    std::vector<uint8_t> packet;
-    packet.reserve(21);
+size_t RobotControlSender::buildRobotControlPacket(const RobotControlCommand &cmd, uint64_t timestamp) {
+    uint8_t *packet = robotControlPacket_.data();
+    size_t offset = 0;
 
     // Message type
-    packet.push_back(MSG_ROBOT_CONTROL);
+    packet[offset++] = MSG_ROBOT_CONTROL;
 
     // Linear velocity X (float, 4 bytes, little-endian)
-    serializeLittleEndian(packet, linearX);
+    serializeLittleEndian(packet, offset, cmd.linearX);
 
     // Linear velocity Y (float, 4 bytes, little-endian)
-    serializeLittleEndian(packet, linearY);
+    serializeLittleEndian(packet, offset, cmd.linearY);
 
     // Angular velocity (float, 4 bytes, little-endian)
-    serializeLittleEndian(packet, angular);
+    serializeLittleEndian(packet, offset, cmd.angular);
 
     // Timestamp (uint64, 8 bytes, little-endian)
-    serializeLittleEndian(packet, timestamp);
+    serializeLittleEndian(packet, offset, timestamp);
+    return offset;
+}
 
-    // Send UDP packet
-    ssize_t sent = sendto(socket_, packet.data(), packet.size(), 0,
-                          (sockaddr *) &destAddr_, sizeof(destAddr_));
+size_t RobotControlSender::putZigzagVarint(uint8_t *out, int64_t value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    size_t len = 0;
+    while (zigzag >= 0x80) {
+        out[len++] = static_cast<uint8_t>(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[len++] = static_cast<uint8_t>(zigzag);
+    return len;
+}
 
-    if (sent < 0) {
-        int failures = ++consecutiveFailures_;
-        if (failures == 1) {
-            LOG_ERROR("RobotControlSender: Robot control send failed (errno=%d: %s). "
-                      "Robot movement commands may not be received.",
-                      errno, strerror(errno));
+size_t RobotControlSender::buildTelemetryPackets(const TelemetryBatch &batch, uint64_t timestamp) {
+    constexpr size_t FIELD_COUNT = 2 + TELEMETRY_STAGE_COUNT;  // frame_id, ready_us, stages
+    constexpr size_t MAX_RECORD_SIZE = 1 + FIELD_COUNT * 10;
+
+    const int64_t ntpOffsetUs = ntpTimer_->GetOffsetUs();
+    const uint8_t ntpSynced = ntpTimer_->HasInitialOffset() ? 1 : 0;
+    const uint64_t sinceSyncUs = ntpTimer_->GetTimeSinceLastSyncUs();
+
+    size_t datagrams = 0;
+    size_t next = 0;
+    size_t droppedOffset = 0;
+    do {
+        uint8_t *packet = telemetryPackets_[datagrams].data();
+        size_t offset = 0;
+        const bool first = datagrams == 0;
+
+        // Header
+        packet[offset++] = MSG_TELEMETRY;
+        packet[offset++] = TELEMETRY_VERSION;
+        serializeLittleEndian(packet, offset, telemetrySeq_++);
+        serializeLittleEndian(packet, offset, timestamp);
+        packet[offset++] = first ? static_cast<uint8_t>(TELEMETRY_HAS_HEALTH | (batch.hasConfig ? TELEMETRY_HAS_CONFIG : 0))
+                                 : 0;
+        const size_t recordCountOffset = offset++;
+        droppedOffset = offset;
+        serializeLittleEndian(packet, offset, uint16_t{0});  // records_dropped, first datagram only
+        serializeLittleEndian(packet, offset, ntpOffsetUs);
+        packet[offset++] = ntpSynced;
+        serializeLittleEndian(packet, offset, sinceSyncUs);
+
+        if (first) {
+            // Per-eye health (right is zero in mono).
+            for (const TelemetryEyeHealth &eye : batch.eyes) {
+                serializeLittleEndian(packet, offset, eye.fps);
+                serializeLittleEndian(packet, offset, eye.lost);
+                serializeLittleEndian(packet, offset, eye.rtx);
+                serializeLittleEndian(packet, offset, eye.jitterUs);
+                serializeLittleEndian(packet, offset, eye.bitrateBps);
+                serializeLittleEndian(packet, offset, eye.jbLatencyMs);
+                serializeLittleEndian(packet, offset, eye.total.p50);
+                serializeLittleEndian(packet, offset, eye.total.p95);
+                serializeLittleEndian(packet, offset, eye.total.p99);
+                serializeLittleEndian(packet, offset, eye.total.max);
+            }
+            if (batch.hasConfig) {
+                packet[offset++] = batch.config.codec;
+                packet[offset++] = batch.config.videoMode;
+                serializeLittleEndian(packet, offset, batch.config.width);
+                serializeLittleEndian(packet, offset, batch.config.height);
+                serializeLittleEndian(packet, offset, batch.config.fps);
+                serializeLittleEndian(packet, offset, batch.config.bitrate);
+            }
+        }
+
+        // Records, each field delta-coded against the previous record of the same eye.
+        uint64_t previous[2][FIELD_COUNT]{};
+        uint8_t recordCount = 0;
+        while (next < batch.recordCount && recordCount < UINT8_MAX) {
+            const TelemetryRecord &record = batch.records[next];
+            uint64_t fields[FIELD_COUNT];
+            fields[0] = record.frameId;
+            fields[1] = record.readyUs;
+            std::copy(record.stages, record.stages + TELEMETRY_STAGE_COUNT, fields + 2);
+
+            uint8_t encoded[MAX_RECORD_SIZE];
+            size_t length = 0;
+            encoded[length++] = record.eye;
+            for (size_t i = 0; i < FIELD_COUNT; i++) {
+                length += putZigzagVarint(encoded + length, static_cast<int64_t>(fields[i] - previous[record.eye][i]));
+            }
+            if (offset + length > TELEMETRY_MAX_SIZE) break;
+
+            std::memcpy(packet + offset, encoded, length);
+            offset += length;
+            std::copy(fields, fields + FIELD_COUNT, previous[record.eye]);
+            recordCount++;
+            next++;
+        }
+        packet[recordCountOffset] = recordCount;
+        telemetryPacketSizes_[datagrams++] = offset;
+    } while (next < batch.recordCount && datagrams < MAX_TELEMETRY_DATAGRAMS);
+
+    // Whatever did not fit is reported with the headset-side drops.
+    const uint32_t dropped = batch.recordsDropped + static_cast<uint32_t>(batch.recordCount - next);
+    const uint16_t droppedField = static_cast<uint16_t>(std::min<uint32_t>(dropped, UINT16_MAX));
+    std::memcpy(telemetryPackets_[0].data() + droppedOffset, &droppedField, sizeof(droppedField));
+    return datagrams;
+}
+
+void RobotControlSender::recordSendResult(uint8_t type, bool ok, int error) {
+    if (ok) {
+        if (type == MSG_HEAD_POSE) {
+            if (consecutiveFailures_ > 0) {
+                LOG_INFO("RobotControlSender: Connection recovered after %d failures",
+                         consecutiveFailures_.load());
+            }
+            ++successfulSends_;
         }
-    } else {
         consecutiveFailures_ = 0;
+        return;
     }
-}
 
-void RobotControlSender::sendDebugInfoPacket(const CameraStatsSnapshot &left,
-                                             const CameraStatsSnapshot &right,
-                                             const StreamingConfig &config, uint64_t timestamp) {
-    std::vector<uint8_t> packet;
-    packet.reserve(166);
+    int failures = ++consecutiveFailures_;
+    if (type == MSG_HEAD_POSE) {
+        if (failures == 1) {
+            LOG_ERROR("RobotControlSender: Head pose send failed (errno=%d: %s). "
+                      "Robot may not be receiving head tracking data.",
+                      error, strerror(error));
+        } else if (failures == FAILURE_THRESHOLD) {
+            LOG_ERROR("RobotControlSender: %d consecutive send failures to %s:%d. "
+                      "Check network connection and robot controller status.",
+                      failures, destIpString_.c_str(), Config::SERVO_PORT);
+        }
+    } else if (type == MSG_ROBOT_CONTROL && failures == 1) {
+        LOG_ERROR("RobotControlSender: Robot control send failed (errno=%d: %s). "
+                  "Robot movement commands may not be received.",
+                  error, strerror(error));
+    }
+    // Telemetry failures are less critical, just counted
+}
 
-    // Message type
-    packet.push_back(MSG_DEBUG_INFO);
-
-    // Latency stages: left stream (per-eye-symmetric, representative).
-    serializeLittleEndian(packet, timestamp);
-    serializeLittleEndian(packet, left.frameId);
-    serializeLittleEndian(packet, left.fps);
-
-    serializeLittleEndian(packet, left.camera);
-    serializeLittleEndian(packet, left.vidConv);
-    serializeLittleEndian(packet, left.enc);
-    serializeLittleEndian(packet, left.rtpPay);
-    serializeLittleEndian(packet, left.udpStream);
-    serializeLittleEndian(packet, left.jbHold);
-    serializeLittleEndian(packet, left.rtpDepay);
-    serializeLittleEndian(packet, left.dec);
-    serializeLittleEndian(packet, left.appsink);
-    serializeLittleEndian(packet, left.presentation);
-
-    serializeLittleEndian(packet, ntpTimer_->GetSmoothedOffsetUs());
-    packet.push_back(ntpTimer_->HasInitialOffset() ? 1 : 0);
-    serializeLittleEndian(packet, ntpTimer_->GetTimeSinceLastSyncUs());
-
-    // Streaming config (shared by both eyes).
-    packet.push_back(static_cast<uint8_t>(config.codec));
-    packet.push_back(static_cast<uint8_t>(config.videoMode));
-    serializeLittleEndian(packet, static_cast<uint16_t>(config.resolution.getWidth()));
-    serializeLittleEndian(packet, static_cast<uint16_t>(config.resolution.getHeight()));
-    serializeLittleEndian(packet, static_cast<uint16_t>(config.fps));
-    serializeLittleEndian(packet, static_cast<uint32_t>(config.bitrate));
-
-    // Per-eye network health (right is default-zero in mono).
-    serializeLittleEndian(packet, left.jbNumLost);
-    serializeLittleEndian(packet, left.rtxCount);
-    serializeLittleEndian(packet, left.jitterUs);
-    serializeLittleEndian(packet, left.actualBitrateBps);
-    serializeLittleEndian(packet, right.jbNumLost);
-    serializeLittleEndian(packet, right.rtxCount);
-    serializeLittleEndian(packet, right.jitterUs);
-    serializeLittleEndian(packet, right.actualBitrateBps);
-
-    ssize_t sent = sendto(socket_, packet.data(), packet.size(), 0,
-                          (sockaddr *) &destAddr_, sizeof(destAddr_));
-
-    if (sent < 0) {
-        // Debug info failures are less critical, just increment counter
-        consecutiveFailures_++;
-    } else {
-        consecutiveFailures_ = 0;
+/**
+ * Enqueue-to-wire latency: from the send* call on the posting thread to
+ * sendmmsg() returning on the sender thread. Logged as p50/p99/max and
+ * standard deviation (jitter) once per WIRE_REPORT_INTERVAL_US.
+ */
+void RobotControlSender::recordWireLatency(uint64_t enqueueUs, uint64_t wireUs) {
+    const uint64_t latencyUs = wireUs > enqueueUs ? wireUs - enqueueUs : 0;
+    wireLatency_.add(latencyUs);
+    wireSamples_++;
+    wireSumUs_ += static_cast<double>(latencyUs);
+    wireSumSqUs_ += static_cast<double>(latencyUs) * static_cast<double>(latencyUs);
+
+    if (wireReportStartUs_ == 0) wireReportStartUs_ = wireUs;
+    // The histogram counts are 16-bit; report early rather than overflow them.
+    if (wireUs - wireReportStartUs_ < WIRE_REPORT_INTERVAL_US && wireSamples_ < UINT16_MAX) return;
+
+    const LatencyPercentiles p = wireLatency_.percentiles(wireSamples_);
+    const double mean = wireSumUs_ / static_cast<double>(wireSamples_);
+    const double variance = std::max(0.0, wireSumSqUs_ / static_cast<double>(wireSamples_) - mean * mean);
+    LOG_INFO("RobotControlSender: enqueue-to-wire p50=%u p99=%u max=%u us, jitter=%.1f us "
+             "(%zu datagrams, %.2f per sendmmsg)",
+             p.p50, p.p99, p.max, std::sqrt(variance), wireSamples_,
+             wireBatches_ ? static_cast<double>(wireSamples_) / static_cast<double>(wireBatches_) : 0.0);
+    if (headPoseCoalesced_ > 0) {
+        LOG_INFO("RobotControlSender: %zu head pose samples replaced before sending, %zu of them beyond the "
+                 "%zu-sample history", headPoseCoalesced_, headPoseUnsent_, HEAD_POSE_HISTORY);
     }
+    const size_t batchesReplaced = telemetryBatchesReplaced_.exchange(0, std::memory_order_relaxed);
+    const size_t recordsReplaced = telemetryRecordsReplaced_.exchange(0, std::memory_order_relaxed);
+    if (batchesReplaced > 0) {
+        LOG_INFO("RobotControlSender: %zu telemetry batches replaced before sending, %zu frame records "
+                 "lost (counted in records_dropped)", batchesReplaced, recordsReplaced);
+    }
+
+    wireLatency_.clear();
+    wireSamples_ = 0;
+    wireSumUs_ = 0.0;
+    wireSumSqUs_ = 0.0;
+    wireBatches_ = 0;
+    wireReportStartUs_ = wireUs;
+    headPoseCoalesced_ = 0;
+    headPoseUnsent_ = 0;
 }
 
 /**
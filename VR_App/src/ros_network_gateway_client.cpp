@@ -5,17 +5,29 @@
  * Each UDP packet contains:
  *   [timestamp (double)][compressed (uint8)][topic\0][type\0][payload]
  * Proto messages (schema definitions) are registered automatically; data messages
- * are parsed against their registered schema.
+ * of a registered type go to the RosTopicStore, which keeps the subscribed ones.
+ * Compressed payloads are Zstd frames, decompressed first when built with zstd.
  */
 #include "ros_network_gateway_client.h"
 #include "config.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 #include <unistd.h>
+#if BUT_HAVE_ZSTD
+#include <dirent.h>
+#include <fstream>
+#include <zstd_errors.h>
+#endif
 
-constexpr int BUFFER_SIZE = 65535;  // Max UDP packet size
-constexpr int RESPONSE_TIMEOUT_US = 50000;
+static uint64_t threadCpuNs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + ts.tv_nsec;
+}
 
-RosNetworkGatewayClient::RosNetworkGatewayClient()
-        : socket_(socket(AF_INET, SOCK_DGRAM, 0)), serverAddrLen_(sizeof(serverAddr_)) {
+RosNetworkGatewayClient::RosNetworkGatewayClient(const std::string &dictionaryDir)
+        : socket_(socket(AF_INET, SOCK_DGRAM, 0)) {
 
     if (socket_ < 0) {
         LOG_ERROR("RosNetworkGatewayClient: Socket creation failed (errno=%d: %s). "
@@ -40,6 +52,21 @@ RosNetworkGatewayClient::RosNetworkGatewayClient()
         return;
     }
 
+    arena_.resize(RECV_BATCH * SLOT_SIZE);
+    for (size_t i = 0; i < RECV_BATCH; i++) {
+        iovs_[i] = iovec{arena_.data() + i * SLOT_SIZE, MAX_DATAGRAM};
+        msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+#if BUT_HAVE_ZSTD
+    dctx_ = ZSTD_createDCtx();
+    decompressed_.resize(DECOMPRESS_BUFFER);
+    if (!dictionaryDir.empty()) loadDictionaries(dictionaryDir);
+#else
+    (void) dictionaryDir;
+#endif
+
     isInitialized_ = true;
     running_ = true;
     LOG_INFO("RosNetworkGatewayClient: Listening for ROS messages on port %d",
@@ -50,16 +77,96 @@ RosNetworkGatewayClient::RosNetworkGatewayClient()
 RosNetworkGatewayClient::~RosNetworkGatewayClient() {
     running_ = false;
     if (socket_ >= 0) {
-        shutdown(socket_, SHUT_RDWR);  // Unblock recvfrom
-        close(socket_);
-        socket_ = -1;
+        shutdown(socket_, SHUT_RDWR);  // Unblock recvmmsg
     }
     if (listenerThread_.joinable()) {
         listenerThread_.join();
     }
+    if (socket_ >= 0) {
+        close(socket_);
+        socket_ = -1;
+    }
+#if BUT_HAVE_ZSTD
+    for (auto &[id, dictionary] : dictionaries_) ZSTD_freeDDict(dictionary);
+    ZSTD_freeDCtx(dctx_);
+#endif
+}
+
+#if BUT_HAVE_ZSTD
+/** Load every *.zdict in dictionaryDir, keyed by the dictionary ID the gateway's frames refer to. */
+void RosNetworkGatewayClient::loadDictionaries(const std::string &dictionaryDir) {
+    DIR *dir = opendir(dictionaryDir.c_str());
+    if (!dir) {
+        LOG_INFO("RosNetworkGatewayClient: No Zstd dictionaries (%s not readable)", dictionaryDir.c_str());
+        return;
+    }
+    while (const dirent *entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.size() <= 6 || name.compare(name.size() - 6, 6, ".zdict") != 0) continue;
+        std::ifstream file(dictionaryDir + "/" + name, std::ios::binary);
+        const std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        // Raw-content dictionaries have no ID, so no frame could select them.
+        const unsigned id = ZSTD_getDictID_fromDict(content.data(), content.size());
+        if (id == 0 || dictionaries_.count(id) != 0) {
+            LOG_WARN("RosNetworkGatewayClient: Skipping %s: %s", name.c_str(),
+                     id == 0 ? "not a trained Zstd dictionary" : "dictionary ID already loaded");
+            continue;
+        }
+        ZSTD_DDict *dictionary = ZSTD_createDDict(content.data(), content.size());
+        if (!dictionary) {
+            LOG_WARN("RosNetworkGatewayClient: Skipping %s: ZSTD_createDDict failed", name.c_str());
+            continue;
+        }
+        dictionaries_[id] = dictionary;
+        LOG_INFO("RosNetworkGatewayClient: Loaded Zstd dictionary %s (id %u, %zu bytes)", name.c_str(), id,
+                 content.size());
+    }
+    closedir(dir);
 }
 
-/** Background listener loop. Receives UDP packets and dispatches to schema/parse logic. */
+bool RosNetworkGatewayClient::decompress(const GatewayMessage &message, std::string_view *payload) {
+    const char *src = message.payload.data();
+    const size_t srcSize = message.payload.size();
+    const unsigned long long contentSize = ZSTD_getFrameContentSize(src, srcSize);
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR || (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize > MAX_DECOMPRESSED)) {
+        LOG_DEBUG("ROS Topic: %.*s: not a Zstd frame or too large", (int) message.topic.size(), message.topic.data());
+        return false;
+    }
+    if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize > decompressed_.size()) {
+        decompressed_.resize(contentSize);
+    }
+
+    const ZSTD_DDict *dictionary = nullptr;
+    if (const unsigned id = ZSTD_getDictID_fromFrame(src, srcSize); id != 0) {
+        auto it = dictionaries_.find(id);
+        if (it == dictionaries_.end()) {
+            LOG_DEBUG("ROS Topic: %.*s: compressed with dictionary %u, which is not loaded",
+                      (int) message.topic.size(), message.topic.data(), id);
+            return false;
+        }
+        dictionary = it->second;
+    }
+
+    for (;;) {
+        const size_t size = dictionary
+            ? ZSTD_decompress_usingDDict(dctx_, decompressed_.data(), decompressed_.size(), src, srcSize, dictionary)
+            : ZSTD_decompressDCtx(dctx_, decompressed_.data(), decompressed_.size(), src, srcSize);
+        if (!ZSTD_isError(size)) {
+            *payload = std::string_view(decompressed_.data(), size);
+            return true;
+        }
+        // Only a frame without a content size can outgrow the buffer.
+        if (ZSTD_getErrorCode(size) != ZSTD_error_dstSize_tooSmall || decompressed_.size() >= MAX_DECOMPRESSED) {
+            LOG_DEBUG("ROS Topic: %.*s: decompression failed: %s", (int) message.topic.size(), message.topic.data(),
+                      ZSTD_getErrorName(size));
+            return false;
+        }
+        decompressed_.resize(std::min(decompressed_.size() * 2, MAX_DECOMPRESSED));
+    }
+}
+#endif
+
+/** Background listener loop. Receives batches of UDP packets and dispatches to schema/field logic. */
 void RosNetworkGatewayClient::listenForMessages() {
     if (!isInitialized_) {
         LOG_ERROR("RosNetworkGatewayClient: Listener started without initialization, exiting");
@@ -67,92 +174,147 @@ void RosNetworkGatewayClient::listenForMessages() {
     }
 
     LOG_INFO("RosNetworkGatewayClient: Listener thread started");
+    reportStartUs_ = RosTopicStore::nowUs();
 
     while (running_) {
-        std::vector<uint8_t> buffer(BUFFER_SIZE);
-
-        ssize_t received = recvfrom(socket_, buffer.data(), buffer.size(), 0,
-                                    (sockaddr *) &serverAddr_, &serverAddrLen_);
-
+        for (size_t i = 0; i < RECV_BATCH; i++) {
+            msgs_[i].msg_hdr.msg_name = &senders_[i];
+            msgs_[i].msg_hdr.msg_namelen = sizeof(senders_[i]);
+        }
+        // Blocks for the first datagram, then takes whatever else is already queued.
+        const int received = recvmmsg(socket_, msgs_.data(), RECV_BATCH, MSG_WAITFORONE, nullptr);
         if (received <= 0) {
             if (!running_) break;  // Normal shutdown
             continue;
         }
 
-        buffer.resize(received);
-
-        double timestamp = 0.0;
-        bool compressed = false;
-        std::string topic, type, payload;
+        const uint64_t receivedUs = RosTopicStore::nowUs();
+        const uint64_t cpuStartNs = threadCpuNs();
+        for (int i = 0; i < received; i++) {
+            uint8_t *data = arena_.data() + static_cast<size_t>(i) * SLOT_SIZE;
+            const size_t size = msgs_[i].msg_len;
+            data[size] = '\0';
 
-        if (!parseMessage(buffer, timestamp, compressed, topic, type, payload)) {
-            LOG_ERROR("ROS Topic: Failed to parse ROS message header");
-            continue;
+            GatewayMessage message{};
+            if ((msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) != 0 || !parseMessage(data, size, message)) {
+                reportMalformed_++;
+                LOG_DEBUG("ROS Topic: Failed to parse ROS message header");
+                continue;
+            }
+            handleMessage(message, receivedUs);
         }
+        const uint64_t cpuNs = threadCpuNs() - cpuStartNs;
+        reportCpuNs_ += cpuNs;
+        handleCpuNs_.fetch_add(cpuNs, std::memory_order_relaxed);
 
-        if (compressed) {
-            LOG_ERROR("ROS Topic: Received compressed message but Zstd decompression "
-                      "is not supported in this client. Set compression_level:=0 on the gateway.");
-            continue;
+        if (receivedUs - reportStartUs_ >= REPORT_INTERVAL_US) reportCounters(receivedUs);
+    }
+}
+
+void RosNetworkGatewayClient::handleMessage(const GatewayMessage &received, uint64_t nowUs) {
+    GatewayMessage message = received;
+    if (message.compressed) {
+#if BUT_HAVE_ZSTD
+        if (!decompress(received, &message.payload)) {
+            reportDecompressFailed_++;
+            return;
         }
+        reportCompressed_++;
+        reportCompressedBytes_ += received.payload.size();
+        reportDecompressedBytes_ += message.payload.size();
+#else
+        reportDecompressFailed_++;
+        LOG_ERROR("ROS Topic: Received compressed message but this client was built without Zstd. "
+                  "Set compression_level:=0 on the gateway.");
+        return;
+#endif
+    }
+
+    LOG_DEBUG("ROS Topic: %.*s (%.*s), timestamp: %.3f, %zu bytes",
+              (int) message.topic.size(), message.topic.data(), (int) message.type.size(), message.type.data(),
+              message.timestamp, message.payload.size());
+
+    // Until its schema is in, a type's messages only matter if they are that schema; after, the
+    // key scan is skipped (a repeated proto then just has none of the subscribed fields).
+    if (!schemaRegistry_.hasSchema(message.type)) {
+        schemaRegistry_.registerIfSchema(message.type, message.payload);
+        return;
+    }
+
+    reportMessages_++;
+    messagesHandled_.fetch_add(1, std::memory_order_relaxed);
+    topics_.publish(message.topic, message.timestamp, message.payload, nowUs);
+}
 
-        LOG_DEBUG("ROS Topic: %s (%s), timestamp: %.3f, payload: %s",
-                  topic.c_str(), type.c_str(), timestamp, payload.c_str());
-
-        try {
-            if (schemaRegistry_.registerIfSchema(type, payload)) { continue; };
-            if (!schemaRegistry_.hasSchema(type)) { continue; }
-            auto parsed = schemaRegistry_.buildParsedMessage(type, topic, payload);
-            LOG_INFO("ROS Topic: %s, json: %s", topic.c_str(), parsed.data().dump().c_str());
-            if (parsed.topic() == "/loki_1/chassis/battery_voltage") {
-                LOG_INFO("ROS Topic: %s, data: %f", topic.c_str(), parsed.get<float>("data"));
-            } else if (parsed.topic() == "/loki_1/chassis/clock") {
-                LOG_INFO("ROS Topic: %s, clock sec: %lu", topic.c_str(),
-                         parsed.get<long>("clock.sec"));
+/** One line per REPORT_INTERVAL_US: message rate, CPU per message and the subscribed topics' latest values. */
+void RosNetworkGatewayClient::reportCounters(uint64_t nowUs) {
+    if (reportMessages_ > 0 || reportMalformed_ > 0 || reportDecompressFailed_ > 0) {
+        char values[256];
+        size_t length = 0;
+        values[0] = '\0';
+        for (size_t i = 0; i < topics_.size() && length < sizeof(values); i++) {
+            const int index = static_cast<int>(i);
+            const RosTopicSnapshot latest = topics_.load(index);
+            if (latest.messages == 0) continue;
+            length += snprintf(values + length, sizeof(values) - length, " %s %.1f Hz",
+                               topics_.topic(index).c_str(), latest.rateHz);
+            const auto &fields = topics_.fields(index);
+            for (size_t f = 0; f < fields.size() && length < sizeof(values); f++) {
+                const RosFieldValue &value = latest.fields[f];
+                if (!value.valid) continue;
+                length += fields[f].type == RosFieldType::String
+                    ? snprintf(values + length, sizeof(values) - length, " %s=%s", fields[f].path.c_str(), value.text)
+                    : snprintf(values + length, sizeof(values) - length, " %s=%g", fields[f].path.c_str(), value.number);
             }
-        } catch (const std::exception &e) {
-            LOG_ERROR("ROS Topic: Failed to parse ROS message payload: %s", e.what());
         }
-
-        buffer.resize(BUFFER_SIZE); // reset for next packet
+        const double seconds = static_cast<double>(nowUs - reportStartUs_) / 1e6;
+        LOG_INFO("RosNetworkGatewayClient: %.1f msg/s, %.1f us CPU/msg, %zu malformed, "
+                 "%zu compressed (ratio %.2f), %zu undecompressible;%s",
+                 static_cast<double>(reportMessages_) / seconds,
+                 reportMessages_ ? static_cast<double>(reportCpuNs_) / 1000.0 / static_cast<double>(reportMessages_)
+                                 : 0.0,
+                 reportMalformed_, reportCompressed_,
+                 reportCompressedBytes_ ? static_cast<double>(reportDecompressedBytes_) /
+                                          static_cast<double>(reportCompressedBytes_) : 0.0,
+                 reportDecompressFailed_, values);
     }
-};
+    reportStartUs_ = nowUs;
+    reportMessages_ = 0;
+    reportMalformed_ = 0;
+    reportCompressed_ = 0;
+    reportCompressedBytes_ = 0;
+    reportDecompressedBytes_ = 0;
+    reportDecompressFailed_ = 0;
+    reportCpuNs_ = 0;
+}
 
-/**
- * Parse the binary message header:
- *   [timestamp(double)][compressed(uint8)][topic\0][type\0][payload]
- * Returns false if the buffer is too small or missing null terminators.
- */
-bool RosNetworkGatewayClient::parseMessage(const std::vector<uint8_t> &buffer,
-                                           double &timestamp,
-                                           bool &compressed,
-                                           std::string &topic,
-                                           std::string &type,
-                                           std::string &payload) {
+bool RosNetworkGatewayClient::parseMessage(const uint8_t *data, size_t size, GatewayMessage &message) {
     // Minimum: 8 (timestamp) + 1 (compressed) + 1 (topic) + 1 (\0) + 1 (type) + 1 (\0)
-    if (buffer.size() < sizeof(double) + 1 + 4)
+    if (size < sizeof(double) + 1 + 4)
         return false;
 
-    std::memcpy(&timestamp, buffer.data(), sizeof(double));
+    std::memcpy(&message.timestamp, data, sizeof(double));
     size_t pos = sizeof(double);
 
     // Compression flag byte
-    compressed = buffer[pos] != 0;
+    message.compressed = data[pos] != 0;
     pos += 1;
 
+    const char *text = reinterpret_cast<const char *>(data);
+
     // Find first null (topic)
-    auto topic_end = std::find(buffer.begin() + pos, buffer.end(), '\0');
-    if (topic_end == buffer.end()) return false;
-    topic.assign(reinterpret_cast<const char *>(&buffer[pos]), topic_end - (buffer.begin() + pos));
-    pos = (topic_end - buffer.begin()) + 1;
+    const void *topicEnd = std::memchr(text + pos, '\0', size - pos);
+    if (!topicEnd) return false;
+    message.topic = std::string_view(text + pos, static_cast<const char *>(topicEnd) - (text + pos));
+    pos += message.topic.size() + 1;
 
     // Find second null (type)
-    auto type_end = std::find(buffer.begin() + pos, buffer.end(), '\0');
-    if (type_end == buffer.end()) return false;
-    type.assign(reinterpret_cast<const char *>(&buffer[pos]), type_end - (buffer.begin() + pos));
-    pos = (type_end - buffer.begin()) + 1;
+    const void *typeEnd = std::memchr(text + pos, '\0', size - pos);
+    if (!typeEnd) return false;
+    message.type = std::string_view(text + pos, static_cast<const char *>(typeEnd) - (text + pos));
+    pos += message.type.size() + 1;
 
     // Rest is payload (JSON string or compressed bytes)
-    payload.assign(reinterpret_cast<const char *>(&buffer[pos]), buffer.size() - pos);
+    message.payload = std::string_view(text + pos, size - pos);
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,229 @@
+/**
+ * ros_topic_store.cpp - JSON field paths and the per-topic latest-value store
+ *
+ * JsonFieldPath walks the payload text with a minimal scanner (skip a string,
+ * skip a value, find a key in an object) that trusts the gateway to send
+ * well-formed JSON and only guards against running off the end of it.
+ * RosTopicStore::publish runs on the gateway listener thread.
+ */
+#include "ros_topic_store.h"
+#include "log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+
+namespace {
+
+size_t skipWhitespace(std::string_view s, size_t pos) {
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) pos++;
+    return pos;
+}
+
+/** pos is at the opening quote; returns the offset after the closing one, or npos. */
+size_t skipString(std::string_view s, size_t pos) {
+    for (pos++; pos < s.size(); pos++) {
+        if (s[pos] == '\\') {
+            pos++;
+        } else if (s[pos] == '"') {
+            return pos + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+/** pos is at the first character of a value; returns the offset just after it, or npos. */
+size_t skipValue(std::string_view s, size_t pos) {
+    if (pos >= s.size()) return std::string_view::npos;
+    if (s[pos] == '"') return skipString(s, pos);
+    if (s[pos] != '{' && s[pos] != '[') {
+        // Number or literal: runs up to the next delimiter.
+        while (pos < s.size() && s[pos] != ',' && s[pos] != '}' && s[pos] != ']' &&
+               s[pos] != ' ' && s[pos] != '\t' && s[pos] != '\n' && s[pos] != '\r') {
+            pos++;
+        }
+        return pos;
+    }
+    int depth = 0;
+    while (pos < s.size()) {
+        const char c = s[pos];
+        if (c == '"') {
+            pos = skipString(s, pos);
+            if (pos == std::string_view::npos) return pos;
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) return pos + 1;
+        }
+        pos++;
+    }
+    return std::string_view::npos;
+}
+
+/** pos is at '{'; returns the offset of the value of key in that object, or npos. */
+size_t findKey(std::string_view s, size_t pos, std::string_view key) {
+    pos = skipWhitespace(s, pos + 1);
+    while (pos < s.size() && s[pos] == '"') {
+        const size_t keyEnd = skipString(s, pos);
+        if (keyEnd == std::string_view::npos) return keyEnd;
+        const std::string_view name = s.substr(pos + 1, keyEnd - pos - 2);
+        pos = skipWhitespace(s, keyEnd);
+        if (pos >= s.size() || s[pos] != ':') return std::string_view::npos;
+        pos = skipWhitespace(s, pos + 1);
+        if (name == key) return pos;
+        pos = skipWhitespace(s, skipValue(s, pos));
+        if (pos >= s.size() || s[pos] != ',') return std::string_view::npos;
+        pos = skipWhitespace(s, pos + 1);
+    }
+    return std::string_view::npos;
+}
+
+/** Step into arrays to their first element; npos if one is empty. */
+size_t unwrapArrays(std::string_view s, size_t pos) {
+    while (pos < s.size() && s[pos] == '[') {
+        pos = skipWhitespace(s, pos + 1);
+        if (pos >= s.size() || s[pos] == ']') return std::string_view::npos;
+    }
+    return pos;
+}
+
+}  // namespace
+
+JsonFieldPath::JsonFieldPath(const std::string &path) : path_(path) {
+    size_t start = 0;
+    while (start <= path.size()) {
+        const size_t dot = std::min(path.find('.', start), path.size());
+        keys_.emplace_back(path, start, dot - start);
+        start = dot + 1;
+    }
+}
+
+size_t JsonFieldPath::locate(std::string_view json) const {
+    size_t pos = skipWhitespace(json, 0);
+    for (const std::string &key : keys_) {
+        pos = unwrapArrays(json, pos);
+        if (pos >= json.size() || json[pos] != '{') return std::string_view::npos;
+        pos = findKey(json, pos, key);
+        if (pos >= json.size()) return std::string_view::npos;
+    }
+    pos = unwrapArrays(json, pos);
+    return pos < json.size() ? pos : std::string_view::npos;
+}
+
+bool JsonFieldPath::extractNumber(std::string_view json, double *value) const {
+    const size_t pos = locate(json);
+    if (pos == std::string_view::npos) return false;
+    if (json.compare(pos, 4, "true") == 0 || json.compare(pos, 5, "false") == 0) {
+        *value = json[pos] == 't' ? 1.0 : 0.0;
+        return true;
+    }
+    // strtod needs a terminated string; a JSON number is a short token.
+    char token[40];
+    const size_t end = skipValue(json, pos);
+    if (end == std::string_view::npos || end - pos >= sizeof(token)) return false;
+    std::memcpy(token, json.data() + pos, end - pos);
+    token[end - pos] = '\0';
+    char *parsedEnd = nullptr;
+    const double parsed = std::strtod(token, &parsedEnd);
+    if (parsedEnd == token || *parsedEnd != '\0') return false;
+    *value = parsed;
+    return true;
+}
+
+bool JsonFieldPath::extractString(std::string_view json, std::string_view *value) const {
+    const size_t pos = locate(json);
+    if (pos == std::string_view::npos || json[pos] != '"') return false;
+    const size_t end = skipString(json, pos);
+    if (end == std::string_view::npos) return false;
+    *value = json.substr(pos + 1, end - pos - 2);
+    return true;
+}
+
+int RosTopicStore::subscribe(const std::string &topic, const std::vector<Field> &fields) {
+    std::lock_guard<std::mutex> lock(subscribeMutex_);
+    const size_t count = count_.load(std::memory_order_relaxed);
+    if (count == MAX_TOPICS || fields.size() > RosTopicSnapshot::MAX_FIELDS || find(topic) >= 0) {
+        LOG_ERROR("RosTopicStore: Cannot subscribe to %s (%zu fields, %zu topics subscribed)", topic.c_str(),
+                  fields.size(), count);
+        return -1;
+    }
+    // The slot is past count_, so the listener does not look at it until count_ is released below.
+    Topic &slot = topics_[count];
+    slot.name = topic;
+    slot.hash = std::hash<std::string_view>{}(topic);
+    slot.fields = fields;
+    for (const Field &field : fields) slot.paths.emplace_back(field.path);
+    count_.store(count + 1, std::memory_order_release);
+    LOG_INFO("RosTopicStore: Subscribed to %s (%zu fields)", topic.c_str(), fields.size());
+    return static_cast<int>(count);
+}
+
+int RosTopicStore::find(std::string_view topic) const {
+    const size_t hash = std::hash<std::string_view>{}(topic);
+    const size_t count = size();
+    for (size_t i = 0; i < count; i++) {
+        if (topics_[i].hash == hash && topics_[i].name == topic) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool RosTopicStore::publish(std::string_view topic, double gatewayStamp, std::string_view payload, uint64_t nowUs) {
+    const int index = find(topic);
+    if (index < 0) return false;
+    Topic &slot = topics_[index];
+
+    // Rate = arrivals after the one that opened the window, over the time since it.
+    float rateHz = -1.0f;  // < 0: window still open, keep the last rate
+    if (slot.windowStartUs == 0) {
+        slot.windowStartUs = nowUs;
+    } else {
+        slot.windowMessages++;
+    }
+    if (nowUs - slot.windowStartUs >= RATE_WINDOW_US) {
+        rateHz = static_cast<float>(slot.windowMessages * 1e6 / static_cast<double>(nowUs - slot.windowStartUs));
+        slot.windowStartUs = nowUs;
+        slot.windowMessages = 0;
+    }
+
+    // Extract before taking the sequence, so readers only ever retry over a copy.
+    RosFieldValue values[RosTopicSnapshot::MAX_FIELDS]{};
+    for (size_t i = 0; i < slot.paths.size(); i++) {
+        RosFieldValue &value = values[i];
+        switch (slot.fields[i].type) {
+            case RosFieldType::Number:
+            case RosFieldType::Bool:
+                value.valid = slot.paths[i].extractNumber(payload, &value.number);
+                break;
+            case RosFieldType::String: {
+                std::string_view text;
+                value.valid = slot.paths[i].extractString(payload, &text);
+                const size_t length = std::min(text.size(), sizeof(value.text) - 1);
+                std::memcpy(value.text, text.data(), length);
+                value.text[length] = '\0';
+                break;
+            }
+        }
+        if (!value.valid) {
+            LOG_DEBUG("RosTopicStore: %s has no field '%s' of the subscribed type", slot.name.c_str(),
+                      slot.paths[i].path().c_str());
+        }
+    }
+
+    slot.latest.update([&](RosTopicSnapshot &latest) {
+        latest.messages++;
+        latest.lastReceiveUs = nowUs;
+        latest.gatewayStamp = gatewayStamp;
+        if (rateHz >= 0.0f) latest.rateHz = rateHz;
+        std::memcpy(latest.fields, values, sizeof(values));
+    });
+    return true;
+}
+
+uint64_t RosTopicStore::nowUs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000ULL + ts.tv_nsec / 1000;
+}
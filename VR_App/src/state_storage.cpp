@@ -57,6 +57,11 @@ void StateStorage::SaveAppState(const AppState &appState) {
         SaveKeyValuePair(editor, putString, "head_movement_speed_multiplier", appState.headMovementSpeedMultiplier * 10); // To build around integer formatting
         SaveKeyValuePair(editor, putString, "robot_control_enabled", appState.robotControlEnabled);
         SaveKeyValuePair(editor, putString, "stereo_convergence", static_cast<int>(appState.stereoConvergence * 1000)); // scaled to survive integer formatting
+        SaveKeyValuePair(editor, putString, "camera_pose_reprojection", appState.cameraPoseReprojection);
+        SaveKeyValuePair(editor, putString, "head_pose_rate_hz", appState.headPoseRateHz);
+        SaveKeyValuePair(editor, putString, "telemetry_interval_ms", appState.telemetryIntervalMs);
+        SaveKeyValuePair(editor, putString, "presentation_mode", static_cast<int>(appState.presentationMode));
+        SaveKeyValuePair(editor, putString, "max_frame_age_ms", appState.streamingConfig.maxFrameAgeMs);
     }
 
 
@@ -120,6 +125,11 @@ void StateStorage::LoadAppState(AppState& appState) {
         appState.headMovementSpeedMultiplier = std::stof(LoadValue(sharedPreferences, getString, "head_movement_speed_multiplier") ) / 10.0f; // To build around integer formatting
         appState.robotControlEnabled = std::stoi(LoadValue(sharedPreferences, getString, "robot_control_enabled"));
         appState.stereoConvergence = std::stof(LoadValue(sharedPreferences, getString, "stereo_convergence")) / 1000.0f;
+        appState.cameraPoseReprojection = std::stoi(LoadValue(sharedPreferences, getString, "camera_pose_reprojection"));
+        appState.headPoseRateHz = std::stoi(LoadValue(sharedPreferences, getString, "head_pose_rate_hz"));
+        appState.telemetryIntervalMs = std::stoi(LoadValue(sharedPreferences, getString, "telemetry_interval_ms"));
+        appState.presentationMode = static_cast<PresentationMode>(std::stoi(LoadValue(sharedPreferences, getString, "presentation_mode")));
+        appState.streamingConfig.maxFrameAgeMs = std::stoi(LoadValue(sharedPreferences, getString, "max_frame_age_ms"));
 
     } catch(const std::exception& e) {
         // Parse failure: leave appState as the caller's default-constructed state.
@@ -434,7 +434,44 @@ openxr_create_swapchains(XrInstance *instance, XrSystemId *system_id, XrSession
     return viewsurfaces;
 }
 
-void openxr_allocate_swapchain_rendertargets(viewsurface_t &viewsurface) {
+viewsurface_t openxr_create_layer_swapchain(XrSession *session, uint32_t width, uint32_t height) {
+    LOG_INFO("Creating layer swapchain with dimensions Width=%u Height=%u", width, height);
+
+    XrSwapchainCreateInfo swapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    swapchainCreateInfo.arraySize = 1;
+    swapchainCreateInfo.format = GL_RGBA8;
+    swapchainCreateInfo.width = width;
+    swapchainCreateInfo.height = height;
+    swapchainCreateInfo.mipCount = 1;
+    swapchainCreateInfo.faceCount = 1;
+    swapchainCreateInfo.sampleCount = 1;
+    swapchainCreateInfo.usageFlags =
+            XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
+
+    viewsurface_t viewsurface{};
+    viewsurface.width = width;
+    viewsurface.height = height;
+    CHECK_XRCMD(xrCreateSwapchain(*session, &swapchainCreateInfo, &viewsurface.swapchain))
+    openxr_allocate_swapchain_rendertargets(viewsurface, false);
+    return viewsurface;
+}
+
+void openxr_destroy_viewsurface(viewsurface_t &viewsurface) {
+    for (render_target_t &rtarget: viewsurface.render_targets) {
+        glDeleteFramebuffers(1, &rtarget.fbo_id);
+        if (rtarget.texz_id != 0) {
+            glDeleteTextures(1, &rtarget.texz_id);
+        }
+    }
+    viewsurface.render_targets.clear();
+    if (viewsurface.swapchain != XR_NULL_HANDLE) {
+        CHECK_XRCMD(xrDestroySwapchain(viewsurface.swapchain))
+        viewsurface.swapchain = XR_NULL_HANDLE;
+    }
+    viewsurface.width = viewsurface.height = 0;
+}
+
+void openxr_allocate_swapchain_rendertargets(viewsurface_t &viewsurface, bool withDepth) {
     uint32_t imageCount;
     CHECK_XRCMD(xrEnumerateSwapchainImages(viewsurface.swapchain, 0, &imageCount, nullptr))
     auto *swapchain_images = (XrSwapchainImageOpenGLESKHR *) calloc(
@@ -459,14 +496,16 @@ void openxr_allocate_swapchain_rendertargets(viewsurface_t &viewsurface) {
         glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
         glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
 
-        glGenTextures(1, &tex_z);
-        glBindTexture(GL_TEXTURE_2D, tex_z);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT,
-                     GL_UNSIGNED_INT, nullptr);
+        if (withDepth) {
+            glGenTextures(1, &tex_z);
+            glBindTexture(GL_TEXTURE_2D, tex_z);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT,
+                         GL_UNSIGNED_INT, nullptr);
+        }
 
         render_target_t rtarget;
         rtarget.texc_id = tex_c;
@@ -816,9 +855,16 @@ int openxr_begin_frame(XrSession *session, XrTime *display_time) {
     {
         struct timespec ts{};
         clock_gettime(CLOCK_MONOTONIC, &ts);
-        XrTiming::renderCycleStartMonotonicNs.store(
-            static_cast<int64_t>(ts.tv_sec) * 1'000'000'000LL + ts.tv_nsec,
-            std::memory_order_relaxed);
+        const int64_t now_ns = static_cast<int64_t>(ts.tv_sec) * 1'000'000'000LL + ts.tv_nsec;
+        XrTiming::renderCycleStartMonotonicNs.store(now_ns, std::memory_order_relaxed);
+
+        // Display lead, smoothed like the RFC 3550 jitter estimate. Bounded so a
+        // stalled frame (e.g. session resume) cannot throw the head pose far ahead.
+        const int64_t lead_ns = std::clamp<int64_t>(
+                static_cast<int64_t>(frameState.predictedDisplayTime) - now_ns, 0, 100'000'000);
+        const int64_t prev_ns = XrTiming::displayLeadNs.load(std::memory_order_relaxed);
+        XrTiming::displayLeadNs.store(prev_ns == 0 ? lead_ns : prev_ns + (lead_ns - prev_ns) / 16,
+                                      std::memory_order_relaxed);
     }
 
     XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
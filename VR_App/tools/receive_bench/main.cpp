@@ -0,0 +1,1222 @@
+/**
+ * receive_bench - Linux harness for the headset receive pipeline
+ *
+ * Runs ReceivePipeline (LinuxMemory backend) against a live streaming driver
+ * and prints the per-stage receive latencies from CameraStats once a second,
+ * so jitterbuffer/depay/decode changes can be measured without a headset.
+ *
+ *   receive_bench [--codec JPEG|H264|H265] [--width W] [--height H] [--fps N]
+ *                 [--mono] [--ntp HOST] [--duration SECONDS] [--jb-min MS] [--jb-max MS]
+ *                 [--jpeg-decoder parallel|stock] [--decode-threads N]
+ *   receive_bench --probe-overhead ITERATIONS
+ *   receive_bench --jpeg-decode-bench FRAMES [--decode-threads N]
+ *   receive_bench --stats-contention ITERATIONS
+ *   receive_bench --ros-gateway-bench MESSAGES
+ *   receive_bench --ros-zstd-bench MESSAGES [--ros-pcap FILE]
+ *
+ * --probe-overhead needs no stream: it times the post-jitterbuffer handoff
+ * on a synthetic RTP buffer, with and without the per-packet element-name
+ * lookups and jitterbuffer "stats" read the handoff used to do.
+ *
+ * --jpeg-decode-bench needs no stream either: for every CameraResolution it
+ * encodes a synthetic frame like the driver does (4:2:0, restart marker every
+ * MCU row) and times stock jpegdec (appsrc ! jpegparse ! jpegdec ! I420 !
+ * appsink, one frame in flight) against JpegDecoder on one thread and on the
+ * pool.
+ *
+ * --stats-contention needs no stream: one thread per CameraStats writer
+ * hammers its fields while a reader takes snapshots, once on the old layout
+ * (one atomic per field, every probe thread writing its own latency stage)
+ * and once on the SeqLock blocks (stages published as one complete frame
+ * record). Writer n stands for frame n; reports the writers' cost per update
+ * and how many snapshots mixed two frames.
+ *
+ * --ros-gateway-bench needs no robot: it builds a synthetic gateway stream
+ * (schemas, then battery voltage, clock and a ~1.5 kB diagnostics message in
+ * turn) and times the old per-datagram path (64 KiB vector, string copies,
+ * two nlohmann parses, dump() and a stringstream path walk) against
+ * RosNetworkGatewayClient's in-place one on a single thread, then sends the
+ * stream to a live client over loopback and reads back its message rate and
+ * CPU per message, while another thread reads the topic store throughout.
+ *
+ * --ros-zstd-bench takes the gateway traffic recorded in a pcap (--ros-pcap,
+ * see readGatewayPcap) or a synthetic stream of MESSAGES varying messages,
+ * trains a Zstd dictionary per topic on the first half and compresses the
+ * second half at levels 1/3/9/19, with and without the dictionaries. Reports
+ * bytes per message on the wire, the gateway's compression time, and
+ * decompression time with a persistent context (as the client does) against a
+ * fresh context per message; then sends the stream plain and at level 3 to a
+ * live client over loopback and compares its CPU per message.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gst/rtp/rtp.h>
+#include <jpeglib.h>
+#include <sstream>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "receive_pipeline.h"
+#include "ros_network_gateway_client.h"
+#if BUT_HAVE_ZSTD
+#include <zdict.h>
+#endif
+#include "jpeg_decoder.h"
+#include "config.h"
+#include "log.h"
+
+struct BenchArgs {
+    Codec codec = Codec::JPEG;
+    int width = 1920;
+    int height = 1080;
+    int fps = 60;
+    bool mono = false;
+    std::string ntpServer = "10.0.31.42";  // Config::DEFAULT_JETSON_IP
+    int durationS = 0;  // 0 = until interrupted
+    int jbLatencyMinMs = 5;
+    int jbLatencyMaxMs = 60;
+    int probeOverheadIterations = 0;  // > 0 = run the probe microbenchmark and exit
+    bool parallelJpeg = BUT_PARALLEL_JPEG_DECODE;
+    int decodeThreads = 3;            // JpegDecoder pool size (GstreamerPlayer::JPEG_DECODE_THREADS)
+    int jpegBenchFrames = 0;          // > 0 = run the JPEG decode benchmark and exit
+    int statsContentionIterations = 0;  // > 0 = run the CameraStats contention benchmark and exit
+    int rosGatewayMessages = 0;         // > 0 = run the ROS gateway receive benchmark and exit
+    int rosZstdMessages = 0;            // > 0 = run the ROS gateway compression benchmark and exit
+    std::string rosPcap;                // recorded gateway traffic for --ros-zstd-bench
+};
+
+static Codec parseCodec(const std::string &name) {
+    for (int i = 0; i < static_cast<int>(Codec::Count); i++) {
+        if (CodecToString(static_cast<Codec>(i)) == name) return static_cast<Codec>(i);
+    }
+    std::cerr << "Unknown codec: " << name << std::endl;
+    std::exit(1);
+}
+
+static BenchArgs parseArgs(int argc, char **argv) {
+    BenchArgs args;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char *next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--mono") {
+            args.mono = true;
+        } else if (next && arg == "--codec") {
+            args.codec = parseCodec(next); i++;
+        } else if (next && arg == "--width") {
+            args.width = std::atoi(next); i++;
+        } else if (next && arg == "--height") {
+            args.height = std::atoi(next); i++;
+        } else if (next && arg == "--fps") {
+            args.fps = std::atoi(next); i++;
+        } else if (next && arg == "--ntp") {
+            args.ntpServer = next; i++;
+        } else if (next && arg == "--duration") {
+            args.durationS = std::atoi(next); i++;
+        } else if (next && arg == "--jb-min") {
+            args.jbLatencyMinMs = std::atoi(next); i++;
+        } else if (next && arg == "--jb-max") {
+            args.jbLatencyMaxMs = std::atoi(next); i++;
+        } else if (next && arg == "--probe-overhead") {
+            args.probeOverheadIterations = std::atoi(next); i++;
+        } else if (next && arg == "--jpeg-decoder") {
+            const std::string mode = next;
+            if (mode != "parallel" && mode != "stock") {
+                std::cerr << "Unknown JPEG decoder: " << mode << std::endl;
+                std::exit(1);
+            }
+            args.parallelJpeg = mode == "parallel"; i++;
+        } else if (next && arg == "--decode-threads") {
+            args.decodeThreads = std::atoi(next); i++;
+        } else if (next && arg == "--jpeg-decode-bench") {
+            args.jpegBenchFrames = std::atoi(next); i++;
+        } else if (next && arg == "--stats-contention") {
+            args.statsContentionIterations = std::atoi(next); i++;
+        } else if (next && arg == "--ros-gateway-bench") {
+            args.rosGatewayMessages = std::atoi(next); i++;
+        } else if (next && arg == "--ros-zstd-bench") {
+            args.rosZstdMessages = std::atoi(next); i++;
+        } else if (next && arg == "--ros-pcap") {
+            args.rosPcap = next; i++;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            std::exit(1);
+        }
+    }
+    return args;
+}
+
+/** Appsink "new-sample": same bookkeeping as the headset, pixels are only mapped and dropped. */
+static GstFlowReturn onNewSample(GstElement *sink, ReceiveCallbackObj *callbackObj) {
+    GstSample *sample = nullptr;
+    g_signal_emit_by_name(sink, "pull-sample", &sample);
+    if (!sample) {
+        return GST_FLOW_ERROR;
+    }
+
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    GstCaps *caps = gst_sample_get_caps(sample);
+    if (caps && gst_structure_has_name(gst_caps_get_structure(caps, 0), "image/jpeg")) {
+        JpegDecoder *decoder = nullptr;
+        ReceivePipeline::decodeJpegSample(sink, buffer, callbackObj, &decoder);
+    }
+    uint64_t foveaRect = 0;
+    uint64_t cameraPose = 0;
+    CameraFrame &frame = ReceivePipeline::onSample(sink, buffer, callbackObj, &foveaRect, &cameraPose);
+
+    // No display here: the frame's record completes on delivery, with a zero presentation stage.
+    const SinkStats delivered = frame.stats->sink.load();
+    if (delivered.hasFrameId) {
+        frame.stats->presentFrame(delivered.frameId, 0, callbackObj->windowFrames);
+    }
+
+    GstMapInfo mapInfo{};
+    if (gst_buffer_map(buffer, &mapInfo, GST_MAP_READ)) {
+        if (foveaRect != 0) frame.foveaRect = foveaRect;
+        FrameSlot &slot = frame.slots[frame.mailbox.backSlot()];
+        slot.isTexture = false;
+        slot.foveaRect = frame.foveaRect;
+        slot.cameraPose = cameraPose;
+        frame.mailbox.publish();
+        gst_buffer_unmap(buffer, &mapInfo);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+static GstElement *buildPipeline(const BenchArgs &args, const std::string &description, const char *eye,
+                                 int port, ReceiveCallbackObj *callbackObj, CameraStats *stats,
+                                 std::vector<GSource *> &samplers) {
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(description.c_str(), &error);
+    if (error) {
+        LOG_ERROR("Unable to build %s pipeline: %s", eye, error->message);
+        g_error_free(error);
+        std::exit(1);
+    }
+
+    ReceivePipeline::configureSource(pipeline, eye, port, args.codec, args.width, args.height, args.fps);
+    ReceivePipeline::connectProbes(pipeline, callbackObj, stats, eye);
+    if (GSource *sampler = ReceivePipeline::attachJitterBufferSampler(pipeline, callbackObj, stats, nullptr)) {
+        samplers.push_back(sampler);
+    }
+
+    GstElement *appsink = ReceivePipeline::getElementRequired(pipeline, "appsink", eye);
+    g_signal_connect(G_OBJECT(appsink), "new-sample", (GCallback) onNewSample, callbackObj);
+    gst_object_unref(appsink);
+
+    // onSample() resolves the eye from the root pipeline name.
+    const std::string fullName = std::string("pipeline_") + eye;
+    gst_element_set_name(pipeline, fullName.c_str());
+    return pipeline;
+}
+
+static void printStats(const char *eye, const CameraStats *stats) {
+    const CameraStatsSnapshot s = stats->averagedSnapshot();
+    const LatencyPercentiles total = s.stagePercentiles(LatencyStage::Total);
+    std::cout << eye << " fps=" << s.fps
+              << " udp=" << s.udpStream << " jb=" << s.jbHold << " depay=" << s.rtpDepay
+              << " dec=" << s.dec << " queue=" << s.queue << " appsink=" << s.appsink
+              << " total=" << s.totalLatency << " (p95=" << total.p95 << " p99=" << total.p99
+              << " max=" << total.max << ") us, jb latency=" << s.jbLatencyMs
+              << " ms, frame=" << s.frameId
+              << " pkts=" << s.packetsPerFrame << std::endl;
+}
+
+struct BenchContext {
+    CamPair *camPair;
+    bool mono;
+    int remainingS;
+    GMainLoop *loop;
+};
+
+static gboolean onReportTick(gpointer data) {
+    auto *ctx = static_cast<BenchContext *>(data);
+    printStats("left ", ctx->camPair->first.stats);
+    if (!ctx->mono) printStats("right", ctx->camPair->second.stats);
+    if (ctx->remainingS > 0 && --ctx->remainingS == 0) {
+        g_main_loop_quit(ctx->loop);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+/**
+ * Time onIdentityHandoff(postjb) per packet. "before" adds back exactly the
+ * per-packet work the handoff did prior to per-probe contexts: two
+ * std::string name comparisons, gst_bin_get_by_name("jitterbuffer") and a
+ * "stats" GstStructure read/free.
+ */
+static void runProbeOverheadBench(const std::string &description, ReceiveCallbackObj *callbackObj,
+                                  CameraStats *stats, int iterations) {
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(description.c_str(), &error);
+    if (error) {
+        LOG_ERROR("Unable to build pipeline: %s", error->message);
+        g_error_free(error);
+        std::exit(1);
+    }
+    gst_element_set_name(pipeline, "pipeline_left");
+    GstElement *identity = ReceivePipeline::getElementRequired(pipeline, "postjb_ident", "bench");
+    ProbeContext ctx{callbackObj, stats, ProbeStage::PostJitterBuffer, "left"};
+
+    GstBuffer *buffer = gst_rtp_buffer_new_allocate(0, 0, 0);
+    auto runPass = [&](bool legacyLookups) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            GST_BUFFER_PTS(buffer) = static_cast<GstClockTime>(i + 1) * GST_MSECOND;
+            if (legacyLookups) {
+                GstObject *parent = GST_OBJECT_PARENT(identity);
+                volatile bool isLeft = std::string(GST_OBJECT_NAME(parent)) == "pipeline_left";
+                volatile bool isPostJb = std::string(GST_OBJECT_NAME(identity)) == "postjb_ident";
+                (void) isLeft;
+                (void) isPostJb;
+                GstElement *jb = gst_bin_get_by_name(GST_BIN(parent), "jitterbuffer");
+                GstStructure *jbStats = nullptr;
+                g_object_get(jb, "stats", &jbStats, NULL);
+                guint64 lost = 0;
+                gst_structure_get_uint64(jbStats, "num-lost", &lost);
+                gst_structure_free(jbStats);
+                gst_object_unref(jb);
+            }
+            ReceivePipeline::onIdentityHandoff(identity, buffer, &ctx);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    };
+
+    runPass(false);  // warm-up
+    const double before = runPass(true);
+    const double after = runPass(false);
+    std::cout << "postjb handoff per packet: before=" << before << " ns, after=" << after
+              << " ns, saved=" << (before - after) << " ns (" << iterations << " iterations)" << std::endl;
+
+    gst_buffer_unref(buffer);
+    gst_object_unref(identity);
+    gst_object_unref(pipeline);
+}
+
+/** Synthetic camera-like frame (gradients + noise) as a driver-style JPEG: 4:2:0, RST every MCU row. */
+static std::vector<uint8_t> encodeTestFrame(int width, int height) {
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    std::mt19937 rng(42);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t *px = &rgb[(static_cast<size_t>(y) * width + x) * 3];
+            px[0] = static_cast<uint8_t>(x * 255 / width);
+            px[1] = static_cast<uint8_t>(y * 255 / height);
+            px[2] = static_cast<uint8_t>((rng() & 31) + (((x / 24) ^ (y / 24)) & 1) * 160);
+        }
+    }
+
+    jpeg_compress_struct cinfo{};
+    jpeg_error_mgr err{};
+    cinfo.err = jpeg_std_error(&err);
+    jpeg_create_compress(&cinfo);
+    unsigned char *out = nullptr;
+    unsigned long outSize = 0;
+    jpeg_mem_dest(&cinfo, &out, &outSize);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 85, TRUE);
+    cinfo.restart_in_rows = 1;
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = &rgb[static_cast<size_t>(cinfo.next_scanline) * width * 3];
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    std::vector<uint8_t> jpeg(out, out + outSize);
+    free(out);
+    return jpeg;
+}
+
+/** Mean per-frame decode time through stock jpegdec, one frame in flight (push, then pull). */
+static double timeStockJpegdec(const std::vector<uint8_t> &jpeg, int width, int height, int frames) {
+    const std::string description =
+        "appsrc name=src caps=\"image/jpeg,width=" + std::to_string(width) + ",height=" + std::to_string(height) +
+        ",framerate=0/1\" ! jpegparse ! jpegdec ! videoconvert ! video/x-raw,format=I420"
+        " ! appsink name=sink sync=false";
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(description.c_str(), &error);
+    if (error) {
+        LOG_ERROR("Unable to build jpegdec pipeline: %s", error->message);
+        g_error_free(error);
+        std::exit(1);
+    }
+    GstElement *src = ReceivePipeline::getElementRequired(pipeline, "src", "jpegdec bench");
+    GstElement *sink = ReceivePipeline::getElementRequired(pipeline, "sink", "jpegdec bench");
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    auto pushPull = [&](int i) {
+        GstBuffer *buffer = gst_buffer_new_memdup(jpeg.data(), jpeg.size());
+        GST_BUFFER_PTS(buffer) = static_cast<GstClockTime>(i) * GST_MSECOND;
+        GstFlowReturn ret;
+        g_signal_emit_by_name(src, "push-buffer", buffer, &ret);
+        gst_buffer_unref(buffer);
+        GstSample *sample = nullptr;
+        g_signal_emit_by_name(sink, "pull-sample", &sample);
+        if (sample) gst_sample_unref(sample);
+    };
+
+    pushPull(0);  // preroll + warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= frames; i++) pushPull(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(src);
+    gst_object_unref(sink);
+    gst_object_unref(pipeline);
+    return std::chrono::duration<double, std::milli>(elapsed).count() / frames;
+}
+
+/** Mean per-frame JpegDecoder::decode() time. */
+static double timeJpegDecoder(JpegDecoder &decoder, const std::vector<uint8_t> &jpeg, int width, int height,
+                              int frames) {
+    if (!decoder.decode(jpeg.data(), jpeg.size(), width, height)) {
+        std::cerr << "JpegDecoder failed on the " << width << "x" << height << " test frame" << std::endl;
+        std::exit(1);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) decoder.decode(jpeg.data(), jpeg.size(), width, height);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / frames;
+}
+
+static void runJpegDecodeBench(int frames, int threads) {
+    BS::thread_pool<BS::tp::none> pool(static_cast<size_t>(std::max(threads, 1)));
+    JpegDecoder single(nullptr);
+    JpegDecoder parallel(&pool);
+
+    std::cout << "JPEG decode, mean ms/frame (frames/s), " << frames << " frames, pool of "
+              << pool.get_thread_count() << " + caller" << std::endl;
+    for (size_t i = 0; i < CameraResolution::count(); i++) {
+        const CameraResolution &res = CameraResolution::fromIndex(i);
+        const std::vector<uint8_t> jpeg = encodeTestFrame(res.getWidth(), res.getHeight());
+
+        const double stock = timeStockJpegdec(jpeg, res.getWidth(), res.getHeight(), frames);
+        const double one = timeJpegDecoder(single, jpeg, res.getWidth(), res.getHeight(), frames);
+        const double sliced = timeJpegDecoder(parallel, jpeg, res.getWidth(), res.getHeight(), frames);
+
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "%-7s %4dx%-4d %5zu KB  jpegdec %6.2f (%5.0f)  1 thread %6.2f (%5.0f)  %d slices %6.2f (%5.0f)",
+                      res.getLabel().c_str(), res.getWidth(), res.getHeight(), jpeg.size() / 1024,
+                      stock, 1000.0 / stock, one, 1000.0 / one, parallel.lastSliceCount(), sliced, 1000.0 / sliced);
+        std::cout << line << std::endl;
+    }
+}
+
+/** CameraStats before the SeqLock blocks: one atomic per field, in declaration order, all writers interleaved. */
+struct LegacyCameraStats {
+    std::atomic<double> prevTimestamp{0.0};
+    std::atomic<double> currTimestamp{0.0};
+    std::atomic<double> fps{0.0};
+    std::atomic<uint64_t> camera{0};
+    std::atomic<uint64_t> vidConv{0};
+    std::atomic<uint64_t> enc{0};
+    std::atomic<uint64_t> rtpPay{0};
+    std::atomic<uint64_t> udpStream{0};
+    std::atomic<uint64_t> jbHold{0};
+    std::atomic<uint64_t> rtpDepay{0};
+    std::atomic<uint64_t> dec{0};
+    std::atomic<uint64_t> queue{0};
+    std::atomic<uint64_t> appsink{0};
+    std::atomic<uint64_t> presentation{0};
+    std::atomic<uint64_t> totalLatency{0};
+    std::atomic<uint64_t> rtpPayTimestamp{0};
+    std::atomic<uint64_t> frameReadyTimestamp{0};
+    std::atomic<uint64_t> frameId{0};
+    std::atomic<uint16_t> packetsPerFrame{0};
+    std::atomic<uint32_t> jitterUs{0};
+    std::atomic<uint32_t> actualBitrateBps{0};
+    std::atomic<uint64_t> lastMeasuredFrameReady{0};
+    std::atomic<uint32_t> renderCpuUs{0};
+
+    CameraStatsSnapshot snapshot() const {
+        CameraStatsSnapshot s{};
+        s.prevTimestamp = prevTimestamp.load();
+        s.currTimestamp = currTimestamp.load();
+        s.camera = camera.load();
+        s.vidConv = vidConv.load();
+        s.enc = enc.load();
+        s.rtpPay = rtpPay.load();
+        s.udpStream = udpStream.load();
+        s.jbHold = jbHold.load();
+        s.rtpDepay = rtpDepay.load();
+        s.dec = dec.load();
+        s.queue = queue.load();
+        s.appsink = appsink.load();
+        s.presentation = presentation.load();
+        s.totalLatency = totalLatency.load();
+        s.rtpPayTimestamp = rtpPayTimestamp.load();
+        s.frameReadyTimestamp = frameReadyTimestamp.load();
+        s.frameId = frameId.load();
+        s.jitterUs = jitterUs.load();
+        s.actualBitrateBps = actualBitrateBps.load();
+        s.renderCpuUs = renderCpuUs.load();
+        return s;
+    }
+};
+
+/**
+ * Every writer stores its update number n (frame n) into all of its fields. A
+ * snapshot is torn if its latency stages come from more than one frame, or if
+ * it mixes two updates of the ingress or sink fields.
+ */
+static bool isTorn(const CameraStatsSnapshot &s) {
+    const uint64_t stages[] = {s.camera, s.vidConv, s.enc, s.rtpPay, s.udpStream, s.jbHold, s.rtpDepay,
+                               s.dec, s.queue, s.appsink, s.presentation, s.totalLatency, s.rtpPayTimestamp};
+    const bool frame = std::any_of(std::begin(stages), std::end(stages), [&](uint64_t v) { return v != s.frameId; });
+    const bool ingress = s.jitterUs != s.actualBitrateBps;
+    const bool sink = static_cast<uint64_t>(s.currTimestamp) != s.frameReadyTimestamp;
+    return frame || ingress || sink;
+}
+
+struct ContentionResult {
+    double writeNs;       // mean per update, over all writers
+    uint64_t snapshots;
+    uint64_t torn;
+};
+
+/** Runs writers[] on one thread each, plus a reader taking snapshots until they are done. */
+template<typename Stats, typename Snapshot>
+static ContentionResult runContention(Stats &stats, Snapshot snapshot,
+                                      const std::vector<void (*)(Stats &, uint64_t)> &writers, int iterations) {
+    std::atomic<bool> go{false};
+    std::atomic<size_t> running{writers.size()};
+    std::vector<double> writeNs(writers.size());
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers.size(); w++) {
+        threads.emplace_back([&, w] {
+            while (!go.load()) {}
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 1; i <= iterations; i++) writers[w](stats, static_cast<uint64_t>(i));
+            writeNs[w] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                         iterations;
+            running--;
+        });
+    }
+
+    ContentionResult result{0.0, 0, 0};
+    go = true;
+    while (running.load() > 0) {
+        const CameraStatsSnapshot s = snapshot(stats);
+        result.snapshots++;
+        if (isTorn(s)) result.torn++;
+    }
+    for (auto &thread : threads) thread.join();
+    for (double ns : writeNs) result.writeNs += ns / static_cast<double>(writers.size());
+    return result;
+}
+
+static void runStatsContentionBench(int iterations) {
+    const std::vector<void (*)(LegacyCameraStats &, uint64_t)> legacyWriters = {
+        [](LegacyCameraStats &s, uint64_t n) {
+            s.frameId = n; s.camera = n; s.vidConv = n; s.enc = n; s.rtpPay = n; s.rtpPayTimestamp = n;
+            s.udpStream = n; s.packetsPerFrame += 1;
+            s.jitterUs = static_cast<uint32_t>(n); s.actualBitrateBps = static_cast<uint32_t>(n);
+        },
+        [](LegacyCameraStats &s, uint64_t n) { s.jbHold = n; s.rtpDepay = n; },
+        [](LegacyCameraStats &s, uint64_t n) { s.dec = n; },
+        [](LegacyCameraStats &s, uint64_t n) { s.queue = n; s.totalLatency = n; },
+        [](LegacyCameraStats &s, uint64_t n) {
+            s.prevTimestamp = s.currTimestamp.load(); s.currTimestamp = static_cast<double>(n);
+            s.frameReadyTimestamp = n; s.appsink = n;
+        },
+        [](LegacyCameraStats &s, uint64_t n) {
+            s.presentation = n; s.lastMeasuredFrameReady = n; s.renderCpuUs = static_cast<uint32_t>(n);
+        },
+    };
+    const std::vector<void (*)(CameraStats &, uint64_t)> seqLockWriters = {
+        [](CameraStats &s, uint64_t n) {
+            s.ingress.update([n](IngressStats &in) {
+                in.packetsPerFrame += 1;
+                in.jitterUs = static_cast<uint32_t>(n); in.actualBitrateBps = static_cast<uint32_t>(n);
+            });
+        },
+        [](CameraStats &s, uint64_t n) {
+            s.sink.update([n](SinkStats &sk) {
+                sk.prevTimestamp = sk.currTimestamp; sk.currTimestamp = static_cast<double>(n);
+                sk.frameReadyTimestamp = n; sk.frameId = n; sk.hasFrameId = true;
+            });
+        },
+        [](CameraStats &s, uint64_t n) {
+            s.render.update([n](RenderStats &rd) {
+                rd.lastMeasuredFrameReady = n; rd.renderCpuUs = static_cast<uint32_t>(n);
+            });
+        },
+        [](CameraStats &s, uint64_t n) {
+            FrameLatencyRecord record;
+            record.frameId = n;
+            record.rtpPayTimestamp = n;
+            for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) record.setStage(static_cast<LatencyStage>(i), n);
+            s.presented.update([&](PresentedStats &pr) { pr.frame = record; pr.fps = static_cast<double>(n); });
+        },
+    };
+
+    auto legacyStats = std::make_unique<LegacyCameraStats>();
+    auto seqLockStats = std::make_unique<CameraStats>();
+    const ContentionResult legacy = runContention(
+        *legacyStats, [](const LegacyCameraStats &s) { return s.snapshot(); }, legacyWriters, iterations);
+    const ContentionResult seqLock = runContention(
+        *seqLockStats, [](const CameraStats &s) { return s.snapshot(); }, seqLockWriters, iterations);
+
+    std::cout << "CameraStats, " << legacyWriters.size() << " (atomics) / " << seqLockWriters.size()
+              << " (blocks) writers x " << iterations << " updates + 1 reader" << std::endl;
+    for (const auto &[name, r] : {std::pair{"per-field atomics", legacy}, std::pair{"SeqLock blocks   ", seqLock}}) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s  write %7.1f ns/update  %10llu snapshots  %10llu torn (%.2f %%)",
+                      name, r.writeNs, static_cast<unsigned long long>(r.snapshots),
+                      static_cast<unsigned long long>(r.torn),
+                      r.snapshots ? 100.0 * static_cast<double>(r.torn) / static_cast<double>(r.snapshots) : 0.0);
+        std::cout << line << std::endl;
+    }
+}
+
+/** One gateway datagram: [timestamp (double)][compressed (uint8)][topic\0][type\0][payload]. */
+static std::vector<uint8_t> gatewayDatagram(const std::string &topic, const std::string &type,
+                                            const std::string &payload) {
+    std::vector<uint8_t> datagram(sizeof(double) + 1);
+    const double timestamp = 1712345678.25;
+    std::memcpy(datagram.data(), &timestamp, sizeof(timestamp));
+    datagram.insert(datagram.end(), topic.begin(), topic.end());
+    datagram.push_back(0);
+    datagram.insert(datagram.end(), type.begin(), type.end());
+    datagram.push_back(0);
+    datagram.insert(datagram.end(), payload.begin(), payload.end());
+    return datagram;
+}
+
+/** Schemas first, then the data messages the benchmark cycles through. */
+static std::pair<std::vector<std::vector<uint8_t>>, std::vector<std::vector<uint8_t>>> gatewayStream() {
+    std::vector<std::vector<uint8_t>> schemas = {
+        gatewayDatagram("/loki_1/chassis/battery_voltage", "std_msgs/msg/Float32",
+                        R"({"namespace":"std_msgs","name":"Float32","fields":[{"name":"data","type":"float32"}]})"),
+        gatewayDatagram("/loki_1/chassis/clock", "rosgraph_msgs/msg/Clock",
+                        R"({"namespace":"rosgraph_msgs","name":"Clock","fields":[{"name":"clock","type":"builtin_interfaces/Time"}]})"),
+        gatewayDatagram("/loki_1/diagnostics", "diagnostic_msgs/msg/DiagnosticArray",
+                        R"({"namespace":"diagnostic_msgs","name":"DiagnosticArray","fields":[{"name":"header","type":"std_msgs/Header"},{"name":"status","type":"diagnostic_msgs/DiagnosticStatus[]"}]})"),
+    };
+    std::string diagnostics = R"({"header":[{"stamp":[{"sec":[1712345678],"nanosec":[250000000]}],"frame_id":[""]}],"status":[)";
+    for (int i = 0; i < 8; i++) {
+        if (i > 0) diagnostics += ",";
+        diagnostics += R"({"level":[0],"name":["motor_)" + std::to_string(i) + R"("],"message":["OK"],"hardware_id":["drive)" +
+                       std::to_string(i) + R"("],"values":[{"key":"temperature","value":"41.5"},{"key":"current","value":"2.25"}]})";
+    }
+    diagnostics += "]}";
+    std::vector<std::vector<uint8_t>> data = {
+        gatewayDatagram("/loki_1/chassis/battery_voltage", "std_msgs/msg/Float32", R"({"data":[25.125]})"),
+        gatewayDatagram("/loki_1/chassis/clock", "rosgraph_msgs/msg/Clock",
+                        R"({"clock":[{"sec":[1712345678],"nanosec":[250000000]}]})"),
+        gatewayDatagram("/loki_1/diagnostics", "diagnostic_msgs/msg/DiagnosticArray", diagnostics),
+    };
+    return {schemas, data};
+}
+
+/** The receive path as it was: everything below ran once per datagram. */
+struct LegacyRosPath {
+    std::unordered_map<std::string, nlohmann::json> schemas;
+    double sink = 0.0;
+
+    template<typename T>
+    static T get(const nlohmann::json &data, const std::string &field) {
+        std::stringstream ss(field);
+        std::string part;
+        const nlohmann::json *cursor = &data;
+        while (std::getline(ss, part, '.')) {
+            cursor = &cursor->at(part);
+            if (cursor->is_array() && !cursor->empty()) cursor = &cursor->at(0);
+        }
+        return cursor->is_array() ? cursor->at(0).get<T>() : cursor->get<T>();
+    }
+
+    void handle(const std::vector<uint8_t> &datagram) {
+        std::vector<uint8_t> buffer(65535);
+        std::memcpy(buffer.data(), datagram.data(), datagram.size());  // recvfrom
+        buffer.resize(datagram.size());
+        size_t pos = sizeof(double) + 1;
+        auto topicEnd = std::find(buffer.begin() + pos, buffer.end(), '\0');
+        std::string topic(reinterpret_cast<const char *>(&buffer[pos]), topicEnd - (buffer.begin() + pos));
+        pos = (topicEnd - buffer.begin()) + 1;
+        auto typeEnd = std::find(buffer.begin() + pos, buffer.end(), '\0');
+        std::string type(reinterpret_cast<const char *>(&buffer[pos]), typeEnd - (buffer.begin() + pos));
+        pos = (typeEnd - buffer.begin()) + 1;
+        std::string payload(reinterpret_cast<const char *>(&buffer[pos]), buffer.size() - pos);
+
+        nlohmann::json probe = nlohmann::json::parse(payload);
+        if (probe.contains("fields") && probe.contains("namespace") && probe.contains("name")) {
+            schemas[type] = probe;
+            return;
+        }
+        auto schema = schemas.find(type);
+        if (schema == schemas.end()) return;
+        nlohmann::json j = nlohmann::json::parse(payload);
+        for (auto &field : schema->second["fields"]) {
+            std::string name = field["name"];
+            if (!j.contains(name)) sink += 1.0;
+        }
+        for (auto &[key, value] : j.items()) {
+            if (value.is_array() && value.size() == 1) value = value.at(0);
+        }
+        sink += static_cast<double>(j.dump().size());  // the INFO log line, minus the logging
+        if (topic == "/loki_1/chassis/battery_voltage") sink += get<float>(j, "data");
+        else if (topic == "/loki_1/chassis/clock") sink += static_cast<double>(get<long>(j, "clock.sec"));
+    }
+};
+
+/** The receive path now: views into the datagram, schema check by key scan, compiled field paths. */
+struct InPlaceRosPath {
+    SchemaRegistry registry;
+    JsonFieldPath voltage{"data"};
+    JsonFieldPath clockSec{"clock.sec"};
+    double sink = 0.0;
+
+    void handle(const std::vector<uint8_t> &datagram) {
+        GatewayMessage message{};
+        if (!RosNetworkGatewayClient::parseMessage(datagram.data(), datagram.size(), message)) return;
+        if (!registry.hasSchema(message.type)) {
+            registry.registerIfSchema(message.type, message.payload);
+            return;
+        }
+        double value = 0.0;
+        if (message.topic == "/loki_1/chassis/battery_voltage" && voltage.extractNumber(message.payload, &value)) {
+            sink += value;
+        } else if (message.topic == "/loki_1/chassis/clock" && clockSec.extractNumber(message.payload, &value)) {
+            sink += value;
+        }
+    }
+};
+
+template<typename Path>
+static double timeRosPath(Path &path, const std::vector<std::vector<uint8_t>> &schemas,
+                          const std::vector<std::vector<uint8_t>> &data, int messages) {
+    for (const auto &schema : schemas) path.handle(schema);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; i++) path.handle(data[static_cast<size_t>(i) % data.size()]);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / messages;
+}
+
+struct LoopbackResult {
+    uint64_t handled;
+    double msgPerSecond;
+    double cpuNsPerMessage;
+};
+
+/** Send the schemas, then messages data messages to a live client over loopback, in bursts the receive buffer can hold. */
+static LoopbackResult sendToClient(const RosNetworkGatewayClient &client, const std::vector<std::vector<uint8_t>> &schemas,
+                                   const std::vector<std::vector<uint8_t>> &data, int messages) {
+    const int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(Config::ROS_GATEWAY_PORT);
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    auto send = [&](const std::vector<uint8_t> &datagram) {
+        sendto(sender, datagram.data(), datagram.size(), 0, reinterpret_cast<sockaddr *>(&dest), sizeof(dest));
+    };
+    for (const auto &schema : schemas) send(schema);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    constexpr int BURST = 64;
+    const uint64_t handledBefore = client.messagesHandled();
+    const uint64_t cpuBefore = client.handleCpuNs();
+    const auto start = std::chrono::steady_clock::now();
+    for (int sent = 0; sent < messages;) {
+        const int burst = std::min(BURST, messages - sent);
+        for (int i = 0; i < burst; i++, sent++) send(data[static_cast<size_t>(sent) % data.size()]);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        while (client.messagesHandled() - handledBefore < static_cast<uint64_t>(sent) &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t handled = client.messagesHandled() - handledBefore;
+    const double cpuNs = static_cast<double>(client.handleCpuNs() - cpuBefore);
+    close(sender);
+    return {handled, static_cast<double>(handled) / seconds, handled ? cpuNs / static_cast<double>(handled) : 0.0};
+}
+
+static void runRosGatewayBench(int messages) {
+    const auto [schemas, data] = gatewayStream();
+    std::cout << "ROS gateway stream: " << data.size() << " message types, " << data[0].size() << " / "
+              << data[1].size() << " / " << data[2].size() << " bytes" << std::endl;
+
+    LegacyRosPath legacy;
+    InPlaceRosPath inPlace;
+    const double legacyNs = timeRosPath(legacy, schemas, data, messages);
+    const double inPlaceNs = timeRosPath(inPlace, schemas, data, messages);
+    char line[256];
+    std::snprintf(line, sizeof(line), "parse only, %d messages: legacy %8.0f ns/msg (%9.0f msg/s)   in place %6.0f ns/msg (%9.0f msg/s)",
+                  messages, legacyNs, 1e9 / legacyNs, inPlaceNs, 1e9 / inPlaceNs);
+    std::cout << line << std::endl;
+
+    // Live client over loopback.
+    RosNetworkGatewayClient client;
+    if (!client.isInitialized()) {
+        std::cerr << "RosNetworkGatewayClient failed to bind port " << Config::ROS_GATEWAY_PORT << std::endl;
+        return;
+    }
+    const int voltage = client.topics().subscribe("/loki_1/chassis/battery_voltage", {{"data", RosFieldType::Number}});
+    client.topics().subscribe("/loki_1/chassis/clock", {{"clock.sec", RosFieldType::Number}});
+
+    // A reader in place of the render thread, copying the topics' latest values as fast as it can.
+    std::atomic<bool> reading{true};
+    uint64_t loads = 0, seen = 0;
+    std::thread reader([&] {
+        while (reading.load(std::memory_order_relaxed)) {
+            for (size_t i = 0; i < client.topics().size(); i++) seen += client.topics().load(static_cast<int>(i)).messages;
+            loads++;
+        }
+    });
+    const auto readStart = std::chrono::steady_clock::now();
+    const LoopbackResult result = sendToClient(client, schemas, data, messages);
+    reading = false;
+    reader.join();
+    if (seen == 0) std::cout << "topic store reader never saw a message" << std::endl;
+    const double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+    std::snprintf(line, sizeof(line), "loopback client: %llu/%d handled, %9.0f msg/s, %6.0f ns CPU/msg in the listener",
+                  static_cast<unsigned long long>(result.handled), messages, result.msgPerSecond, result.cpuNsPerMessage);
+    std::cout << line << std::endl;
+    const RosTopicSnapshot battery = client.topics().load(voltage);
+    std::snprintf(line, sizeof(line), "topic store reader: %.0f passes/s over %zu topics meanwhile; battery_voltage %llu msgs, "
+                  "%.1f Hz, data=%g", static_cast<double>(loads) / readSeconds, client.topics().size(),
+                  static_cast<unsigned long long>(battery.messages), battery.rateHz, battery.fields[0].number);
+    std::cout << line << std::endl;
+}
+
+#if BUT_HAVE_ZSTD
+/** A gateway stream whose values change from message to message, as they do on the robot. */
+static std::vector<std::vector<uint8_t>> variedGatewayStream(int messages) {
+    std::vector<std::vector<uint8_t>> stream = gatewayStream().first;
+    stream.push_back(gatewayDatagram("/loki_1/joint_states", "sensor_msgs/msg/JointState",
+                                     R"({"namespace":"sensor_msgs","name":"JointState","fields":[{"name":"header","type":"std_msgs/Header"},{"name":"name","type":"string[]"},{"name":"position","type":"float64[]"},{"name":"velocity","type":"float64[]"},{"name":"effort","type":"float64[]"}]})"));
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    char number[32];
+    auto format = [&](const char *fmt, double value) {
+        std::snprintf(number, sizeof(number), fmt, value);
+        return std::string(number);
+    };
+    for (int i = 0; i < messages; i++) {
+        const double stamp = 1712345678.0 + i * 0.01;
+        const std::string sec = std::to_string(static_cast<long>(stamp));
+        const std::string nanosec = std::to_string(static_cast<long>((stamp - std::floor(stamp)) * 1e9) + rng() % 1000);
+        const std::string header = R"({"stamp":[{"sec":[)" + sec + R"(],"nanosec":[)" + nanosec + R"(]}],"frame_id":["base_link"]})";
+        switch (i % 4) {
+        case 0:
+            stream.push_back(gatewayDatagram("/loki_1/chassis/battery_voltage", "std_msgs/msg/Float32",
+                                             R"({"data":[)" + format("%.4f", 25.1 + 0.02 * noise(rng)) + "]}"));
+            break;
+        case 1:
+            stream.push_back(gatewayDatagram("/loki_1/chassis/clock", "rosgraph_msgs/msg/Clock",
+                                             R"({"clock":[{"sec":[)" + sec + R"(],"nanosec":[)" + nanosec + "]}]}"));
+            break;
+        case 2: {
+            std::string diagnostics = R"({"header":[)" + header + R"(],"status":[)";
+            for (int m = 0; m < 8; m++) {
+                if (m > 0) diagnostics += ",";
+                diagnostics += R"({"level":[)" + std::to_string(rng() % 50 == 0 ? 1 : 0) + R"(],"name":["motor_)" +
+                               std::to_string(m) + R"("],"message":["OK"],"hardware_id":["drive)" + std::to_string(m) +
+                               R"("],"values":[{"key":"temperature","value":")" + format("%.1f", 41.5 + noise(rng)) +
+                               R"("},{"key":"current","value":")" + format("%.2f", 2.25 + 0.3 * noise(rng)) + R"("}]})";
+            }
+            stream.push_back(gatewayDatagram("/loki_1/diagnostics", "diagnostic_msgs/msg/DiagnosticArray", diagnostics + "]}"));
+            break;
+        }
+        default: {
+            std::string names, position, velocity, effort;
+            for (int j = 0; j < 12; j++) {
+                const char *sep = j > 0 ? "," : "";
+                names += sep + std::string(R"("joint_)") + std::to_string(j) + "\"";
+                position += sep + format("%.6f", 0.5 * noise(rng));
+                velocity += sep + format("%.6f", 0.05 * noise(rng));
+                effort += sep + format("%.4f", 3.0 + noise(rng));
+            }
+            stream.push_back(gatewayDatagram("/loki_1/joint_states", "sensor_msgs/msg/JointState",
+                                             R"({"header":[)" + header + R"(],"name":[)" + names + R"(],"position":[)" +
+                                             position + R"(],"velocity":[)" + velocity + R"(],"effort":[)" + effort + "]}"));
+            break;
+        }
+        }
+    }
+    return stream;
+}
+
+/**
+ * Gateway datagrams (UDP to Config::ROS_GATEWAY_PORT) from a classic pcap file, e.g.
+ *   tcpdump -i wlan0 -w gateway.pcap udp port 8502
+ * Ethernet and Linux cooked captures; IPv4 fragments are put back together when they come in order.
+ */
+static std::vector<std::vector<uint8_t>> readGatewayPcap(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> pcap((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::vector<uint8_t>> datagrams;
+    auto u16be = [&](size_t at) { return static_cast<uint16_t>(pcap[at] << 8 | pcap[at + 1]); };
+    uint32_t magic = 0, linkType = 0;
+    if (pcap.size() >= 24) {
+        std::memcpy(&magic, pcap.data(), 4);
+        std::memcpy(&linkType, pcap.data() + 20, 4);
+    }
+    if (magic != 0xa1b2c3d4 && magic != 0xa1b23c4d) {
+        std::cerr << path << ": not a little-endian pcap file (pcapng is not supported)" << std::endl;
+        return datagrams;
+    }
+    std::map<uint16_t, std::vector<uint8_t>> fragments;  // by IP identification
+    for (size_t pos = 24; pos + 16 <= pcap.size();) {
+        uint32_t captured = 0;
+        std::memcpy(&captured, pcap.data() + pos + 8, 4);
+        const size_t packet = pos + 16;
+        pos = packet + captured;
+        if (pos > pcap.size()) break;
+
+        size_t ip = packet;
+        uint16_t etherType = 0;
+        if (linkType == 1 && captured >= 14) {          // Ethernet, maybe one VLAN tag
+            etherType = u16be(packet + 12);
+            ip = packet + 14;
+            if (etherType == 0x8100 && captured >= 18) {
+                etherType = u16be(packet + 16);
+                ip = packet + 18;
+            }
+        } else if (linkType == 113 && captured >= 16) { // Linux cooked (SLL)
+            etherType = u16be(packet + 14);
+            ip = packet + 16;
+        } else if (linkType == 276 && captured >= 20) { // Linux cooked v2 (SLL2)
+            etherType = u16be(packet);
+            ip = packet + 20;
+        }
+        if (etherType != 0x0800 || ip + 20 > pos || (pcap[ip] >> 4) != 4 || pcap[ip + 9] != 17) continue;
+        const size_t headerLength = (pcap[ip] & 0x0f) * 4u;
+        const size_t ipEnd = std::min<size_t>(pos, ip + u16be(ip + 2));
+        const uint16_t id = u16be(ip + 4);
+        const bool moreFragments = (pcap[ip + 6] & 0x20) != 0;
+        const size_t fragmentOffset = (u16be(ip + 6) & 0x1fff) * 8u;
+        if (ip + headerLength > ipEnd) continue;
+
+        std::vector<uint8_t> &udp = fragments[id];
+        if (fragmentOffset != udp.size()) {  // lost or out-of-order fragment
+            fragments.erase(id);
+            continue;
+        }
+        udp.insert(udp.end(), pcap.begin() + static_cast<long>(ip + headerLength), pcap.begin() + static_cast<long>(ipEnd));
+        if (moreFragments) continue;
+        if (udp.size() > 8 && ((udp[2] << 8) | udp[3]) == Config::ROS_GATEWAY_PORT) {
+            datagrams.emplace_back(udp.begin() + 8, udp.end());
+        }
+        fragments.erase(id);
+    }
+    return datagrams;
+}
+
+/** A gateway datagram split for recompression: everything up to the payload, and the (uncompressed) payload. */
+struct GatewaySample {
+    std::string topic;
+    std::vector<uint8_t> header;
+    std::string payload;
+};
+
+/** Header and payload bytes in a datagram flagged compressed. */
+static std::vector<uint8_t> compressedDatagram(const GatewaySample &sample, const void *payload, size_t size) {
+    std::vector<uint8_t> datagram = sample.header;
+    datagram[sizeof(double)] = 1;
+    datagram.insert(datagram.end(), static_cast<const uint8_t *>(payload), static_cast<const uint8_t *>(payload) + size);
+    return datagram;
+}
+
+static void runRosZstdBench(int messages, const std::string &pcapPath) {
+    const std::vector<std::vector<uint8_t>> stream = pcapPath.empty() ? variedGatewayStream(messages)
+                                                                      : readGatewayPcap(pcapPath);
+
+    // Schemas go to the client as they are; data messages of a known type are the samples. Recorded
+    // traffic may already be compressed (without a dictionary): that is undone first.
+    SchemaRegistry registry;
+    std::vector<std::vector<uint8_t>> schemas;
+    std::vector<GatewaySample> samples;
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    std::vector<char> scratch(1 << 24);
+    for (const auto &datagram : stream) {
+        GatewayMessage message{};
+        if (!RosNetworkGatewayClient::parseMessage(datagram.data(), datagram.size(), message)) continue;
+        std::string payload(message.payload);
+        if (message.compressed) {
+            const size_t size = ZSTD_decompressDCtx(dctx, scratch.data(), scratch.size(), payload.data(), payload.size());
+            if (ZSTD_isError(size)) continue;
+            payload.assign(scratch.data(), size);
+        }
+        if (!registry.hasSchema(message.type)) {
+            if (registry.registerIfSchema(message.type, payload)) schemas.push_back(datagram);
+            continue;
+        }
+        const size_t headerSize = message.payload.data() - reinterpret_cast<const char *>(datagram.data());
+        GatewaySample sample{std::string(message.topic), std::vector<uint8_t>(datagram.begin(), datagram.begin() + static_cast<long>(headerSize)), payload};
+        sample.header[sizeof(double)] = 0;
+        samples.push_back(std::move(sample));
+    }
+    if (samples.size() < 100) {
+        std::cerr << "Need at least 100 data messages with a known schema, have " << samples.size() << std::endl;
+        ZSTD_freeDCtx(dctx);
+        return;
+    }
+
+    // Dictionaries are trained per topic on the first half; everything is measured on the second.
+    const size_t split = samples.size() / 2;
+    std::map<std::string, std::vector<uint8_t>> dictionaries;
+    {
+        std::map<std::string, std::pair<std::string, std::vector<size_t>>> training;
+        for (size_t i = 0; i < split; i++) {
+            auto &[buffer, sizes] = training[samples[i].topic];
+            buffer += samples[i].payload;
+            sizes.push_back(samples[i].payload.size());
+        }
+        for (const auto &[topic, set] : training) {
+            std::vector<uint8_t> dictionary(4096);
+            const size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), set.first.data(),
+                                                      set.second.data(), static_cast<unsigned>(set.second.size()));
+            if (ZDICT_isError(size)) {
+                std::cout << "  no dictionary for " << topic << ": " << ZDICT_getErrorName(size) << std::endl;
+                continue;
+            }
+            dictionary.resize(size);
+            dictionaries[topic] = std::move(dictionary);
+        }
+    }
+
+    size_t rawBytes = 0;
+    for (size_t i = split; i < samples.size(); i++) rawBytes += samples[i].header.size() + samples[i].payload.size();
+    const size_t evaluated = samples.size() - split;
+    std::cout << "ROS gateway zstd: " << (pcapPath.empty() ? "synthetic stream" : pcapPath) << ", " << samples.size()
+              << " data messages, " << dictionaries.size() << " topic dictionaries trained on the first " << split
+              << ", measured on " << evaluated << ": " << rawBytes / evaluated << " bytes/msg uncompressed" << std::endl;
+
+    char line[256];
+    std::vector<uint8_t> compressed(ZSTD_compressBound(scratch.size()));
+    std::vector<std::vector<uint8_t>> liveData;
+    for (const int level : {1, 3, 9, 19}) {
+        for (const bool useDictionary : {false, true}) {
+            if (useDictionary && dictionaries.empty()) continue;
+            std::map<std::string, ZSTD_CDict *> cdicts;
+            std::map<std::string, ZSTD_DDict *> ddicts;
+            if (useDictionary) {
+                for (const auto &[topic, dictionary] : dictionaries) {
+                    cdicts[topic] = ZSTD_createCDict(dictionary.data(), dictionary.size(), level);
+                    ddicts[topic] = ZSTD_createDDict(dictionary.data(), dictionary.size());
+                }
+            }
+            ZSTD_CCtx *cctx = ZSTD_createCCtx();
+            std::vector<std::vector<uint8_t>> frames;
+            size_t wireBytes = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = split; i < samples.size(); i++) {
+                const GatewaySample &sample = samples[i];
+                auto cdict = cdicts.find(sample.topic);
+                const size_t size = cdict != cdicts.end()
+                    ? ZSTD_compress_usingCDict(cctx, compressed.data(), compressed.size(), sample.payload.data(),
+                                               sample.payload.size(), cdict->second)
+                    : ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(), sample.payload.data(),
+                                        sample.payload.size(), level);
+                frames.emplace_back(compressed.begin(), compressed.begin() + static_cast<long>(size));
+                wireBytes += sample.header.size() + size;
+            }
+            const double compressUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / evaluated;
+
+            // The client's way: one context for the thread's lifetime, dictionaries digested once.
+            size_t roundTripErrors = 0;
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames.size(); i++) {
+                auto ddict = ddicts.find(samples[split + i].topic);
+                const size_t size = ddict != ddicts.end()
+                    ? ZSTD_decompress_usingDDict(dctx, scratch.data(), scratch.size(), frames[i].data(), frames[i].size(), ddict->second)
+                    : ZSTD_decompressDCtx(dctx, scratch.data(), scratch.size(), frames[i].data(), frames[i].size());
+                if (ZSTD_isError(size) || std::string_view(scratch.data(), size) != samples[split + i].payload) roundTripErrors++;
+            }
+            const double persistentNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / evaluated;
+
+            // A context (and the raw dictionary) set up for every message.
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames.size(); i++) {
+                auto dictionary = dictionaries.find(samples[split + i].topic);
+                if (useDictionary && dictionary != dictionaries.end()) {
+                    ZSTD_DCtx *fresh = ZSTD_createDCtx();
+                    ZSTD_decompress_usingDict(fresh, scratch.data(), scratch.size(), frames[i].data(), frames[i].size(),
+                                              dictionary->second.data(), dictionary->second.size());
+                    ZSTD_freeDCtx(fresh);
+                } else {
+                    ZSTD_decompress(scratch.data(), scratch.size(), frames[i].data(), frames[i].size());
+                }
+            }
+            const double freshNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / evaluated;
+
+            std::snprintf(line, sizeof(line), "level %2d %-15s %6zu bytes/msg (x%5.2f)  compress %7.1f us/msg  "
+                          "decompress %6.0f ns/msg persistent, %7.0f ns/msg fresh context%s",
+                          level, useDictionary ? "+ topic dicts:" : "no dictionary:", wireBytes / evaluated,
+                          static_cast<double>(rawBytes) / static_cast<double>(wireBytes), compressUs, persistentNs, freshNs,
+                          roundTripErrors ? "  ROUND TRIP FAILED" : "");
+            std::cout << line << std::endl;
+
+            if (level == 3 && useDictionary == !dictionaries.empty()) {
+                for (size_t i = 0; i < frames.size(); i++) {
+                    liveData.push_back(compressedDatagram(samples[split + i], frames[i].data(), frames[i].size()));
+                }
+            }
+            ZSTD_freeCCtx(cctx);
+            for (auto &[topic, cdict] : cdicts) ZSTD_freeCDict(cdict);
+            for (auto &[topic, ddict] : ddicts) ZSTD_freeDDict(ddict);
+        }
+    }
+    ZSTD_freeDCtx(dctx);
+
+    // Live client over loopback: the plain stream, then level 3 (with the dictionaries, loaded from a directory).
+    char dictionaryDir[] = "/tmp/ros_dictionaries_XXXXXX";
+    if (!mkdtemp(dictionaryDir)) {
+        std::cerr << "mkdtemp failed" << std::endl;
+        return;
+    }
+    for (const auto &[topic, dictionary] : dictionaries) {
+        std::string name = topic.substr(1);
+        std::replace(name.begin(), name.end(), '/', '_');
+        std::ofstream(std::string(dictionaryDir) + "/" + name + ".zdict", std::ios::binary)
+            .write(reinterpret_cast<const char *>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+    }
+    std::vector<std::vector<uint8_t>> plainData;
+    for (size_t i = split; i < samples.size(); i++) {
+        plainData.push_back(samples[i].header);
+        plainData.back().insert(plainData.back().end(), samples[i].payload.begin(), samples[i].payload.end());
+    }
+    {
+        RosNetworkGatewayClient client(dictionaryDir);
+        if (!client.isInitialized()) {
+            std::cerr << "RosNetworkGatewayClient failed to bind port " << Config::ROS_GATEWAY_PORT << std::endl;
+        } else {
+            const int count = static_cast<int>(evaluated);
+            const LoopbackResult plain = sendToClient(client, schemas, plainData, count);
+            const LoopbackResult packed = sendToClient(client, {}, liveData, count);
+            std::snprintf(line, sizeof(line), "loopback client: uncompressed %llu/%d handled, %6.0f ns CPU/msg   "
+                          "level 3%s %llu/%d handled, %6.0f ns CPU/msg",
+                          static_cast<unsigned long long>(plain.handled), count, plain.cpuNsPerMessage,
+                          dictionaries.empty() ? "" : " + dicts", static_cast<unsigned long long>(packed.handled), count,
+                          packed.cpuNsPerMessage);
+            std::cout << line << std::endl;
+        }
+    }
+    for (const auto &[topic, dictionary] : dictionaries) {
+        std::string name = topic.substr(1);
+        std::replace(name.begin(), name.end(), '/', '_');
+        unlink((std::string(dictionaryDir) + "/" + name + ".zdict").c_str());
+    }
+    rmdir(dictionaryDir);
+}
+#endif
+
+int main(int argc, char **argv) {
+    gst_init(&argc, &argv);
+    const BenchArgs args = parseArgs(argc, argv);
+
+    NtpTimer ntpTimer(args.ntpServer);
+    ntpTimer.StartAutoSync();
+
+    CamPair camPair;
+    camPair.first.stats = new CameraStats();
+    camPair.second.stats = new CameraStats();
+    ReceiveCallbackObj callbackObj(&camPair, &ntpTimer);
+    callbackObj.jbLatencyMinMs = args.jbLatencyMinMs;
+    callbackObj.jbLatencyMaxMs = args.jbLatencyMaxMs;
+    callbackObj.windowFrames = static_cast<size_t>(args.fps > 0 ? args.fps : 60);
+
+    if (args.rosGatewayMessages > 0) {
+        runRosGatewayBench(args.rosGatewayMessages);
+        delete camPair.first.stats;
+        delete camPair.second.stats;
+        return 0;
+    }
+
+    if (args.rosZstdMessages > 0) {
+#if BUT_HAVE_ZSTD
+        runRosZstdBench(args.rosZstdMessages, args.rosPcap);
+#else
+        std::cerr << "receive_bench was built without zstd (libzstd not found)" << std::endl;
+#endif
+        delete camPair.first.stats;
+        delete camPair.second.stats;
+        return 0;
+    }
+
+    if (args.statsContentionIterations > 0) {
+        runStatsContentionBench(args.statsContentionIterations);
+        delete camPair.first.stats;
+        delete camPair.second.stats;
+        return 0;
+    }
+
+    if (args.jpegBenchFrames > 0) {
+        runJpegDecodeBench(args.jpegBenchFrames, args.decodeThreads);
+        delete camPair.first.stats;
+        delete camPair.second.stats;
+        return 0;
+    }
+
+    // JPEG samples are decoded into frames of the stream size, as on the headset.
+    camPair.first.frameWidth = camPair.second.frameWidth = args.width;
+    camPair.first.frameHeight = camPair.second.frameHeight = args.height;
+    BS::thread_pool<BS::tp::none> decodePool(static_cast<size_t>(std::max(args.decodeThreads, 1)));
+    JpegDecoder leftDecoder(&decodePool), rightDecoder(&decodePool);
+    if (args.parallelJpeg) {
+        callbackObj.jpegDecoders[0] = &leftDecoder;
+        callbackObj.jpegDecoders[1] = &rightDecoder;
+    }
+
+    const std::string description = ReceivePipeline::description(args.codec, ReceiveBackend::LinuxMemory,
+                                                                 args.parallelJpeg);
+    if (args.probeOverheadIterations > 0) {
+        runProbeOverheadBench(description, &callbackObj, camPair.first.stats, args.probeOverheadIterations);
+        delete camPair.first.stats;
+        delete camPair.second.stats;
+        return 0;
+    }
+
+    std::vector<GSource *> samplers;
+    GstElement *left = buildPipeline(args, description, "left", Config::LEFT_CAMERA_PORT, &callbackObj,
+                                     camPair.first.stats, samplers);
+    GstElement *right = args.mono ? nullptr
+        : buildPipeline(args, description, "right", Config::RIGHT_CAMERA_PORT, &callbackObj,
+                        camPair.second.stats, samplers);
+
+    gst_element_set_state(left, GST_STATE_PLAYING);
+    if (right) gst_element_set_state(right, GST_STATE_PLAYING);
+
+    GMainLoop *loop = g_main_loop_new(nullptr, FALSE);
+    BenchContext ctx{&camPair, args.mono, args.durationS, loop};
+    g_timeout_add_seconds(1, onReportTick, &ctx);
+    g_main_loop_run(loop);
+
+    for (GSource *sampler : samplers) {
+        g_source_destroy(sampler);
+        g_source_unref(sampler);
+    }
+    gst_element_set_state(left, GST_STATE_NULL);
+    gst_object_unref(left);
+    if (right) {
+        gst_element_set_state(right, GST_STATE_NULL);
+        gst_object_unref(right);
+    }
+    g_main_loop_unref(loop);
+    delete camPair.first.stats;
+    delete camPair.second.stats;
+    return 0;
+}
@@ -5,7 +5,7 @@ This package provides a UDP relay service that routes commands to different
 robot subsystems:
 - Head pose commands (0x01 prefix) -> Servo driver via translator
 - Robot movement commands (0x02 prefix) -> Robot controller
-- Debug info (0x03 prefix) -> Logging
+- Telemetry batches (0x04 prefix) -> InfluxDB
 
 The servo translation layer is abstracted to support different robot types
 with different proprietary servo drivers.
@@ -40,6 +40,8 @@ class RelayConfig:
     tg_speed_max: int = 1000000
     tg_speed_multiplier: float = 0.0
     tg_filter_alpha: float = 0.15
+    tg_filter_reference_hz: float = 72.0
+    tg_max_command_rate_hz: float = 90.0
     tg_swap_axes: bool = False
     tg_invert_azimuth: bool = False
     tg_invert_elevation: bool = False
@@ -51,6 +53,10 @@ class RelayConfig:
 
     # Panoramic camera switching
     camera_control_port: int = 9100
+    # Foveated mode: gaze offset (head pose minus camera boresight) for the inset crop
+    camera_fovea_port: int = 9101
+    # Estimated camera boresight per head-pose packet, tagged onto frames for headset reprojection
+    camera_pose_port: int = 9102
 
     # Timeouts (seconds)
     servo_response_timeout: float = 1.0
@@ -168,6 +174,12 @@ class RelayConfig:
                     config_dict['camera_control_port'] = data['network']['camera'].get(
                         'control_port', cls.camera_control_port
                     )
+                    config_dict['camera_fovea_port'] = data['network']['camera'].get(
+                        'fovea_port', cls.camera_fovea_port
+                    )
+                    config_dict['camera_pose_port'] = data['network']['camera'].get(
+                        'pose_port', cls.camera_pose_port
+                    )
 
             if 'logging' in data:
                 config_dict['log_level'] = data['logging'].get('level', cls.log_level)
@@ -193,6 +205,8 @@ class RelayConfig:
                 config_dict['tg_speed_max'] = data['tg_drives'].get('speed_max', cls.tg_speed_max)
                 config_dict['tg_speed_multiplier'] = data['tg_drives'].get('speed_multiplier', cls.tg_speed_multiplier)
                 config_dict['tg_filter_alpha'] = data['tg_drives'].get('filter_alpha', cls.tg_filter_alpha)
+                config_dict['tg_filter_reference_hz'] = data['tg_drives'].get('filter_reference_hz', cls.tg_filter_reference_hz)
+                config_dict['tg_max_command_rate_hz'] = data['tg_drives'].get('max_command_rate_hz', cls.tg_max_command_rate_hz)
                 config_dict['tg_swap_axes'] = data['tg_drives'].get('swap_axes', cls.tg_swap_axes)
                 config_dict['tg_invert_azimuth'] = data['tg_drives'].get('invert_azimuth', cls.tg_invert_azimuth)
                 config_dict['tg_invert_elevation'] = data['tg_drives'].get('invert_elevation', cls.tg_invert_elevation)
@@ -1,7 +1,8 @@
 """
 Message type detection for robot communication protocol.
 
-This module only handles identifying the message type (head pose, robot control, debug info).
+This module only handles identifying the message type (head pose, robot control, telemetry,
+clock ping).
 The actual servo protocol translation is handled by servo_translators.
 """
 
@@ -13,7 +14,8 @@ class MessageType(Enum):
     """Type of incoming message."""
     HEAD_POSE = "head_pose"  # Servo/head control
     ROBOT_CONTROL = "robot_control"  # Robot movement
-    DEBUG_INFO = "debug_info"
+    TELEMETRY = "telemetry"  # Batched pipeline telemetry
+    CLOCK_PING = "clock_ping"  # Headset clock sync, answered with an echo
     UNKNOWN = "unknown"
 
 
@@ -24,13 +26,16 @@ class MessageDetector:
     Protocol:
     - Head pose messages (servo control): Start with 0x01
     - Robot control messages: Start with 0x02
-    - Debug info messages: Start with 0x03
+    - Telemetry batch messages: Start with 0x04
+    - Clock ping messages: Start with 0x05 (answered with 0x06)
     """
 
     # Protocol constants
     HEAD_POSE_PREFIX = 0x01
     ROBOT_CONTROL_PREFIX = 0x02
-    DEBUG_INFO_PREFIX = 0x03
+    TELEMETRY_PREFIX = 0x04
+    CLOCK_PING_PREFIX = 0x05
+    CLOCK_ECHO_PREFIX = 0x06
 
     def __init__(self):
         self.logger = logging.getLogger(__name__)
@@ -59,8 +64,11 @@ class MessageDetector:
         elif prefix == self.ROBOT_CONTROL_PREFIX:
             return MessageType.ROBOT_CONTROL
 
-        elif prefix == self.DEBUG_INFO_PREFIX:
-            return MessageType.DEBUG_INFO
+        elif prefix == self.TELEMETRY_PREFIX:
+            return MessageType.TELEMETRY
+
+        elif prefix == self.CLOCK_PING_PREFIX:
+            return MessageType.CLOCK_PING
 
         # Unknown message type
         else:
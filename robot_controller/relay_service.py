@@ -28,6 +28,20 @@ except ImportError:
     INFLUXDB_AVAILABLE = False
 
 
+def _read_zigzag_varint(data: bytes, offset: int) -> Tuple[int, int]:
+    """Decode one zigzag LEB128 varint at offset; returns (value, next offset)."""
+    result = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        result |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            break
+        shift += 7
+    return (result >> 1) ^ -(result & 1), offset
+
+
 class UDPRelayService:
     """
     Main UDP relay service.
@@ -35,8 +49,35 @@ class UDPRelayService:
     Receives UDP messages on ingest port, routes them based on message type:
     - Head pose messages (0x01 prefix) -> servo translator -> servo driver
     - Robot control messages (0x02 prefix) -> robot controller
+    - Telemetry batches (0x04 prefix) -> InfluxDB
+    - Clock pings (0x05 prefix) -> answered with a clock echo (0x06)
     """
 
+    # Head pose (0x01) layout: header, then the newest samples, newest first
+    _HEAD_POSE_HEADER = struct.Struct('<BIB')  # type, seq, sample count
+    _HEAD_POSE_SAMPLE_SIZE = 20  # azimuth, elevation, speed (float), timestamp (uint64)
+    HEAD_POSE_REPORT_INTERVAL_S = 10.0
+
+    # Clock ping (0x05) and echo (0x06): type, seq, then the headset's send time,
+    # our receive and our transmit time, all microseconds of CLOCK_REALTIME
+    _CLOCK_PING = struct.Struct('<BIQ')
+    _CLOCK_ECHO = struct.Struct('<BIQQQ')
+
+    # Telemetry batch (0x04) layout, see robot_control_sender.h on the headset
+    TELEMETRY_VERSION = 1
+    TELEMETRY_HAS_CONFIG = 0x01
+    TELEMETRY_HAS_HEALTH = 0x02
+    _TELEMETRY_HEADER = struct.Struct('<BBIQBBHqBQ')
+    _TELEMETRY_EYE_HEALTH = struct.Struct('<fIIIIH4I')
+    _TELEMETRY_CONFIG = struct.Struct('<BBHHHI')
+    _TELEMETRY_STAGES = ('camera_us', 'vidConv_us', 'enc_us', 'rtpPay_us', 'udpStream_us', 'jbHold_us',
+                         'rtpDepay_us', 'dec_us', 'queue_us', 'appsink_us', 'presentation_us')
+    _TELEMETRY_EYES = ('left', 'right')
+    # Influx line protocol of one frame record: tags source, eye; frame_id, the stages, total; time
+    _TELEMETRY_FRAME_LINE = ("pipeline_metrics,source={},eye={} frame_id={}i,"
+                             + ",".join(f"{name}={{}}i" for name in _TELEMETRY_STAGES)
+                             + ",total_latency_us={}i {}")
+
     def __init__(self, config: RelayConfig):
         """
         Initialize the UDP relay service.
@@ -66,16 +107,35 @@ class UDPRelayService:
 
         # Panoramic camera switching
         self._camera_select_socket: Optional[socket.socket] = None
+        # Estimated camera boresight (radians), tracked for the foveated inset
+        # and the per-frame camera pose tags
+        self._boresight_az = 0.0
+        self._boresight_el = 0.0
+        self._boresight_timestamp = 0  # timestamp of the last head pose sample filtered in
         self._current_camera_index: int = 0
         self._num_cameras: int = 6
         self._hysteresis_margin: float = 0.1  # fraction of sector width
 
         # Telemetry - InfluxDB with batch buffering
         self.influx_client: Optional[InfluxDBClient3] = None
-        self.influx_buffer: List[Point] = []
+        self.influx_buffer: List = []  # Points and line-protocol strings
         self.influx_buffer_lock = Lock()
         self.influx_batch_thread: Optional[Thread] = None
 
+        # Head pose sequence tracking and loss/reorder counters
+        self._head_pose_seq: Optional[int] = None
+        self._head_pose_timestamp = 0
+        self.head_pose_lost = 0        # samples missing from every datagram received
+        self.head_pose_recovered = 0   # samples of lost datagrams taken from later ones
+        self.head_pose_reordered = 0   # stale, reordered or duplicate datagrams dropped
+        self._head_pose_report_time = time.monotonic()
+        self._head_pose_reported = (0, 0, 0)
+
+        # Telemetry batch tracking: last seq seen, datagrams lost (seq gaps), last config received
+        self._telemetry_seq: Optional[int] = None
+        self.telemetry_datagrams_lost = 0
+        self._telemetry_config: Optional[Tuple[int, ...]] = None
+
     def _init_influxdb(self):
         """Initialize InfluxDB client if telemetry is enabled."""
         if not self.config.telemetry_enabled:
@@ -166,6 +226,8 @@ class UDPRelayService:
                 speed_max=self.config.tg_speed_max,
                 speed_multiplier=self.config.tg_speed_multiplier,
                 filter_alpha=self.config.tg_filter_alpha,
+                filter_reference_hz=self.config.tg_filter_reference_hz,
+                max_command_rate_hz=self.config.tg_max_command_rate_hz,
                 swap_axes=self.config.tg_swap_axes,
                 invert_azimuth=self.config.tg_invert_azimuth,
                 invert_elevation=self.config.tg_invert_elevation
@@ -291,18 +353,109 @@ class UDPRelayService:
         # Detect message type
         message_type = self.message_detector.detect_message_type(data)
 
-        if message_type == MessageType.HEAD_POSE:
-            self._forward_to_servo(data, client_addr)
+        if message_type == MessageType.CLOCK_PING:
+            self._handle_clock_ping(data, client_addr)
+
+        elif message_type == MessageType.HEAD_POSE:
+            self._handle_head_pose(data, client_addr)
 
         elif message_type == MessageType.ROBOT_CONTROL:
             self._forward_to_robot(data, client_addr)
 
-        elif message_type == MessageType.DEBUG_INFO:
-            self._handle_debug_info(data, client_addr)
+        elif message_type == MessageType.TELEMETRY:
+            self._handle_telemetry(data, client_addr)
 
         else:
             self.logger.warning(f"Unknown message type from {client_addr[0]}:{client_addr[1]}, dropping")
 
+    def _handle_clock_ping(self, data: bytes, client_addr: Tuple[str, int]):
+        """
+        Answer a clock ping so the headset can map its clock onto this host's.
+
+        The camera pipeline stamps frames with CLOCK_REALTIME on this host, so
+        this is the clock the headset's latency figures need. Checked first in
+        _route_message: time spent before the receive stamp is read shifts the
+        offset the headset computes.
+
+        Message format:
+            [0x05] [seq (uint32)] [t1 (uint64)]                                   (13 bytes)
+        Answer, to the sender's address:
+            [0x06] [seq (uint32)] [t1 (uint64)] [t2 (uint64)] [t3 (uint64)]       (29 bytes)
+            t1 is echoed, t2 is when the ping was handled, t3 when the echo is sent.
+        """
+        t2 = time.time_ns() // 1000
+        if len(data) != self._CLOCK_PING.size:
+            self.logger.warning(f"Invalid clock ping packet length: {len(data)} bytes")
+            return
+        _, seq, t1 = self._CLOCK_PING.unpack(data)
+        self.ingest_socket.sendto(
+            self._CLOCK_ECHO.pack(MessageDetector.CLOCK_ECHO_PREFIX, seq, t1, t2, time.time_ns() // 1000),
+            client_addr)
+
+    def _handle_head_pose(self, data: bytes, client_addr: Tuple[str, int]):
+        """
+        Handle a head pose message: forward each sample not seen yet, oldest first.
+
+        Args:
+            data: Head pose message
+            client_addr: Client address
+
+        Message format (6 + 20 * sample_count bytes):
+            [0x01] [seq (uint32)] [sample_count (uint8)]
+            sample_count x [azimuth (float)] [elevation (float)] [speed (float)] [timestamp (uint64)]
+            The first sample has seq, each following one is a step older.
+
+        A datagram lost on the way is filled in from the samples the next one
+        repeats; a datagram not newer than the last one is dropped. Each
+        sample is passed on as a single-sample message:
+            [0x01] [azimuth (float)] [elevation (float)] [speed (float)] [timestamp (uint64)]
+        """
+        if len(data) < self._HEAD_POSE_HEADER.size:
+            self.logger.warning(f"Invalid head pose packet length: {len(data)} bytes")
+            return
+        _, seq, sample_count = self._HEAD_POSE_HEADER.unpack_from(data, 0)
+        expected_length = self._HEAD_POSE_HEADER.size + sample_count * self._HEAD_POSE_SAMPLE_SIZE
+        if sample_count == 0 or len(data) != expected_length:
+            self.logger.warning(f"Invalid head pose packet length: {len(data)} bytes, expected {expected_length}")
+            return
+
+        # Newest sample's timestamp (after azimuth, elevation, speed)
+        timestamp = struct.unpack_from('<Q', data, self._HEAD_POSE_HEADER.size + 12)[0]
+        new_samples = 1
+        if self._head_pose_seq is not None:
+            ahead = (seq - self._head_pose_seq) & 0xFFFFFFFF
+            if 0 < ahead < 0x80000000:
+                new_samples = min(ahead, sample_count)
+                self.head_pose_recovered += new_samples - 1
+                self.head_pose_lost += ahead - new_samples
+            elif timestamp <= self._head_pose_timestamp:
+                self.head_pose_reordered += 1
+                self._report_head_pose_counters()
+                return
+            else:
+                # Not ahead by seq, but newer: the headset restarted its count
+                self.logger.info(f"Head pose seq restarted at {seq} (was {self._head_pose_seq})")
+        self._head_pose_seq = seq
+        self._head_pose_timestamp = timestamp
+
+        for i in reversed(range(new_samples)):
+            start = self._HEAD_POSE_HEADER.size + i * self._HEAD_POSE_SAMPLE_SIZE
+            sample = data[start:start + self._HEAD_POSE_SAMPLE_SIZE]
+            self._forward_to_servo(bytes([MessageDetector.HEAD_POSE_PREFIX]) + sample, client_addr)
+        self._report_head_pose_counters()
+
+    def _report_head_pose_counters(self):
+        """Log the head pose loss/reorder counters every HEAD_POSE_REPORT_INTERVAL_S, if they moved."""
+        now = time.monotonic()
+        if now - self._head_pose_report_time < self.HEAD_POSE_REPORT_INTERVAL_S:
+            return
+        self._head_pose_report_time = now
+        counters = (self.head_pose_lost, self.head_pose_recovered, self.head_pose_reordered)
+        if counters != self._head_pose_reported:
+            self._head_pose_reported = counters
+            self.logger.info(f"Head pose: {counters[0]} samples lost, {counters[1]} recovered from redundancy, "
+                             f"{counters[2]} stale/reordered datagrams dropped")
+
     def _compute_camera_index(self, azimuth: float) -> int:
         """
         Compute camera index from head azimuth with hysteresis.
@@ -336,9 +489,9 @@ class UDPRelayService:
 
     def _update_camera_selection(self, data: bytes):
         """
-        Extract azimuth from head pose packet and send camera select if changed.
+        Extract azimuth from head pose sample and send camera select if changed.
 
-        Head pose packet: [0x01] [azimuth (float)] [elevation (float)] [speed (float)] [timestamp (uint64)]
+        Head pose sample: [0x01] [azimuth (float)] [elevation (float)] [speed (float)] [timestamp (uint64)]
         """
         if len(data) < 5 or not self._camera_select_socket:
             return
@@ -358,12 +511,73 @@ class UDPRelayService:
         except (struct.error, Exception) as e:
             self.logger.warning(f"Failed to update camera selection: {e}")
 
+    def _update_boresight(self, data: bytes):
+        """
+        Track the camera boresight and send it to the streaming driver, which
+        tags every captured frame with it so the headset can reproject.
+
+        There is no position readback from the gimbal, so the boresight is
+        estimated with the same time-based low-pass the TG Drives translator
+        applies to its servo targets, run on every sample as the translator
+        does. With servo motion disabled the camera stays put.
+
+        Sent packet: [azimuth (float)] [elevation (float)], radians, same
+        convention as the head pose packet
+        """
+        if len(data) < 21:
+            return
+
+        try:
+            azimuth, elevation = struct.unpack('<ff', data[1:9])
+            timestamp = struct.unpack('<Q', data[13:21])[0]
+            if self.config.servo_motion_enabled:
+                interval_us = (timestamp - self._boresight_timestamp if self._boresight_timestamp
+                               else int(1e6 / self.config.tg_filter_reference_hz))
+                self._boresight_timestamp = max(self._boresight_timestamp, timestamp)
+                alpha = TGDrivesTranslator.filter_alpha_for_interval(
+                    self.config.tg_filter_alpha, self.config.tg_filter_reference_hz, interval_us)
+                self._boresight_az += (azimuth - self._boresight_az) * alpha
+                self._boresight_el += (elevation - self._boresight_el) * alpha
+            if self._camera_select_socket:
+                self._camera_select_socket.sendto(
+                    struct.pack('<ff', self._boresight_az, self._boresight_el),
+                    ("127.0.0.1", self.config.camera_pose_port)
+                )
+
+        except (struct.error, Exception) as e:
+            self.logger.warning(f"Failed to update camera boresight: {e}")
+
+    def _update_fovea_gaze(self, data: bytes):
+        """
+        Send the head gaze relative to the camera boresight to the streaming driver,
+        which steers the foveated inset crop with it.
+
+        The offset is the part of the head motion the gimbal has not caught up
+        with yet (see _update_boresight); with servo motion disabled it is the
+        raw head pose.
+
+        Sent packet: [azimuth offset (float)] [elevation offset (float)], radians
+        """
+        if len(data) < 9 or not self._camera_select_socket:
+            return
+
+        try:
+            azimuth, elevation = struct.unpack('<ff', data[1:9])
+            self._camera_select_socket.sendto(
+                struct.pack('<ff', azimuth - self._boresight_az,
+                            elevation - self._boresight_el),
+                ("127.0.0.1", self.config.camera_fovea_port)
+            )
+
+        except (struct.error, Exception) as e:
+            self.logger.warning(f"Failed to update fovea gaze: {e}")
+
     def _forward_to_servo(self, data: bytes, client_addr: Tuple[str, int]):
         """
-        Forward message to servo driver via translator.
+        Forward one head pose sample to servo driver via translator.
 
         Args:
-            data: Servo command data
+            data: Single-sample head pose message (see _handle_head_pose)
             client_addr: Client address to send response to
         """
         if not self.servo_translator:
@@ -372,6 +586,10 @@ class UDPRelayService:
 
         # Update panoramic camera selection based on head azimuth
         self._update_camera_selection(data)
+        # Camera pose for the frame tags, then the foveated inset relative to it
+        # (ignored by the driver in other modes)
+        self._update_boresight(data)
+        self._update_fovea_gaze(data)
 
         # Servo motion is gated by config: disabled during latency/p2p capture
         # campaigns (keeps the optical rig static), enabled for normal use.
@@ -432,189 +650,165 @@ class UDPRelayService:
             self.consecutive_errors += 1
             self.logger.error(f"Error forwarding to robot: {e}")
 
-    def _handle_debug_info(self, data: bytes, client_addr: Tuple[str, int]):
+    def _handle_telemetry(self, data: bytes, client_addr: Tuple[str, int]):
         """
-        Handle debug info message.
+        Handle a telemetry batch message.
 
         Args:
-            data: Debug info data
+            data: Telemetry batch data
             client_addr: Client address
 
-        Message format (166 bytes):
-            [0x03] [timestamp (uint64)] [frame_id (uint64)] [fps (double)]
-            [camera_us (uint64)] [vidConv_us (uint64)] [enc_us (uint64)] [rtpPay_us (uint64)]
-            [udpStream_us (uint64)] [jbHold_us (uint64)] [rtpDepay_us (uint64)] [dec_us (uint64)]
-            [appsink_us (uint64)] [presentation_us (uint64)]
+        Message format (variable length, little-endian):
+            [0x04] [version (uint8)] [seq (uint32)] [timestamp (uint64)] [flags (uint8)]
+            [record_count (uint8)] [records_dropped (uint16)]
             [ntp_offset_us (int64)] [ntp_synced (uint8)] [time_since_ntp_sync_us (uint64)]
-            [codec (uint8)] [video_mode (uint8)] [res_width (uint16)] [res_height (uint16)]
-            [fps_config (uint16)] [bitrate_cfg (uint32)]
-            [left_lost/rtx/jitter_us/bitrate_bps (4x uint32)]
-            [right_lost/rtx/jitter_us/bitrate_bps (4x uint32)]
+            flags bit 1 - per-eye health, left then right:
+                [fps (float)] [lost/rtx/jitter_us/bitrate_bps (4x uint32)] [jb_latency_ms (uint16)]
+                [total_p50/p95/p99/max_us (4x uint32)]
+            flags bit 0 - streaming config:
+                [codec (uint8)] [video_mode (uint8)] [res_width (uint16)] [res_height (uint16)]
+                [fps_config (uint16)] [bitrate_cfg (uint32)]
+            record_count records:
+                [eye (uint8)] then zigzag varints of frame_id, ready_us and the 11 stage
+                latencies, each a delta from the previous record of the same eye
+
+        Each record becomes one pipeline_metrics row (tags source, eye), stamped
+        at the frame's appsink time; the health block becomes one
+        pipeline_health row carrying the latest config received.
         """
         try:
-            expected_length = 166
-            if len(data) != expected_length:
-                self.logger.warning(f"Invalid debug info packet length: {len(data)} bytes, expected {expected_length}")
+            if len(data) < self._TELEMETRY_HEADER.size:
+                self.logger.warning(f"Invalid telemetry packet length: {len(data)} bytes")
                 return
 
-            # Parse the message
-            offset = 1  # Skip message type byte
-
-            timestamp = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            frame_id = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            fps = struct.unpack('<d', data[offset:offset+8])[0]
-            offset += 8
-
-            camera_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            vidConv_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            enc_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            rtpPay_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            udpStream_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            jbHold_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            rtpDepay_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            dec_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            appsink_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            presentation_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            ntp_offset_us = struct.unpack('<q', data[offset:offset+8])[0]
-            offset += 8
-
-            ntp_synced = struct.unpack('<B', data[offset:offset+1])[0]
-            offset += 1
-
-            time_since_ntp_sync_us = struct.unpack('<Q', data[offset:offset+8])[0]
-            offset += 8
-
-            # Streaming config (shared by both eyes)
-            codec = struct.unpack('<B', data[offset:offset+1])[0]
-            offset += 1
-            video_mode = struct.unpack('<B', data[offset:offset+1])[0]
-            offset += 1
-            res_width = struct.unpack('<H', data[offset:offset+2])[0]
-            offset += 2
-            res_height = struct.unpack('<H', data[offset:offset+2])[0]
-            offset += 2
-            fps_config = struct.unpack('<H', data[offset:offset+2])[0]
-            offset += 2
-            bitrate_cfg = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-
-            # Per-eye network health (right = 0 in mono)
-            left_lost = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            left_rtx = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            left_jitter_us = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            left_bitrate_bps = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            right_lost = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            right_rtx = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            right_jitter_us = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-            right_bitrate_bps = struct.unpack('<I', data[offset:offset+4])[0]
-            offset += 4
-
-            # Log the debug information
+            (_, version, seq, timestamp, flags, record_count, records_dropped,
+             ntp_offset_us, ntp_synced, time_since_ntp_sync_us) = self._TELEMETRY_HEADER.unpack_from(data, 0)
+            if version != self.TELEMETRY_VERSION:
+                self.logger.warning(f"Unsupported telemetry version {version}, expected {self.TELEMETRY_VERSION}")
+                return
+            offset = self._TELEMETRY_HEADER.size
+
+            # Datagram loss shows up as a seq gap; a jump backwards is a headset restart.
+            if self._telemetry_seq is not None:
+                gap = (seq - self._telemetry_seq - 1) & 0xFFFFFFFF
+                if 0 < gap < 0x80000000:
+                    self.telemetry_datagrams_lost += gap
+                    self.logger.warning(f"Telemetry: {gap} datagram(s) lost before seq {seq} "
+                                        f"({self.telemetry_datagrams_lost} total)")
+            self._telemetry_seq = seq
+
+            health = None
+            if flags & self.TELEMETRY_HAS_HEALTH:
+                health = []
+                for _ in self._TELEMETRY_EYES:
+                    health.append(self._TELEMETRY_EYE_HEALTH.unpack_from(data, offset))
+                    offset += self._TELEMETRY_EYE_HEALTH.size
+            if flags & self.TELEMETRY_HAS_CONFIG:
+                self._telemetry_config = self._TELEMETRY_CONFIG.unpack_from(data, offset)
+                offset += self._TELEMETRY_CONFIG.size
+
+            # Per-frame records, delta-coded per eye within this datagram
+            field_count = 2 + len(self._TELEMETRY_STAGES)
+            previous = ([0] * field_count, [0] * field_count)
+            records = []
+            for _ in range(record_count):
+                eye = data[offset]
+                offset += 1
+                fields = previous[eye]
+                for i in range(field_count):
+                    byte = data[offset]
+                    if byte < 0x80:  # most deltas fit one byte
+                        offset += 1
+                        delta = (byte >> 1) ^ -(byte & 1)
+                    else:
+                        delta, offset = _read_zigzag_varint(data, offset)
+                    fields[i] = (fields[i] + delta) & 0xFFFFFFFFFFFFFFFF
+                records.append((eye, tuple(fields)))
+
+            if records_dropped:
+                self.logger.warning(f"Telemetry: headset dropped {records_dropped} frame record(s)")
             self.logger.debug(
-                f"DEBUG INFO from {client_addr[0]}:{client_addr[1]} - "
-                f"frame_id={frame_id}, fps={fps:.1f}, ts={timestamp}, "
-                f"pipeline_us=[camera={camera_us}, vidConv={vidConv_us}, enc={enc_us}, rtpPay={rtpPay_us}, "
-                f"udpStream={udpStream_us}, jbHold={jbHold_us}, rtpDepay={rtpDepay_us}, dec={dec_us}, appsink={appsink_us}, pres={presentation_us}], "
+                f"TELEMETRY from {client_addr[0]}:{client_addr[1]} - seq={seq}, ts={timestamp}, "
+                f"records={record_count}, dropped={records_dropped}, "
                 f"ntp=[offset_us={ntp_offset_us}, synced={ntp_synced}, time_since_sync_us={time_since_ntp_sync_us}]"
             )
 
             # Write to InfluxDB if enabled
             if self.influx_client:
                 try:
-                    # Calculate total pipeline latency. jbHold_us is the
-                    # rtpjitterbuffer hold time, measured between udpsrc and
-                    # the depayloader, keyed by RTP timestamp.
-                    total_latency_us = camera_us + vidConv_us + enc_us + rtpPay_us + udpStream_us + jbHold_us + rtpDepay_us + dec_us + appsink_us + presentation_us
-
-                    # Create Point using influxdb3-python API
-                    # Use current time instead of packet timestamp (which is relative, not Unix epoch)
-                    timestamp_ns = time.time_ns()
-
-                    point = (
-                        Point("pipeline_metrics")
-                        .tag("source", client_addr[0])
-                        .field("frame_id", int(frame_id))
-                        .field("fps", float(fps))
-                        .field("camera_us", int(camera_us))
-                        .field("vidConv_us", int(vidConv_us))
-                        .field("enc_us", int(enc_us))
-                        .field("rtpPay_us", int(rtpPay_us))
-                        .field("udpStream_us", int(udpStream_us))
-                        .field("jbHold_us", int(jbHold_us))
-                        .field("rtpDepay_us", int(rtpDepay_us))
-                        .field("dec_us", int(dec_us))
-                        .field("appsink_us", int(appsink_us))
-                        .field("presentation_us", int(presentation_us))
-                        .field("total_latency_us", int(total_latency_us))
-                        .field("ntp_offset_us", int(ntp_offset_us))
-                        .field("ntp_synced", int(ntp_synced))
-                        .field("time_since_ntp_sync_us", int(time_since_ntp_sync_us))
-                        # Streaming config (shared)
-                        .field("codec", int(codec))
-                        .field("video_mode", int(video_mode))
-                        .field("resolution_width", int(res_width))
-                        .field("resolution_height", int(res_height))
-                        .field("fps_config", int(fps_config))
-                        .field("bitrate_cfg", int(bitrate_cfg))
-                        # Per-eye network health
-                        .field("left_lost", int(left_lost))
-                        .field("left_rtx", int(left_rtx))
-                        .field("left_jitter_us", int(left_jitter_us))
-                        .field("left_bitrate_bps", int(left_bitrate_bps))
-                        .field("right_lost", int(right_lost))
-                        .field("right_rtx", int(right_rtx))
-                        .field("right_jitter_us", int(right_jitter_us))
-                        .field("right_bitrate_bps", int(right_bitrate_bps))
-                        .time(timestamp_ns)
-                    )
-
-                    # Buffer point for batch write (non-blocking)
+                    source = client_addr[0]
+                    # Frames are stamped at their appsink time: ready_us and the
+                    # batch timestamp share the headset clock, the offset from
+                    # now is applied to the relay's clock.
+                    now_ns = time.time_ns()
+                    # Records are written as line protocol: one Point object per
+                    # frame costs more than the rest of the parsing together.
+                    line = self._TELEMETRY_FRAME_LINE.format
+                    lines = []
+                    for eye, fields in records:
+                        stages = fields[2:]
+                        time_ns = now_ns - (timestamp - fields[1]) * 1000
+                        lines.append(line(source, self._TELEMETRY_EYES[eye], fields[0], *stages, sum(stages), time_ns))
+
+                    point = None
+                    if health:
+                        point = (
+                            Point("pipeline_health")
+                            .tag("source", source)
+                            .field("fps", float(health[0][0]))
+                            .field("right_fps", float(health[1][0]))
+                            .field("ntp_offset_us", int(ntp_offset_us))
+                            .field("ntp_synced", int(ntp_synced))
+                            .field("time_since_ntp_sync_us", int(time_since_ntp_sync_us))
+                            .field("records_dropped", int(records_dropped))
+                            .field("datagrams_lost", int(self.telemetry_datagrams_lost))
+                            .field("head_pose_lost", int(self.head_pose_lost))
+                            .field("head_pose_recovered", int(self.head_pose_recovered))
+                            .field("head_pose_reordered", int(self.head_pose_reordered))
+                        )
+                        # Per-eye network health and rolling total-latency percentiles
+                        for name, (_, lost, rtx, jitter_us, bitrate_bps, jb_latency_ms,
+                                   p50, p95, p99, max_us) in zip(self._TELEMETRY_EYES, health):
+                            (point
+                             .field(f"{name}_lost", int(lost))
+                             .field(f"{name}_rtx", int(rtx))
+                             .field(f"{name}_jitter_us", int(jitter_us))
+                             .field(f"{name}_bitrate_bps", int(bitrate_bps))
+                             .field(f"{name}_jb_latency_ms", int(jb_latency_ms))
+                             .field(f"{name}_total_p50_us", int(p50))
+                             .field(f"{name}_total_p95_us", int(p95))
+                             .field(f"{name}_total_p99_us", int(p99))
+                             .field(f"{name}_total_max_us", int(max_us)))
+                        # Streaming config (shared); only sent when it changes, repeated here
+                        if self._telemetry_config:
+                            codec, video_mode, res_width, res_height, fps_config, bitrate_cfg = self._telemetry_config
+                            (point
+                             .field("codec", int(codec))
+                             .field("video_mode", int(video_mode))
+                             .field("resolution_width", int(res_width))
+                             .field("resolution_height", int(res_height))
+                             .field("fps_config", int(fps_config))
+                             .field("bitrate_cfg", int(bitrate_cfg)))
+                        point.time(now_ns)
+
+                    # Buffer for batch write (non-blocking)
                     with self.influx_buffer_lock:
-                        self.influx_buffer.append(point)
-                    self.logger.debug(f"Buffered metrics for InfluxDB: frame_id={frame_id}, fps={fps:.1f}, buffer_size={len(self.influx_buffer)}")
+                        self.influx_buffer.extend(lines)
+                        if point is not None:
+                            self.influx_buffer.append(point)
+                    self.logger.debug(f"Buffered telemetry for InfluxDB: {len(lines)} frames, buffer_size={len(self.influx_buffer)}")
                 except Exception as e:
-                    self.logger.warning(f"Failed to buffer InfluxDB point: {e}")
+                    self.logger.warning(f"Failed to buffer InfluxDB points: {e}")
 
             # Reset error counter on success
             self.consecutive_errors = 0
 
-        except struct.error as e:
+        except (struct.error, IndexError) as e:
             self.consecutive_errors += 1
-            self.logger.error(f"Error parsing debug info: {e}")
+            self.logger.error(f"Error parsing telemetry: {e}")
         except Exception as e:
             self.consecutive_errors += 1
-            self.logger.error(f"Error handling debug info: {e}")
+            self.logger.error(f"Error handling telemetry: {e}")
 
     def _listen_loop(self):
         """
@@ -51,11 +51,38 @@ class TGDrivesTranslator(ServoTranslator):
     SPEED = 0x07
     MODE = 0x09
 
+    # Longest sample interval the low-pass integrates over; a longer gap in
+    # the head pose stream moves the target no further than this would
+    MAX_FILTER_INTERVAL_US = 100000
+
+    @staticmethod
+    def filter_alpha_for_interval(filter_alpha: float, reference_hz: float, interval_us: int) -> float:
+        """
+        Low-pass alpha for one sample, scaled to the time since the previous one.
+
+        filter_alpha is the per-sample alpha at reference_hz. Applying the
+        returned alpha once over interval_us decays the error as much as
+        filter_alpha applied at reference_hz over the same time, so the
+        smoothing time constant does not depend on the head pose rate.
+
+        Args:
+            filter_alpha: Alpha for one sample at the reference rate (0-1)
+            reference_hz: Sample rate filter_alpha is tuned for
+            interval_us: Time since the previous sample, microseconds
+
+        Returns:
+            Alpha to apply for this sample (0-1)
+        """
+        interval_us = max(0, min(interval_us, TGDrivesTranslator.MAX_FILTER_INTERVAL_US))
+        periods = interval_us * reference_hz / 1e6
+        return 1.0 - (1.0 - filter_alpha) ** periods
+
     def __init__(self, servo_ip: str, servo_port: int, timeout: float,
                  azimuth_min: int = -180000, azimuth_max: int = 180000,
                  elevation_min: int = -90000, elevation_max: int = 90000,
                  speed_max: int = 1000000, speed_multiplier: float = 0.0,
-                 filter_alpha: float = 0.15, swap_axes: bool = False,
+                 filter_alpha: float = 0.15, filter_reference_hz: float = 72.0,
+                 max_command_rate_hz: float = 90.0, swap_axes: bool = False,
                  invert_azimuth: bool = False, invert_elevation: bool = False):
         """
         Initialize TG Drives translator.
@@ -70,7 +97,12 @@ class TGDrivesTranslator(ServoTranslator):
             elevation_max: Maximum elevation value in motor units
             speed_max: Maximum speed value for servos
             speed_multiplier: Speed multiplier for accelerated movement
-            filter_alpha: Low-pass filter alpha (0-1, higher = less filtering)
+            filter_alpha: Low-pass filter alpha per sample at filter_reference_hz
+                (0-1, higher = less filtering)
+            filter_reference_hz: Head pose rate filter_alpha is tuned for; the
+                alpha is rescaled to each sample's interval
+            max_command_rate_hz: Most GT commands sent per second (0 = one per
+                sample); samples in between still update the filter
             swap_axes: Whether to swap azimuth and elevation axes
             invert_azimuth: Whether to invert azimuth direction
             invert_elevation: Whether to invert elevation direction
@@ -91,9 +123,14 @@ class TGDrivesTranslator(ServoTranslator):
 
         # Filtering
         self.filter_alpha = filter_alpha
+        self.filter_reference_hz = filter_reference_hz
         self.azimuth_filtered = 0
         self.elevation_filtered = 0
 
+        # Command rate limit, in sample time
+        self.min_command_interval_us = int(1e6 / max_command_rate_hz) if max_command_rate_hz > 0 else 0
+        self.last_command_timestamp = 0
+
         # Out-of-order packet guard
         self.last_timestamp = 0
 
@@ -179,7 +216,10 @@ class TGDrivesTranslator(ServoTranslator):
             self.logger.warning(f"Out-of-order packet dropped: ts={timestamp}, last_ts={self.last_timestamp}")
             return None
 
+        # The first sample counts as one reference period
+        interval_us = timestamp - self.last_timestamp if self.last_timestamp else int(1e6 / self.filter_reference_hz)
         self.last_timestamp = timestamp
+        alpha = self.filter_alpha_for_interval(self.filter_alpha, self.filter_reference_hz, interval_us)
 
         self.logger.debug(f"Received: azimuth={azimuth_rad:.3f} rad, elevation={elevation_rad:.3f} rad, speed={speed_motor}, ts={timestamp}")
 
@@ -198,7 +238,12 @@ class TGDrivesTranslator(ServoTranslator):
             self.logger.debug(f"Elevation inverted: {elevation_rad:.3f} rad")
 
         # Convert radians to motor units
-        azimuth_motor, elevation_motor = self._convert_to_motor_units(azimuth_rad, elevation_rad)
+        azimuth_motor, elevation_motor = self._convert_to_motor_units(azimuth_rad, elevation_rad, alpha)
+
+        # The filter follows every sample; the drive gets at most max_command_rate_hz commands
+        if timestamp - self.last_command_timestamp < self.min_command_interval_us:
+            return None
+        self.last_command_timestamp = timestamp
 
         # Build GT protocol message
         gt_message = self._build_gt_message(azimuth_motor, elevation_motor, int(speed_motor))
@@ -216,13 +261,14 @@ class TGDrivesTranslator(ServoTranslator):
         # For now, we'll skip waiting for response to match that behavior
         return None
 
-    def _convert_to_motor_units(self, azimuth_rad: float, elevation_rad: float) -> Tuple[int, int]:
+    def _convert_to_motor_units(self, azimuth_rad: float, elevation_rad: float, alpha: float) -> Tuple[int, int]:
         """
         Convert azimuth/elevation from radians to motor units.
 
         Args:
             azimuth_rad: Azimuth in radians
             elevation_rad: Elevation in radians
+            alpha: Low-pass alpha for this sample (see filter_alpha_for_interval)
 
         Returns:
             Tuple of (azimuth_motor, elevation_motor) in motor units
@@ -243,8 +289,8 @@ class TGDrivesTranslator(ServoTranslator):
         elevation_motor += int((elevation_motor - elevation_center) * self.speed_multiplier)
 
         # Apply low-pass filter
-        self.azimuth_filtered = int(self.azimuth_filtered * (1.0 - self.filter_alpha) + azimuth_motor * self.filter_alpha)
-        self.elevation_filtered = int(self.elevation_filtered * (1.0 - self.filter_alpha) + elevation_motor * self.filter_alpha)
+        self.azimuth_filtered = int(self.azimuth_filtered * (1.0 - alpha) + azimuth_motor * alpha)
+        self.elevation_filtered = int(self.elevation_filtered * (1.0 - alpha) + elevation_motor * alpha)
 
         # Clamp to limits
         self.azimuth_filtered = max(self.azimuth_min, min(self.azimuth_max, self.azimuth_filtered))
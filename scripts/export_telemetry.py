@@ -37,19 +37,21 @@ def export_to_csv(
         database=database,
     )
 
-    # Select specific columns: time, all latency stages, and fps
+    # Select specific columns: time and all latency stages of the left eye's frames
     # Mixed-case names need double quotes in SQL
     columns = [
         "time",
         "frame_id",
-        "fps",
         "camera_us",
         '"vidConv_us"',
         "enc_us",
         '"rtpPay_us"',
         '"udpStream_us"',
+        '"jbHold_us"',
         '"rtpDepay_us"',
         "dec_us",
+        "queue_us",
+        "appsink_us",
         "presentation_us",
         "total_latency_us",
     ]
@@ -57,9 +59,9 @@ def export_to_csv(
     select_clause = ", ".join(columns)
 
     if time_filter:
-        query = f"SELECT {select_clause} FROM pipeline_metrics WHERE time > now() - INTERVAL '{time_filter}' ORDER BY time"
+        query = f"SELECT {select_clause} FROM pipeline_metrics WHERE eye = 'left' AND time > now() - INTERVAL '{time_filter}' ORDER BY time"
     else:
-        query = f"SELECT {select_clause} FROM pipeline_metrics ORDER BY time"
+        query = f"SELECT {select_clause} FROM pipeline_metrics WHERE eye = 'left' ORDER BY time"
 
     print(f"Executing query...")
 
@@ -74,6 +76,10 @@ def export_to_csv(
         print("No data found in database.")
         sys.exit(0)
 
+    # One row per frame, stamped at its appsink time: fps is the frame count over the trailing second
+    if 'time' in df.columns:
+        df.insert(2, 'fps', df.rolling('1s', on='time')['frame_id'].count())
+
     # Convert timestamp to readable format
     if 'time' in df.columns:
         df['time'] = df['time'].astype(str)
@@ -41,8 +41,9 @@ def cfg_dict_from_state(s: dict) -> dict:
         "bitrate": int(s["bitrate"]),
         "horizontalResolution": int(s["resolution"]["width"]),
         "verticalResolution": int(s["resolution"]["height"]),
-        "videoMode": s["video_mode"],  # "mono"/"stereo"/"panoramic"
+        "videoMode": s["video_mode"],  # "mono"/"stereo"/"panoramic"/"foveated"
         "fps": int(s["fps"]),
+        "maxFrameAgeMs": int(s.get("max_frame_age_ms", 50)),
     }
 
 
@@ -149,6 +150,7 @@ def api_v1_stream_state_get():  # noqa: E501
                 "resolution": {"width": 1920, "height": 1080},
                 "video_mode": "stereo",
                 "fps": 60,
+                "max_frame_age_ms": 50,
                 "is_streaming": False,
             }
 
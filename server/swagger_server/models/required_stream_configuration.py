@@ -16,7 +16,7 @@ class RequiredStreamConfiguration(Model):
 
     Do not edit the class manually.
     """
-    def __init__(self, ip_address: str=None, port_left: int=None, port_right: int=None, codec: str=None, encoding_quality: int=None, bitrate: str=None, resolution: Apiv1streamupdateResolution=None, video_mode: str=None, fps: int=None):  # noqa: E501
+    def __init__(self, ip_address: str=None, port_left: int=None, port_right: int=None, codec: str=None, encoding_quality: int=None, bitrate: str=None, resolution: Apiv1streamupdateResolution=None, video_mode: str=None, fps: int=None, max_frame_age_ms: int=None):  # noqa: E501
         """RequiredStreamConfiguration - a model defined in Swagger
 
         :param ip_address: The ip_address of this RequiredStreamConfiguration.  # noqa: E501
@@ -37,6 +37,8 @@ class RequiredStreamConfiguration(Model):
         :type video_mode: str
         :param fps: The fps of this RequiredStreamConfiguration.  # noqa: E501
         :type fps: int
+        :param max_frame_age_ms: The max_frame_age_ms of this RequiredStreamConfiguration.  # noqa: E501
+        :type max_frame_age_ms: int
         """
         self.swagger_types = {
             'ip_address': str,
@@ -47,7 +49,8 @@ class RequiredStreamConfiguration(Model):
             'bitrate': str,
             'resolution': Apiv1streamupdateResolution,
             'video_mode': str,
-            'fps': int
+            'fps': int,
+            'max_frame_age_ms': int
         }
 
         self.attribute_map = {
@@ -59,7 +62,8 @@ class RequiredStreamConfiguration(Model):
             'bitrate': 'bitrate',
             'resolution': 'resolution',
             'video_mode': 'video_mode',
-            'fps': 'fps'
+            'fps': 'fps',
+            'max_frame_age_ms': 'max_frame_age_ms'
         }
         self._ip_address = ip_address
         self._port_left = port_left
@@ -70,6 +74,7 @@ class RequiredStreamConfiguration(Model):
         self._resolution = resolution
         self._video_mode = video_mode
         self._fps = fps
+        self._max_frame_age_ms = max_frame_age_ms
 
     @classmethod
     def from_dict(cls, dikt) -> 'RequiredStreamConfiguration':
@@ -265,7 +270,7 @@ class RequiredStreamConfiguration(Model):
         :param video_mode: The video_mode of this RequiredStreamConfiguration.
         :type video_mode: str
         """
-        allowed_values = ["stereo", "mono", "panoramic"]  # noqa: E501
+        allowed_values = ["stereo", "mono", "panoramic", "foveated"]  # noqa: E501
         if video_mode not in allowed_values:
             raise ValueError(
                 "Invalid value for `video_mode` ({0}), must be one of {1}"
@@ -296,3 +301,26 @@ class RequiredStreamConfiguration(Model):
             raise ValueError("Invalid value for `fps`, must not be `None`")  # noqa: E501
 
         self._fps = fps
+
+    @property
+    def max_frame_age_ms(self) -> int:
+        """Gets the max_frame_age_ms of this RequiredStreamConfiguration.
+
+        Frames older than this when they reach the encoder are dropped. 0 disables the check.  # noqa: E501
+
+        :return: The max_frame_age_ms of this RequiredStreamConfiguration.
+        :rtype: int
+        """
+        return self._max_frame_age_ms
+
+    @max_frame_age_ms.setter
+    def max_frame_age_ms(self, max_frame_age_ms: int):
+        """Sets the max_frame_age_ms of this RequiredStreamConfiguration.
+
+        Frames older than this when they reach the encoder are dropped. 0 disables the check.  # noqa: E501
+
+        :param max_frame_age_ms: The max_frame_age_ms of this RequiredStreamConfiguration.
+        :type max_frame_age_ms: int
+        """
+
+        self._max_frame_age_ms = max_frame_age_ms
@@ -16,7 +16,7 @@ class StreamState(Model):
 
     Do not edit the class manually.
     """
-    def __init__(self, is_streaming: bool=None, ip_address: str=None, port_left: int=None, port_right: int=None, codec: str=None, encoding_quality: int=None, bitrate: str=None, resolution: Apiv1streamupdateResolution=None, video_mode: str=None, fps: int=None):  # noqa: E501
+    def __init__(self, is_streaming: bool=None, ip_address: str=None, port_left: int=None, port_right: int=None, codec: str=None, encoding_quality: int=None, bitrate: str=None, resolution: Apiv1streamupdateResolution=None, video_mode: str=None, fps: int=None, max_frame_age_ms: int=None):  # noqa: E501
         """StreamState - a model defined in Swagger
 
         :param is_streaming: The is_streaming of this StreamState.  # noqa: E501
@@ -39,6 +39,8 @@ class StreamState(Model):
         :type video_mode: str
         :param fps: The fps of this StreamState.  # noqa: E501
         :type fps: int
+        :param max_frame_age_ms: The max_frame_age_ms of this StreamState.  # noqa: E501
+        :type max_frame_age_ms: int
         """
         self.swagger_types = {
             'is_streaming': bool,
@@ -50,7 +52,8 @@ class StreamState(Model):
             'bitrate': str,
             'resolution': Apiv1streamupdateResolution,
             'video_mode': str,
-            'fps': int
+            'fps': int,
+            'max_frame_age_ms': int
         }
 
         self.attribute_map = {
@@ -63,7 +66,8 @@ class StreamState(Model):
             'bitrate': 'bitrate',
             'resolution': 'resolution',
             'video_mode': 'video_mode',
-            'fps': 'fps'
+            'fps': 'fps',
+            'max_frame_age_ms': 'max_frame_age_ms'
         }
         self._is_streaming = is_streaming
         self._ip_address = ip_address
@@ -75,6 +79,7 @@ class StreamState(Model):
         self._resolution = resolution
         self._video_mode = video_mode
         self._fps = fps
+        self._max_frame_age_ms = max_frame_age_ms
 
     @classmethod
     def from_dict(cls, dikt) -> 'StreamState':
@@ -279,7 +284,7 @@ class StreamState(Model):
         :param video_mode: The video_mode of this StreamState.
         :type video_mode: str
         """
-        allowed_values = ["stereo", "mono", "panoramic"]  # noqa: E501
+        allowed_values = ["stereo", "mono", "panoramic", "foveated"]  # noqa: E501
         if video_mode not in allowed_values:
             raise ValueError(
                 "Invalid value for `video_mode` ({0}), must be one of {1}"
@@ -308,3 +313,26 @@ class StreamState(Model):
         """
 
         self._fps = fps
+
+    @property
+    def max_frame_age_ms(self) -> int:
+        """Gets the max_frame_age_ms of this StreamState.
+
+        Frames older than this when they reach the encoder are dropped. 0 disables the check.  # noqa: E501
+
+        :return: The max_frame_age_ms of this StreamState.
+        :rtype: int
+        """
+        return self._max_frame_age_ms
+
+    @max_frame_age_ms.setter
+    def max_frame_age_ms(self, max_frame_age_ms: int):
+        """Sets the max_frame_age_ms of this StreamState.
+
+        Frames older than this when they reach the encoder are dropped. 0 disables the check.  # noqa: E501
+
+        :param max_frame_age_ms: The max_frame_age_ms of this StreamState.
+        :type max_frame_age_ms: int
+        """
+
+        self._max_frame_age_ms = max_frame_age_ms
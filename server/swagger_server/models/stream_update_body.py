@@ -15,7 +15,7 @@ class StreamUpdateBody(Model):
 
     Do not edit the class manually.
     """
-    def __init__(self, ip_address: str=None, port_left: int=None, port_right: int=None, codec: str=None, encoding_quality: int=None, bitrate: int=None, resolution: Apiv1streamupdateResolution=None, video_mode: str=None, fps: int=None):  # noqa: E501
+    def __init__(self, ip_address: str=None, port_left: int=None, port_right: int=None, codec: str=None, encoding_quality: int=None, bitrate: int=None, resolution: Apiv1streamupdateResolution=None, video_mode: str=None, fps: int=None, max_frame_age_ms: int=None):  # noqa: E501
         """StreamUpdateBody - a model defined in Swagger
 
         :param ip_address: The ip_address of this StreamUpdateBody.  # noqa: E501
@@ -36,6 +36,8 @@ class StreamUpdateBody(Model):
         :type video_mode: str
         :param fps: The fps of this StreamUpdateBody.  # noqa: E501
         :type fps: int
+        :param max_frame_age_ms: The max_frame_age_ms of this StreamUpdateBody.  # noqa: E501
+        :type max_frame_age_ms: int
         """
         self.swagger_types = {
             'ip_address': str,
@@ -46,7 +48,8 @@ class StreamUpdateBody(Model):
             'bitrate': int,
             'resolution': Apiv1streamupdateResolution,
             'video_mode': str,
-            'fps': int
+            'fps': int,
+            'max_frame_age_ms': int
         }
 
         self.attribute_map = {
@@ -58,7 +61,8 @@ class StreamUpdateBody(Model):
             'bitrate': 'bitrate',
             'resolution': 'resolution',
             'video_mode': 'video_mode',
-            'fps': 'fps'
+            'fps': 'fps',
+            'max_frame_age_ms': 'max_frame_age_ms'
         }
         self._ip_address = ip_address
         self._port_left = port_left
@@ -69,6 +73,7 @@ class StreamUpdateBody(Model):
         self._resolution = resolution
         self._video_mode = video_mode
         self._fps = fps
+        self._max_frame_age_ms = max_frame_age_ms
 
     @classmethod
     def from_dict(cls, dikt) -> 'StreamUpdateBody':
@@ -252,7 +257,7 @@ class StreamUpdateBody(Model):
         :param video_mode: The video_mode of this StreamUpdateBody.
         :type video_mode: str
         """
-        allowed_values = ["stereo", "mono", "panoramic"]  # noqa: E501
+        allowed_values = ["stereo", "mono", "panoramic", "foveated"]  # noqa: E501
         if video_mode not in allowed_values:
             raise ValueError(
                 "Invalid value for `video_mode` ({0}), must be one of {1}"
@@ -281,3 +286,26 @@ class StreamUpdateBody(Model):
         """
 
         self._fps = fps
+
+    @property
+    def max_frame_age_ms(self) -> int:
+        """Gets the max_frame_age_ms of this StreamUpdateBody.
+
+        Frames older than this when they reach the encoder are dropped. 0 disables the check.  # noqa: E501
+
+        :return: The max_frame_age_ms of this StreamUpdateBody.
+        :rtype: int
+        """
+        return self._max_frame_age_ms
+
+    @max_frame_age_ms.setter
+    def max_frame_age_ms(self, max_frame_age_ms: int):
+        """Sets the max_frame_age_ms of this StreamUpdateBody.
+
+        Frames older than this when they reach the encoder are dropped. 0 disables the check.  # noqa: E501
+
+        :param max_frame_age_ms: The max_frame_age_ms of this StreamUpdateBody.
+        :type max_frame_age_ms: int
+        """
+
+        self._max_frame_age_ms = max_frame_age_ms
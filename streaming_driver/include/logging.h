@@ -8,6 +8,10 @@
 #include <exception>
 #include <gst/rtp/gstrtpbuffer.h>
 #include <string_view>
+#include <atomic>
+#include <map>
+#include <algorithm>
+#include <cmath>
 
 // ============================================================================
 // Constants
@@ -16,6 +20,13 @@
 namespace PipelineNames {
     constexpr std::string_view LEFT = "pipeline_left";
     constexpr std::string_view RIGHT = "pipeline_right";
+    // Per-frame state of the foveated inset stream is keyed by the owning
+    // pipeline's name + this suffix (it has its own frame ids and stage times).
+    constexpr std::string_view FOVEA_SUFFIX = "_fovea";
+}
+
+namespace FoveaNames {
+    constexpr std::string_view ENC_TAIL = "fovea_enc_tail";
 }
 
 namespace IdentityNames {
@@ -23,6 +34,7 @@ namespace IdentityNames {
     constexpr std::string_view VIDEO_CONVERT = "vidconv_ident";
     constexpr std::string_view ENCODER = "enc_ident";
     constexpr std::string_view RTP_PAYLOADER = "rtppay_ident";
+    constexpr std::string_view FOVEA_VIDEO_CONVERT = "fovea_vidconv_ident";
 }
 
 // IMX415 sensor + Argus capture-to-output latency. The sensor does not expose
@@ -77,6 +89,13 @@ public:
         map_[pts] = time_us;
     }
 
+    // Like consume(), but leaves the entry for the downstream stage.
+    uint64_t peek(uint64_t pts) const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = map_.find(pts);
+        return it == map_.end() ? 0 : it->second;
+    }
+
     // Returns 0 if pts not found.
     uint64_t consume(uint64_t pts) {
         std::lock_guard<std::mutex> lock(mtx_);
@@ -92,6 +111,82 @@ private:
     std::unordered_map<uint64_t, uint64_t> map_;
 };
 
+// ============================================================================
+// Foveated inset crop rectangle
+// ============================================================================
+
+/**
+ * Inset crop window in the DELIVERED (flipped) full frame, normalised to
+ * 0..65535 per axis and packed into one uint64 so it travels through a
+ * PtsTimestampMap and as a single 8-byte RTP extension element:
+ *   bits  0..15 x, 16..31 y, 32..47 width, 48..63 height
+ * Row 0 is the first row of the delivered frame. Width/height are never 0, so
+ * a packed value of 0 means "no crop".
+ */
+inline uint64_t PackFoveaRect(double x, double y, double w, double h) {
+    auto q = [](double v) -> uint64_t {
+        if (v < 0.0) v = 0.0;
+        if (v > 1.0) v = 1.0;
+        return static_cast<uint64_t>(v * 65535.0 + 0.5);
+    };
+    return q(x) | (q(y) << 16) | (q(w) << 32) | (q(h) << 48);
+}
+
+// ============================================================================
+// Camera pose (pan-tilt boresight)
+// ============================================================================
+
+/**
+ * Pan-tilt boresight packed into one uint64 so it travels through a
+ * PtsTimestampMap and as a single 8-byte RTP extension element (id 2):
+ *   bits 0..15 azimuth, 16..31 elevation (signed, 0.1 mrad units), bit 32 set
+ * so that a valid pose is never 0. Positive azimuth is left, positive
+ * elevation up -- the convention of the headset's head pose packets.
+ */
+inline uint64_t PackCameraPose(double azimuth, double elevation) {
+    auto q = [](double rad) -> uint64_t {
+        const double units = std::clamp(rad * 10000.0, -32767.0, 32767.0);
+        return static_cast<uint16_t>(static_cast<int16_t>(std::lround(units)));
+    };
+    return q(azimuth) | (q(elevation) << 16) | (uint64_t{1} << 32);
+}
+
+/**
+ * Recent boresight samples from the relay, so a frame can be tagged with the
+ * pose at exposure rather than the one current when it leaves the camera.
+ */
+class CameraPoseHistory {
+public:
+    static constexpr size_t SIZE = 64;
+
+    void record(uint64_t timeUs, uint64_t pose) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        samples_[next_ % SIZE] = {timeUs, pose};
+        next_++;
+    }
+
+    // Latest pose recorded at or before timeUs (else the oldest kept); 0 if none yet.
+    uint64_t at(uint64_t timeUs) const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        const size_t count = std::min(next_, SIZE);
+        for (size_t i = 1; i <= count; i++) {
+            const Sample &s = samples_[(next_ - i) % SIZE];
+            if (s.timeUs <= timeUs || i == count) return s.pose;
+        }
+        return 0;
+    }
+
+private:
+    struct Sample {
+        uint64_t timeUs;
+        uint64_t pose;
+    };
+
+    mutable std::mutex mtx_;
+    Sample samples_[SIZE]{};
+    size_t next_ = 0;
+};
+
 // ============================================================================
 // Per-Pipeline State
 // ============================================================================
@@ -108,6 +203,28 @@ struct PipelineState {
     PtsTimestampMap vidconvPtsMap;
     PtsTimestampMap encPtsMap;
 
+    // Foveated mode only. On the base stream's state, `fovea` points at the
+    // inset stream's state so the shared camsrc_ident can feed both. On the
+    // inset state, cropPtsMap holds the packed crop rect (PackFoveaRect) that
+    // was live when the frame left fovea_crop -- same PTS-keyed map, the value
+    // is just not a timestamp.
+    PipelineState *fovea = nullptr;
+    PtsTimestampMap cropPtsMap;
+
+    // Packed camera pose (PackCameraPose) at exposure, stored at camsrc_ident;
+    // empty while no boresight has been received.
+    PtsTimestampMap cameraPosePtsMap;
+
+    // Freshness gate in front of the encoder (fresh_queue, see pipelines.h).
+    // maxFrameAgeUs is set from the config; the rest are written on the
+    // encoder-side streaming thread and drained by the camera thread's report.
+    std::atomic<uint64_t> maxFrameAgeUs{0};       // 0 = no age limit
+    std::atomic<uint64_t> overrunDrops{0};        // superseded by a newer frame in the queue
+    std::atomic<uint64_t> ageDrops{0};            // older than maxFrameAgeUs at encode start
+    std::atomic<uint64_t> encodeAgeSumUs{0};      // camsrc -> encode start, frames passed
+    std::atomic<uint64_t> encodeAgeMaxUs{0};
+    std::atomic<uint64_t> encodeAgeCount{0};
+
     uint16_t getAndIncrementFrameId() {
         return frameId++;
     }
@@ -119,6 +236,13 @@ struct PipelineState {
 
 inline std::map<std::string, PipelineState> pipelineStates;
 
+// Crop window currently applied to fovea_crop (PackFoveaRect), written by the
+// gaze listener, sampled per frame at fovea_vidconv_ident.
+inline std::atomic<uint64_t> foveaCropRect{0};
+
+// Camera boresight received from the relay, written by the camera pose listener.
+inline CameraPoseHistory cameraPoseHistory;
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
@@ -139,7 +263,8 @@ inline PipelineState& GetState(const std::string& pipelineName) {
 
 inline void AddRtpHeaderMetadataPerFrame(GstBuffer* buffer, PipelineState& state,
                                          uint64_t vidConvDuration, uint64_t encDuration,
-                                         uint64_t rtpPayDuration, uint64_t rtpPayTimestamp) {
+                                         uint64_t rtpPayDuration, uint64_t rtpPayTimestamp,
+                                         uint64_t foveaRect = 0, uint64_t cameraPose = 0) {
     GstRTPBuffer rtpBuf = GST_RTP_BUFFER_INIT;
     if (!gst_rtp_buffer_map(buffer, GST_MAP_READWRITE, &rtpBuf)) {
         return;
@@ -156,6 +281,15 @@ inline void AddRtpHeaderMetadataPerFrame(GstBuffer* buffer, PipelineState& state
         gst_rtp_buffer_add_extension_onebyte_header(&rtpBuf, 1, &rtpPayDuration, sizeof(rtpPayDuration)) &&
         gst_rtp_buffer_add_extension_onebyte_header(&rtpBuf, 1, &rtpPayTimestamp, sizeof(rtpPayTimestamp));
 
+    // Foveated inset stream: 7th element carries the crop window of this frame.
+    if (success && foveaRect != 0) {
+        success = gst_rtp_buffer_add_extension_onebyte_header(&rtpBuf, 1, &foveaRect, sizeof(foveaRect));
+    }
+    // Camera pose at exposure, under its own id so the id-1 element indices stay put.
+    if (success && cameraPose != 0) {
+        success = gst_rtp_buffer_add_extension_onebyte_header(&rtpBuf, 2, &cameraPose, sizeof(cameraPose));
+    }
+
     if (!success) {
         std::cerr << "Failed to add RTP header metadata\n";
     }
@@ -178,12 +312,28 @@ inline void OnIdentityHandoffCameraStreaming(GstElement* identity, GstBuffer* bu
     // rtppay stage reads an empty camsrc/vidconv map, skips embedding, and the
     // headset sees zeroed robot stages -> udpStream_us balloons to a full epoch
     // timestamp.
+    //
+    // The foveated inset branch (fovea_vidconv_ident + the fovea_enc_tail bin)
+    // lives in the same pipeline but is a separate stream, so it resolves to
+    // its own "<pipeline>_fovea" state and is handled like the base stage.
     GstObject* root = &identity->object;
+    bool inFoveaTail = false;
     while (root->parent != nullptr) {
         root = root->parent;
+        if (root->name != nullptr && root->name == FoveaNames::ENC_TAIL) {
+            inFoveaTail = true;
+        }
+    }
+    std::string pipelineName = (root->name != nullptr) ? root->name : "";
+    std::string identityName = identity->object.name;
+
+    const bool isFovea = inFoveaTail || identityName == IdentityNames::FOVEA_VIDEO_CONVERT;
+    if (isFovea) {
+        pipelineName += PipelineNames::FOVEA_SUFFIX;
+        if (identityName == IdentityNames::FOVEA_VIDEO_CONVERT) {
+            identityName = IdentityNames::VIDEO_CONVERT;
+        }
     }
-    const std::string pipelineName = (root->name != nullptr) ? root->name : "";
-    const std::string identityName = identity->object.name;
 
     auto& state = GetState(pipelineName);
 
@@ -195,9 +345,20 @@ inline void OnIdentityHandoffCameraStreaming(GstElement* identity, GstBuffer* bu
         // Static sensor + Argus latency contribution (unchanged from pre-patch).
         state.cameraFrameDuration = SENSOR_STATIC_LATENCY_US;
         state.camsrcPtsMap.store(ptsKey, now);
+        // The frame was exposed one sensor latency before it got here.
+        const uint64_t cameraPose = cameraPoseHistory.at(now - SENSOR_STATIC_LATENCY_US);
+        if (cameraPose != 0) state.cameraPosePtsMap.store(ptsKey, cameraPose);
+        if (state.fovea != nullptr) {
+            state.fovea->cameraFrameDuration = SENSOR_STATIC_LATENCY_US;
+            state.fovea->camsrcPtsMap.store(ptsKey, now);
+            if (cameraPose != 0) state.fovea->cameraPosePtsMap.store(ptsKey, cameraPose);
+        }
     }
     else if (identityName == IdentityNames::VIDEO_CONVERT) {
         state.vidconvPtsMap.store(ptsKey, now);
+        if (isFovea) {
+            state.cropPtsMap.store(ptsKey, foveaCropRect.load(std::memory_order_relaxed));
+        }
     }
     else if (identityName == IdentityNames::ENCODER) {
         state.encPtsMap.store(ptsKey, now);
@@ -224,7 +385,11 @@ inline void OnIdentityHandoffCameraStreaming(GstElement* identity, GstBuffer* bu
         uint64_t encDuration     = (encTime > vidconvTime)    ? (encTime - vidconvTime)    : 0;
         uint64_t rtpPayDuration  = (now > encTime)            ? (now - encTime)            : 0;
 
-        AddRtpHeaderMetadataPerFrame(buffer, state, vidConvDuration, encDuration, rtpPayDuration, now);
+        const uint64_t foveaRect = isFovea ? state.cropPtsMap.consume(ptsKey) : 0;
+        const uint64_t cameraPose = state.cameraPosePtsMap.consume(ptsKey);
+
+        AddRtpHeaderMetadataPerFrame(buffer, state, vidConvDuration, encDuration, rtpPayDuration, now,
+                                     foveaRect, cameraPose);
         state.lastEmbeddedPts = ptsKey;
     }
 }
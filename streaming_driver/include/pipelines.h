@@ -7,15 +7,21 @@
 #include <sstream>
 #include <string>
 #include <stdexcept>
+#include <gst/gst.h>
 
 enum Codec {
     JPEG, VP8, VP9, H264, H265
 };
 
 enum VideoMode {
-    STEREO, MONO, PANORAMIC
+    STEREO, MONO, PANORAMIC, FOVEATED
 };
 
+// Frames older than this (camsrc_ident -> encoder input) are dropped instead of
+// encoded. ~3 frame intervals at 60 FPS: normal camera->encoder transit is a few ms,
+// so only frames held back by an encoder/network stall exceed it.
+inline constexpr int DEFAULT_MAX_FRAME_AGE_MS = 50;
+
 struct StreamingConfig {
     std::string ip{};
     int portLeft{};
@@ -26,8 +32,22 @@ struct StreamingConfig {
     int horizontalResolution{}, verticalResolution{};
     VideoMode videoMode{};
     int fps{};
+    int maxFrameAgeMs{DEFAULT_MAX_FRAME_AGE_MS};  // 0 = no age limit
 };
 
+// Latest-frame-wins stage between the front-end and the encoder tail. A one-slot
+// leaky queue: under encoder/network backpressure a new frame replaces the one
+// still waiting (counted via "overrun"), so the encoder always picks up the
+// newest image. Frames that are still too old when they leave it are dropped by
+// a pad probe on its src pad (main.cpp, AttachFreshnessGate). It also gives the
+// encoder its own streaming thread, decoupling it from capture/convert.
+inline std::string GetFreshQueueDescription(const char *name) {
+    std::ostringstream oss;
+    oss << " ! queue name=" << name
+        << " max-size-buffers=1 max-size-bytes=0 max-size-time=0 leaky=downstream silent=false";
+    return oss.str();
+}
+
 // Camera exposure control (single source of truth for all pipelines).
 // "" (empty) => auto-exposure: correct for normal use / live teleoperation.
 // To re-lock for a latency-rig capture campaign, set this to a GStreamer
@@ -35,6 +55,44 @@ struct StreamingConfig {
 //     exposuretimerange=4000000 4000000   (remember the escaped quotes + trailing space)
 inline constexpr const char *CAMERA_EXPOSURE_LOCK = "";
 
+// JPEG restart markers, in MCU rows between markers (0 = none). Every marker
+// that starts an MCU row is a point where the headset can cut the frame into
+// independently decodable slices and decode them on several cores;
+// rtpjpegpay carries them (RFC 2435 restart marker header). The cost is a
+// few bytes per marker plus a DC predictor reset.
+inline constexpr int JPEG_RESTART_MCU_ROWS = 1;
+
+// True if elements made by the named factory have the given property. Looked
+// up on the element class, so no encoder instance is created.
+inline bool ElementFactoryHasProperty(const char *factoryName, const char *property) {
+    GstElementFactory *factory = gst_element_factory_find(factoryName);
+    if (!factory) return false;
+    GstPluginFeature *loaded = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+    gst_object_unref(factory);
+    if (!loaded) return false;
+    gpointer klass = g_type_class_ref(gst_element_factory_get_element_type(GST_ELEMENT_FACTORY(loaded)));
+    const bool found = g_object_class_find_property(G_OBJECT_CLASS(klass), property) != nullptr;
+    g_type_class_unref(klass);
+    gst_object_unref(loaded);
+    return found;
+}
+
+// Restart interval for the JPEG encoder, in MCUs (16x16 for the 4:2:0 output),
+// or 0 if restart markers are off or the encoder cannot emit them.
+inline int GetJpegRestartInterval(const StreamingConfig &cfg) {
+    static const bool supported = ElementFactoryHasProperty("nvjpegenc", "restart-interval");
+    if (JPEG_RESTART_MCU_ROWS <= 0) return 0;
+    if (!supported) {
+        static bool warned = false;
+        if (!warned) {
+            std::cerr << "nvjpegenc has no restart-interval property; JPEG frames carry no restart markers\n";
+            warned = true;
+        }
+        return 0;
+    }
+    return JPEG_RESTART_MCU_ROWS * ((cfg.horizontalResolution + 15) / 16);
+}
+
 // Encoder + RTP-payloader tail -- the ONLY codec-specific part of a per-camera
 // pipeline. Used both for the initial build and for a LIVE codec swap
 // (SwapEncoderTail in main.cpp), so a codec change replaces just this tail and
@@ -47,8 +105,11 @@ inline std::string GetEncoderTailDescription(const StreamingConfig &cfg) {
     std::ostringstream oss;
     switch (cfg.codec) {
         case Codec::JPEG:
-            oss << "nvjpegenc name=encoder quality=" << cfg.encodingQuality << " idct-method=ifast"
-                << " ! identity name=enc_ident"
+            oss << "nvjpegenc name=encoder quality=" << cfg.encodingQuality << " idct-method=ifast";
+            if (const int restartInterval = GetJpegRestartInterval(cfg)) {
+                oss << " restart-interval=" << restartInterval;
+            }
+            oss << " ! identity name=enc_ident"
                 << " ! rtpjpegpay name=rtppay mtu=1300";
             break;
         case Codec::H264:
@@ -59,7 +120,8 @@ inline std::string GetEncoderTailDescription(const StreamingConfig &cfg) {
         case Codec::H265:
             oss << "nvv4l2h265enc name=encoder control-rate=1 insert-sps-pps=1 iframeinterval=10 idrinterval=10 bitrate=" << cfg.bitrate << " preset-level=1"
                 << " ! identity name=enc_ident"
-                << " ! rtph265pay name=rtppay mtu=1300 config-interval=1 pt=96";
+                // Own payload type, so the headset can drop in-flight H264 packets after a codec swap
+                << " ! rtph265pay name=rtppay mtu=1300 config-interval=1 pt=97";
             break;
         case Codec::VP8:
         case Codec::VP9:
@@ -89,7 +151,53 @@ inline std::string GetCameraFrontEndDescription(const StreamingConfig &cfg, int
         << " ! capsfilter name=scale_capsfilter caps=video/x-raw(memory:NVMM),width=(int)" << cfg.horizontalResolution << ",height=(int)" << cfg.verticalResolution
         << " ! identity name=vidconv_ident"
         << " ! videorate drop-only=true"
-        << " ! capsfilter name=rate_capsfilter caps=video/x-raw(memory:NVMM),framerate=(fraction)" << cfg.fps << "/1";
+        << " ! capsfilter name=rate_capsfilter caps=video/x-raw(memory:NVMM),framerate=(fraction)" << cfg.fps << "/1"
+        << GetFreshQueueDescription("fresh_queue");
+    return oss.str();
+}
+
+// Foveated mode: camera 0 only, two streams from one Argus session.
+//   base  (portLeft)  -- full FOV scaled to the configured resolution
+//   inset (portRight) -- a 1/FOVEA_ZOOM crop of the native capture, scaled to the
+//                        same configured resolution, steered by the operator's gaze
+// Both encoders share the configured bitrate, so e.g. HD + HD inset costs about
+// one FHD stream while the centre of view gets FOVEA_ZOOM x the base detail.
+inline constexpr int FOVEA_ZOOM = 2;
+inline constexpr int FOVEA_CROP_WIDTH = CAMERA_CAPTURE_WIDTH / FOVEA_ZOOM;
+inline constexpr int FOVEA_CROP_HEIGHT = CAMERA_CAPTURE_HEIGHT / FOVEA_ZOOM;
+
+// Foveated camera front-end: the camera front-end above, but split by a tee right
+// after camsrc_ident into the base branch (same element names as the stereo
+// front-end, so SwapEncoderTail / UpdatePipelineProperties keep working) and a
+// fovea_* crop branch. fovea_crop's left/right/top/bottom are moved live by
+// FoveaGazeListener; the initial crop is centred.
+inline std::string GetFoveatedFrontEndDescription(const StreamingConfig &cfg, int sensorId) {
+    const int left = (CAMERA_CAPTURE_WIDTH - FOVEA_CROP_WIDTH) / 2;
+    const int top = (CAMERA_CAPTURE_HEIGHT - FOVEA_CROP_HEIGHT) / 2;
+
+    std::ostringstream oss;
+    oss << "nvarguscamerasrc aeantibanding=AeAntibandingMode_Off ee-mode=EdgeEnhancement_Off tnr-mode=NoiseReduction_Off saturation=1.2 " << CAMERA_EXPOSURE_LOCK << "sensor-id=" << sensorId
+        << " ! video/x-raw(memory:NVMM),width=(int)" << CAMERA_CAPTURE_WIDTH << ",height=(int)" << CAMERA_CAPTURE_HEIGHT << ",framerate=(fraction)60/1,format=(string)NV12"
+        << " ! identity name=camsrc_ident"
+        << " ! tee name=fovea_tee"
+        // Base branch
+        << " fovea_tee. ! queue max-size-buffers=1 leaky=downstream"
+        << " ! nvvidconv flip-method=vertical-flip"
+        << " ! capsfilter name=scale_capsfilter caps=video/x-raw(memory:NVMM),width=(int)" << cfg.horizontalResolution << ",height=(int)" << cfg.verticalResolution
+        << " ! identity name=vidconv_ident"
+        << " ! videorate drop-only=true"
+        << " ! capsfilter name=rate_capsfilter caps=video/x-raw(memory:NVMM),framerate=(fraction)" << cfg.fps << "/1"
+        << GetFreshQueueDescription("fresh_queue")
+        // Inset branch
+        << " fovea_tee. ! queue max-size-buffers=1 leaky=downstream"
+        << " ! nvvidconv name=fovea_crop flip-method=vertical-flip"
+        << " left=" << left << " right=" << left + FOVEA_CROP_WIDTH
+        << " top=" << top << " bottom=" << top + FOVEA_CROP_HEIGHT
+        << " ! capsfilter name=fovea_scale_capsfilter caps=video/x-raw(memory:NVMM),width=(int)" << cfg.horizontalResolution << ",height=(int)" << cfg.verticalResolution
+        << " ! identity name=fovea_vidconv_ident"
+        << " ! videorate drop-only=true"
+        << " ! capsfilter name=fovea_rate_capsfilter caps=video/x-raw(memory:NVMM),framerate=(fraction)" << cfg.fps << "/1"
+        << GetFreshQueueDescription("fovea_fresh_queue");
     return oss.str();
 }
 
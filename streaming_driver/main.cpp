@@ -6,6 +6,9 @@
 #include <gst/video/video.h>
 #include <thread>
 #include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
@@ -16,6 +19,14 @@
 using json = nlohmann::json;
 
 constexpr int CAMERA_SELECT_PORT = 9100;
+constexpr int FOVEA_GAZE_PORT = 9101;
+constexpr int CAMERA_POSE_PORT = 9102;
+constexpr auto FRESHNESS_REPORT_INTERVAL = std::chrono::seconds(5);
+
+// Horizontal field of view of the delivered (full) frame, used to map a gaze
+// offset in radians onto the frame. Lens dependent; vertical FOV follows from
+// the capture aspect ratio.
+constexpr double CAMERA_HFOV_RAD = 90.0 * M_PI / 180.0;
 
 StreamingConfig DEFAULT_STREAMING_CONFIG = {
     "192.168.1.100", 8554, 8556, Codec::JPEG, 85, 400000, 1920, 1080, VideoMode::STEREO, 60
@@ -46,6 +57,11 @@ int window_sensors[PANORAMIC_WINDOW_SIZE] = {5, 0, 1};  // sensor-id per slot
 int active_slot = 1;  // slot index currently selected (initially sensor 0 = forward)
 std::atomic<bool> swap_in_progress{false};
 
+// Foveated mode: the live inset crop element of camera 0's pipeline (nullptr
+// when not foveated / not running). Guarded by fovea_mutex.
+GstElement *fovea_crop = nullptr;
+std::mutex fovea_mutex;
+
 void StopPipeline(GstElement *pipeline) {
     if (pipeline == nullptr) { return; };
     std::cout << "Stopping the pipeline!\n";
@@ -128,9 +144,131 @@ static void ConnectLatencyHandoffs(GstElement *pipeline) {
     }
 }
 
+// Freshness gate, fresh_queue:src side. Runs on the encoder's streaming thread as
+// each frame leaves the one-slot queue, i.e. right as its encode starts. Age is
+// measured from camsrc_ident (this frame's PTS in camsrcPtsMap). Frames over the
+// configured max age are dropped here rather than encoded.
+static GstPadProbeReturn FreshQueueSrcProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void) pad;
+    auto *state = static_cast<PipelineState *>(user_data);
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+
+    const uint64_t ptsKey = static_cast<uint64_t>(GST_BUFFER_PTS(buffer));
+    const uint64_t camsrcTime = state->camsrcPtsMap.peek(ptsKey);
+    if (camsrcTime == 0) return GST_PAD_PROBE_OK;
+
+    const uint64_t now = GetCurrentUs();
+    const uint64_t age = (now > camsrcTime) ? (now - camsrcTime) : 0;
+    const uint64_t maxAge = state->maxFrameAgeUs.load(std::memory_order_relaxed);
+    if (maxAge != 0 && age > maxAge) {
+        state->ageDrops.fetch_add(1, std::memory_order_relaxed);
+        // This PTS never reaches rtppay_ident; release its stage entries now.
+        state->camsrcPtsMap.consume(ptsKey);
+        state->vidconvPtsMap.consume(ptsKey);
+        state->cropPtsMap.consume(ptsKey);
+        state->cameraPosePtsMap.consume(ptsKey);
+        return GST_PAD_PROBE_DROP;
+    }
+
+    state->encodeAgeSumUs.fetch_add(age, std::memory_order_relaxed);
+    state->encodeAgeCount.fetch_add(1, std::memory_order_relaxed);
+    if (age > state->encodeAgeMaxUs.load(std::memory_order_relaxed)) {
+        state->encodeAgeMaxUs.store(age, std::memory_order_relaxed);  // single writer
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// Freshness gate, fresh_queue input side: "overrun" fires once per frame the
+// leaky queue discards because a newer one arrived before the encoder took it.
+static void OnFreshQueueOverrun(GstElement *queue, gpointer user_data) {
+    (void) queue;
+    static_cast<PipelineState *>(user_data)->overrunDrops.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Hook the freshness gate on `queueName` up to `state` (the state the stream's
+// latency handoffs resolve to, so camsrcPtsMap is the one camsrc_ident fills).
+static void AttachFreshnessGate(GstElement *pipeline, const char *queueName, PipelineState &state,
+                                const StreamingConfig &cfg) {
+    state.maxFrameAgeUs.store(static_cast<uint64_t>(std::max(cfg.maxFrameAgeMs, 0)) * 1000,
+                              std::memory_order_relaxed);
+
+    GstElement *queue = gst_bin_get_by_name(GST_BIN(pipeline), queueName);
+    if (!queue) {
+        std::cerr << "Freshness gate: " << queueName << " not found\n";
+        return;
+    }
+    g_signal_connect(queue, "overrun", G_CALLBACK(OnFreshQueueOverrun), &state);
+    GstPad *srcPad = gst_element_get_static_pad(queue, "src");
+    if (srcPad) {
+        gst_pad_add_probe(srcPad, GST_PAD_PROBE_TYPE_BUFFER, FreshQueueSrcProbe, &state, nullptr);
+        gst_object_unref(srcPad);
+    }
+    gst_object_unref(queue);
+}
+
+// Periodic freshness summary for one stream: encode-start age over the window
+// since the last report, plus the cumulative drop counters.
+static void ReportFrameFreshness(const std::string &name, PipelineState &state) {
+    const uint64_t n = state.encodeAgeCount.exchange(0, std::memory_order_relaxed);
+    const uint64_t sum = state.encodeAgeSumUs.exchange(0, std::memory_order_relaxed);
+    const uint64_t max = state.encodeAgeMaxUs.exchange(0, std::memory_order_relaxed);
+    std::cout << name << ": frame age at encode avg " << (n ? sum / n : 0) << " us, max " << max
+              << " us (" << n << " frames); dropped " << state.overrunDrops.load() << " superseded, "
+              << state.ageDrops.load() << " over max age\n";
+}
+
+// Foveated mode: attach the inset stream's own encoder tail + udpsink behind
+// fovea_fresh_queue:
+//     ... fovea_rate_capsfilter ! fovea_fresh_queue ! [fovea_enc_tail bin] ! fovea_udpsink (portRight)
+// The inset is never hot-swapped (codec/res/fps changes rebuild in this mode),
+// so its elements keep the stock tail names inside their own bin.
+static void AddFoveaStream(GstElement *pipeline, const StreamingConfig &tailCfg) {
+    GstElement *udpsink = gst_element_factory_make("udpsink", "fovea_udpsink");
+    if (!udpsink) {
+        gst_object_unref(pipeline);
+        throw std::runtime_error("Failed to create fovea_udpsink");
+    }
+    g_object_set(udpsink, "host", tailCfg.ip.c_str(), "port", tailCfg.portRight, "sync", FALSE, nullptr);
+
+    GError *err = nullptr;
+    const std::string tailStr = GetEncoderTailDescription(tailCfg);
+    GstElement *encTail = gst_parse_bin_from_description(tailStr.c_str(), TRUE, &err);
+    if (!encTail) {
+        const std::string m = err ? err->message : "unknown error";
+        if (err) g_error_free(err);
+        gst_object_unref(udpsink);
+        gst_object_unref(pipeline);
+        throw std::runtime_error("Fovea encoder-tail parse failed: " + m);
+    }
+    gst_element_set_name(encTail, std::string(FoveaNames::ENC_TAIL).c_str());
+
+    gst_bin_add_many(GST_BIN(pipeline), encTail, udpsink, nullptr);
+
+    GstElement *freshQueue = gst_bin_get_by_name(GST_BIN(pipeline), "fovea_fresh_queue");
+    const bool linked = freshQueue && gst_element_link_many(freshQueue, encTail, udpsink, nullptr);
+    if (freshQueue) gst_object_unref(freshQueue);
+    if (!linked) {
+        gst_object_unref(pipeline);
+        throw std::runtime_error("Failed to link fovea front-end -> fovea_enc_tail -> fovea_udpsink");
+    }
+
+    // fovea_vidconv_ident is in the front-end; enc_ident/rtppay_ident are looked
+    // up in the fovea bin (the pipeline-wide lookup would find the base tail's).
+    GstElement *vidconv = gst_bin_get_by_name(GST_BIN(pipeline), "fovea_vidconv_ident");
+    GstElement *enc = gst_bin_get_by_name(GST_BIN(encTail), "enc_ident");
+    GstElement *rtppay = gst_bin_get_by_name(GST_BIN(encTail), "rtppay_ident");
+    for (GstElement *e : {vidconv, enc, rtppay}) {
+        if (e) {
+            g_signal_connect(e, "handoff", G_CALLBACK(OnIdentityHandoffCameraStreaming), nullptr);
+            gst_object_unref(e);
+        }
+    }
+}
+
 // Build a per-camera pipeline as a permanent camera front-end + a SWAPPABLE
 // encoder tail + a codec-independent udpsink:
-//     nvarguscamerasrc ... videorate ! rate_capsfilter ! [enc_tail bin] ! udpsink
+//     nvarguscamerasrc ... videorate ! rate_capsfilter ! fresh_queue ! [enc_tail bin] ! udpsink
 // The front-end and udpsink live for the pipeline's whole life; codec changes
 // hot-swap only the enc_tail bin (SwapEncoderTail) and fps changes only retime
 // rate_capsfilter
@@ -140,8 +278,15 @@ GstElement *BuildCameraPipeline(int sensorId, const StreamingConfig &streamingCo
     const std::string side = sensorId == 0 ? "left" : "right";
     const int port = sensorId == 0 ? streamingConfig.portLeft : streamingConfig.portRight;
 
-    const std::string frontStr = GetCameraFrontEndDescription(streamingConfig, sensorId);
-    const std::string tailStr = GetEncoderTailDescription(streamingConfig);
+    const bool foveated = streamingConfig.videoMode == VideoMode::FOVEATED;
+
+    // Foveated: the base and inset encoders split the configured bitrate.
+    StreamingConfig tailCfg = streamingConfig;
+    if (foveated) tailCfg.bitrate = streamingConfig.bitrate / 2;
+
+    const std::string frontStr = foveated ? GetFoveatedFrontEndDescription(streamingConfig, sensorId)
+                                          : GetCameraFrontEndDescription(streamingConfig, sensorId);
+    const std::string tailStr = GetEncoderTailDescription(tailCfg);
 
     std::cout << "=== Building Pipeline for Camera " << sensorId << " (" << side << ") ===\n";
     std::cout << frontStr << "\n  ! [enc_tail] " << tailStr
@@ -180,16 +325,32 @@ GstElement *BuildCameraPipeline(int sensorId, const StreamingConfig &streamingCo
 
     gst_bin_add_many(GST_BIN(pipeline), encTail, udpsink, nullptr);
 
-    // 4. Link rate_capsfilter -> enc_tail -> udpsink.
-    GstElement *rateCaps = gst_bin_get_by_name(GST_BIN(pipeline), "rate_capsfilter");
-    const bool linked = rateCaps && gst_element_link_many(rateCaps, encTail, udpsink, nullptr);
-    if (rateCaps) gst_object_unref(rateCaps);
+    // 4. Link fresh_queue -> enc_tail -> udpsink.
+    GstElement *freshQueue = gst_bin_get_by_name(GST_BIN(pipeline), "fresh_queue");
+    const bool linked = freshQueue && gst_element_link_many(freshQueue, encTail, udpsink, nullptr);
+    if (freshQueue) gst_object_unref(freshQueue);
     if (!linked) {
         gst_object_unref(pipeline);
         throw std::runtime_error("Failed to link front-end -> enc_tail -> udpsink");
     }
 
     ConnectLatencyHandoffs(pipeline);
+
+    // 5. Foveated: second tail + sink for the inset stream on portRight.
+    auto &baseState = GetState(std::string("pipeline_") + side);
+    baseState.fovea = nullptr;
+    AttachFreshnessGate(pipeline, "fresh_queue", baseState, streamingConfig);
+    if (foveated) {
+        AddFoveaStream(pipeline, tailCfg);
+        AttachFreshnessGate(pipeline, "fovea_fresh_queue",
+                            GetState(std::string("pipeline_") + side + std::string(PipelineNames::FOVEA_SUFFIX)),
+                            streamingConfig);
+        // The front-end starts with the crop centred (until the first gaze update).
+        foveaCropRect.store(PackFoveaRect(0.5 - 0.5 / FOVEA_ZOOM, 0.5 - 0.5 / FOVEA_ZOOM,
+                                          1.0 / FOVEA_ZOOM, 1.0 / FOVEA_ZOOM),
+                            std::memory_order_relaxed);
+        baseState.fovea = &GetState(std::string("pipeline_") + side + std::string(PipelineNames::FOVEA_SUFFIX));
+    }
     return pipeline;
 }
 
@@ -213,8 +374,18 @@ bool CanUpdateDynamically(const StreamingConfig &oldCfg, const StreamingConfig &
         return false;
     }
 
+    // Foveated: the swap probe only knows the base tail, so anything that would
+    // swap it (or retime just one branch) rebuilds both streams together.
+    if (newCfg.videoMode == VideoMode::FOVEATED &&
+        (oldCfg.codec != newCfg.codec || oldCfg.fps != newCfg.fps ||
+         oldCfg.horizontalResolution != newCfg.horizontalResolution ||
+         oldCfg.verticalResolution != newCfg.verticalResolution)) {
+        return false;
+    }
+
     // Stereo/mono: codec + resolution -> encoder-tail swap (+ scale caps); fps ->
-    // rate_capsfilter; bitrate/quality -> live property. Camera never torn down.
+    // rate_capsfilter; bitrate/quality/max frame age -> live property. Camera never
+    // torn down.
     return true;
 }
 
@@ -226,10 +397,10 @@ struct EncSwapContext {
     StreamingConfig cfg;
 };
 
-// Pad-probe (BLOCK_DOWNSTREAM on rate_capsfilter:src) that hot-swaps the encoder
+// Pad-probe (BLOCK_DOWNSTREAM on fresh_queue:src) that hot-swaps the encoder
 // tail for a new codec WITHOUT touching nvarguscamerasrc. Mirrors SwapCameraProbe:
 // while the pad is blocked, detach + NULL + remove the old enc_tail bin, build the
-// new codec's tail, relink rate_capsfilter -> enc_tail -> udpsink, sync to PLAYING,
+// new codec's tail, relink fresh_queue -> enc_tail -> udpsink, sync to PLAYING,
 // reissue a keyframe, then remove the probe to resume flow. The camera front-end
 // never stops.
 GstPadProbeReturn SwapEncoderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
@@ -239,7 +410,7 @@ GstPadProbeReturn SwapEncoderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer
 
     // Resolution rides the same swap: re-assert the downstream scale caps so
     // nvvidconv rescales to the new delivered resolution. The block holds the new
-    // caps event at rate_capsfilter:src until the fresh encoder (rebuilt below) is
+    // caps event at fresh_queue:src until the fresh encoder (rebuilt below) is
     // linked, so it negotiates the new resolution cleanly. Codec-only changes just
     // re-set the same caps (harmless). The camera capture stays fixed at pre-defined resolution.
     {
@@ -257,11 +428,11 @@ GstPadProbeReturn SwapEncoderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer
 
     GstElement *oldTail = gst_bin_get_by_name(GST_BIN(ctx->pipeline), "enc_tail");
     GstElement *udpsink = gst_bin_get_by_name(GST_BIN(ctx->pipeline), "udpsink");
-    GstElement *rateCaps = gst_bin_get_by_name(GST_BIN(ctx->pipeline), "rate_capsfilter");
+    GstElement *freshQueue = gst_bin_get_by_name(GST_BIN(ctx->pipeline), "fresh_queue");
 
-    if (oldTail && udpsink && rateCaps) {
+    if (oldTail && udpsink && freshQueue) {
         gst_element_set_state(oldTail, GST_STATE_NULL);
-        gst_element_unlink(rateCaps, oldTail);
+        gst_element_unlink(freshQueue, oldTail);
         gst_element_unlink(oldTail, udpsink);
         gst_bin_remove(GST_BIN(ctx->pipeline), oldTail);  // drops the pipeline's ref
 
@@ -287,7 +458,7 @@ GstPadProbeReturn SwapEncoderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer
                 gst_object_unref(rtppay_ident);
             }
 
-            if (!gst_element_link_many(rateCaps, newTail, udpsink, nullptr)) {
+            if (!gst_element_link_many(freshQueue, newTail, udpsink, nullptr)) {
                 std::cerr << "Encoder-tail swap: relink failed\n";
             }
             gst_element_sync_state_with_parent(newTail);
@@ -298,30 +469,30 @@ GstPadProbeReturn SwapEncoderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer
             std::cout << "Encoder tail swapped (codec " << ctx->cfg.codec << ", camera kept alive)\n";
         }
     } else {
-        std::cerr << "Encoder-tail swap: missing enc_tail/udpsink/rate_capsfilter\n";
+        std::cerr << "Encoder-tail swap: missing enc_tail/udpsink/fresh_queue\n";
     }
 
     if (oldTail) gst_object_unref(oldTail);
     if (udpsink) gst_object_unref(udpsink);
-    if (rateCaps) gst_object_unref(rateCaps);
+    if (freshQueue) gst_object_unref(freshQueue);
 
     delete ctx;
     return GST_PAD_PROBE_REMOVE;
 }
 
-// Arm the encoder-tail swap probe on rate_capsfilter's src pad. Returns true once
+// Arm the encoder-tail swap probe on fresh_queue's src pad. Returns true once
 // the probe is installed (the swap itself runs on the next buffer). On failure the
 // caller falls back to a full rebuild.
 bool SwapEncoderTail(GstElement *pipeline, const StreamingConfig &newCfg) {
-    GstElement *rateCaps = gst_bin_get_by_name(GST_BIN(pipeline), "rate_capsfilter");
-    if (!rateCaps) {
-        std::cerr << "SwapEncoderTail: rate_capsfilter not found\n";
+    GstElement *freshQueue = gst_bin_get_by_name(GST_BIN(pipeline), "fresh_queue");
+    if (!freshQueue) {
+        std::cerr << "SwapEncoderTail: fresh_queue not found\n";
         return false;
     }
-    GstPad *srcPad = gst_element_get_static_pad(rateCaps, "src");
-    gst_object_unref(rateCaps);
+    GstPad *srcPad = gst_element_get_static_pad(freshQueue, "src");
+    gst_object_unref(freshQueue);
     if (!srcPad) {
-        std::cerr << "SwapEncoderTail: rate_capsfilter src pad not found\n";
+        std::cerr << "SwapEncoderTail: fresh_queue src pad not found\n";
         return false;
     }
 
@@ -376,21 +547,38 @@ bool UpdatePipelineProperties(GstElement *pipeline, const StreamingConfig &oldCf
         }
     }
 
-    // 3. Bitrate / quality -> live property on the encoder. Skipped when the tail
+    // 3. Max frame age -> the freshness gate reads it per frame.
+    if (oldCfg.maxFrameAgeMs != newCfg.maxFrameAgeMs) {
+        std::cout << "Max frame age " << oldCfg.maxFrameAgeMs << " -> " << newCfg.maxFrameAgeMs << " ms\n";
+        const uint64_t maxAgeUs = static_cast<uint64_t>(std::max(newCfg.maxFrameAgeMs, 0)) * 1000;
+        auto &state = GetState(GST_OBJECT_NAME(pipeline));
+        state.maxFrameAgeUs.store(maxAgeUs, std::memory_order_relaxed);
+        if (state.fovea) state.fovea->maxFrameAgeUs.store(maxAgeUs, std::memory_order_relaxed);
+    }
+
+    // 4. Bitrate / quality -> live property on the encoder. Skipped when the tail
     //    just swapped (codec or resolution): the new tail was built from newCfg.
+    //    Foveated: both tails, each at half the bitrate (see BuildCameraPipeline).
     if (!codecChanged && !resChanged) {
-        GstElement *encoder = gst_bin_get_by_name(GST_BIN(pipeline), "encoder");
-        if (encoder) {
-            if (newCfg.codec == Codec::JPEG) {
-                std::cout << "Updating JPEG quality to " << newCfg.encodingQuality << "\n";
-                g_object_set(encoder, "quality", newCfg.encodingQuality, nullptr);
+        const bool foveated = newCfg.videoMode == VideoMode::FOVEATED;
+        const int bitrate = foveated ? newCfg.bitrate / 2 : newCfg.bitrate;
+        const std::string tails[] = {"enc_tail", std::string(FoveaNames::ENC_TAIL)};
+        for (int i = 0; i < (foveated ? 2 : 1); i++) {
+            GstElement *tail = gst_bin_get_by_name(GST_BIN(pipeline), tails[i].c_str());
+            GstElement *encoder = tail ? gst_bin_get_by_name(GST_BIN(tail), "encoder") : nullptr;
+            if (tail) gst_object_unref(tail);
+            if (encoder) {
+                if (newCfg.codec == Codec::JPEG) {
+                    std::cout << "Updating JPEG quality (" << tails[i] << ") to " << newCfg.encodingQuality << "\n";
+                    g_object_set(encoder, "quality", newCfg.encodingQuality, nullptr);
+                } else {
+                    std::cout << "Updating bitrate (" << tails[i] << ") to " << bitrate << "\n";
+                    g_object_set(encoder, "bitrate", bitrate, nullptr);
+                }
+                gst_object_unref(encoder);
             } else {
-                std::cout << "Updating bitrate to " << newCfg.bitrate << "\n";
-                g_object_set(encoder, "bitrate", newCfg.bitrate, nullptr);
+                std::cerr << "Bitrate/quality update: encoder not found in " << tails[i] << "\n";
             }
-            gst_object_unref(encoder);
-        } else {
-            std::cerr << "Bitrate/quality update: encoder not found\n";
         }
     }
 
@@ -398,6 +586,15 @@ bool UpdatePipelineProperties(GstElement *pipeline, const StreamingConfig &oldCf
     return true;
 }
 
+// Drop the gaze listener's handle on `pipeline`'s fovea_crop before teardown.
+void ReleaseFoveaCrop(GstElement *pipeline) {
+    std::lock_guard<std::mutex> lock(fovea_mutex);
+    if (fovea_crop && GST_ELEMENT_PARENT(fovea_crop) == GST_OBJECT(pipeline)) {
+        gst_object_unref(fovea_crop);
+        fovea_crop = nullptr;
+    }
+}
+
 void RunCameraStreamingPipelineDynamic(int sensorId) {
     // Stagger camera initialization to avoid Argus contention on startup
     if (sensorId == 1) {
@@ -432,9 +629,10 @@ void RunCameraStreamingPipelineDynamic(int sensorId) {
             if (seen_version == 0) continue;
         }
 
-        // In MONO mode, only camera 0 (left) should be active
-        if (cfg.videoMode == VideoMode::MONO && sensorId == 1) {
-            std::cout << "Camera 1 disabled in MONO mode, sleeping...\n";
+        // In MONO / FOVEATED mode, only camera 0 (left) should be active
+        if ((cfg.videoMode == VideoMode::MONO || cfg.videoMode == VideoMode::FOVEATED) && sensorId == 1) {
+            std::cout << "Camera 1 disabled in " << (cfg.videoMode == VideoMode::MONO ? "MONO" : "FOVEATED")
+                      << " mode, sleeping...\n";
             std::this_thread::sleep_for(std::chrono::seconds(1));
             continue;
         }
@@ -459,8 +657,13 @@ void RunCameraStreamingPipelineDynamic(int sensorId) {
                     std::lock_guard<std::mutex> lock(pipelines_mutex);
                     pipelines[sensorId] = pipeline;
                 }
+                if (cfg.videoMode == VideoMode::FOVEATED) {
+                    std::lock_guard<std::mutex> lock(fovea_mutex);
+                    fovea_crop = gst_bin_get_by_name(GST_BIN(pipeline), "fovea_crop");
+                }
                 if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
                     std::cerr << "Unable to set pipeline PLAYING\n";
+                    ReleaseFoveaCrop(pipeline);
                     StopPipeline(pipeline);
                     std::lock_guard<std::mutex> lock(pipelines_mutex);
                     pipelines[sensorId] = nullptr;
@@ -490,8 +693,19 @@ void RunCameraStreamingPipelineDynamic(int sensorId) {
         GstBus *bus = gst_element_get_bus(pipeline);
         bool rebuild = false;
         bool error_during_streaming = false;
+        auto lastFreshnessReport = std::chrono::steady_clock::now();
 
         while (!stop_requested.load() && !rebuild) {
+            if (std::chrono::steady_clock::now() - lastFreshnessReport >= FRESHNESS_REPORT_INTERVAL) {
+                lastFreshnessReport = std::chrono::steady_clock::now();
+                auto &state = GetState(GST_OBJECT_NAME(pipeline));
+                ReportFrameFreshness(GST_OBJECT_NAME(pipeline), state);
+                if (state.fovea) {
+                    ReportFrameFreshness(std::string(GST_OBJECT_NAME(pipeline)) + std::string(PipelineNames::FOVEA_SUFFIX),
+                                         *state.fovea);
+                }
+            }
+
             // 100ms poll so updates can be noticed
             GstMessage *msg = gst_bus_timed_pop_filtered(
                 bus,
@@ -541,6 +755,7 @@ void RunCameraStreamingPipelineDynamic(int sensorId) {
             // Serialize Argus STREAMOFF/teardown with the other camera thread
             // (see camera_lifecycle_mutex rationale at the build block above).
             std::lock_guard<std::mutex> lifecycle(camera_lifecycle_mutex);
+            ReleaseFoveaCrop(pipeline);
             StopPipeline(pipeline);
             std::lock_guard<std::mutex> lock(pipelines_mutex);
             pipelines[sensorId] = nullptr;
@@ -934,6 +1149,130 @@ void RunPanoramicPipeline() {
     }
 }
 
+// Foveated mode: move the inset crop to where the operator is looking.
+// The relay sends [azimuth offset (float)] [elevation offset (float)] in radians,
+// head pose relative to the (estimated) camera boresight. Positive azimuth is
+// left, positive elevation is up; delivered frames are vertically flipped, so
+// delivered row 0 is the bottom of the view.
+void FoveaGazeListener() {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        std::cerr << "Failed to create fovea gaze socket\n";
+        return;
+    }
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(FOVEA_GAZE_PORT);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        std::cerr << "Failed to bind fovea gaze socket on port " << FOVEA_GAZE_PORT << "\n";
+        close(sock);
+        return;
+    }
+
+    std::cout << "Fovea gaze listener started on port " << FOVEA_GAZE_PORT << "\n";
+
+    struct timeval tv{};
+    tv.tv_sec = 1;
+    tv.tv_usec = 0;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    constexpr double vfov = CAMERA_HFOV_RAD * CAMERA_CAPTURE_HEIGHT / CAMERA_CAPTURE_WIDTH;
+    constexpr double cropW = static_cast<double>(FOVEA_CROP_WIDTH) / CAMERA_CAPTURE_WIDTH;
+    constexpr double cropH = static_cast<double>(FOVEA_CROP_HEIGHT) / CAMERA_CAPTURE_HEIGHT;
+
+    uint8_t buf[16];
+
+    while (!stop_requested.load()) {
+        struct sockaddr_in client{};
+        socklen_t len = sizeof(client);
+        ssize_t n = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *)&client, &len);
+        if (n < 8) continue;
+
+        float az, el;
+        std::memcpy(&az, buf, sizeof(az));
+        std::memcpy(&el, buf + 4, sizeof(el));
+        if (!std::isfinite(az) || !std::isfinite(el)) continue;
+
+        // Crop origin in the delivered frame (normalised), clamped inside it.
+        const double cx = 0.5 - az / CAMERA_HFOV_RAD;
+        const double cy = 0.5 + el / vfov;
+        const double x = std::clamp(cx - cropW / 2, 0.0, 1.0 - cropW);
+        const double y = std::clamp(cy - cropH / 2, 0.0, 1.0 - cropH);
+
+        // nvvidconv crops the INPUT (pre-flip) frame: flip the rows back.
+        const int left = static_cast<int>(x * CAMERA_CAPTURE_WIDTH) & ~1;
+        const int top = (CAMERA_CAPTURE_HEIGHT - static_cast<int>(y * CAMERA_CAPTURE_HEIGHT) - FOVEA_CROP_HEIGHT) & ~1;
+
+        {
+            std::lock_guard<std::mutex> lock(fovea_mutex);
+            if (!fovea_crop) continue;
+            g_object_set(fovea_crop,
+                         "left", left, "right", left + FOVEA_CROP_WIDTH,
+                         "top", top, "bottom", top + FOVEA_CROP_HEIGHT, nullptr);
+        }
+
+        // Publish what was applied, in delivered-frame coordinates.
+        const int yOut = CAMERA_CAPTURE_HEIGHT - (top + FOVEA_CROP_HEIGHT);
+        foveaCropRect.store(PackFoveaRect(static_cast<double>(left) / CAMERA_CAPTURE_WIDTH,
+                                          static_cast<double>(yOut) / CAMERA_CAPTURE_HEIGHT,
+                                          cropW, cropH),
+                            std::memory_order_relaxed);
+    }
+
+    close(sock);
+}
+
+// Camera pose tags: the relay sends the estimated pan-tilt boresight,
+// [azimuth (float)] [elevation (float)] in radians, with every head pose it
+// forwards. camsrc_ident tags each frame with the pose at its exposure, and
+// the headset reprojects the image by what the head has moved since.
+void CameraPoseListener() {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        std::cerr << "Failed to create camera pose socket\n";
+        return;
+    }
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(CAMERA_POSE_PORT);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        std::cerr << "Failed to bind camera pose socket on port " << CAMERA_POSE_PORT << "\n";
+        close(sock);
+        return;
+    }
+
+    std::cout << "Camera pose listener started on port " << CAMERA_POSE_PORT << "\n";
+
+    struct timeval tv{};
+    tv.tv_sec = 1;
+    tv.tv_usec = 0;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    uint8_t buf[16];
+
+    while (!stop_requested.load()) {
+        struct sockaddr_in client{};
+        socklen_t len = sizeof(client);
+        ssize_t n = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *)&client, &len);
+        if (n < 8) continue;
+
+        float az, el;
+        std::memcpy(&az, buf, sizeof(az));
+        std::memcpy(&el, buf + 4, sizeof(el));
+        if (!std::isfinite(az) || !std::isfinite(el)) continue;
+
+        cameraPoseHistory.record(GetCurrentUs(), PackCameraPose(az, el));
+    }
+
+    close(sock);
+}
+
 int RunCameraStreaming() {
     std::cout << "Streaming driver running; waiting for updates on stdin\n";
 
@@ -955,10 +1294,16 @@ int RunCameraStreaming() {
         RunPanoramicPipeline();
         camSelectThread.join();
     } else {
+        // Gaze listener runs in every non-panoramic mode so a live switch to
+        // FOVEATED (which rebuilds the camera pipelines) is steerable at once.
+        std::thread gazeThread(FoveaGazeListener);
+        std::thread poseThread(CameraPoseListener);
         std::thread t0(RunCameraStreamingPipelineDynamic, 0);
         std::thread t1(RunCameraStreamingPipelineDynamic, 1);
         t0.join();
         t1.join();
+        gazeThread.join();
+        poseThread.join();
     }
 
     return 0;
@@ -977,6 +1322,7 @@ VideoMode GetVideoModeFromString(const std::string &videoModeString) {
     if (videoModeString == "stereo") return VideoMode::STEREO;
     if (videoModeString == "mono") return VideoMode::MONO;
     if (videoModeString == "panoramic") return VideoMode::PANORAMIC;
+    if (videoModeString == "foveated") return VideoMode::FOVEATED;
     throw std::invalid_argument("Invalid video mode passed!");
 }
 
@@ -992,6 +1338,7 @@ StreamingConfig ConfigFromJson(const json &c) {
     out.verticalResolution = c.at("verticalResolution").get<int>();
     out.videoMode = GetVideoModeFromString(c.at("videoMode").get<std::string>());
     out.fps = c.at("fps").get<int>();
+    out.maxFrameAgeMs = c.value("maxFrameAgeMs", DEFAULT_MAX_FRAME_AGE_MS);
     return out;
 }
 
@@ -1011,6 +1358,7 @@ std::string VideoModeToString(VideoMode mode) {
         case STEREO: return "STEREO";
         case MONO: return "MONO";
         case PANORAMIC: return "PANORAMIC";
+        case FOVEATED: return "FOVEATED";
         default: return "UNKNOWN";
     }
 }
@@ -1026,6 +1374,7 @@ void DumpConfig(const StreamingConfig &cfg) {
     std::cout << "  Resolution: " << cfg.horizontalResolution << "x" << cfg.verticalResolution << "\n";
     std::cout << "  Video Mode: " << VideoModeToString(cfg.videoMode) << "\n";
     std::cout << "  FPS: " << cfg.fps << "\n";
+    std::cout << "  Max Frame Age: " << cfg.maxFrameAgeMs << " ms\n";
     std::cout << "==========================\n";
 }
 